@@ -9,6 +9,7 @@ import { dumpModules, getAllModules, gatherAllModules } from "./lib/passes/gathe
 
 import { bold, reset, genFreshFileName, Writer } from "./lib/echo-util";
 import { Triple } from "./lib/triple";
+import { TypeProfile } from "./lib/type-profile";
 
 import {
     LLVM_SUFFIX as DEFAULT_LLVM_SUFFIX,
@@ -98,6 +99,7 @@ let options = {
     warn_on_undeclared: false,
     frozen_global: false,
     record_types: false,
+    type_profile: null,
     output_filename: null,
     show_help: false,
     leave_temp_files: false,
@@ -141,6 +143,10 @@ function add_debug_after_pass(passname) {
     options.debug_passes.add(passname);
 }
 
+function use_type_profile(filename) {
+    options.type_profile = TypeProfile.read(filename);
+}
+
 function add_import_variable(arg) {
     let equal_idx = arg.indexOf("=");
     if (equal_idx == -1) throw new Error("-I flag requires <name>=<value>");
@@ -217,6 +223,11 @@ let args = {
         flag: "record_types",
         help: "generates an executable which records types in a format later used for optimizations.",
     },
+    "--use-type-profile": {
+        handler: use_type_profile,
+        handlerArgc: 1,
+        help: "specializes code using the profile written by a --record-types executable (ejs-types.profile, or $EJS_TYPE_PROFILE.)",
+    },
     "--frozen-global": {
         flag: "frozen_global",
         help: "compiler acts as if the global object is frozen after initialization, allowing for faster access.",
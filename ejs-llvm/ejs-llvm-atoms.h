@@ -79,6 +79,24 @@ EJS_ATOM(createBitCast)
 EJS_ATOM(createSwitch)
 EJS_ATOM(createSelect)
 EJS_ATOM(createNswSub)
+EJS_ATOM(createFSub)
+EJS_ATOM(createFMul)
+EJS_ATOM(createFDiv)
+EJS_ATOM(createFRem)
+EJS_ATOM(createFCmpOEq)
+EJS_ATOM(createFCmpUNe)
+EJS_ATOM(createFCmpOLt)
+EJS_ATOM(createFCmpOLe)
+EJS_ATOM(createFCmpOGt)
+EJS_ATOM(createFCmpOGe)
+EJS_ATOM(createICmpULe)
+EJS_ATOM(createXor)
+EJS_ATOM(createShl)
+EJS_ATOM(createLShr)
+EJS_ATOM(createAShr)
+EJS_ATOM(createSIToFP)
+EJS_ATOM(createUIToFP)
+EJS_ATOM(createFPToSI)
 EJS_ATOM(createLandingPad)
 EJS_ATOM(createResume)
 EJS_ATOM(getDoubleTy)
@@ -355,6 +355,147 @@ namespace ejsllvm {
         return Value_new(_llvm_builder.CreateNSWSub(lhs, rhs, name));
     }
 
+    static EJS_NATIVE_FUNC(IRBuilder_createFSub) {
+        REQ_LLVM_VAL_ARG(0, lhs);
+        REQ_LLVM_VAL_ARG(1, rhs);
+        FALLBACK_EMPTY_UTF8_ARG(2, name);
+
+        return Value_new(_llvm_builder.CreateFSub(lhs, rhs, name));
+    }
+
+    static EJS_NATIVE_FUNC(IRBuilder_createFMul) {
+        REQ_LLVM_VAL_ARG(0, lhs);
+        REQ_LLVM_VAL_ARG(1, rhs);
+        FALLBACK_EMPTY_UTF8_ARG(2, name);
+
+        return Value_new(_llvm_builder.CreateFMul(lhs, rhs, name));
+    }
+
+    static EJS_NATIVE_FUNC(IRBuilder_createFDiv) {
+        REQ_LLVM_VAL_ARG(0, lhs);
+        REQ_LLVM_VAL_ARG(1, rhs);
+        FALLBACK_EMPTY_UTF8_ARG(2, name);
+
+        return Value_new(_llvm_builder.CreateFDiv(lhs, rhs, name));
+    }
+
+    static EJS_NATIVE_FUNC(IRBuilder_createFRem) {
+        REQ_LLVM_VAL_ARG(0, lhs);
+        REQ_LLVM_VAL_ARG(1, rhs);
+        FALLBACK_EMPTY_UTF8_ARG(2, name);
+
+        return Value_new(_llvm_builder.CreateFRem(lhs, rhs, name));
+    }
+
+    static EJS_NATIVE_FUNC(IRBuilder_createFCmpOEq) {
+        REQ_LLVM_VAL_ARG(0, lhs);
+        REQ_LLVM_VAL_ARG(1, rhs);
+        FALLBACK_EMPTY_UTF8_ARG(2, name);
+
+        return Value_new(_llvm_builder.CreateFCmpOEQ(lhs, rhs, name));
+    }
+
+    static EJS_NATIVE_FUNC(IRBuilder_createFCmpUNe) {
+        REQ_LLVM_VAL_ARG(0, lhs);
+        REQ_LLVM_VAL_ARG(1, rhs);
+        FALLBACK_EMPTY_UTF8_ARG(2, name);
+
+        return Value_new(_llvm_builder.CreateFCmpUNE(lhs, rhs, name));
+    }
+
+    static EJS_NATIVE_FUNC(IRBuilder_createFCmpOLt) {
+        REQ_LLVM_VAL_ARG(0, lhs);
+        REQ_LLVM_VAL_ARG(1, rhs);
+        FALLBACK_EMPTY_UTF8_ARG(2, name);
+
+        return Value_new(_llvm_builder.CreateFCmpOLT(lhs, rhs, name));
+    }
+
+    static EJS_NATIVE_FUNC(IRBuilder_createFCmpOLe) {
+        REQ_LLVM_VAL_ARG(0, lhs);
+        REQ_LLVM_VAL_ARG(1, rhs);
+        FALLBACK_EMPTY_UTF8_ARG(2, name);
+
+        return Value_new(_llvm_builder.CreateFCmpOLE(lhs, rhs, name));
+    }
+
+    static EJS_NATIVE_FUNC(IRBuilder_createFCmpOGt) {
+        REQ_LLVM_VAL_ARG(0, lhs);
+        REQ_LLVM_VAL_ARG(1, rhs);
+        FALLBACK_EMPTY_UTF8_ARG(2, name);
+
+        return Value_new(_llvm_builder.CreateFCmpOGT(lhs, rhs, name));
+    }
+
+    static EJS_NATIVE_FUNC(IRBuilder_createFCmpOGe) {
+        REQ_LLVM_VAL_ARG(0, lhs);
+        REQ_LLVM_VAL_ARG(1, rhs);
+        FALLBACK_EMPTY_UTF8_ARG(2, name);
+
+        return Value_new(_llvm_builder.CreateFCmpOGE(lhs, rhs, name));
+    }
+
+    static EJS_NATIVE_FUNC(IRBuilder_createICmpULe) {
+        REQ_LLVM_VAL_ARG(0, lhs);
+        REQ_LLVM_VAL_ARG(1, rhs);
+        FALLBACK_EMPTY_UTF8_ARG(2, name);
+
+        return Value_new(_llvm_builder.CreateICmpULE(lhs, rhs, name));
+    }
+
+    static EJS_NATIVE_FUNC(IRBuilder_createXor) {
+        REQ_LLVM_VAL_ARG(0, lhs);
+        REQ_LLVM_VAL_ARG(1, rhs);
+        FALLBACK_EMPTY_UTF8_ARG(2, name);
+
+        return Value_new(_llvm_builder.CreateXor(lhs, rhs, name));
+    }
+
+    static EJS_NATIVE_FUNC(IRBuilder_createShl) {
+        REQ_LLVM_VAL_ARG(0, lhs);
+        REQ_LLVM_VAL_ARG(1, rhs);
+        FALLBACK_EMPTY_UTF8_ARG(2, name);
+
+        return Value_new(_llvm_builder.CreateShl(lhs, rhs, name));
+    }
+
+    static EJS_NATIVE_FUNC(IRBuilder_createLShr) {
+        REQ_LLVM_VAL_ARG(0, lhs);
+        REQ_LLVM_VAL_ARG(1, rhs);
+        FALLBACK_EMPTY_UTF8_ARG(2, name);
+
+        return Value_new(_llvm_builder.CreateLShr(lhs, rhs, name));
+    }
+
+    static EJS_NATIVE_FUNC(IRBuilder_createAShr) {
+        REQ_LLVM_VAL_ARG(0, lhs);
+        REQ_LLVM_VAL_ARG(1, rhs);
+        FALLBACK_EMPTY_UTF8_ARG(2, name);
+
+        return Value_new(_llvm_builder.CreateAShr(lhs, rhs, name));
+    }
+
+    static EJS_NATIVE_FUNC(IRBuilder_createSIToFP) {
+        REQ_LLVM_VAL_ARG(0, V);
+        REQ_LLVM_TYPE_ARG(1, dest_ty);
+        FALLBACK_EMPTY_UTF8_ARG(2, name);
+        return Value_new (_llvm_builder.CreateSIToFP(V, dest_ty, name));
+    }
+
+    static EJS_NATIVE_FUNC(IRBuilder_createUIToFP) {
+        REQ_LLVM_VAL_ARG(0, V);
+        REQ_LLVM_TYPE_ARG(1, dest_ty);
+        FALLBACK_EMPTY_UTF8_ARG(2, name);
+        return Value_new (_llvm_builder.CreateUIToFP(V, dest_ty, name));
+    }
+
+    static EJS_NATIVE_FUNC(IRBuilder_createFPToSI) {
+        REQ_LLVM_VAL_ARG(0, V);
+        REQ_LLVM_TYPE_ARG(1, dest_ty);
+        FALLBACK_EMPTY_UTF8_ARG(2, name);
+        return Value_new (_llvm_builder.CreateFPToSI(V, dest_ty, name));
+    }
+
     static EJS_NATIVE_FUNC(IRBuilder_createLandingPad) {
         REQ_LLVM_TYPE_ARG(0, ty);
         REQ_INT_ARG(1, num_clauses);
@@ -438,6 +579,24 @@ namespace ejsllvm {
         OBJ_METHOD(createSelect);
 
         OBJ_METHOD(createNswSub);
+        OBJ_METHOD(createFSub);
+        OBJ_METHOD(createFMul);
+        OBJ_METHOD(createFDiv);
+        OBJ_METHOD(createFRem);
+        OBJ_METHOD(createFCmpOEq);
+        OBJ_METHOD(createFCmpUNe);
+        OBJ_METHOD(createFCmpOLt);
+        OBJ_METHOD(createFCmpOLe);
+        OBJ_METHOD(createFCmpOGt);
+        OBJ_METHOD(createFCmpOGe);
+        OBJ_METHOD(createICmpULe);
+        OBJ_METHOD(createXor);
+        OBJ_METHOD(createShl);
+        OBJ_METHOD(createLShr);
+        OBJ_METHOD(createAShr);
+        OBJ_METHOD(createSIToFP);
+        OBJ_METHOD(createUIToFP);
+        OBJ_METHOD(createFPToSI);
     
         OBJ_METHOD(createLandingPad);
         OBJ_METHOD(createResume);
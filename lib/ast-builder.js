@@ -233,7 +233,7 @@ export function labeledStatement(label, body) {
     return {
         type: LabeledStatement,
         label: isast(label),
-        body: body.map(isast),
+        body: isast(body),
     };
 }
 export function literal(val) {
@@ -299,6 +299,13 @@ export function switchCase(test, consequent) {
         consequent: isastarray(consequent),
     };
 }
+export function switchStatement(discriminant, cases) {
+    return {
+        type: SwitchStatement,
+        discriminant: isast(discriminant),
+        cases: isastarray(cases),
+    };
+}
 export function thisExpression() {
     return { type: ThisExpression };
 }
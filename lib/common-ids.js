@@ -11,6 +11,8 @@ export const makeClosureNoEnv_id = identifier("%makeClosureNoEnv");
 export const makeAnonClosure_id = identifier("%makeAnonClosure");
 export const makeGenerator_id = identifier("%makeGenerator");
 export const generatorYield_id = identifier("%generatorYield");
+export const makeGeneratorStateMachine_id = identifier("%makeGeneratorStateMachine");
+export const generatorReturn_id = identifier("%generatorReturn");
 export const setSlot_id = identifier("%setSlot");
 export const slot_id = identifier("%slot");
 export const invokeClosure_id = identifier("%invokeClosure");
@@ -48,6 +50,9 @@ export const isNullOrUndefined_id = identifier("%isNullOrUndefined");
 export const argPresent_id = identifier("%argPresent");
 export const getArg_id = identifier("%getArg");
 export const getArgumentsObject_id = identifier("%getArgumentsObject");
+export const argumentsLength_id = identifier("%argumentsLength");
+export const argumentsGet_id = identifier("%argumentsGet");
+export const forwardArgs_id = identifier("%forwardArgs");
 
 export const createIterResult_id = identifier("%createIterResult");
 
@@ -73,5 +78,7 @@ export const getNewTarget_id = identifier("%getNewTarget");
 export const setConstructorKindDerived_id = identifier("%setConstructorKindDerived");
 export const setConstructorKindBase_id = identifier("%setConstructorKindBase");
 export const createIteratorWrapper_id = identifier("%createIteratorWrapper");
+export const iteratorStepValue_id = identifier("%iteratorStepValue");
+export const isIteratorDone_id = identifier("%isIteratorDone");
 export const getNextValue_id = identifier("getNextValue");
 export const getRest_id = identifier("getRest");
@@ -32,6 +32,38 @@ let ir = llvm.IRBuilder;
 
 let hasOwn = Object.prototype.hasOwnProperty;
 
+// array literals with at least this many constant elements share storage with a global
+// until they're written to.
+const COW_ARRAY_MIN_LENGTH = 4;
+
+// binary operators we open-code when both operands are numbers.  the
+// value is the IRBuilder method used for the fast path.
+const NUMERIC_ARITH_OPS = {
+    "+": "createFAdd",
+    "-": "createFSub",
+    "*": "createFMul",
+    "/": "createFDiv",
+    "%": "createFRem",
+};
+const NUMERIC_COMPARE_OPS = {
+    "<": "createFCmpOLt",
+    "<=": "createFCmpOLe",
+    ">": "createFCmpOGt",
+    ">=": "createFCmpOGe",
+    "==": "createFCmpOEq",
+    "===": "createFCmpOEq",
+    "!=": "createFCmpUNe",
+    "!==": "createFCmpUNe",
+};
+const NUMERIC_BITWISE_OPS = {
+    "&": "createAnd",
+    "|": "createOr",
+    "^": "createXor",
+    "<<": "createShl",
+    ">>": "createAShr",
+    ">>>": "createLShr",
+};
+
 class LLVMIRVisitor extends TreeVisitor {
     constructor(module, filename, triple, options, abi, allModules, this_module_info, dibuilder, difile) {
         super();
@@ -47,7 +79,10 @@ class LLVMIRVisitor extends TreeVisitor {
 
         this.idgen = startGenerator();
 
-        if (this.options.record_types) this.genRecordId = startGenerator();
+        // record sites are numbered in visit order, so a --use-type-profile
+        // compile gives each site the same id the --record-types compile did.
+        if (this.options.record_types || this.options.type_profile)
+            this.genRecordId = startGenerator();
 
         // build up our runtime method table
         this.ejs_intrinsics = Object.create(null, {
@@ -65,6 +100,9 @@ class LLVMIRVisitor extends TreeVisitor {
             getGlobal: { value: this.handleGetGlobal },
             setGlobal: { value: this.handleSetGlobal },
             getArg: { value: this.handleGetArg },
+            argumentsLength: { value: this.handleArgumentsLength },
+            argumentsGet: { value: this.handleArgumentsGet },
+            forwardArgs: { value: this.handleForwardArgs },
             getNewTarget: { value: this.handleGetNewTarget },
             slot: { value: this.handleGetSlot },
             setSlot: { value: this.handleSetSlot },
@@ -83,6 +121,8 @@ class LLVMIRVisitor extends TreeVisitor {
             makeAnonClosure: { value: this.handleMakeAnonClosure },
             makeGenerator: { value: this.handleMakeGenerator },
             generatorYield: { value: this.handleGeneratorYield },
+            makeGeneratorStateMachine: { value: this.handleMakeGeneratorStateMachine },
+            generatorReturn: { value: this.handleGeneratorReturn },
             createArgScratchArea: { value: this.handleCreateArgScratchArea },
             makeClosureEnv: { value: this.handleMakeClosureEnv },
             typeofIsObject: { value: this.handleTypeofIsObject },
@@ -101,6 +141,8 @@ class LLVMIRVisitor extends TreeVisitor {
             arrayFromSpread: { value: this.handleArrayFromSpread },
             createIterResult: { value: this.handleCreateIterResult },
             createIteratorWrapper: { value: this.handleCreateIteratorWrapper },
+            iteratorStepValue: { value: this.handleIteratorStepValue },
+            isIteratorDone: { value: this.handleIsIteratorDone },
         });
 
         this.opencode_intrinsics = {
@@ -566,7 +608,12 @@ class LLVMIRVisitor extends TreeVisitor {
         for (let i = 0, e = ids.length; i < e; i++) {
             let name = ids[i].id.name;
             if (!scope.has(name)) {
-                allocas[j] = ir.createAlloca(types.EjsValue, `local_${name}`);
+                if (func.unboxed_locals && func.unboxed_locals.has(name)) {
+                    allocas[j] = ir.createAlloca(types.Double, `local_${name}`);
+                    allocas[j]._ejs_unboxed_double = true;
+                } else {
+                    allocas[j] = ir.createAlloca(types.EjsValue, `local_${name}`);
+                }
                 allocas[j].setAlignment(8);
                 scope.set(name, allocas[j]);
                 new_allocas[j] = true;
@@ -614,13 +661,10 @@ class LLVMIRVisitor extends TreeVisitor {
         if (computed) {
             // we load obj[prop], prop can be any value
             let loadprop = this.visit(prop);
+            let site = this.recordGetprop(obj, loadprop);
 
-            if (this.options.record_types)
-                this.createCall(
-                    this.ejs_runtime.record_getprop,
-                    [consts.int32(this.genRecordId()), obj, loadprop],
-                    ""
-                );
+            if (site && site.operandIsDenseArray(0))
+                return this.emitDenseArrayGetprop(obj, loadprop, "getprop_computed", canThrow, false);
 
             return this.createCall(
                 this.ejs_runtime.object_getprop,
@@ -631,13 +675,10 @@ class LLVMIRVisitor extends TreeVisitor {
         } else {
             // we load obj.prop, prop is an id
             let pname = this.getAtom(prop.name);
+            let site = this.recordGetprop(obj, pname);
 
-            if (this.options.record_types)
-                this.createCall(
-                    this.ejs_runtime.record_getprop,
-                    [consts.int32(this.genRecordId()), obj, pname],
-                    ""
-                );
+            if (site && site.operandIsDenseArray(0) && prop.name === "length")
+                return this.emitDenseArrayGetprop(obj, pname, "getprop_length", canThrow, true);
 
             return this.createCall(
                 this.ejs_runtime.object_getprop,
@@ -648,6 +689,129 @@ class LLVMIRVisitor extends TreeVisitor {
         }
     }
 
+    // allocates the id for the next record site.  site is the site's
+    // TypeSite if we're compiling against a type profile and the site
+    // ran in the profiled run.
+    nextRecordSite() {
+        if (!this.genRecordId) return { id: -1, site: undefined };
+        let id = this.genRecordId();
+        let site = this.options.type_profile
+            ? this.options.type_profile.lookup(this.filename, id)
+            : undefined;
+        return { id, site };
+    }
+
+    recordGetprop(obj, prop) {
+        let { id, site } = this.nextRecordSite();
+        if (this.options.record_types)
+            this.createCall(
+                this.ejs_runtime.record_getprop,
+                [consts.string(ir, this.filename), consts.int32(id), obj, prop],
+                ""
+            );
+        return site;
+    }
+
+    // the profile says this site only ever saw dense arrays.  check the
+    // specops inline, then load .length or an in-bounds element straight
+    // out of the array.  holes and non-index keys go to
+    // _ejs_array_getprop_dense, anything that isn't a dense array to
+    // _ejs_object_getprop.
+    emitDenseArrayGetprop(obj, prop, name, canThrow, is_length) {
+        if (this.triple.pointerSize() !== 64)
+            return this.createCall(this.ejs_runtime.object_getprop, [obj, prop], name, canThrow);
+
+        let insertFunc = ir.getInsertBlock().parent;
+        let is_object_bb = new llvm.BasicBlock("getprop_is_object", insertFunc);
+        let dense_bb = new llvm.BasicBlock("getprop_dense_array", insertFunc);
+        let is_number_bb = new llvm.BasicBlock("getprop_number_key", insertFunc);
+        let in_range_bb = new llvm.BasicBlock("getprop_in_range", insertFunc);
+        let load_bb = new llvm.BasicBlock("getprop_load_element", insertFunc);
+        let present_bb = new llvm.BasicBlock("getprop_present", insertFunc);
+        let runtime_bb = new llvm.BasicBlock("getprop_dense_runtime", insertFunc);
+        let generic_bb = new llvm.BasicBlock("getprop_generic", insertFunc);
+        let merge_bb = new llvm.BasicBlock("getprop_merge", insertFunc);
+
+        let result = this.createAlloca(this.currentFunction, types.EjsValue, `${name}_result`);
+
+        ir.createCondBr(this.isObject(obj), is_object_bb, generic_bb);
+
+        let objptr;
+        this.doInsideBBlock(is_object_bb, () => {
+            objptr = this.emitEjsvalToObjectPtr(obj);
+            ir.createCondBr(this.isObjectDenseArray(objptr), dense_bb, generic_bb);
+        });
+
+        let arrayptr, length;
+        this.doInsideBBlock(dense_bb, () => {
+            arrayptr = ir.createBitCast(objptr, types.EjsDenseArray.pointerTo(), "arrayptr");
+            length = this.emitLoadDenseArrayLength(arrayptr);
+            if (is_length) {
+                ir.createStore(
+                    this.boxDouble(ir.createSIToFP(length, types.Double, "length_double"), "length_boxed"),
+                    result
+                );
+                ir.createBr(merge_bb);
+            } else {
+                ir.createCondBr(this.isNumber(prop), is_number_bb, runtime_bb);
+            }
+        });
+
+        let key_d;
+        this.doInsideBBlock(is_number_bb, () => {
+            key_d = this.unboxDouble(prop, "key_double");
+            let in_range = ir.createAnd(
+                ir.createFCmpOGe(key_d, llvm.ConstantFP.getDouble(0), "key_ge_0"),
+                ir.createFCmpOLt(key_d, ir.createSIToFP(length, types.Double, "length_double"), "key_lt_length"),
+                "key_in_range"
+            );
+            ir.createCondBr(in_range, in_range_bb, runtime_bb);
+        });
+
+        let index;
+        this.doInsideBBlock(in_range_bb, () => {
+            index = ir.createFPToSI(key_d, types.Int64, "key_index");
+            let integral = ir.createFCmpOEq(
+                ir.createSIToFP(index, types.Double, "key_index_double"),
+                key_d,
+                "key_is_index"
+            );
+            ir.createCondBr(integral, load_bb, runtime_bb);
+        });
+
+        let element;
+        this.doInsideBBlock(load_bb, () => {
+            let elements = this.emitLoadDenseArrayElements(arrayptr);
+            let element_ptr = ir.createGetElementPointer(types.EjsValue, elements, [index], "element_ptr");
+            element = this.createEjsValueLoad(element_ptr, "element");
+            ir.createCondBr(this.isArrayHole(element), runtime_bb, present_bb);
+        });
+
+        this.doInsideBBlock(present_bb, () => {
+            ir.createStore(element, result);
+            ir.createBr(merge_bb);
+        });
+
+        this.doInsideBBlock(runtime_bb, () => {
+            ir.createStore(
+                this.createCall(this.ejs_runtime.array_getprop_dense, [obj, prop], name, canThrow),
+                result
+            );
+            ir.createBr(merge_bb);
+        });
+
+        this.doInsideBBlock(generic_bb, () => {
+            ir.createStore(
+                this.createCall(this.ejs_runtime.object_getprop, [obj, prop], name, canThrow),
+                result
+            );
+            ir.createBr(merge_bb);
+        });
+
+        ir.setInsertPoint(merge_bb);
+        return this.createEjsValueLoad(result, `${name}_load`);
+    }
+
     setDebugLoc(ast_node) {
         if (!this.options.debug) return;
         if (!ast_node || !ast_node.loc) return;
@@ -727,10 +891,25 @@ class LLVMIRVisitor extends TreeVisitor {
             }
         }
 
+        // if every case test is a distinct int32 literal (the state
+        // dispatch in generator state machines, for one), we can
+        // dispatch with a native switch on the unboxed discriminant
+        let int_cases = this.triple.pointerSize() === 64;
+        let case_values = new Set();
+        for (let _case of n.cases) {
+            if (_case === defaultCase) continue;
+            let v = _case.test.type === b.Literal ? _case.test.value : null;
+            if (typeof v !== "number" || (v | 0) !== v || case_values.has(v)) {
+                int_cases = false;
+                break;
+            }
+            case_values.add(v);
+        }
+
         // for each case, create 2 basic blocks
         for (let _case of n.cases) {
             _case.bb = new llvm.BasicBlock("case_bb", insertFunc);
-            if (_case !== defaultCase)
+            if (_case !== defaultCase && !int_cases)
                 _case.dest_check = new llvm.BasicBlock("case_dest_check_bb", insertFunc);
         }
 
@@ -738,6 +917,15 @@ class LLVMIRVisitor extends TreeVisitor {
 
         let discr = this.visit(n.discriminant);
 
+        if (int_cases) {
+            this.doInsideExitableScope(new SwitchExitableScope(merge_bb), () => {
+                let default_bb = defaultCase ? defaultCase.bb : merge_bb;
+                this.emitIntSwitchDispatch(n.cases, defaultCase, discr, default_bb);
+                this.emitSwitchCaseBodies(n.cases, merge_bb);
+            });
+            return merge_bb;
+        }
+
         let case_checks = [];
         for (let _case of n.cases) {
             if (defaultCase !== _case)
@@ -786,30 +974,76 @@ class LLVMIRVisitor extends TreeVisitor {
                 ir.setInsertPoint(case_checks[casenum + 1].dest_check);
             }
 
-            let case_bodies = [];
+            this.emitSwitchCaseBodies(n.cases, merge_bb);
+        });
 
-            // now insert all the code for the case consequents
-            for (let _case of n.cases)
-                case_bodies.push({
-                    bb: _case.bb,
-                    consequent: _case.consequent,
-                });
+        return merge_bb;
+    }
 
-            case_bodies.push({ bb: merge_bb });
+    emitSwitchCaseBodies(cases, merge_bb) {
+        let case_bodies = [];
 
-            for (let casenum = 0; casenum < case_bodies.length - 1; casenum++) {
-                ir.setInsertPoint(case_bodies[casenum].bb);
-                case_bodies[casenum].consequent.forEach((consequent) => {
-                    this.visit(consequent);
-                });
+        // now insert all the code for the case consequents
+        for (let _case of cases)
+            case_bodies.push({
+                bb: _case.bb,
+                consequent: _case.consequent,
+            });
 
-                ir.createBr(case_bodies[casenum + 1].bb);
-            }
+        case_bodies.push({ bb: merge_bb });
 
-            ir.setInsertPoint(merge_bb);
+        for (let casenum = 0; casenum < case_bodies.length - 1; casenum++) {
+            ir.setInsertPoint(case_bodies[casenum].bb);
+            case_bodies[casenum].consequent.forEach((consequent) => {
+                this.visit(consequent);
+            });
+
+            ir.createBr(case_bodies[casenum + 1].bb);
+        }
+
+        ir.setInsertPoint(merge_bb);
+    }
+
+    // the discriminant only matches an int32 case if it's a number that
+    // converts to that int32 exactly (-0 included), so anything else
+    // goes straight to @default_bb.
+    emitIntSwitchDispatch(cases, defaultCase, discr, default_bb) {
+        let insertFunc = ir.getInsertBlock().parent;
+        let is_number_bb = new llvm.BasicBlock("switch_is_number", insertFunc);
+        let in_range_bb = new llvm.BasicBlock("switch_in_range", insertFunc);
+        let dispatch_bb = new llvm.BasicBlock("switch_dispatch", insertFunc);
+
+        ir.createCondBr(this.isNumber(discr), is_number_bb, default_bb);
+
+        let discr_d;
+        this.doInsideBBlock(is_number_bb, () => {
+            discr_d = this.unboxDouble(discr, "discr_double");
+            let in_range = ir.createAnd(
+                ir.createFCmpOGe(discr_d, llvm.ConstantFP.getDouble(-2147483648), "discr_ge_min"),
+                ir.createFCmpOLe(discr_d, llvm.ConstantFP.getDouble(2147483647), "discr_le_max"),
+                "discr_in_range"
+            );
+            ir.createCondBr(in_range, in_range_bb, default_bb);
         });
 
-        return merge_bb;
+        let discr_i;
+        this.doInsideBBlock(in_range_bb, () => {
+            discr_i = ir.createFPToSI(discr_d, types.Int32, "discr_int");
+            let exact = ir.createFCmpOEq(
+                ir.createSIToFP(discr_i, types.Double, "discr_int_double"),
+                discr_d,
+                "discr_is_int"
+            );
+            ir.createCondBr(exact, dispatch_bb, default_bb);
+        });
+
+        this.doInsideBBlock(dispatch_bb, () => {
+            let switch_stmt = ir.createSwitch(discr_i, default_bb, cases.length);
+            for (let _case of cases) {
+                if (_case !== defaultCase)
+                    switch_stmt.addCase(consts.int32(_case.test.value), _case.bb);
+            }
+        });
     }
 
     visitCase() {
@@ -1002,33 +1236,27 @@ class LLVMIRVisitor extends TreeVisitor {
 
         this.doInsideExitableScope(new LoopExitableScope(n.label, forin_bb, merge_bb), () => {
             // forin_bb:
-            //     moreleft = prop_iterator_next (iterator, true)
-            //     if moreleft === false
+            //     current = prop_iterator_step (iterator)
+            //     if current is the no-iter-value magic
             //         goto merge_bb
             //     else
             //         goto body_bb
             //
+            let current;
             this.doInsideBBlock(forin_bb, () => {
-                let moreleft = this.createCall(
-                    this.ejs_runtime.prop_iterator_next,
-                    [iterator, consts.True()],
-                    "moreleft"
+                current = this.createCall(
+                    this.ejs_runtime.prop_iterator_step,
+                    [iterator],
+                    "iterator_current"
                 );
-                let cmp = ir.createICmpEq(moreleft, consts.False(), "cmpmoreleft");
-                ir.createCondBr(cmp, merge_bb, body_bb);
+                ir.createCondBr(this.isNoIterValue(current), merge_bb, body_bb);
             });
 
             // body_bb:
-            //     current = prop_iteratorcurrent (iterator)
             //     *lhs = current
             //      <body>
             //     goto forin_bb
             this.doInsideBBlock(body_bb, () => {
-                let current = this.createCall(
-                    this.ejs_runtime.prop_iterator_current,
-                    [iterator],
-                    "iterator_current"
-                );
                 this.storeValueInDest(current, lhs);
                 this.visit(n.body);
                 ir.createBr(forin_bb);
@@ -1048,6 +1276,20 @@ class LLVMIRVisitor extends TreeVisitor {
     }
 
     visitUpdateExpression(n) {
+        if (is_intrinsic(n.argument, "%getLocal")) {
+            let dest = this.findIdentifierInScope(n.argument.arguments[0].name);
+            if (dest._ejs_unboxed_double) {
+                let old_d = ir.createLoad(types.Double, dest, "update_load");
+                let new_d = ir[n.operator === "++" ? "createFAdd" : "createFSub"](
+                    old_d,
+                    llvm.ConstantFP.getDouble(1),
+                    "update_temp"
+                );
+                ir.createStore(new_d, dest);
+                return this.boxDouble(n.prefix ? new_d : old_d, "update_result");
+            }
+        }
+
         let result = this.createAlloca(this.currentFunction, types.EjsValue, "%update_result");
         let argument = this.visit(n.argument);
 
@@ -1059,12 +1301,10 @@ class LLVMIRVisitor extends TreeVisitor {
         }
 
         // argument = argument $op 1
-        let update_op = this.ejs_binops[n.operator === "++" ? "+" : "-"];
-        let temp = this.createCall(
-            update_op,
-            [argument, one],
-            "update_temp",
-            !update_op.doesNotThrow
+        let op = n.operator === "++" ? "+" : "-";
+        let update_op = this.ejs_binops[op];
+        let temp = this.emitNumericBinop(op, argument, one, () =>
+            this.createCall(update_op, [argument, one], "update_temp", !update_op.doesNotThrow)
         );
 
         this.storeValueInDest(temp, n.argument);
@@ -1174,7 +1414,11 @@ class LLVMIRVisitor extends TreeVisitor {
             scope
         );
         for (let i = 0, e = n.declarations.length; i < e; i++) {
-            if (!n.declarations[i].init) {
+            if (allocas[i]._ejs_unboxed_double) {
+                // InferNumericLocals has proven the undefined initializer is never read
+                if (n.declarations[i].init && n.declarations[i].init.inferred_type === "number")
+                    ir.createStore(this.visitNumber(n.declarations[i].init), allocas[i]);
+            } else if (!n.declarations[i].init) {
                 // there was not an initializer. we only store undefined
                 // if the alloca is newly allocated.
                 if (new_allocas[i]) {
@@ -1209,7 +1453,10 @@ class LLVMIRVisitor extends TreeVisitor {
         } else if (is_intrinsic(lhs, "%slot")) {
             return ir.createStore(rhvalue, this.handleSlotRef(lhs));
         } else if (is_intrinsic(lhs, "%getLocal")) {
-            return ir.createStore(rhvalue, this.findIdentifierInScope(lhs.arguments[0].name));
+            let dest = this.findIdentifierInScope(lhs.arguments[0].name);
+            if (dest._ejs_unboxed_double)
+                return ir.createStore(this.unboxDouble(rhvalue, "unboxed_store"), dest);
+            return ir.createStore(rhvalue, dest);
         } else if (is_intrinsic(lhs, "%getGlobal")) {
             let gname = lhs.arguments[0].name;
 
@@ -1234,10 +1481,11 @@ class LLVMIRVisitor extends TreeVisitor {
                 `binary assignment operators '${n.operator}' should not exist at this point`
             );
 
+        let { id } = this.nextRecordSite();
         if (this.options.record_types)
             this.createCall(
                 this.ejs_runtime.record_assignment,
-                [consts.int32(this.genRecordId()), rhvalue],
+                [consts.string(ir, this.filename), consts.int32(id), rhvalue],
                 ""
             );
         this.storeValueInDest(rhvalue, lhs);
@@ -1292,6 +1540,7 @@ class LLVMIRVisitor extends TreeVisitor {
         ir_func.entry_bb = entry_bb;
 
         ir_func.literalAllocas = Object.create(null);
+        ir_func.unboxed_locals = n.unboxed_locals || new Set();
 
         let allocas = [];
 
@@ -1415,6 +1664,19 @@ class LLVMIRVisitor extends TreeVisitor {
 
     visitBinaryExpression(n) {
         debug.log(() => `operator = '${n.operator}'`);
+
+        if (n.left.inferred_type === "number" && n.right.inferred_type === "number") {
+            if (hasOwn.call(NUMERIC_ARITH_OPS, n.operator))
+                return this.boxDouble(this.visitNumber(n), `result_${n.operator}`);
+            if (hasOwn.call(NUMERIC_COMPARE_OPS, n.operator))
+                return this.createEjsBoolSelect(
+                    ir[NUMERIC_COMPARE_OPS[n.operator]](
+                        this.visitNumber(n.left),
+                        this.visitNumber(n.right),
+                        `cmp_${n.operator}`
+                    )
+                );
+        }
         let callee = this.ejs_binops[n.operator];
 
         if (!callee) throw new Error(`Internal error: unhandled binary operator '${n.operator}'`);
@@ -1422,11 +1684,13 @@ class LLVMIRVisitor extends TreeVisitor {
         let left_visited = this.visit(n.left);
         let right_visited = this.visit(n.right);
 
+        let { id, site } = this.nextRecordSite();
         if (this.options.record_types)
             this.createCall(
                 this.ejs_runtime.record_binop,
                 [
-                    consts.int32(this.genRecordId()),
+                    consts.string(ir, this.filename),
+                    consts.int32(id),
                     consts.string(ir, n.operator),
                     left_visited,
                     right_visited,
@@ -1434,13 +1698,162 @@ class LLVMIRVisitor extends TreeVisitor {
                 ""
             );
 
+        // the profile says this site never saw a number on one side (string
+        // concatenation, for instance), don't bother with the numeric check.
+        if (site && (site.operandNeverNumber(0) || site.operandNeverNumber(1)))
+            return this.createCall(
+                callee,
+                [left_visited, right_visited],
+                `result_${n.operator}`,
+                !callee.doesNotThrow
+            );
+
         // call the actual runtime binaryop method
-        return this.createCall(
-            callee,
-            [left_visited, right_visited],
-            `result_${n.operator}`,
-            !callee.doesNotThrow
+        return this.emitNumericBinop(n.operator, left_visited, right_visited, () =>
+            this.createCall(
+                callee,
+                [left_visited, right_visited],
+                `result_${n.operator}`,
+                !callee.doesNotThrow
+            )
+        );
+    }
+
+    // expressions InferNumericLocals has marked as always producing a
+    // number can be computed as doubles directly, only boxing them when
+    // the value escapes (see boxDouble).
+    visitNumber(n) {
+        if (n.type === b.Literal && typeof n.value === "number")
+            return llvm.ConstantFP.getDouble(n.value);
+
+        if (is_intrinsic(n, "%getLocal")) {
+            let source = this.findIdentifierInScope(n.arguments[0].name);
+            if (source && source._ejs_unboxed_double)
+                return ir.createLoad(types.Double, source, `load_${n.arguments[0].name}`);
+        }
+
+        if (is_intrinsic(n, "%argumentsLength")) return this.emitArgumentsLength();
+
+        if (
+            n.type === b.BinaryExpression &&
+            hasOwn.call(NUMERIC_ARITH_OPS, n.operator) &&
+            n.left.inferred_type === "number" &&
+            n.right.inferred_type === "number"
+        )
+            return ir[NUMERIC_ARITH_OPS[n.operator]](
+                this.visitNumber(n.left),
+                this.visitNumber(n.right),
+                `result_${n.operator}`
+            );
+
+        return this.unboxDouble(this.visit(n), "unboxed");
+    }
+
+    boxDouble(d, name) {
+        let box_alloca = this.currentFunction.box_alloca;
+        if (!box_alloca) {
+            box_alloca = this.createAlloca(this.currentFunction, types.EjsValue, "box_alloca");
+            this.currentFunction.box_alloca = box_alloca;
+        }
+        ir.createStore(d, ir.createBitCast(box_alloca, types.Double.pointerTo(), "box_as_double"));
+        return this.createEjsValueLoad(box_alloca, name);
+    }
+
+    // only valid when @v is known to be a number
+    unboxDouble(v, name) {
+        return ir.createBitCast(this.getEjsvalBits(v), types.Double, name);
+    }
+
+    // if both operands are numbers (doubles are stored unboxed, so this
+    // is an unsigned compare of the bits against the largest double
+    // encoding) do the operation inline, otherwise fall back to
+    // emit_slow_path(), which calls into the runtime.
+    emitNumericBinop(op, left, right, emit_slow_path) {
+        let is_arith = hasOwn.call(NUMERIC_ARITH_OPS, op);
+        let is_compare = hasOwn.call(NUMERIC_COMPARE_OPS, op);
+        let is_bitwise = hasOwn.call(NUMERIC_BITWISE_OPS, op);
+
+        // the 32 bit layout boxes doubles differently, only open-code for 64 bit.
+        if ((!is_arith && !is_compare && !is_bitwise) || this.triple.pointerSize() !== 64)
+            return emit_slow_path();
+
+        let result = this.createAlloca(this.currentFunction, types.EjsValue, `result_${op}`);
+
+        let insertFunc = ir.getInsertBlock().parent;
+        let fast_bb = new llvm.BasicBlock("numeric_fast", insertFunc);
+        let slow_bb = new llvm.BasicBlock("numeric_slow", insertFunc);
+        let merge_bb = new llvm.BasicBlock("numeric_merge", insertFunc);
+
+        let max_double = consts.int64_lowhi(0xfff80000, 0xffffffff);
+        let left_bits = this.getEjsvalBits(left);
+        let right_bits = this.getEjsvalBits(right);
+        let both_numbers = ir.createAnd(
+            ir.createICmpULe(left_bits, max_double, "left_is_number"),
+            ir.createICmpULe(right_bits, max_double, "right_is_number"),
+            "both_numbers"
         );
+        let left_d = ir.createBitCast(left_bits, types.Double, "left_double");
+        let right_d = ir.createBitCast(right_bits, types.Double, "right_double");
+
+        if (is_bitwise) {
+            // ToInt32 is a truncation toward zero modulo 2^32, which
+            // fptosi to i64 + trunc gives us as long as the value fits in
+            // an i64.  NaN/Infinity/huge values take the slow path.
+            let in_range = (d, name) =>
+                ir.createAnd(
+                    ir.createFCmpOLt(d, llvm.ConstantFP.getDouble(9223372036854775808), `${name}_lt`),
+                    ir.createFCmpOGt(d, llvm.ConstantFP.getDouble(-9223372036854775808), `${name}_gt`),
+                    name
+                );
+            both_numbers = ir.createAnd(
+                both_numbers,
+                ir.createAnd(in_range(left_d, "left_in_range"), in_range(right_d, "right_in_range"), "both_in_range"),
+                "both_int32able"
+            );
+        }
+
+        ir.createCondBr(both_numbers, fast_bb, slow_bb);
+
+        this.doInsideBBlock(fast_bb, () => {
+            if (is_compare) {
+                let cmp = ir[NUMERIC_COMPARE_OPS[op]](left_d, right_d, `cmp_${op}`);
+                ir.createStore(this.createEjsBoolSelect(cmp), result);
+            } else {
+                let result_d;
+                if (is_arith) {
+                    result_d = ir[NUMERIC_ARITH_OPS[op]](left_d, right_d, `result_${op}`);
+                } else {
+                    let toInt32 = (d, name) =>
+                        ir.createTrunc(ir.createFPToSI(d, types.Int64, `${name}_i64`), types.Int32, name);
+                    let left_i = toInt32(left_d, "left_int32");
+                    let right_i = toInt32(right_d, "right_int32");
+                    // shift counts are masked to 5 bits (and llvm
+                    // shifts >= the bit width are poison.)
+                    if (op === "<<" || op === ">>" || op === ">>>")
+                        right_i = ir.createAnd(right_i, consts.int32(0x1f), "shift_count");
+                    let result_i = ir[NUMERIC_BITWISE_OPS[op]](left_i, right_i, `result_${op}`);
+                    result_d =
+                        op === ">>>"
+                            ? ir.createUIToFP(result_i, types.Double, "result_uint32")
+                            : ir.createSIToFP(result_i, types.Double, "result_int32");
+                }
+                let result_as_double = ir.createBitCast(result, types.Double.pointerTo(), "result_as_double");
+                ir.createStore(result_d, result_as_double);
+            }
+            ir.createBr(merge_bb);
+        });
+
+        let slow_result;
+        this.doInsideBBlock(slow_bb, () => {
+            slow_result = emit_slow_path();
+            ir.createStore(slow_result, result);
+            ir.createBr(merge_bb);
+        });
+
+        ir.setInsertPoint(merge_bb);
+        let rv = this.createEjsValueLoad(result, `result_${op}_load`);
+        if (is_compare && slow_result._ejs_returns_ejsval_bool) rv._ejs_returns_ejsval_bool = true;
+        return rv;
     }
 
     visitLogicalExpression(n) {
@@ -1789,7 +2202,69 @@ class LLVMIRVisitor extends TreeVisitor {
         return obj;
     }
 
+    // returns the ejsvals for an array literal made up entirely of number, boolean, and null
+    // literals, or null if it has anything else in it.
+    constantArrayElements(n) {
+        let is32bit = this.triple.pointerSize() === 32;
+        let rv = [];
+        for (let el of n.elements) {
+            if (el == null) return null;
+
+            let value;
+            if (el.type === b.Literal) value = el.value;
+            else if (
+                el.type === b.UnaryExpression &&
+                el.operator === "-" &&
+                el.argument.type === b.Literal &&
+                typeof el.argument.value === "number"
+            )
+                value = -el.argument.value;
+            else return null;
+
+            if (typeof value === "number") rv.push(consts.ejsval_double(value));
+            else if (typeof value === "boolean")
+                rv.push(value ? consts.ejsval_true(is32bit) : consts.ejsval_false(is32bit));
+            else if (value === null) rv.push(consts.ejsval_null(is32bit));
+            else return null;
+        }
+        return rv;
+    }
+
     visitArrayExpression(n) {
+        // constant arrays are emitted as a read-only global, and the array we create at
+        // runtime points at it until the first write.
+        if (n.elements.length >= COW_ARRAY_MIN_LENGTH) {
+            let constant_elements = this.constantArrayElements(n);
+            if (constant_elements) {
+                let arrayType = llvm.ArrayType.get(types.Int64, constant_elements.length);
+                let arrayglobal = new llvm.GlobalVariable(
+                    this.module,
+                    arrayType,
+                    `arrayconst-${this.idgen()}`,
+                    llvm.ConstantArray.get(arrayType, constant_elements),
+                    true
+                );
+                arrayglobal.setAlignment(8);
+
+                let elements = ir.createBitCast(
+                    ir.createInBoundsGetElementPointer(
+                        types.Int64.pointerTo(),
+                        arrayglobal,
+                        [consts.int32(0), consts.int32(0)],
+                        "arrayconst_gep"
+                    ),
+                    types.EjsValue.pointerTo(),
+                    "arrayconst_elements"
+                );
+                return this.createCall(
+                    this.ejs_runtime.array_new_cow,
+                    [consts.int64(constant_elements.length), elements],
+                    "arrtmp",
+                    !this.ejs_runtime.array_new_cow.doesNotThrow
+                );
+            }
+        }
+
         let force_fill = false;
         // if there are holes, we need to fill the array at allocation time.
         // FIXME(toshok) we could just as easily have the compiler emit code to initialize the holes as well, right?
@@ -1806,16 +2281,14 @@ class LLVMIRVisitor extends TreeVisitor {
             "arrtmp",
             !this.ejs_runtime.array_new.doesNotThrow
         );
-        let i = 0;
-        for (let el of n.elements) {
+        n.elements.forEach((el, i) => {
             // don't create property stores for array holes
-            if (el == null) continue;
+            if (el == null) return;
 
             let val = this.visit(el);
             let index = { type: b.Literal, value: i };
             this.createPropertyStore(obj, index, val, true);
-            i = i + 1;
-        }
+        });
         return obj;
     }
 
@@ -1958,12 +2431,22 @@ class LLVMIRVisitor extends TreeVisitor {
                 }`
             );
 
-            let regexp_new_utf8 = this.ejs_runtime.regexp_new_utf8;
+            // the runtime caches the compiled pattern in a slot per literal, so
+            // evaluating the literal again doesn't recompile it
+            let site = new llvm.GlobalVariable(
+                this.module,
+                types.Int8Pointer,
+                `regexp-site-${this.idgen()}`,
+                consts.Null(types.Int8Pointer),
+                false
+            );
+
+            let regexp_new_literal = this.ejs_runtime.regexp_new_literal;
             var regexpcall = this.createCall(
-                regexp_new_utf8,
-                [source, flags],
+                regexp_new_literal,
+                [source, flags, site],
                 "regexptmp",
-                !regexp_new_utf8.doesNotThrow
+                !regexp_new_literal.doesNotThrow
             );
             debug.log(() => `regexpcall = ${regexpcall}`);
             return regexpcall;
@@ -2020,6 +2503,31 @@ class LLVMIRVisitor extends TreeVisitor {
 
     visitThrow(n) {
         let arg = this.visit(n.argument);
+
+        // if the innermost try block has a catch clause, it's in this
+        // function.  skip the unwinder and branch straight to it.
+        if (TryExitableScope.unwindStack.depth > 0) {
+            let local_catch = TryExitableScope.unwindStack.top.local_catch;
+            if (local_catch) {
+                if (!local_catch.block) {
+                    local_catch.block = new llvm.BasicBlock("catch_bb", this.currentFunction);
+                    local_catch.value = this.createAlloca(
+                        this.currentFunction,
+                        types.EjsValue,
+                        "local_exception"
+                    );
+                    local_catch.from_unwind = this.createAlloca(
+                        this.currentFunction,
+                        types.Bool,
+                        "exception_from_unwind"
+                    );
+                }
+                ir.createStore(arg, local_catch.value);
+                ir.createStore(consts.False(), local_catch.from_unwind);
+                return ir.createBr(local_catch.block);
+            }
+        }
+
         this.createCall(this.ejs_runtime.throw, [arg], "", true);
         return ir.createUnreachable();
     }
@@ -2056,6 +2564,7 @@ class LLVMIRVisitor extends TreeVisitor {
             () => new llvm.BasicBlock("exception", insertFunc),
             finally_block != null
         );
+        if (n.handlers.length > 0) scope.local_catch = { block: null };
         this.doInsideExitableScope(scope, () => {
             scope.enterTry();
             this.visit(n.block);
@@ -2067,9 +2576,15 @@ class LLVMIRVisitor extends TreeVisitor {
             scope.leaveTry();
         });
 
-        if (scope.landing_pad_block && n.handlers.length > 0)
+        // throws in the try block that visitThrow turned into branches
+        // leave the exception in local_catch.value
+        let local_catch = scope.local_catch && scope.local_catch.block ? scope.local_catch : null;
+
+        if (local_catch) catch_block = local_catch.block;
+        else if (scope.landing_pad_block && n.handlers.length > 0)
             catch_block = new llvm.BasicBlock("catch_bb", insertFunc);
 
+        let exception = null;
         if (scope.landing_pad_block) {
             // the scope's landingpad block is created if needed by this.createCall (using that function we pass in as the last argument to TryExitableScope's ctor.)
             // if a try block includes no calls, there's no need for an landing pad block as nothing can throw, and we don't bother generating any code for the
@@ -2103,46 +2618,69 @@ class LLVMIRVisitor extends TreeVisitor {
                     );
                 }
 
-                let exception = ir.createExtractValue(caught_result, 0, "exception");
+                exception = ir.createExtractValue(caught_result, 0, "exception");
+
+                if (catch_block && local_catch) {
+                    ir.createStore(this.beginCatch(exception), local_catch.value);
+                    ir.createStore(consts.True(), local_catch.from_unwind);
+                }
 
                 if (catch_block) ir.createBr(catch_block);
                 else if (finally_block) ir.createBr(finally_block);
                 else throw "this shouldn't happen.  a try{} without either a catch{} or finally{}";
+            });
+        }
 
-                // if we have a catch clause, create catch_bb
-                if (n.handlers.length > 0) {
-                    this.doInsideBBlock(catch_block, () => {
-                        // call _ejs_begin_catch to return the actual exception
-                        let catchval = this.beginCatch(exception);
-
-                        // create a new scope which maps the catch parameter name (the 'e' in 'try { } catch (e) { }') to catchval
-                        let catch_scope = new Map();
-                        if (n.handlers[0].param && n.handlers[0].param.name) {
-                            let catch_name = n.handlers[0].param.name;
-                            let alloca = this.createAlloca(
-                                this.currentFunction,
-                                types.EjsValue,
-                                `local_catch_${catch_name}`
-                            );
-                            catch_scope.set(catch_name, alloca);
-                            ir.createStore(catchval, alloca);
-                        }
+        // if we have a catch clause, create catch_bb
+        if (catch_block) {
+            this.doInsideBBlock(catch_block, () => {
+                // call _ejs_begin_catch to return the actual exception
+                let catchval = local_catch
+                    ? this.createEjsValueLoad(local_catch.value, "local_exception_load")
+                    : this.beginCatch(exception);
+
+                // create a new scope which maps the catch parameter name (the 'e' in 'try { } catch (e) { }') to catchval
+                let catch_scope = new Map();
+                if (n.handlers[0].param && n.handlers[0].param.name) {
+                    let catch_name = n.handlers[0].param.name;
+                    let alloca = this.createAlloca(
+                        this.currentFunction,
+                        types.EjsValue,
+                        `local_catch_${catch_name}`
+                    );
+                    catch_scope.set(catch_name, alloca);
+                    ir.createStore(catchval, alloca);
+                }
 
-                        if (n.finalizer) this.finallyStack.unshift(finally_block);
+                if (n.finalizer) this.finallyStack.unshift(finally_block);
 
-                        this.doInsideExitableScope(scope, () => {
-                            this.visitWithScope(catch_scope, [n.handlers[0]]);
-                        });
+                this.doInsideExitableScope(scope, () => {
+                    this.visitWithScope(catch_scope, [n.handlers[0]]);
+                });
 
-                        // unsure about this one - we should likely call end_catch if another exception is thrown from the catch block?
+                // unsure about this one - we should likely call end_catch if another exception is thrown from the catch block?
+                if (!local_catch) {
+                    this.endCatch();
+                } else if (scope.landing_pad_block) {
+                    // only the exceptions that came through the unwinder were begun
+                    let end_catch_bb = new llvm.BasicBlock("end_catch", insertFunc);
+                    let end_catch_merge_bb = new llvm.BasicBlock("end_catch_merge", insertFunc);
+                    ir.createCondBr(
+                        ir.createLoad(types.Bool, local_catch.from_unwind, "from_unwind_load"),
+                        end_catch_bb,
+                        end_catch_merge_bb
+                    );
+                    this.doInsideBBlock(end_catch_bb, () => {
                         this.endCatch();
-
-                        if (n.finalizer) this.finallyStack.shift();
-
-                        // at the end of the catch block branch to our branch_target (either the finally block or the merge block after the try{}) with REASON_FALLOFF
-                        scope.exitAft(false);
+                        ir.createBr(end_catch_merge_bb);
                     });
+                    ir.setInsertPoint(end_catch_merge_bb);
                 }
+
+                if (n.finalizer) this.finallyStack.shift();
+
+                // at the end of the catch block branch to our branch_target (either the finally block or the merge block after the try{}) with REASON_FALLOFF
+                scope.exitAft(false);
             });
         }
 
@@ -2450,6 +2988,12 @@ class LLVMIRVisitor extends TreeVisitor {
     }
 
     handleGetLocal(exp) {
+        let source = this.findIdentifierInScope(exp.arguments[0].name);
+        if (source._ejs_unboxed_double)
+            return this.boxDouble(
+                ir.createLoad(types.Double, source, `load_${exp.arguments[0].name}`),
+                `box_${exp.arguments[0].name}`
+            );
         return this.createEjsValueLoad(
             this.findIdentifierInScope(exp.arguments[0].name),
             `load_${exp.arguments[0].name}`
@@ -2463,6 +3007,11 @@ class LLVMIRVisitor extends TreeVisitor {
         let dest = this.findIdentifierInScope(exp.arguments[0].name);
         if (!dest) throw new Error(`identifier not found: ${exp.arguments[0].name}`);
         let arg = exp.arguments[1];
+        if (dest._ejs_unboxed_double) {
+            let d = this.visitNumber(arg);
+            ir.createStore(d, dest);
+            return this.boxDouble(d, "box_val");
+        }
         this.storeToDest(dest, arg);
         return ir.createLoad(types.EjsValue, dest, "load_val");
     }
@@ -2499,7 +3048,8 @@ class LLVMIRVisitor extends TreeVisitor {
         }
     }
 
-    emitEjsvalFromPtr(ptr, prefix) {
+    // @tag_hi is the high word of the shifted tag to box @ptr with
+    emitEjsvalFromPtr(ptr, prefix, tag_hi = 0xfffc0000) {
         if (this.triple.pointerSize() === 64) {
             let fromptr_alloca = this.createAlloca(
                 this.currentFunction,
@@ -2509,7 +3059,7 @@ class LLVMIRVisitor extends TreeVisitor {
             let intval = ir.createPtrToInt(ptr, types.Int64, `${prefix}_intval`);
             let payload = ir.createOr(
                 intval,
-                consts.int64_lowhi(0xfffc0000, 0x00000000),
+                consts.int64_lowhi(tag_hi, 0x00000000),
                 `${prefix}_payload`
             );
             let alloca_as_int64 = ir.createBitCast(
@@ -2562,26 +3112,14 @@ class LLVMIRVisitor extends TreeVisitor {
     // this method assumes it's called in an opencoded context
     emitLoadEjsFunctionClosureFunc(closure) {
         if (this.triple.pointerSize() === 64) {
-            let func_slot_gep = ir.createInBoundsGetElementPointer(
-                types.EjsClosureEnv.pointerTo(),
+            // %1 = getelementptr inbounds %struct.EJSFunction* %closure, i64 0, i32 1
+            let func_slot = ir.createInBoundsGetElementPointer(
+                types.EjsFunction,
                 closure,
-                [consts.int64(1)],
-                "func_slot_gep"
-            );
-            let func_slot = ir.createBitCast(
-                func_slot_gep,
-                this.abi
-                    .createFunctionType(types.EjsValue, [
-                        types.EjsValue,
-                        types.EjsValue,
-                        types.Int32,
-                        types.EjsValue.pointerTo(),
-                    ])
-                    .pointerTo()
-                    .pointerTo(),
+                [consts.int64(0), consts.int32(1)],
                 "func_slot"
             );
-            return ir.createLoad(types.EjsValue, func_slot, "func_load");
+            return ir.createLoad(types.getEjsClosureFunc(this.abi), func_slot, "func_load");
         } else {
             throw new Error("emitLoadEjsFunctionClosureFunc not implemented for this case");
         }
@@ -2590,19 +3128,116 @@ class LLVMIRVisitor extends TreeVisitor {
     // this method assumes it's called in an opencoded context
     emitLoadEjsFunctionClosureEnv(closure) {
         if (this.triple.pointerSize() === 64) {
-            let env_slot_gep = ir.createInBoundsGetElementPointer(
-                types.EjsClosureEnv.pointerTo(),
+            // %1 = getelementptr inbounds %struct.EJSFunction* %closure, i64 0, i32 2
+            let env_slot = ir.createInBoundsGetElementPointer(
+                types.EjsFunction,
                 closure,
-                [consts.int64(1), consts.int32(1)],
-                "env_slot_gep"
+                [consts.int64(0), consts.int32(2)],
+                "env_slot"
             );
-            let env_slot = ir.createBitCast(env_slot_gep, types.EjsValue.pointerTo(), "env_slot");
             return ir.createLoad(types.EjsValue, env_slot, "env_load");
         } else {
             throw new Error("emitLoadEjsFunctionClosureEnv not implemented for this case");
         }
     }
 
+    // this method assumes it's called in an opencoded context
+    emitLoadDenseArrayLength(arrayptr) {
+        // %1 = getelementptr inbounds %struct.EJSDenseArray* %arrayptr, i64 0, i32 2
+        let length_slot = ir.createInBoundsGetElementPointer(
+            types.EjsDenseArray,
+            arrayptr,
+            [consts.int64(0), consts.int32(2)],
+            "length_slot"
+        );
+        return ir.createLoad(types.Int64, length_slot, "length_load");
+    }
+
+    // this method assumes it's called in an opencoded context
+    emitLoadDenseArrayElements(arrayptr) {
+        // %1 = getelementptr inbounds %struct.EJSDenseArray* %arrayptr, i64 0, i32 7
+        let elements_slot = ir.createInBoundsGetElementPointer(
+            types.EjsDenseArray,
+            arrayptr,
+            [consts.int64(0), consts.int32(7)],
+            "elements_slot"
+        );
+        return ir.createLoad(types.EjsValue.pointerTo(), elements_slot, "elements_load");
+    }
+
+    // calls the lifted function @direct_callee.name directly, with the
+    // env of the closure in argv[0].  unless the DirectCalls pass proved
+    // argv[0] is always that closure, guard on the closure's func and
+    // fall back to _ejs_invoke_closure.
+    emitDirectInvoke(direct_callee, callee, argv) {
+        let callDirect = (closure) => {
+            let env;
+            if (direct_callee.env !== undefined)
+                // EscapeAnalysis elided the closure, pass its env ourselves
+                env = direct_callee.env ? this.visit(direct_callee.env) : this.loadUndefinedEjsValue();
+            else if (direct_callee.has_env) env = this.emitLoadEjsFunctionClosureEnv(closure);
+            else env = this.loadUndefinedEjsValue();
+            return this.createCall(callee, [env, argv[1], argv[2], argv[3], argv[4]], "direct_call");
+        };
+
+        if (!direct_callee.guarded)
+            return callDirect(
+                direct_callee.has_env && direct_callee.env === undefined
+                    ? this.emitEjsvalToObjectPtr(argv[0])
+                    : null
+            );
+
+        let insertFunc = ir.getInsertBlock().parent;
+        let candidate_is_object_bb = new llvm.BasicBlock("candidate_is_object_bb", insertFunc);
+        let candidate_is_function_bb = new llvm.BasicBlock("candidate_is_function_bb", insertFunc);
+        let direct_invoke_bb = new llvm.BasicBlock("direct_invoke_bb", insertFunc);
+        let runtime_invoke_bb = new llvm.BasicBlock("runtime_invoke_bb", insertFunc);
+        let invoke_merge_bb = new llvm.BasicBlock("invoke_merge_bb", insertFunc);
+
+        let call_result_alloca = this.createAlloca(this.currentFunction, types.EjsValue, "call_result");
+
+        ir.createCondBr(this.isObject(argv[0]), candidate_is_object_bb, runtime_invoke_bb);
+
+        let closure;
+        this.doInsideBBlock(candidate_is_object_bb, () => {
+            closure = this.emitEjsvalToObjectPtr(argv[0]);
+            ir.createCondBr(this.isObjectFunction(closure), candidate_is_function_bb, runtime_invoke_bb);
+        });
+
+        this.doInsideBBlock(candidate_is_function_bb, () => {
+            let func = ir.createPointerCast(
+                this.emitLoadEjsFunctionClosureFunc(closure),
+                types.Int8Pointer,
+                "func_ptr"
+            );
+            let known = ir.createPointerCast(callee, types.Int8Pointer, "known_func_ptr");
+            ir.createCondBr(
+                ir.createICmpEq(func, known, "func_cmp"),
+                direct_invoke_bb,
+                runtime_invoke_bb
+            );
+        });
+
+        this.doInsideBBlock(direct_invoke_bb, () => {
+            ir.createStore(callDirect(closure), call_result_alloca);
+            ir.createBr(invoke_merge_bb);
+        });
+
+        this.doInsideBBlock(runtime_invoke_bb, () => {
+            let runtime_call_result = this.createCall(
+                this.ejs_runtime.invoke_closure,
+                argv,
+                "callresult",
+                true
+            );
+            ir.createStore(runtime_call_result, call_result_alloca);
+            ir.createBr(invoke_merge_bb);
+        });
+
+        ir.setInsertPoint(invoke_merge_bb);
+        return ir.createLoad(types.EjsValue, call_result_alloca, "call_result_load");
+    }
+
     handleInvokeClosure(exp, opencode) {
         let insertBlock = ir.getInsertBlock();
         let insertFunc = insertBlock.parent;
@@ -2615,6 +3250,11 @@ class LLVMIRVisitor extends TreeVisitor {
 
         let argv = this.visitArgsForCall(this.ejs_runtime.invoke_closure, true, exp.arguments);
 
+        if (exp.direct_callee && this.triple.pointerSize() === 64) {
+            let callee = this.module.getFunction(exp.direct_callee.name);
+            if (callee) return this.emitDirectInvoke(exp.direct_callee, callee, argv);
+        }
+
         if (opencode && this.triple.pointerSize() === 64) {
             //
             // generate basically the following code:
@@ -2651,7 +3291,7 @@ class LLVMIRVisitor extends TreeVisitor {
                     let env_load = this.emitLoadEjsFunctionClosureEnv(closure);
                     let direct_call_result = this.createCall(
                         func_load,
-                        [env_load, argv[1], argv[2], argv[3], argv[4], argv[5]],
+                        [env_load, argv[1], argv[2], argv[3], argv[4]],
                         "callresult"
                     );
                     ir.createStore(direct_call_result, call_result_alloca);
@@ -2764,17 +3404,34 @@ class LLVMIRVisitor extends TreeVisitor {
         return this.createCall(this.ejs_runtime.generator_yield, argv, "yield");
     }
 
+    handleMakeGeneratorStateMachine(exp) {
+        let argv = this.visitArgsForCall(
+            this.ejs_runtime.make_generator_state_machine,
+            false,
+            exp.arguments
+        );
+        return this.createCall(this.ejs_runtime.make_generator_state_machine, argv, "generator");
+    }
+
+    handleGeneratorReturn(exp) {
+        let argv = this.visitArgsForCall(this.ejs_runtime.generator_return, false, exp.arguments);
+        return this.createCall(this.ejs_runtime.generator_return, argv, "generator_rv");
+    }
+
     handleMakeClosure(exp) {
+        if (exp.elided) return this.loadUndefinedEjsValue();
         let argv = this.visitArgsForCall(this.ejs_runtime.make_closure, false, exp.arguments);
         return this.createCall(this.ejs_runtime.make_closure, argv, "closure_tmp");
     }
 
     handleMakeClosureNoEnv(exp) {
+        if (exp.elided) return this.loadUndefinedEjsValue();
         let argv = this.visitArgsForCall(this.ejs_runtime.make_closure_noenv, false, exp.arguments);
         return this.createCall(this.ejs_runtime.make_closure_noenv, argv, "closure_tmp");
     }
 
     handleMakeAnonClosure(exp) {
+        if (exp.elided) return this.loadUndefinedEjsValue();
         let argv = this.visitArgsForCall(this.ejs_runtime.make_anon_closure, false, exp.arguments);
         return this.createCall(this.ejs_runtime.make_anon_closure, argv, "closure_tmp");
     }
@@ -2793,6 +3450,47 @@ class LLVMIRVisitor extends TreeVisitor {
 
     handleMakeClosureEnv(exp) {
         let size = exp.arguments[0].value;
+        if (exp.stack_allocate && this.triple.pointerSize() === 64) {
+            // EscapeAnalysis says nothing can see this env after we
+            // return, so it can live in our frame.  this is what
+            // _ejs_closure_init does, but visible to LLVM.
+            let env_alloca = this.createAlloca(
+                this.currentFunction,
+                llvm.ArrayType.get(types.EjsValue, size + 1),
+                "stack_env"
+            );
+            let envp = ir.createBitCast(env_alloca, types.EjsClosureEnv.pointerTo(), "stack_envp");
+            ir.createStore(
+                consts.int32(0),
+                ir.createInBoundsGetElementPointer(
+                    types.EjsClosureEnv,
+                    envp,
+                    [consts.int64(0), consts.int32(0)],
+                    "gc_header_ref"
+                )
+            );
+            ir.createStore(
+                consts.int32(size),
+                ir.createInBoundsGetElementPointer(
+                    types.EjsClosureEnv,
+                    envp,
+                    [consts.int64(0), consts.int32(1)],
+                    "length_ref"
+                )
+            );
+            for (let i = 0; i < size; i++) {
+                this.storeUndefined(
+                    ir.createInBoundsGetElementPointer(
+                        types.EjsClosureEnv,
+                        envp,
+                        [consts.int64(0), consts.int32(2), consts.int64(i)],
+                        "slot_ref"
+                    ),
+                    "slot_init"
+                );
+            }
+            return this.emitEjsvalFromPtr(envp, "stack_env", 0xfffb0000);
+        }
         return this.createCall(this.ejs_runtime.make_closure_env, [consts.int32(size)], "env_tmp");
     }
 
@@ -2889,6 +3587,14 @@ class LLVMIRVisitor extends TreeVisitor {
         }
     }
 
+    isObjectDenseArray(obj) {
+        return ir.createICmpEq(
+            this.emitLoadSpecops(obj),
+            this.ejs_runtime.array_specops,
+            "array_specops_cmp"
+        );
+    }
+
     isObjectFunction(obj) {
         return ir.createICmpEq(
             this.emitLoadSpecops(obj),
@@ -2975,6 +3681,23 @@ class LLVMIRVisitor extends TreeVisitor {
         }
     }
 
+    // the runtime's iterator steppers return the EJS_NO_ITER_VALUE magic
+    // when they're done
+    isNoIterValue(val) {
+        let is32 = this.triple.pointerSize() === 32;
+        return this.createEjsvalICmpEq(
+            val,
+            consts.int64_lowhi(is32 ? 0xffffff84 : 0xfffa0000, 0x00000003),
+            "is_no_iter_value"
+        );
+    }
+
+    // the EJS_ARRAY_HOLE magic, what dense arrays store for missing
+    // elements.  only used on 64 bit targets
+    isArrayHole(val) {
+        return this.createEjsvalICmpEq(val, consts.int64_lowhi(0xfffa0000, 0x00000000), "is_array_hole");
+    }
+
     isNull(val) {
         if (this.triple.pointerSize() === 64) {
             return this.createEjsvalICmpEq(
@@ -3345,6 +4068,138 @@ class LLVMIRVisitor extends TreeVisitor {
         return ir.createLoad(types.EjsValue, arg_value_alloca, "load_arg_value");
     }
 
+    loadArgc() {
+        return this.createLoad(types.Int32, this.currentFunction.topScope.get("%argc"), "argc_load");
+    }
+
+    loadArgs() {
+        return this.createLoad(
+            types.EjsValue.pointerTo(),
+            this.currentFunction.topScope.get("%args"),
+            "args_load"
+        );
+    }
+
+    emitArgumentsLength() {
+        return ir.createSIToFP(this.loadArgc(), types.Double, "arguments_length");
+    }
+
+    // EliminateArguments rewrites arguments.length, arguments[key] and
+    // f.apply(recv, arguments) in functions where the arguments object
+    // never escapes, so we can read %argc/%args instead of allocating it.
+    handleArgumentsLength() {
+        return this.boxDouble(this.emitArgumentsLength(), "arguments_length_boxed");
+    }
+
+    handleArgumentsGet(exp) {
+        let key = this.visit(exp.arguments[0]);
+        let argc = this.loadArgc();
+        let args = this.loadArgs();
+
+        if (this.triple.pointerSize() !== 64)
+            return this.createCall(this.ejs_runtime.arguments_get, [argc, args, key], "arguments_get");
+
+        let insertFunc = ir.getInsertBlock().parent;
+        let is_number_bb = new llvm.BasicBlock("arguments_get_number", insertFunc);
+        let in_range_bb = new llvm.BasicBlock("arguments_get_in_range", insertFunc);
+        let fast_bb = new llvm.BasicBlock("arguments_get_fast", insertFunc);
+        let slow_bb = new llvm.BasicBlock("arguments_get_slow", insertFunc);
+        let merge_bb = new llvm.BasicBlock("arguments_get_merge", insertFunc);
+
+        let result = this.createAlloca(this.currentFunction, types.EjsValue, "arguments_get_result");
+
+        ir.createCondBr(this.isNumber(key), is_number_bb, slow_bb);
+
+        let key_d;
+        this.doInsideBBlock(is_number_bb, () => {
+            key_d = this.unboxDouble(key, "key_double");
+            let in_range = ir.createAnd(
+                ir.createFCmpOGe(key_d, llvm.ConstantFP.getDouble(0), "key_ge_0"),
+                ir.createFCmpOLt(key_d, ir.createSIToFP(argc, types.Double, "argc_double"), "key_lt_argc"),
+                "key_in_range"
+            );
+            ir.createCondBr(in_range, in_range_bb, slow_bb);
+        });
+
+        let index;
+        this.doInsideBBlock(in_range_bb, () => {
+            index = ir.createFPToSI(key_d, types.Int32, "key_index");
+            let integral = ir.createFCmpOEq(
+                ir.createSIToFP(index, types.Double, "key_index_double"),
+                key_d,
+                "key_is_index"
+            );
+            ir.createCondBr(integral, fast_bb, slow_bb);
+        });
+
+        this.doInsideBBlock(fast_bb, () => {
+            let arg_ptr = ir.createGetElementPointer(types.EjsValue, args, [index], "arg_ptr");
+            ir.createStore(this.createEjsValueLoad(arg_ptr, "arg"), result);
+            ir.createBr(merge_bb);
+        });
+
+        this.doInsideBBlock(slow_bb, () => {
+            ir.createStore(
+                this.createCall(this.ejs_runtime.arguments_get, [argc, args, key], "arguments_get"),
+                result
+            );
+            ir.createBr(merge_bb);
+        });
+
+        ir.setInsertPoint(merge_bb);
+        return this.createEjsValueLoad(result, "arguments_get_load");
+    }
+
+    // %forwardArgs(F.apply, recv, k, prefix...) is
+    // F.apply(recv, [prefix..., ...args.slice(k)])
+    handleForwardArgs(exp) {
+        let [callee, recv, skip, ...prefix] = exp.arguments;
+        let func = this.visit(callee.object);
+        let apply = this.createPropertyLoad(func, callee.property, callee.computed);
+        let thisArg = this.visit(recv);
+
+        let prefix_ptr = consts.Null(types.EjsValue.pointerTo());
+        if (prefix.length > 0) {
+            // the scratch area is sized for the %arrayFromSpread we
+            // replaced, which can have fewer arguments than we have
+            // prefix elements, so these get their own
+            let visited = prefix.map((p) => this.visit(p));
+            const prefixType = llvm.ArrayType.get(types.EjsValue, prefix.length);
+            let prefix_alloca = this.createAlloca(this.currentFunction, prefixType, "forward_prefix");
+            visited.forEach((v, i) => {
+                let gep = ir.createGetElementPointer(
+                    prefixType,
+                    prefix_alloca,
+                    [consts.int32(0), consts.int64(i)],
+                    `forward_gep_${i}`
+                );
+                ir.createStore(v, gep, `forward[${i}]-store`);
+            });
+            prefix_ptr = ir.createGetElementPointer(
+                prefixType,
+                prefix_alloca,
+                [consts.int32(0), consts.int64(0)],
+                "forward_prefix_ptr"
+            );
+        }
+
+        let k = skip.value;
+        let argc = this.loadArgc();
+        let nrest = ir.createSelect(
+            ir.createICmpSGt(argc, consts.int32(k), "has_rest"),
+            ir.createNswSub(argc, consts.int32(k), "argc_minus_k"),
+            consts.int32(0),
+            "nrest"
+        );
+        let rest = ir.createGetElementPointer(types.EjsValue, this.loadArgs(), [consts.int32(k)], "rest_ptr");
+
+        return this.createCall(
+            this.ejs_runtime.invoke_closure_forward,
+            [func, apply, thisArg, consts.int32(prefix.length), prefix_ptr, nrest, rest],
+            "forward_call"
+        );
+    }
+
     handleCreateIterResult(exp) {
         let value = this.visit(exp.arguments[0]);
         let done = this.visit(exp.arguments[1]);
@@ -3355,6 +4210,19 @@ class LLVMIRVisitor extends TreeVisitor {
         let iter = this.visit(exp.arguments[0]);
         return this.createCall(this.ejs_runtime.iterator_wrapper_new, [iter], "iter_wrapper");
     }
+
+    handleIteratorStepValue(exp) {
+        let iter = this.visit(exp.arguments[0]);
+        let next = this.visit(exp.arguments[1]);
+        return this.createCall(this.ejs_runtime.iterator_step_value, [iter, next], "iter_value");
+    }
+
+    // %isIteratorDone(v) is true if v is the EJS_NO_ITER_VALUE magic
+    // %iteratorStepValue returns once the iterator is exhausted.
+    handleIsIteratorDone(exp) {
+        let arg = this.visit(exp.arguments[0]);
+        return this.createEjsBoolSelect(this.isNoIterValue(arg));
+    }
 }
 
 class AddFunctionsVisitor extends TreeVisitor {
@@ -58,3 +58,12 @@ export function ejsval_true(is32bit) {
 export function ejsval_false(is32bit) {
     return int64_lowhi(is32bit ? 0xffffff83 : 0xfff98000, 0x00000000);
 }
+export function ejsval_null(is32bit) {
+    return int64_lowhi(is32bit ? 0xffffff87 : 0xfffb8000, 0x00000000);
+}
+// doubles aren't boxed, so the ejsval is just the bits of the double
+export function ejsval_double(n) {
+    let view = new DataView(new ArrayBuffer(8));
+    view.setFloat64(0, n);
+    return int64_lowhi(view.getUint32(0), view.getUint32(4));
+}
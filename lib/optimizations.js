@@ -6,8 +6,18 @@ import * as escodegen from "../external-deps/escodegen/escodegen-es6";
 import * as debug from "./debug";
 
 import { ReplaceUnaryVoid } from "./passes/replace-unary-void";
+import { EliminateArguments } from "./passes/eliminate-arguments";
+import { InferNumericLocals } from "./passes/infer-numeric-locals";
+import { DirectCalls } from "./passes/direct-calls";
+import { EscapeAnalysis } from "./passes/escape-analysis";
 
-const passes = [ReplaceUnaryVoid];
+const passes = [
+    ReplaceUnaryVoid,
+    EliminateArguments,
+    InferNumericLocals,
+    DirectCalls,
+    EscapeAnalysis,
+];
 
 export function run(tree) {
     passes.forEach((passType) => {
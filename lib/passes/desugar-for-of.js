@@ -9,18 +9,32 @@
 // to:
 //
 //   {
-//     %forof = a[Symbol.iterator]();
-//     while (!(%iter_next = %forof.next()).done) {
-//       let x = %iter_next.value;
+//     let %forof_tmp = a;
+//     let %forof_iter = %forof_tmp[Symbol.iterator]();
+//     let %forof_next = %forof_iter.next;
+//     let %forof_value = undefined;
+//     while (!%isIteratorDone(%forof_value = %iteratorStepValue(%forof_iter, %forof_next))) {
+//       let x = %forof_value;
 //       { ... }
 //     }
 //   }
+//
+// %iteratorStepValue returns the next value directly (or a magic value
+// %isIteratorDone recognizes), and for the builtin array, string, Map
+// and Set iterators it steps the iterator without creating an iter
+// result object per iteration.
 
 import * as b from "../ast-builder";
 import { TransformPass } from "../node-visitor";
-import { startGenerator } from "../echo-util";
+import { startGenerator, intrinsic } from "../echo-util";
 import { Stack } from "../stack-es6";
-import { Symbol_id, iterator_id, value_id, next_id, done_id } from "../common-ids";
+import {
+    Symbol_id,
+    iterator_id,
+    next_id,
+    iteratorStepValue_id,
+    isIteratorDone_id,
+} from "../common-ids";
 
 let forofgen = startGenerator();
 let freshForOf = function (ident) {
@@ -48,10 +62,12 @@ export class DesugarForOf extends TransformPass {
         let iterable_tmp = freshForOf("tmp");
         let iter_name = freshForOf("iter");
         let iter_next_name = freshForOf("next");
+        let iter_value_name = freshForOf("value");
 
         let iterable_id = b.identifier(iterable_tmp);
         let iter_id = b.identifier(iter_name);
         let iter_next_id = b.identifier(iter_next_name);
+        let iter_value_id = b.identifier(iter_value_name);
 
         let tmp_iterable_decl = b.letDeclaration(iterable_id, n.right);
 
@@ -61,34 +77,41 @@ export class DesugarForOf extends TransformPass {
             b.callExpression(b.memberExpression(iterable_id, Symbol_iterator, true), [])
         );
 
+        let next_decl = b.letDeclaration(iter_next_id, b.memberExpression(iter_id, next_id));
+
         let loop_iter_stmt;
 
         if (n.left.type === b.VariableDeclaration)
             loop_iter_stmt = b.letDeclaration(
                 n.left.declarations[0].id, // can there be more than 1?
-                b.memberExpression(iter_next_id, value_id)
+                iter_value_id
             );
         else
             loop_iter_stmt = b.expressionStatement(
-                b.assignmentExpression(n.left, "=", b.memberExpression(iter_next_id, value_id))
+                b.assignmentExpression(n.left, "=", iter_value_id)
             );
 
-        let next_decl = b.letDeclaration(iter_next_id, b.undefinedLit());
+        let value_decl = b.letDeclaration(iter_value_id, b.undefinedLit());
 
         let not_done = b.unaryExpression(
             "!",
-            b.memberExpression(
+            intrinsic(isIteratorDone_id, [
                 b.assignmentExpression(
-                    iter_next_id,
+                    iter_value_id,
                     "=",
-                    b.callExpression(b.memberExpression(iter_id, next_id))
+                    intrinsic(iteratorStepValue_id, [iter_id, iter_next_id])
                 ),
-                done_id
-            )
+            ])
         );
 
         let while_stmt = b.whileStatement(not_done, b.blockStatement([loop_iter_stmt, n.body]));
 
-        return b.blockStatement([tmp_iterable_decl, get_iterator_stmt, next_decl, while_stmt]);
+        return b.blockStatement([
+            tmp_iterable_decl,
+            get_iterator_stmt,
+            next_decl,
+            value_decl,
+            while_stmt,
+        ]);
     }
 }
@@ -1,18 +1,57 @@
 /* -*- Mode: js2; indent-tabs-mode: nil; tab-width: 4; js2-indent-offset: 4; js2-basic-offset: 4; -*-
  * vim: set ts=4 sw=4 et tw=99 ft=js:
  */
-// this pass converts all generator functions like this:
+// this pass converts generator functions into state machines where it
+// can.  a generator like this:
 //
-// function* foo() {
-//   yield 1;
-//   yield 2;
-//   yield 3;
+// function* foo(n) {
+//   for (let i = 0; i < n; i++)
+//     yield i;
+//   return "done";
 // }
 //
-// into this:
+// becomes:
 //
-// function foo() {
+// function foo(n) {
+//   let %_gen_state_0 = 0;
+//   let i;
 //   // arrow function so `this` is bound
+//   let %_gen_0 = %makeGeneratorStateMachine((%_gen_sent_0, %_gen_throw_0) => {
+//     %_gen_dispatch_0: while (true) {
+//       switch (%_gen_state_0) {
+//       case 0:
+//         i = 0;
+//       case 1:
+//         if (!(i < n)) { %_gen_state_0 = 3; continue %_gen_dispatch_0; }
+//         %_gen_state_0 = 4;
+//         return i;
+//       case 4:
+//         if (%_gen_throw_0) throw %_gen_sent_0;
+//       case 2:
+//         i++;
+//         { %_gen_state_0 = 1; continue %_gen_dispatch_0; }
+//       case 3:
+//         return %generatorReturn(%_gen_0, "done");
+//       default:
+//         return %generatorReturn(%_gen_0, undefined);
+//       }
+//     }
+//   });
+//   return %_gen_0;
+// }
+//
+// the runtime calls the step function for each next()/throw(), and it
+// returns the next value.  the locals live in the closure env, so a
+// suspended generator is just that env and its state number, and
+// resuming it is a plain call.
+//
+// statements without a yield are emitted as is, inside a single case.
+// we can't split try/switch/labeled statements or for-in loops, or a
+// yield nested inside an expression, and we can't hoist the bindings
+// of a loop if a closure might capture them.  generators using those
+// fall back to running on their own stack:
+//
+// function foo() {
 //   let %gen = %makeGenerator(() => {
 //     %generatorYield(%gen, 1);
 //     %generatorYield(%gen, 2);
@@ -24,10 +63,475 @@
 
 import { TransformPass } from "../node-visitor";
 import * as b from "../ast-builder";
-import { makeGenerator_id, generatorYield_id } from "../common-ids";
+import {
+    makeGenerator_id,
+    makeGeneratorStateMachine_id,
+    generatorYield_id,
+    generatorReturn_id,
+} from "../common-ids";
 import { intrinsic, startGenerator } from "../echo-util";
 import { reportError, reportWarning } from "../errors";
 
+// thrown when a generator body can't be turned into a state machine
+class CannotLower {}
+
+function is_function(n) {
+    return (
+        n.type === b.FunctionDeclaration ||
+        n.type === b.FunctionExpression ||
+        n.type === b.ArrowFunctionExpression ||
+        n.type === b.ClassDeclaration ||
+        n.type === b.ClassExpression
+    );
+}
+
+function children(n) {
+    let rv = [];
+    for (let key of Object.keys(n)) {
+        if (key === "loc" || key === "range") continue;
+        let v = n[key];
+        if (Array.isArray(v)) {
+            for (let el of v) if (el && typeof el.type === "string") rv.push(el);
+        } else if (v && typeof v.type === "string") {
+            rv.push(v);
+        }
+    }
+    return rv;
+}
+
+// true if @pred holds for @n or anything in it, not counting the
+// insides of nested functions
+function contains(n, pred) {
+    if (!n || typeof n.type !== "string") return false;
+    if (pred(n)) return true;
+    if (is_function(n)) return false;
+    return children(n).some((child) => contains(child, pred));
+}
+
+function contains_yield(n) {
+    return contains(n, (c) => c.type === b.YieldExpression);
+}
+
+function contains_function(n) {
+    return contains(n, is_function);
+}
+
+function count_references(n, name) {
+    let count = 0;
+    let walk = (c) => {
+        if (!c || typeof c.type !== "string") return;
+        if (c.type === b.Identifier && c.name === name) count++;
+        for (let child of children(c)) walk(child);
+    };
+    walk(n);
+    return count;
+}
+
+function copy_node(n) {
+    return Object.assign(Object.create(Object.getPrototypeOf(n)), n);
+}
+
+function not(e) {
+    return b.unaryExpression("!", e);
+}
+
+function assign(id, value) {
+    return b.expressionStatement(b.assignmentExpression(id, "=", value));
+}
+
+class StateMachine {
+    constructor(gen, id, params, body) {
+        this.gen = gen;
+        this.state = b.identifier(`%_gen_state_${id}`);
+        this.sent = b.identifier(`%_gen_sent_${id}`);
+        this.throwing = b.identifier(`%_gen_throw_${id}`);
+        this.dispatch = b.identifier(`%_gen_dispatch_${id}`);
+        this.tempGen = startGenerator();
+        this.id = id;
+        this.body = body;
+
+        this.cases = [{ label: 0, body: [] }];
+        this.nextLabel = 1;
+        this.loops = []; // { break_label, continue_label } for each loop we split
+        this.hoisted = []; // names to declare in the generator function
+        this.hoisted_functions = [];
+        this.param_names = new Set();
+        for (let p of params) {
+            if (p.type === b.Identifier) this.param_names.add(p.name);
+            else if (p.type === b.AssignmentPattern && p.left.type === b.Identifier)
+                this.param_names.add(p.left.name);
+            else throw new CannotLower();
+        }
+    }
+
+    newLabel() {
+        return this.nextLabel++;
+    }
+
+    mark(label) {
+        this.cases.push({ label, body: [] });
+    }
+
+    emit(stmt) {
+        // hoisted loop bindings are shared by every iteration, which a
+        // closure created in the loop could notice
+        if (this.loops.length > 0 && contains_function(stmt)) throw new CannotLower();
+        this.cases[this.cases.length - 1].body.push(stmt);
+    }
+
+    jump(label) {
+        return b.blockStatement([
+            assign(this.state, b.literal(label)),
+            b.continueStatement(this.dispatch),
+        ]);
+    }
+
+    emitJumpUnless(test, label) {
+        this.emit(b.ifStatement(not(test), this.jump(label)));
+    }
+
+    complete(value) {
+        return b.returnStatement(
+            intrinsic(generatorReturn_id, [this.gen, value || b.undefinedLit()])
+        );
+    }
+
+    temp(name) {
+        let id = b.identifier(`%_gen_${name}_${this.id}_${this.tempGen()}`);
+        this.hoisted.push(id);
+        return id;
+    }
+
+    // @scope is the statement the declaration was scoped to.  if that's
+    // not the generator body itself, nothing outside of it can use the
+    // name, since that would see the hoisted binding instead of
+    // whatever was there before.
+    hoist(id, scope) {
+        if (id.type !== b.Identifier) throw new CannotLower();
+        let name = id.name;
+        if (
+            name === "arguments" ||
+            this.param_names.has(name) ||
+            this.hoisted.some((h) => h.name === name)
+        )
+            throw new CannotLower();
+        if (
+            scope !== this.body &&
+            count_references(this.body, name) !== count_references(scope, name)
+        )
+            throw new CannotLower();
+        this.hoisted.push(b.identifier(name));
+    }
+
+    lower() {
+        for (let stmt of this.body.body) this.explode(stmt, this.body);
+        let last = this.cases[this.cases.length - 1].body;
+        if (last.length === 0 || last[last.length - 1].type !== b.ReturnStatement)
+            this.emit(this.complete());
+
+        let cases = this.cases.map((c) => b.switchCase(b.literal(c.label), c.body));
+        cases.push(b.switchCase(null, [this.complete()]));
+
+        let step = b.arrowFunctionExpression(
+            [this.sent, this.throwing],
+            b.blockStatement([
+                b.labeledStatement(
+                    this.dispatch,
+                    b.whileStatement(
+                        b.literal(true),
+                        b.blockStatement([b.switchStatement(this.state, cases)])
+                    )
+                ),
+            ])
+        );
+
+        let stmts = [b.letDeclaration(this.state, b.literal(0))];
+        for (let id of this.hoisted) stmts.push(b.letDeclaration(id, null));
+        stmts.push(...this.hoisted_functions);
+        stmts.push(b.letDeclaration(this.gen, intrinsic(makeGeneratorStateMachine_id, [step])));
+        stmts.push(b.returnStatement(this.gen));
+        return b.blockStatement(stmts);
+    }
+
+    // yield @value, and continue at the next case when resumed
+    emitYield(value) {
+        let resume = this.newLabel();
+        this.emit(assign(this.state, b.literal(resume)));
+        this.emit(b.returnStatement(value || b.undefinedLit()));
+        this.mark(resume);
+        this.emit(b.ifStatement(this.throwing, b.throwStatement(this.sent)));
+    }
+
+    emitDelegate(iterable) {
+        let iter = this.temp("iter");
+        let result = this.temp("result");
+        let top = this.newLabel();
+        let end = this.newLabel();
+        this.emitGetIterator(iter, iterable);
+        this.mark(top);
+        this.emitIteratorStep(iter, result, end);
+        this.emitYield(b.memberExpression(result, b.identifier("value")));
+        this.emit(this.jump(top));
+        this.mark(end);
+    }
+
+    // result = iter.next(), jumping to @end if it's done
+    emitIteratorStep(iter, result, end) {
+        let next = b.callExpression(b.memberExpression(iter, b.identifier("next")), []);
+        this.emit(assign(result, next));
+        this.emit(b.ifStatement(b.memberExpression(result, b.identifier("done")), this.jump(end)));
+    }
+
+    emitGetIterator(iter, iterable) {
+        let symbol_iterator = b.memberExpression(b.identifier("Symbol"), b.identifier("iterator"));
+        this.emit(
+            assign(iter, b.callExpression(b.memberExpression(iterable, symbol_iterator, true), []))
+        );
+    }
+
+    // a declaration in the body of the generator (or a block/loop we're
+    // splitting), which becomes a hoisted binding plus assignments
+    explodeDeclaration(decl, scope) {
+        if (decl.kind === "var" && scope !== this.body) throw new CannotLower();
+        for (let d of decl.declarations) {
+            this.hoist(d.id, scope);
+            if (!d.init) {
+                if (decl.kind !== "var") this.emit(assign(d.id, b.undefinedLit()));
+            } else if (d.init.type === b.YieldExpression && !d.init.delegate) {
+                if (contains_yield(d.init.argument)) throw new CannotLower();
+                this.emitYield(this.rewrite(d.init.argument));
+                this.emit(assign(d.id, this.sent));
+            } else if (contains_yield(d.init)) {
+                throw new CannotLower();
+            } else {
+                this.emit(assign(d.id, this.rewrite(d.init)));
+            }
+        }
+    }
+
+    explode(stmt, scope) {
+        switch (stmt.type) {
+            case b.VariableDeclaration:
+                return this.explodeDeclaration(stmt, scope);
+
+            case b.FunctionDeclaration:
+                if (scope !== this.body) throw new CannotLower();
+                this.hoisted_functions.push(stmt);
+                return;
+
+            case b.EmptyStatement:
+                return;
+        }
+
+        if (!contains_yield(stmt)) {
+            this.emit(this.rewrite(stmt));
+            return;
+        }
+
+        switch (stmt.type) {
+            case b.BlockStatement:
+                for (let s of stmt.body) this.explode(s, stmt);
+                return;
+
+            case b.ExpressionStatement: {
+                let e = stmt.expression;
+                if (e.type === b.YieldExpression) {
+                    if (contains_yield(e.argument)) throw new CannotLower();
+                    let arg = e.argument ? this.rewrite(e.argument) : null;
+                    if (e.delegate) this.emitDelegate(arg);
+                    else this.emitYield(arg);
+                    return;
+                }
+                if (
+                    e.type === b.AssignmentExpression &&
+                    e.operator === "=" &&
+                    e.left.type === b.Identifier &&
+                    e.right.type === b.YieldExpression &&
+                    !e.right.delegate &&
+                    !contains_yield(e.right.argument)
+                ) {
+                    this.emitYield(e.right.argument ? this.rewrite(e.right.argument) : null);
+                    this.emit(assign(e.left, this.sent));
+                    return;
+                }
+                throw new CannotLower();
+            }
+
+            case b.IfStatement: {
+                if (contains_yield(stmt.test)) throw new CannotLower();
+                let else_label = this.newLabel();
+                this.emitJumpUnless(this.rewrite(stmt.test), else_label);
+                this.explode(stmt.consequent, stmt);
+                if (stmt.alternate) {
+                    let end = this.newLabel();
+                    this.emit(this.jump(end));
+                    this.mark(else_label);
+                    this.explode(stmt.alternate, stmt);
+                    this.mark(end);
+                } else {
+                    this.mark(else_label);
+                }
+                return;
+            }
+
+            case b.WhileStatement: {
+                if (contains_yield(stmt.test)) throw new CannotLower();
+                let top = this.newLabel();
+                let end = this.newLabel();
+                this.mark(top);
+                this.emitJumpUnless(this.rewrite(stmt.test), end);
+                this.explodeLoopBody(stmt, end, top);
+                this.emit(this.jump(top));
+                this.mark(end);
+                return;
+            }
+
+            case b.DoWhileStatement: {
+                if (contains_yield(stmt.test)) throw new CannotLower();
+                let top = this.newLabel();
+                let cont = this.newLabel();
+                let end = this.newLabel();
+                this.mark(top);
+                this.explodeLoopBody(stmt, end, cont);
+                this.mark(cont);
+                this.emit(b.ifStatement(this.rewrite(stmt.test), this.jump(top)));
+                this.mark(end);
+                return;
+            }
+
+            case b.ForStatement: {
+                if (
+                    contains_yield(stmt.init) ||
+                    contains_yield(stmt.test) ||
+                    contains_yield(stmt.update)
+                )
+                    throw new CannotLower();
+                let top = this.newLabel();
+                let cont = this.newLabel();
+                let end = this.newLabel();
+                this.loops.push(null); // the init's bindings are per-iteration too
+                if (stmt.init) {
+                    if (stmt.init.type === b.VariableDeclaration)
+                        this.explodeDeclaration(stmt.init, stmt);
+                    else this.emit(b.expressionStatement(this.rewrite(stmt.init)));
+                }
+                this.loops.pop();
+                this.mark(top);
+                if (stmt.test) this.emitJumpUnless(this.rewrite(stmt.test), end);
+                this.explodeLoopBody(stmt, end, cont);
+                this.mark(cont);
+                if (stmt.update) this.emit(b.expressionStatement(this.rewrite(stmt.update)));
+                this.emit(this.jump(top));
+                this.mark(end);
+                return;
+            }
+
+            case b.ForOfStatement: {
+                if (contains_yield(stmt.right)) throw new CannotLower();
+                let binding;
+                if (stmt.left.type === b.VariableDeclaration) {
+                    if (stmt.left.declarations.length !== 1) throw new CannotLower();
+                    binding = stmt.left.declarations[0].id;
+                    this.hoist(binding, stmt);
+                } else if (stmt.left.type === b.Identifier) {
+                    binding = stmt.left;
+                } else {
+                    throw new CannotLower();
+                }
+                let iter = this.temp("iter");
+                let result = this.temp("result");
+                let top = this.newLabel();
+                let end = this.newLabel();
+                this.emitGetIterator(iter, this.rewrite(stmt.right));
+                this.mark(top);
+                this.emitIteratorStep(iter, result, end);
+                this.loops.push(null);
+                this.emit(assign(binding, b.memberExpression(result, b.identifier("value"))));
+                this.loops.pop();
+                this.explodeLoopBody(stmt, end, top);
+                this.emit(this.jump(top));
+                this.mark(end);
+                return;
+            }
+
+            default:
+                // try, switch, labels, for-in, return/throw of a yield
+                throw new CannotLower();
+        }
+    }
+
+    explodeLoopBody(loop, break_label, continue_label) {
+        this.loops.push({ break_label, continue_label });
+        this.explode(loop.body, loop);
+        this.loops.pop();
+    }
+
+    // returns @n with returns completing the generator, and break and
+    // continue statements that leave it for a loop we split turned into
+    // jumps.  @n itself isn't modified, changed nodes are copies.
+    rewrite(n, in_loop = false, in_breakable = false) {
+        if (!n || typeof n.type !== "string" || is_function(n)) return n;
+
+        switch (n.type) {
+            case b.LabeledStatement:
+                throw new CannotLower();
+
+            case b.VariableDeclaration:
+                // var is function scoped, it would end up in the step function
+                if (n.kind === "var") throw new CannotLower();
+                break;
+
+            case b.ReturnStatement:
+                return this.complete(this.rewrite(n.argument));
+
+            case b.BreakStatement:
+                if (n.label) throw new CannotLower();
+                if (in_breakable) return n;
+                return this.jump(this.innermostLoop().break_label);
+
+            case b.ContinueStatement:
+                if (n.label) throw new CannotLower();
+                if (in_loop) return n;
+                return this.jump(this.innermostLoop().continue_label);
+
+            case b.WhileStatement:
+            case b.DoWhileStatement:
+            case b.ForStatement:
+            case b.ForInStatement:
+            case b.ForOfStatement:
+                in_loop = in_breakable = true;
+                break;
+
+            case b.SwitchStatement:
+                in_breakable = true;
+                break;
+        }
+
+        let copy = null;
+        for (let key of Object.keys(n)) {
+            if (key === "loc" || key === "range") continue;
+            let v = n[key];
+            let nv = v;
+            if (Array.isArray(v)) {
+                let mapped = v.map((el) => this.rewrite(el, in_loop, in_breakable));
+                if (mapped.some((el, i) => el !== v[i])) nv = mapped;
+            } else if (v && typeof v.type === "string") {
+                nv = this.rewrite(v, in_loop, in_breakable);
+            }
+            if (nv !== v) {
+                if (!copy) copy = copy_node(n);
+                copy[key] = nv;
+            }
+        }
+        return copy || n;
+    }
+
+    innermostLoop() {
+        for (let i = this.loops.length - 1; i >= 0; i--) if (this.loops[i]) return this.loops[i];
+        throw new CannotLower();
+    }
+}
+
 export class DesugarGeneratorFunctions extends TransformPass {
     constructor(options) {
         super(options);
@@ -37,6 +541,23 @@ export class DesugarGeneratorFunctions extends TransformPass {
     }
 
     visitFunction(n) {
+        if (n.generator && n.body.type === b.BlockStatement) {
+            let id = this.genGen();
+            let body;
+            try {
+                body = new StateMachine(b.identifier(`%_gen_${id}`), id, n.params, n.body).lower();
+            } catch (e) {
+                if (!(e instanceof CannotLower)) throw e;
+                body = null;
+            }
+            if (body) {
+                n.body = body;
+                n.generator = false;
+                // nested functions still need visiting
+                return super.visitFunction(n);
+            }
+        }
+
         if (n.generator) this.mapping.unshift(b.identifier(`%_gen_${this.genGen()}`));
         n = super.visitFunction(n);
         if (n.generator) {
@@ -0,0 +1,304 @@
+/* -*- Mode: js2; indent-tabs-mode: nil; tab-width: 4; js2-indent-offset: 4; js2-basic-offset: 4; -*-
+ * vim: set ts=4 sw=4 et tw=99 ft=js:
+ */
+//
+// DirectCalls runs on the closure converted tree and finds the
+// %invokeClosure calls whose callee can only be one lifted function,
+// so the compiler can call that function directly instead of going
+// through _ejs_invoke_closure and the [[Call]] specop.  A direct call
+// is something LLVM can inline.
+//
+// A binding (a local, or an env slot for captured bindings) has a known
+// callee if the only value other than undefined ever stored in it is a
+// single %makeClosure/%makeClosureNoEnv/%makeAnonClosure.  Bindings used
+// as class constructors are left alone, since those throw when called.
+//
+// Calls through a known binding, and calls of a closure created right
+// there (iifes), are marked with direct_callee:
+//
+//   { name: <lifted function>, has_env: <bool>, guarded: <bool> }
+//
+// guarded is false for a local whose single definition is a statement
+// at the top of the function body that comes before every other
+// reference to it (and after every store of undefined to it), since
+// every read is guaranteed to see the closure.
+// Everything else (env slots in particular, which other functions can
+// see before they're initialized) gets a guard comparing the closure's
+// func against the known function, with the normal call as fallback.
+
+import * as b from "../ast-builder";
+import { TreeVisitor } from "../node-visitor";
+import { is_intrinsic } from "../echo-util";
+
+const CLOSURE_INTRINSICS = new Set(["%makeClosure", "%makeClosureNoEnv", "%makeAnonClosure"]);
+
+function is_local_ref(n) {
+    return is_intrinsic(n, "%getLocal") && n.arguments[0].type === b.Identifier;
+}
+
+function is_slot_ref(n) {
+    return (
+        is_intrinsic(n, "%slot") &&
+        n.arguments[0].type === b.Identifier &&
+        n.arguments[1].type === b.Literal
+    );
+}
+
+function slot_key(n) {
+    return `${n.arguments[0].name}:${n.arguments[1].value}`;
+}
+
+function is_undefined_value(n) {
+    return (
+        !n ||
+        (n.type === b.Literal && n.value === undefined) ||
+        (n.type === b.UnaryExpression && n.operator === "void") ||
+        is_intrinsic(n, "%builtinUndefined")
+    );
+}
+
+// returns the callee info for a closure creating intrinsic, or null
+function closure_callee(n) {
+    if (!n || n.type !== b.CallExpression || n.callee.type !== b.Identifier) return null;
+    if (!CLOSURE_INTRINSICS.has(n.callee.name)) return null;
+
+    let fn = n.arguments[n.arguments.length - 1];
+    if (fn.type !== b.Identifier) return null;
+
+    let has_env = n.callee.name !== "%makeClosureNoEnv" && !is_undefined_value(n.arguments[0]);
+    return { name: fn.name, has_env };
+}
+
+function children(n) {
+    let rv = [];
+    for (let key of Object.keys(n)) {
+        if (key === "loc" || key === "range") continue;
+        let v = n[key];
+        if (Array.isArray(v)) {
+            for (let el of v) if (el && typeof el.type === "string") rv.push(el);
+        } else if (v && typeof v.type === "string") {
+            rv.push(v);
+        }
+    }
+    return rv;
+}
+
+class Bindings {
+    constructor() {
+        this.defs = new Map(); // key -> [closure callee | null (anything else)]
+        this.undefined_stores = new Map(); // key -> [top level statement index]
+        this.excluded = new Set();
+    }
+
+    // @top is the top level statement the store is in, for locals
+    addDef(key, value, top) {
+        if (is_undefined_value(value)) {
+            // a call through the binding after this sees undefined and
+            // has to throw, so it doesn't count towards the callee, but
+            // definedBeforeUse needs to know about it.
+            if (!this.undefined_stores.has(key)) this.undefined_stores.set(key, []);
+            this.undefined_stores.get(key).push(top);
+            return;
+        }
+        if (!this.defs.has(key)) this.defs.set(key, []);
+        this.defs.get(key).push(closure_callee(value));
+    }
+
+    exclude(key) {
+        this.excluded.add(key);
+    }
+
+    // the callee stored in @key, or null if there isn't a single one
+    callee(key) {
+        if (this.excluded.has(key)) return null;
+        let defs = this.defs.get(key);
+        if (!defs || defs.length !== 1) return null;
+        return defs[0];
+    }
+}
+
+export class DirectCalls extends TreeVisitor {
+    visitProgram(program) {
+        this.slots = new Bindings();
+        this.functions = [];
+
+        // slots are shared between the function that creates an env and
+        // every function closed over it, so gather them module wide first
+        for (let n of program.body) this.gather(n, null, null);
+
+        for (let fn of this.functions) this.markFunction(fn);
+        return program;
+    }
+
+    // walks @n collecting definitions.  @locals is the Bindings for the
+    // enclosing function, @top the top level statement of it we're in.
+    gather(n, locals, top) {
+        if (!n || typeof n.type !== "string") return;
+
+        switch (n.type) {
+            case b.FunctionDeclaration:
+            case b.FunctionExpression:
+            case b.ArrowFunctionExpression: {
+                let fn_locals = new Bindings();
+                fn_locals.first_def = new Map(); // name -> top level statement index
+                fn_locals.first_ref = new Map();
+                this.functions.push({ fn: n, locals: fn_locals });
+                if (n.body.type === b.BlockStatement) {
+                    n.body.body.forEach((stmt, i) => this.gather(stmt, fn_locals, i));
+                } else {
+                    this.gather(n.body, fn_locals, 0);
+                }
+                return;
+            }
+
+            case b.VariableDeclarator:
+                if (locals) {
+                    locals.addDef(n.id.name, n.init, top);
+                    if (!is_undefined_value(n.init)) this.noteDef(locals, n.id.name, top);
+                }
+                this.gather(n.init, locals, top);
+                return;
+
+            case b.Identifier:
+                // a reference we don't understand
+                if (locals) locals.exclude(n.name);
+                return;
+
+            case b.MemberExpression:
+                this.gather(n.object, locals, top);
+                if (n.computed) this.gather(n.property, locals, top);
+                return;
+
+            case b.Property:
+                if (n.computed) this.gather(n.key, locals, top);
+                this.gather(n.value, locals, top);
+                return;
+
+            case b.AssignmentExpression:
+            case b.UpdateExpression: {
+                let target = n.type === b.AssignmentExpression ? n.left : n.argument;
+                let value = n.type === b.AssignmentExpression && n.operator === "=" ? n.right : n;
+                if (is_local_ref(target)) {
+                    locals.addDef(target.arguments[0].name, value, top);
+                    this.noteRef(locals, target.arguments[0].name, top);
+                } else if (is_slot_ref(target)) {
+                    this.slots.addDef(slot_key(target), value);
+                } else {
+                    this.gather(target, locals, top);
+                }
+                if (n.type === b.AssignmentExpression) this.gather(n.right, locals, top);
+                return;
+            }
+
+            case b.ForInStatement:
+            case b.ForOfStatement:
+                if (is_local_ref(n.left)) {
+                    locals.exclude(n.left.arguments[0].name);
+                    this.gather(n.right, locals, top);
+                    this.gather(n.body, locals, top);
+                    return;
+                }
+                break;
+
+            case b.CallExpression:
+                if (is_local_ref(n)) {
+                    this.noteRef(locals, n.arguments[0].name, top);
+                    return;
+                }
+                if (is_intrinsic(n, "%setLocal") && n.arguments[0].type === b.Identifier) {
+                    let name = n.arguments[0].name;
+                    locals.addDef(name, n.arguments[1], top);
+                    if (!is_undefined_value(n.arguments[1])) this.noteDef(locals, name, top);
+                    this.gather(n.arguments[1], locals, top);
+                    return;
+                }
+                if (is_intrinsic(n, "%setSlot")) {
+                    let value = n.arguments[n.arguments.length - 1];
+                    if (n.arguments[0].type === b.Identifier && n.arguments[1].type === b.Literal)
+                        this.slots.addDef(slot_key(n), value);
+                    this.gather(value, locals, top);
+                    return;
+                }
+                if (is_slot_ref(n)) return;
+                if (
+                    is_intrinsic(n, "%setConstructorKindBase") ||
+                    is_intrinsic(n, "%setConstructorKindDerived")
+                ) {
+                    let ctor = n.arguments[0];
+                    if (is_local_ref(ctor)) locals.exclude(ctor.arguments[0].name);
+                    else if (is_slot_ref(ctor)) this.slots.exclude(slot_key(ctor));
+                }
+                if (!is_intrinsic(n)) this.gather(n.callee, locals, top);
+                for (let arg of n.arguments) this.gather(arg, locals, top);
+                return;
+        }
+
+        for (let child of children(n)) this.gather(child, locals, top);
+    }
+
+    noteDef(locals, name, top) {
+        if (!locals.first_def.has(name)) locals.first_def.set(name, top);
+    }
+
+    noteRef(locals, name, top) {
+        if (!locals.first_ref.has(name)) locals.first_ref.set(name, top);
+    }
+
+    // true if the single definition of local @name is one of the
+    // top level statements of the function, and nothing refers to
+    // @name before that statement runs or stores undefined to it after
+    definedBeforeUse(fn, locals, name) {
+        let top = locals.first_def.get(name);
+        if (top === undefined || fn.body.type !== b.BlockStatement) return false;
+
+        let undefined_stores = locals.undefined_stores.get(name) || [];
+        if (undefined_stores.some((store_top) => store_top >= top)) return false;
+
+        let stmt = fn.body.body[top];
+        let def;
+        if (stmt.type === b.ExpressionStatement && is_intrinsic(stmt.expression, "%setLocal")) {
+            def = stmt.expression.arguments[0].name;
+        } else if (stmt.type === b.VariableDeclaration && stmt.declarations.length === 1) {
+            def = stmt.declarations[0].id.name;
+        }
+        if (def !== name) return false;
+
+        let ref = locals.first_ref.get(name);
+        return ref === undefined || ref > top;
+    }
+
+    markFunction({ fn, locals }) {
+        let mark = (n) => {
+            if (!n || typeof n.type !== "string") return;
+            if (
+                n.type === b.FunctionDeclaration ||
+                n.type === b.FunctionExpression ||
+                n.type === b.ArrowFunctionExpression
+            ) {
+                if (n !== fn) return;
+            }
+            for (let child of children(n)) mark(child);
+
+            if (!is_intrinsic(n, "%invokeClosure")) return;
+            let target = n.arguments[0];
+            let closure = closure_callee(target);
+            if (closure) {
+                // an iife
+                n.direct_callee = { name: closure.name, has_env: closure.has_env, guarded: false };
+            } else if (is_local_ref(target)) {
+                let name = target.arguments[0].name;
+                let callee = locals.callee(name);
+                if (callee)
+                    n.direct_callee = {
+                        name: callee.name,
+                        has_env: callee.has_env,
+                        guarded: !this.definedBeforeUse(fn, locals, name),
+                    };
+            } else if (is_slot_ref(target)) {
+                let callee = this.slots.callee(slot_key(target));
+                if (callee) n.direct_callee = { name: callee.name, has_env: callee.has_env, guarded: true };
+            }
+        };
+        mark(fn);
+    }
+}
@@ -0,0 +1,207 @@
+/* -*- Mode: js2; indent-tabs-mode: nil; tab-width: 4; js2-indent-offset: 4; js2-basic-offset: 4; -*-
+ * vim: set ts=4 sw=4 et tw=99 ft=js:
+ */
+//
+// EliminateArguments runs on the closure converted tree and removes
+// the arguments objects and rest arrays that are only used to read
+// arguments or to forward them to another function.  The compiler can
+// read those straight out of the caller's %argc/%args, so there's no
+// allocation.
+//
+// Each %getArgumentsObject() creates its own (unmapped) copy of the
+// arguments, so if every use in a function is one of:
+//
+//   arguments.length          -> %argumentsLength()
+//   arguments[key]            -> %argumentsGet(key)
+//   F.apply(recv, arguments)  -> %forwardArgs(F.apply, recv, 0)
+//
+// we rewrite them.  Anything else (writes, method calls, passing it
+// somewhere) leaves the function alone.
+//
+// A rest parameter `let r = %arrayFromRest('r', k)` whose only uses are
+// as the last part of a spread call,
+//
+//   F.apply(recv, %arrayFromSpread([a, b], %getLocal(r)))
+//
+// (which is what desugar-spread produces for F(a, b, ...r)) loses its
+// declaration, and the calls become %forwardArgs(F.apply, recv, k, a, b).
+//
+// %forwardArgs still looks up F.apply, and the runtime only skips the
+// array when it's the builtin Function.prototype.apply.
+
+import * as b from "../ast-builder";
+import { TreeVisitor } from "../node-visitor";
+import { is_intrinsic } from "../echo-util";
+import { argumentsLength_id, argumentsGet_id, forwardArgs_id } from "../common-ids";
+
+function is_function(n) {
+    return (
+        n.type === b.FunctionDeclaration ||
+        n.type === b.FunctionExpression ||
+        n.type === b.ArrowFunctionExpression
+    );
+}
+
+function children(n) {
+    let rv = [];
+    for (let key of Object.keys(n)) {
+        if (key === "loc" || key === "range" || key === "params") continue;
+        let v = n[key];
+        if (Array.isArray(v)) {
+            for (let el of v) if (el && typeof el.type === "string") rv.push(el);
+        } else if (v && typeof v.type === "string") {
+            rv.push(v);
+        }
+    }
+    return rv;
+}
+
+// walks @n without descending into nested functions, recording the
+// parent of every node in @parents.
+function gatherParents(n, parents, parent = null) {
+    if (!n || typeof n.type !== "string") return;
+    parents.set(n, parent);
+    for (let child of children(n)) if (!is_function(child)) gatherParents(child, parents, n);
+}
+
+function replaceChild(parent, child, replacement) {
+    for (let key of Object.keys(parent)) {
+        let v = parent[key];
+        if (v === child) {
+            parent[key] = replacement;
+            return;
+        }
+        if (Array.isArray(v)) {
+            let i = v.indexOf(child);
+            if (i !== -1) {
+                v[i] = replacement;
+                return;
+            }
+        }
+    }
+}
+
+// true if @call is `F.apply(recv, @arg)` with the call's this coming
+// from the member expression
+function is_apply_call(call, arg) {
+    if (!call || !is_intrinsic(call, "%invokeClosure") || call.arguments.length !== 3) return false;
+    if (call.arguments[2] !== arg) return false;
+    let callee = call.arguments[0];
+    return (
+        callee.type === b.MemberExpression &&
+        !callee.computed &&
+        callee.property.type === b.Identifier &&
+        callee.property.name === "apply"
+    );
+}
+
+// true if the value of member expression @m is only read
+function is_read(m, parent) {
+    if (!parent) return true;
+    switch (parent.type) {
+        case b.AssignmentExpression:
+            return parent.left !== m;
+        case b.UpdateExpression:
+            return false;
+        case b.UnaryExpression:
+            return parent.operator !== "delete";
+        case b.ForInStatement:
+        case b.ForOfStatement:
+            return parent.left !== m;
+        case b.CallExpression:
+            // a method call would pass arguments as this
+            if (is_intrinsic(parent, "%invokeClosure")) return parent.arguments[0] !== m;
+            return parent.callee !== m;
+        default:
+            return true;
+    }
+}
+
+export class EliminateArguments extends TreeVisitor {
+    visitFunction(n) {
+        if (n.body.type !== b.BlockStatement) return n;
+
+        let parents = new Map();
+        gatherParents(n.body, parents);
+
+        this.eliminateArguments(parents);
+        for (let stmt of n.body.body.slice()) this.eliminateRest(n, stmt, parents);
+        return n;
+    }
+
+    eliminateArguments(parents) {
+        let rewrites = [];
+        for (let [node, parent] of parents) {
+            if (!is_intrinsic(node, "%getArgumentsObject")) continue;
+
+            if (parent && parent.type === b.MemberExpression && parent.object === node) {
+                let grandparent = parents.get(parent);
+                if (!is_read(parent, grandparent)) return;
+                if (parent.computed) {
+                    rewrites.push(() =>
+                        replaceChild(grandparent, parent, b.callExpression(argumentsGet_id, [parent.property]))
+                    );
+                } else if (parent.property.type === b.Identifier && parent.property.name === "length") {
+                    rewrites.push(() =>
+                        replaceChild(grandparent, parent, b.callExpression(argumentsLength_id, []))
+                    );
+                } else {
+                    return;
+                }
+            } else if (is_apply_call(parent, node)) {
+                rewrites.push(() => {
+                    parent.callee = forwardArgs_id;
+                    parent.arguments = [parent.arguments[0], parent.arguments[1], b.literal(0)];
+                });
+            } else {
+                return;
+            }
+        }
+        for (let rewrite of rewrites) rewrite();
+    }
+
+    eliminateRest(fn, stmt, parents) {
+        if (stmt.type !== b.VariableDeclaration || stmt.declarations.length !== 1) return;
+        let decl = stmt.declarations[0];
+        if (!decl.init || !is_intrinsic(decl.init, "%arrayFromRest")) return;
+
+        let name = decl.id.name;
+        let skip = decl.init.arguments[1].value;
+        let calls = [];
+        for (let [node, parent] of parents) {
+            if (node.type !== b.Identifier || node.name !== name || node === decl.id) continue;
+
+            // %getLocal(r) as the last argument of %arrayFromSpread,
+            // everything before it plain array literals
+            let spread = parents.get(parent);
+            if (
+                !is_intrinsic(parent, "%getLocal") ||
+                !spread ||
+                !is_intrinsic(spread, "%arrayFromSpread") ||
+                spread.arguments[spread.arguments.length - 1] !== parent
+            )
+                return;
+            let prefix = spread.arguments.slice(0, -1);
+            if (
+                !prefix.every(
+                    (el) =>
+                        el.type === b.ArrayExpression &&
+                        el.elements.every((e) => e && e.type !== b.SpreadElement)
+                )
+            )
+                return;
+
+            let call = parents.get(spread);
+            if (!is_apply_call(call, spread)) return;
+            calls.push({ call, prefix });
+        }
+
+        for (let { call, prefix } of calls) {
+            let elements = [];
+            for (let arr of prefix) elements.push(...arr.elements);
+            call.callee = forwardArgs_id;
+            call.arguments = [call.arguments[0], call.arguments[1], b.literal(skip), ...elements];
+        }
+        fn.body.body.splice(fn.body.body.indexOf(stmt), 1);
+    }
+}
@@ -0,0 +1,200 @@
+/* -*- Mode: js2; indent-tabs-mode: nil; tab-width: 4; js2-indent-offset: 4; js2-basic-offset: 4; -*-
+ * vim: set ts=4 sw=4 et tw=99 ft=js:
+ */
+//
+// EscapeAnalysis runs after DirectCalls and finds closures and closure
+// environments that can't outlive the function activation that creates
+// them.
+//
+// A closure doesn't escape if the only thing ever done with it is to
+// call it, and every one of those calls is an unguarded direct call
+// (see direct-calls.js.)  Nothing needs the closure object then, so we
+// mark the creating intrinsic with elided = true and the compiler skips
+// it, passing the env straight to the lifted function instead.  The
+// closure in an iife is only ever used by that one call, so it goes too.
+//
+// An environment doesn't escape if it's created once per activation (a
+// top level `let %env_N = %makeClosureEnv(n)` statement), and in every
+// function that can see it, it's only used to get and set slots and to
+// create closures that don't escape.  Such an environment is marked with
+// stack_allocate = true, and lives in its creator's stack frame.  The
+// conservative stack scan in the GC keeps its slots alive.  Once LLVM
+// inlines the direct calls, the slots usually dissolve into registers.
+//
+// We don't try to follow closures into other functions (even the
+// synchronous builtins like Array.prototype.forEach), those always escape.
+
+import * as b from "../ast-builder";
+import { TreeVisitor } from "../node-visitor";
+import { is_intrinsic } from "../echo-util";
+
+const CLOSURE_INTRINSICS = new Set(["%makeClosure", "%makeClosureNoEnv", "%makeAnonClosure"]);
+
+function is_closure_intrinsic(n) {
+    return n && is_intrinsic(n) && CLOSURE_INTRINSICS.has(n.callee.name);
+}
+
+function is_local_ref(n) {
+    return is_intrinsic(n, "%getLocal") && n.arguments[0].type === b.Identifier;
+}
+
+function is_undefined_value(n) {
+    return (
+        !n ||
+        (n.type === b.Literal && n.value === undefined) ||
+        (n.type === b.UnaryExpression && n.operator === "void") ||
+        is_intrinsic(n, "%builtinUndefined")
+    );
+}
+
+function is_function(n) {
+    return (
+        n.type === b.FunctionDeclaration ||
+        n.type === b.FunctionExpression ||
+        n.type === b.ArrowFunctionExpression
+    );
+}
+
+function children(n) {
+    let rv = [];
+    for (let key of Object.keys(n)) {
+        if (key === "loc" || key === "range" || key === "params") continue;
+        let v = n[key];
+        if (Array.isArray(v)) {
+            for (let el of v) if (el && typeof el.type === "string") rv.push(el);
+        } else if (v && typeof v.type === "string") {
+            rv.push(v);
+        }
+    }
+    return rv;
+}
+
+// walks @n without descending into nested functions.  @f is called
+// with each node and its parent.
+function walk(n, f, parent = null) {
+    if (!n || typeof n.type !== "string") return;
+    f(n, parent);
+    for (let child of children(n)) if (!is_function(child)) walk(child, f, n);
+}
+
+export class EscapeAnalysis extends TreeVisitor {
+    visitProgram(program) {
+        let functions = program.body.filter(is_function);
+
+        for (let fn of functions) this.elideClosures(fn);
+
+        let escaped = new Set();
+        let creators = new Map(); // env name -> %makeClosureEnv node
+        for (let fn of functions) this.gatherEnvs(fn, creators, escaped);
+
+        for (let [name, creator] of creators) {
+            if (!escaped.has(name)) creator.stack_allocate = true;
+        }
+        return program;
+    }
+
+    // the closure intrinsic defining each local of @fn that's only ever
+    // called through unguarded direct calls.  the local has to have no
+    // other definition, and the closure can't be used as the value of
+    // an expression (as in `g = (f = function () {})`), so it has to be
+    // stored by a statement of its own.
+    elideClosures(fn) {
+        let defs = new Map(); // name -> [closure intrinsic stored by a statement | null]
+        let refs = new Map(); // name -> number of %getLocal references
+        let calls = new Map(); // name -> [%invokeClosure nodes]
+
+        let addDef = (name, value, statement_level) => {
+            if (!defs.has(name)) defs.set(name, []);
+            defs.get(name).push(statement_level && is_closure_intrinsic(value) ? value : null);
+        };
+
+        let elide = (closure, direct) => {
+            closure.elided = true;
+            let env = closure.callee.name === "%makeClosureNoEnv" ? null : closure.arguments[0];
+            for (let call of direct) call.direct_callee.env = env;
+        };
+
+        // `let x;` at the top of the function (where HoistVars puts
+        // vars) only gives the local its initial value
+        let initial_decls = new Set(
+            fn.body.type === b.BlockStatement
+                ? fn.body.body.filter((stmt) => stmt.type === b.VariableDeclaration)
+                : []
+        );
+
+        walk(fn.body, (n, parent) => {
+            if (
+                is_intrinsic(n, "%invokeClosure") &&
+                n.direct_callee &&
+                is_closure_intrinsic(n.arguments[0])
+            ) {
+                // an iife, the closure is only needed for this call
+                elide(n.arguments[0], [n]);
+            } else if (n.type === b.VariableDeclarator) {
+                if (!(is_undefined_value(n.init) && initial_decls.has(parent)))
+                    addDef(n.id.name, n.init, true);
+            } else if (is_intrinsic(n, "%setLocal") && n.arguments[0].type === b.Identifier) {
+                addDef(n.arguments[0].name, n.arguments[1], parent && parent.type === b.ExpressionStatement);
+            } else if (
+                (n.type === b.AssignmentExpression && is_local_ref(n.left)) ||
+                (n.type === b.UpdateExpression && is_local_ref(n.argument))
+            ) {
+                let target = n.type === b.AssignmentExpression ? n.left : n.argument;
+                addDef(target.arguments[0].name, null, false);
+            } else if (is_local_ref(n)) {
+                let name = n.arguments[0].name;
+                refs.set(name, (refs.get(name) || 0) + 1);
+                if (
+                    parent &&
+                    is_intrinsic(parent, "%invokeClosure") &&
+                    parent.arguments[0] === n &&
+                    parent.direct_callee &&
+                    !parent.direct_callee.guarded
+                ) {
+                    if (!calls.has(name)) calls.set(name, []);
+                    calls.get(name).push(parent);
+                }
+            }
+        });
+
+        for (let [name, closures] of defs) {
+            if (closures.length !== 1 || !closures[0]) continue;
+
+            let direct = calls.get(name) || [];
+            if (direct.length !== (refs.get(name) || 0)) continue;
+
+            elide(closures[0], direct);
+        }
+    }
+
+    gatherEnvs(fn, creators, escaped) {
+        walk(fn.body, (n, parent) => {
+            if (n.type !== b.Identifier || n.name.indexOf("%env_") !== 0) return;
+
+            if (parent.type === b.VariableDeclarator && parent.id === n) {
+                if (
+                    parent.init &&
+                    is_intrinsic(parent.init, "%makeClosureEnv") &&
+                    fn.body.body.some(
+                        (stmt) =>
+                            stmt.type === b.VariableDeclaration &&
+                            stmt.declarations.indexOf(parent) !== -1
+                    ) &&
+                    !creators.has(n.name)
+                ) {
+                    creators.set(n.name, parent.init);
+                } else {
+                    escaped.add(n.name);
+                }
+                return;
+            }
+
+            if (is_intrinsic(parent) && parent.arguments[0] === n) {
+                if (is_intrinsic(parent, "%slot") || is_intrinsic(parent, "%setSlot")) return;
+                if (is_closure_intrinsic(parent) && parent.elided) return;
+            }
+
+            escaped.add(n.name);
+        });
+    }
+}
@@ -0,0 +1,310 @@
+/* -*- Mode: js2; indent-tabs-mode: nil; tab-width: 4; js2-indent-offset: 4; js2-basic-offset: 4; -*-
+ * vim: set ts=4 sw=4 et tw=99 ft=js:
+ */
+//
+// InferNumericLocals runs on the closure converted tree and finds the
+// locals of each function that only ever hold numbers (loop counters,
+// accumulators, indices), so the compiler can keep them in a double
+// alloca instead of a boxed ejsval.  mem2reg turns those into native
+// registers, and LLVM's loop optimizations can see straight through
+// the arithmetic.
+//
+// A local is unboxed if:
+//
+//   1. every reference to it is %getLocal/%setLocal, an assignment or
+//      update of %getLocal, or its single declaration.  anything else
+//      (for-in, catch params, plain identifiers) leaves it alone.
+//
+//   2. it is definitely assigned before every read.  this is a simple
+//      flow sensitive walk in evaluation order: assignments in
+//      straight-line code count, assignments under a condition, loop,
+//      try, switch or label only count inside that construct.  the
+//      declaration's undefined initializer is never observed.
+//
+//   3. every value assigned to it is a number.  this is computed
+//      optimistically: assume every candidate is a number, and remove
+//      candidates with a non-number assignment until nothing changes.
+//
+// We mark the function with unboxed_locals (a Set of names), and every
+// expression we know produces a number with inferred_type = "number".
+//
+// Numbers are always doubles in this runtime, so we don't try to
+// narrow things further to int32.
+
+import * as b from "../ast-builder";
+import { TreeVisitor } from "../node-visitor";
+import { is_intrinsic } from "../echo-util";
+
+// binary operators that produce a number regardless of their operands
+const NUMERIC_RESULT_OPS = new Set(["-", "*", "/", "%", "&", "|", "^", "<<", ">>", ">>>"]);
+const NUMERIC_RESULT_UNARY_OPS = new Set(["-", "+", "~"]);
+
+function is_local_ref(n) {
+    return is_intrinsic(n, "%getLocal") && n.arguments[0].type === b.Identifier;
+}
+
+function is_undefined_init(n) {
+    return (
+        !n ||
+        (n.type === b.Literal && n.value === undefined) ||
+        (n.type === b.UnaryExpression && n.operator === "void") ||
+        is_intrinsic(n, "%builtinUndefined")
+    );
+}
+
+function children(n) {
+    let rv = [];
+    for (let key of Object.keys(n)) {
+        if (key === "loc" || key === "range") continue;
+        let v = n[key];
+        if (Array.isArray(v)) {
+            for (let el of v) if (el && typeof el.type === "string") rv.push(el);
+        } else if (v && typeof v.type === "string") {
+            rv.push(v);
+        }
+    }
+    return rv;
+}
+
+class FunctionAnalysis {
+    constructor(fn) {
+        this.fn = fn;
+        this.declared = new Map(); // name -> number of declarations
+        this.disqualified = new Set();
+        this.defs = new Map(); // name -> [value expression | null (non-number def)]
+    }
+
+    disqualify(name) {
+        this.disqualified.add(name);
+    }
+
+    addDef(name, value) {
+        if (!this.defs.has(name)) this.defs.set(name, []);
+        this.defs.get(name).push(value);
+    }
+
+    run() {
+        for (let p of this.fn.params) if (p.type === b.Identifier) this.disqualify(p.name);
+
+        this.walk(this.fn.body, new Set());
+
+        let numbers = new Set();
+        for (let [name, count] of this.declared) {
+            if (count === 1 && !this.disqualified.has(name) && this.defs.has(name)) numbers.add(name);
+        }
+
+        let changed = true;
+        while (changed) {
+            changed = false;
+            for (let name of numbers) {
+                if (this.defs.get(name).every((v) => v && this.isNumber(v, numbers))) continue;
+                numbers.delete(name);
+                changed = true;
+            }
+        }
+
+        this.fn.unboxed_locals = numbers;
+        if (numbers.size > 0) this.annotate(this.fn.body, numbers);
+    }
+
+    isNumber(n, numbers) {
+        switch (n.type) {
+            case b.Literal:
+                return typeof n.value === "number";
+            case b.UpdateExpression:
+                return true;
+            case b.UnaryExpression:
+                return NUMERIC_RESULT_UNARY_OPS.has(n.operator);
+            case b.BinaryExpression:
+                if (NUMERIC_RESULT_OPS.has(n.operator)) return true;
+                return (
+                    n.operator === "+" &&
+                    this.isNumber(n.left, numbers) &&
+                    this.isNumber(n.right, numbers)
+                );
+            case b.AssignmentExpression:
+                return this.isNumber(n.right, numbers);
+            case b.ConditionalExpression:
+                return this.isNumber(n.consequent, numbers) && this.isNumber(n.alternate, numbers);
+            case b.SequenceExpression:
+                return this.isNumber(n.expressions[n.expressions.length - 1], numbers);
+            case b.CallExpression:
+                if (is_local_ref(n)) return numbers.has(n.arguments[0].name);
+                if (is_intrinsic(n, "%setLocal")) return this.isNumber(n.arguments[1], numbers);
+                if (is_intrinsic(n, "%argumentsLength")) return true;
+                return false;
+            default:
+                return false;
+        }
+    }
+
+    annotate(n, numbers) {
+        if (!n || typeof n.type !== "string") return;
+        for (let child of children(n)) this.annotate(child, numbers);
+        if (this.isNumber(n, numbers)) n.inferred_type = "number";
+    }
+
+    // a read of @name with @assigned the set of definitely assigned locals
+    use(name, assigned) {
+        if (!assigned.has(name)) this.disqualify(name);
+    }
+
+    // walks @n in evaluation order.  @assigned is updated with locals
+    // definitely assigned by the time @n completes.
+    walk(n, assigned) {
+        if (!n || typeof n.type !== "string") return;
+
+        // constructs whose parts might not run, or might run before
+        // earlier assignments: walk them with a copy of the set and
+        // drop whatever they assigned.
+        let conditionally = (...parts) => {
+            for (let part of parts) this.walk(part, new Set(assigned));
+        };
+
+        switch (n.type) {
+            case b.FunctionDeclaration:
+            case b.FunctionExpression:
+            case b.ArrowFunctionExpression:
+                // lambda lifting has already moved these out
+                return;
+
+            case b.VariableDeclarator: {
+                let name = n.id.name;
+                this.declared.set(name, (this.declared.get(name) || 0) + 1);
+                if (is_undefined_init(n.init)) {
+                    assigned.delete(name);
+                } else {
+                    this.walk(n.init, assigned);
+                    this.addDef(name, n.init);
+                    assigned.add(name);
+                }
+                return;
+            }
+
+            case b.Identifier:
+                // only reached for identifiers that aren't the name in a
+                // %getLocal/%setLocal/declaration
+                this.disqualify(n.name);
+                return;
+
+            case b.MemberExpression:
+                this.walk(n.object, assigned);
+                if (n.computed) this.walk(n.property, assigned);
+                return;
+
+            case b.Property:
+                if (n.computed) this.walk(n.key, assigned);
+                this.walk(n.value, assigned);
+                return;
+
+            case b.CallExpression:
+                if (is_local_ref(n)) {
+                    this.use(n.arguments[0].name, assigned);
+                    return;
+                }
+                if (is_intrinsic(n, "%setLocal") && n.arguments[0].type === b.Identifier) {
+                    this.walk(n.arguments[1], assigned);
+                    this.addDef(n.arguments[0].name, n.arguments[1]);
+                    assigned.add(n.arguments[0].name);
+                    return;
+                }
+                this.walk(n.callee.type === b.Identifier && n.callee.name[0] === "%" ? null : n.callee, assigned);
+                for (let arg of n.arguments) this.walk(arg, assigned);
+                return;
+
+            case b.AssignmentExpression:
+                if (is_local_ref(n.left)) {
+                    this.walk(n.right, assigned);
+                    this.addDef(n.left.arguments[0].name, n.operator === "=" ? n.right : null);
+                    assigned.add(n.left.arguments[0].name);
+                    return;
+                }
+                this.walk(n.left, assigned);
+                this.walk(n.right, assigned);
+                return;
+
+            case b.UpdateExpression:
+                if (is_local_ref(n.argument)) {
+                    let name = n.argument.arguments[0].name;
+                    this.use(name, assigned);
+                    this.addDef(name, n);
+                    return;
+                }
+                this.walk(n.argument, assigned);
+                return;
+
+            case b.ForInStatement:
+            case b.ForOfStatement:
+                if (is_local_ref(n.left)) this.addDef(n.left.arguments[0].name, null);
+                else this.walk(n.left, assigned);
+                this.walk(n.right, assigned);
+                conditionally(n.body);
+                return;
+
+            case b.IfStatement:
+            case b.ConditionalExpression:
+                this.walk(n.test, assigned);
+                conditionally(n.consequent, n.alternate);
+                return;
+
+            case b.LogicalExpression:
+                this.walk(n.left, assigned);
+                conditionally(n.right);
+                return;
+
+            case b.ForStatement: {
+                this.walk(n.init, assigned);
+                // the test runs before the body on every iteration, and
+                // the update after it.  a continue can skip the rest of
+                // the body, so the update only sees what the test assigned.
+                let body_assigned = new Set(assigned);
+                this.walk(n.test, body_assigned);
+                let test_assigned = new Set(body_assigned);
+                this.walk(n.body, body_assigned);
+                this.walk(n.update, new Set(test_assigned));
+                // the test of the first iteration always runs
+                for (let name of test_assigned) assigned.add(name);
+                return;
+            }
+
+            case b.WhileStatement: {
+                let body_assigned = new Set(assigned);
+                this.walk(n.test, body_assigned);
+                let test_assigned = new Set(body_assigned);
+                this.walk(n.body, body_assigned);
+                for (let name of test_assigned) assigned.add(name);
+                return;
+            }
+
+            case b.DoWhileStatement:
+                // the body runs at least once, but a continue can skip
+                // the rest of it.
+                conditionally(n.body, n.test);
+                return;
+
+            case b.SwitchStatement:
+                this.walk(n.discriminant, assigned);
+                conditionally(...n.cases);
+                return;
+
+            case b.TryStatement:
+                conditionally(n.block, n.handler, n.finalizer);
+                return;
+
+            case b.LabeledStatement:
+                conditionally(n.body);
+                return;
+
+            default:
+                for (let child of children(n)) this.walk(child, assigned);
+                return;
+        }
+    }
+}
+
+export class InferNumericLocals extends TreeVisitor {
+    visitFunction(n) {
+        new FunctionAnalysis(n).run();
+        return n;
+    }
+}
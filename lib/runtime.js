@@ -75,6 +75,22 @@ const runtime_interface = {
             ])
         );
     },
+    invoke_closure_forward: function () {
+        return this.abi.createExternalFunction(
+            this.module,
+            "_ejs_invoke_closure_forward",
+            ty.EjsValue,
+            [
+                ty.EjsValue,
+                ty.EjsValue,
+                ty.EjsValue,
+                ty.Int32,
+                ty.EjsValue.pointerTo(),
+                ty.Int32,
+                ty.EjsValue.pointerTo(),
+            ]
+        );
+    },
     construct_closure_apply: function () {
         return takes_builtins(
             this.abi.createExternalFunction(
@@ -164,6 +180,22 @@ const runtime_interface = {
             ty.EjsValue,
         ]);
     },
+    make_generator_state_machine: function () {
+        return this.abi.createExternalFunction(
+            this.module,
+            "_ejs_generator_new_state_machine",
+            ty.EjsValue,
+            [ty.EjsValue]
+        );
+    },
+    generator_return: function () {
+        return does_not_throw(
+            this.abi.createExternalFunction(this.module, "_ejs_generator_complete", ty.EjsValue, [
+                ty.EjsValue,
+                ty.EjsValue,
+            ])
+        );
+    },
 
     object_create: function () {
         return this.abi.createExternalFunction(this.module, "_ejs_object_create", ty.EjsValue, [
@@ -178,6 +210,13 @@ const runtime_interface = {
             ])
         );
     },
+    arguments_get: function () {
+        return this.abi.createExternalFunction(this.module, "_ejs_arguments_get", ty.EjsValue, [
+            ty.Int32,
+            ty.EjsValue.pointerTo(),
+            ty.EjsValue,
+        ]);
+    },
     array_new: function () {
         return this.abi.createExternalFunction(this.module, "_ejs_array_new", ty.EjsValue, [
             ty.Int64,
@@ -190,6 +229,14 @@ const runtime_interface = {
             ty.EjsValue.pointerTo(),
         ]);
     },
+    array_new_cow: function () {
+        return does_not_throw(
+            this.abi.createExternalFunction(this.module, "_ejs_array_new_cow", ty.EjsValue, [
+                ty.Int64,
+                ty.EjsValue.pointerTo(),
+            ])
+        );
+    },
     array_from_iterables: function () {
         return this.abi.createExternalFunction(
             this.module,
@@ -222,6 +269,13 @@ const runtime_interface = {
             ty.String,
         ]);
     },
+    regexp_new_literal: function () {
+        return this.abi.createExternalFunction(this.module, "_ejs_regexp_new_literal", ty.EjsValue, [
+            ty.String,
+            ty.String,
+            ty.Int8Pointer.pointerTo(),
+        ]);
+    },
     truthy: function () {
         return does_not_throw(
             does_not_access_memory(
@@ -244,6 +298,14 @@ const runtime_interface = {
             ])
         );
     },
+    array_getprop_dense: function () {
+        return only_reads_memory(
+            this.abi.createExternalFunction(this.module, "_ejs_array_getprop_dense", ty.EjsValue, [
+                ty.EjsValue,
+                ty.EjsValue,
+            ])
+        );
+    },
     global_setprop: function () {
         return this.abi.createExternalFunction(this.module, "_ejs_global_setprop", ty.EjsValue, [
             ty.EjsValue,
@@ -312,6 +374,14 @@ const runtime_interface = {
             [ty.EjsPropIterator, ty.Bool]
         );
     },
+    prop_iterator_step: function () {
+        return this.abi.createExternalFunction(
+            this.module,
+            "_ejs_property_iterator_step",
+            ty.EjsValue,
+            [ty.EjsPropIterator]
+        );
+    },
     begin_catch: function () {
         return this.abi.createExternalFunction(this.module, "_ejs_begin_catch", ty.EjsValue, [
             ty.Int8Pointer,
@@ -453,6 +523,15 @@ const runtime_interface = {
         );
     },
 
+    iterator_step_value: function () {
+        return this.abi.createExternalFunction(
+            this.module,
+            "_ejs_iterator_step_value",
+            ty.EjsValue,
+            [ty.EjsValue, ty.EjsValue]
+        );
+    },
+
     iterator_wrapper_new: function () {
         return this.abi.createExternalFunction(
             this.module,
@@ -486,6 +565,9 @@ const runtime_interface = {
     exception_typeinfo: function () {
         return this.module.getOrInsertGlobal("EJS_EHTYPE_ejsvalue", ty.EjsExceptionTypeInfo);
     },
+    array_specops: function () {
+        return this.module.getOrInsertGlobal("_ejs_Array_specops", ty.EjsSpecops);
+    },
     function_specops: function () {
         return this.module.getOrInsertGlobal("_ejs_Function_specops", ty.EjsSpecops);
     },
@@ -542,6 +624,7 @@ const runtime_interface = {
     },
     record_binop: function () {
         return this.abi.createExternalFunction(this.module, "_ejs_record_binop", ty.Void, [
+            ty.String,
             ty.Int32,
             ty.String,
             ty.EjsValue,
@@ -550,12 +633,14 @@ const runtime_interface = {
     },
     record_assignment: function () {
         return this.abi.createExternalFunction(this.module, "_ejs_record_assignment", ty.Void, [
+            ty.String,
             ty.Int32,
             ty.EjsValue,
         ]);
     },
     record_getprop: function () {
         return this.abi.createExternalFunction(this.module, "_ejs_record_getprop", ty.Void, [
+            ty.String,
             ty.Int32,
             ty.EjsValue,
             ty.EjsValue,
@@ -563,6 +648,7 @@ const runtime_interface = {
     },
     record_setprop: function () {
         return this.abi.createExternalFunction(this.module, "_ejs_record_setprop", ty.Void, [
+            ty.String,
             ty.Int32,
             ty.EjsValue,
             ty.EjsValue,
@@ -0,0 +1,78 @@
+/* -*- Mode: js2; indent-tabs-mode: nil; tab-width: 4; js2-indent-offset: 4; js2-basic-offset: 4; -*-
+ * vim: set ts=4 sw=4 et tw=99 ft=js:
+ */
+
+// reads the profile written at exit by executables built with
+// --record-types (see runtime/ejs-recording.c for the format.)
+
+import * as fs from "@node-compat/fs";
+
+const NUMBER_TYPES = new Set(["int32", "double"]);
+
+function parseHistogram(field) {
+    let histogram = new Map();
+    if (field === "-") return histogram;
+    for (let entry of field.split(",")) {
+        let colon = entry.lastIndexOf(":");
+        histogram.set(entry.substring(0, colon), parseInt(entry.substring(colon + 1)));
+    }
+    return histogram;
+}
+
+export class TypeSite {
+    constructor(kind, op, operands) {
+        this.kind = kind;
+        this.op = op;
+        this.operands = operands; // an array of Map<type name, count>
+    }
+
+    // true if every value recorded for operand @n has a type in @types
+    operandOnly(n, types) {
+        let histogram = this.operands[n];
+        if (!histogram || histogram.size === 0) return false;
+        for (let t of histogram.keys()) if (!types.has(t)) return false;
+        return true;
+    }
+
+    operandNever(n, types) {
+        let histogram = this.operands[n];
+        if (!histogram) return false;
+        for (let t of histogram.keys()) if (types.has(t)) return false;
+        return true;
+    }
+
+    operandIsNumber(n) {
+        return this.operandOnly(n, NUMBER_TYPES);
+    }
+    operandNeverNumber(n) {
+        return this.operandNever(n, NUMBER_TYPES);
+    }
+    operandIsDenseArray(n) {
+        return this.operandOnly(n, new Set(["array"]));
+    }
+}
+
+export class TypeProfile {
+    constructor() {
+        this.sites = new Map();
+    }
+
+    static read(filename) {
+        let profile = new TypeProfile();
+        for (let line of fs.readFileSync(filename, "utf-8").split("\n")) {
+            if (line.length === 0) continue;
+            let fields = line.split("\t");
+            let kind = fields[0];
+            let op = kind === "binop" ? fields[3] : null;
+            let operands = fields.slice(kind === "binop" ? 4 : 3).map(parseHistogram);
+            profile.sites.set(`${fields[1]}\t${fields[2]}`, new TypeSite(kind, op, operands));
+        }
+        return profile;
+    }
+
+    // returns the TypeSite for @id in @module, or undefined if the site
+    // never executed in the profiled run.
+    lookup(module, id) {
+        return this.sites.get(`${module}\t${id}`);
+    }
+}
@@ -52,8 +52,15 @@ export let EjsPropertyMap = llvm.StructType.create("struct.EJSPropertyMap", [
     Int32, // int inuse;
 ]);
 
+export let EjsPropertyDesc = llvm.StructType.create("struct.EJSPropertyDesc", [
+    Int32, // uint32_t flags;
+    EjsValue, // ejsval   value; (or getter)
+    EjsValue, // ejsval   setter;
+]);
+
 export let EjsObject = null;
 export let EjsFunction = null;
+export let EjsDenseArray = null;
 export let EjsModule = null;
 
 function CreateModuleTy(suffix, num_exports) {
@@ -101,6 +108,18 @@ export function initTypes(is32bit) {
         Int32, // EJSBool  bound;
     ]);
 
+    // an EJSArray with the dense member of its union
+    EjsDenseArray = llvm.StructType.create("struct.EJSDenseArray", [
+        EjsObject, // EJSObject obj;
+        EjsPropertyDesc, // EJSPropertyDesc array_length_desc;
+        Int64, // int64_t  array_length;
+        Int64, // int64_t  dense.array_alloc;
+        Int64, // int64_t  dense.array_offset;
+        Int32, // EJSBool  dense.cow;
+        EjsPropertyDesc.pointerTo(), // EJSPropertyDesc* dense.element_descs;
+        EjsValue.pointerTo(), // ejsval*  dense.elements;
+    ]);
+
     EjsModule = CreateModuleTy("", 1);
 }
 
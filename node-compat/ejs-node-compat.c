@@ -13,6 +13,7 @@
 #include <errno.h>
 #include <dirent.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <sys/wait.h>
 #include <sys/param.h>
 #include <sys/utsname.h>
@@ -26,6 +27,7 @@
 #include "ejs-symbol.h"
 #include "ejs-node-compat.h"
 #include "ejs-error.h"
+#include "ejs-typedarrays.h"
 
 ////
 /// path module
@@ -452,6 +454,97 @@ static EJS_NATIVE_FUNC(_ejs_fs_readFileSync) {
     return rv;
 }
 
+typedef struct {
+    void* base;
+    size_t length;
+} MappedRegion;
+
+static void
+release_mapped_region (void* data, int size, void* release_data)
+{
+    MappedRegion* region = (MappedRegion*)release_data;
+    munmap (region->base, region->length);
+    free (region);
+}
+
+// fs.mmapSync(path[, offset[, length]])
+//
+// returns an ArrayBuffer backed directly by a private (copy-on-write) mapping of the file, so
+// typed arrays and DataViews read the file contents without copying them.  writes through the
+// buffer are private to the mapping and never reach the file.  the mapping is released when the
+// buffer is collected.
+static EJS_NATIVE_FUNC(_ejs_fs_mmapSync) {
+    ejsval path = _ejs_undefined;
+    if (argc > 0) path = args[0];
+
+    if (!EJSVAL_IS_STRING_TYPE(path)) {
+        _ejs_throw_nativeerror_utf8 (EJS_TYPE_ERROR, "path must be a string");
+    }
+
+    // convert everything that can throw before there's a path or fd to leak
+    ejsval path_str = ToString(path);
+
+    int64_t offset = 0;
+    if (argc > 1 && !EJSVAL_IS_UNDEFINED(args[1]))
+        offset = ToLength(args[1]);
+
+    EJSBool have_length = argc > 2 && !EJSVAL_IS_UNDEFINED(args[2]);
+    int64_t requested_length = have_length ? ToLength(args[2]) : 0;
+
+    char* utf8_path = ucs2_to_utf8(EJSVAL_TO_FLAT_STRING(path_str));
+
+    int fd = open (utf8_path, O_RDONLY);
+    if (fd == -1)
+        throw_errno_error(errno, utf8_path);
+
+    struct stat fd_stat;
+    if (fstat (fd, &fd_stat) == -1) {
+        int stat_errno = errno;
+        close(fd);
+        throw_errno_error(stat_errno, utf8_path);
+    }
+
+    if (offset > fd_stat.st_size)
+        offset = fd_stat.st_size;
+
+    int64_t length = fd_stat.st_size - offset;
+    if (have_length)
+        length = MIN(length, requested_length);
+
+    if (length > INT32_MAX) {
+        close(fd);
+        free(utf8_path);
+        _ejs_throw_nativeerror_utf8 (EJS_RANGE_ERROR, "mapping is too large for an ArrayBuffer, pass an offset and length to map a window of the file");
+    }
+
+    if (length == 0) {
+        close(fd);
+        free(utf8_path);
+        return _ejs_arraybuffer_new (0);
+    }
+
+    // mmap offsets have to be page aligned, so map from the page containing @offset and hand
+    // out a pointer into the middle of it.
+    long page_size = sysconf(_SC_PAGESIZE);
+    int64_t aligned_offset = offset - (offset % page_size);
+    size_t map_length = (size_t)(length + (offset - aligned_offset));
+
+    void* base = mmap (NULL, map_length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, (off_t)aligned_offset);
+    int mmap_errno = errno;
+    close(fd);
+
+    if (base == MAP_FAILED)
+        throw_errno_error(mmap_errno, utf8_path);
+
+    free(utf8_path);
+
+    MappedRegion* region = (MappedRegion*)malloc(sizeof(MappedRegion));
+    region->base = base;
+    region->length = map_length;
+
+    return _ejs_arraybuffer_new_external ((char*)base + (offset - aligned_offset), (int)length, release_mapped_region, region);
+}
+
 static EJS_NATIVE_FUNC(_ejs_fs_writeFileSync) {
     // XXX we ignore the options argument (third) entirely
     ejsval path = _ejs_undefined;
@@ -629,6 +722,7 @@ _ejs_fs_module_func (ejsval exports)
     EJS_INSTALL_FUNCTION(exports, "statSync", _ejs_fs_statSync);
     EJS_INSTALL_FUNCTION(exports, "existsSync", _ejs_fs_existsSync);
     EJS_INSTALL_FUNCTION(exports, "readFileSync", _ejs_fs_readFileSync);
+    EJS_INSTALL_FUNCTION(exports, "mmapSync", _ejs_fs_mmapSync);
     EJS_INSTALL_FUNCTION(exports, "writeFileSync", _ejs_fs_writeFileSync);
     EJS_INSTALL_FUNCTION(exports, "unlinkSync", _ejs_fs_unlinkSync);
     EJS_INSTALL_FUNCTION(exports, "createWriteStream", _ejs_fs_createWriteStream);
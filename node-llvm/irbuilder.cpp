@@ -73,6 +73,24 @@ namespace jsllvm {
     Nan::SetMethod(ctor_func, "createSelect", IRBuilder::CreateSelect);
 
     Nan::SetMethod(ctor_func, "createNswSub", IRBuilder::CreateNswSub);
+    Nan::SetMethod(ctor_func, "createFSub", IRBuilder::CreateFSub);
+    Nan::SetMethod(ctor_func, "createFMul", IRBuilder::CreateFMul);
+    Nan::SetMethod(ctor_func, "createFDiv", IRBuilder::CreateFDiv);
+    Nan::SetMethod(ctor_func, "createFRem", IRBuilder::CreateFRem);
+    Nan::SetMethod(ctor_func, "createFCmpOEq", IRBuilder::CreateFCmpOEq);
+    Nan::SetMethod(ctor_func, "createFCmpUNe", IRBuilder::CreateFCmpUNe);
+    Nan::SetMethod(ctor_func, "createFCmpOLt", IRBuilder::CreateFCmpOLt);
+    Nan::SetMethod(ctor_func, "createFCmpOLe", IRBuilder::CreateFCmpOLe);
+    Nan::SetMethod(ctor_func, "createFCmpOGt", IRBuilder::CreateFCmpOGt);
+    Nan::SetMethod(ctor_func, "createFCmpOGe", IRBuilder::CreateFCmpOGe);
+    Nan::SetMethod(ctor_func, "createICmpULe", IRBuilder::CreateICmpULe);
+    Nan::SetMethod(ctor_func, "createXor", IRBuilder::CreateXor);
+    Nan::SetMethod(ctor_func, "createShl", IRBuilder::CreateShl);
+    Nan::SetMethod(ctor_func, "createLShr", IRBuilder::CreateLShr);
+    Nan::SetMethod(ctor_func, "createAShr", IRBuilder::CreateAShr);
+    Nan::SetMethod(ctor_func, "createSIToFP", IRBuilder::CreateSIToFP);
+    Nan::SetMethod(ctor_func, "createUIToFP", IRBuilder::CreateUIToFP);
+    Nan::SetMethod(ctor_func, "createFPToSI", IRBuilder::CreateFPToSI);
 
     Nan::SetMethod(ctor_func, "createLandingPad", IRBuilder::CreateLandingPad);
     Nan::SetMethod(ctor_func, "createResume", IRBuilder::CreateResume);
@@ -597,6 +615,240 @@ namespace jsllvm {
     info.GetReturnValue().Set(result);
   }
 
+  NAN_METHOD(IRBuilder::CreateFSub) {
+    v8::Isolate *isolate = info.GetIsolate();
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();    
+    Nan::HandleScope scope;
+
+    REQ_LLVM_VAL_ARG(context, 0, lhs);
+    REQ_LLVM_VAL_ARG(context, 1, rhs);
+    FALLBACK_EMPTY_UTF8_ARG(context, 2, name);
+
+    Local<v8::Value> result = Instruction::Create(static_cast<llvm::Instruction*>(IRBuilder::builder.CreateFSub(lhs, rhs, *name)));
+    info.GetReturnValue().Set(result);
+  }
+
+  NAN_METHOD(IRBuilder::CreateFMul) {
+    v8::Isolate *isolate = info.GetIsolate();
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();    
+    Nan::HandleScope scope;
+
+    REQ_LLVM_VAL_ARG(context, 0, lhs);
+    REQ_LLVM_VAL_ARG(context, 1, rhs);
+    FALLBACK_EMPTY_UTF8_ARG(context, 2, name);
+
+    Local<v8::Value> result = Instruction::Create(static_cast<llvm::Instruction*>(IRBuilder::builder.CreateFMul(lhs, rhs, *name)));
+    info.GetReturnValue().Set(result);
+  }
+
+  NAN_METHOD(IRBuilder::CreateFDiv) {
+    v8::Isolate *isolate = info.GetIsolate();
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();    
+    Nan::HandleScope scope;
+
+    REQ_LLVM_VAL_ARG(context, 0, lhs);
+    REQ_LLVM_VAL_ARG(context, 1, rhs);
+    FALLBACK_EMPTY_UTF8_ARG(context, 2, name);
+
+    Local<v8::Value> result = Instruction::Create(static_cast<llvm::Instruction*>(IRBuilder::builder.CreateFDiv(lhs, rhs, *name)));
+    info.GetReturnValue().Set(result);
+  }
+
+  NAN_METHOD(IRBuilder::CreateFRem) {
+    v8::Isolate *isolate = info.GetIsolate();
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();    
+    Nan::HandleScope scope;
+
+    REQ_LLVM_VAL_ARG(context, 0, lhs);
+    REQ_LLVM_VAL_ARG(context, 1, rhs);
+    FALLBACK_EMPTY_UTF8_ARG(context, 2, name);
+
+    Local<v8::Value> result = Instruction::Create(static_cast<llvm::Instruction*>(IRBuilder::builder.CreateFRem(lhs, rhs, *name)));
+    info.GetReturnValue().Set(result);
+  }
+
+  NAN_METHOD(IRBuilder::CreateFCmpOEq) {
+    v8::Isolate *isolate = info.GetIsolate();
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();    
+    Nan::HandleScope scope;
+
+    REQ_LLVM_VAL_ARG(context, 0, lhs);
+    REQ_LLVM_VAL_ARG(context, 1, rhs);
+    FALLBACK_EMPTY_UTF8_ARG(context, 2, name);
+
+    Local<v8::Value> result = Instruction::Create(static_cast<llvm::Instruction*>(IRBuilder::builder.CreateFCmpOEQ(lhs, rhs, *name)));
+    info.GetReturnValue().Set(result);
+  }
+
+  NAN_METHOD(IRBuilder::CreateFCmpUNe) {
+    v8::Isolate *isolate = info.GetIsolate();
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();    
+    Nan::HandleScope scope;
+
+    REQ_LLVM_VAL_ARG(context, 0, lhs);
+    REQ_LLVM_VAL_ARG(context, 1, rhs);
+    FALLBACK_EMPTY_UTF8_ARG(context, 2, name);
+
+    Local<v8::Value> result = Instruction::Create(static_cast<llvm::Instruction*>(IRBuilder::builder.CreateFCmpUNE(lhs, rhs, *name)));
+    info.GetReturnValue().Set(result);
+  }
+
+  NAN_METHOD(IRBuilder::CreateFCmpOLt) {
+    v8::Isolate *isolate = info.GetIsolate();
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();    
+    Nan::HandleScope scope;
+
+    REQ_LLVM_VAL_ARG(context, 0, lhs);
+    REQ_LLVM_VAL_ARG(context, 1, rhs);
+    FALLBACK_EMPTY_UTF8_ARG(context, 2, name);
+
+    Local<v8::Value> result = Instruction::Create(static_cast<llvm::Instruction*>(IRBuilder::builder.CreateFCmpOLT(lhs, rhs, *name)));
+    info.GetReturnValue().Set(result);
+  }
+
+  NAN_METHOD(IRBuilder::CreateFCmpOLe) {
+    v8::Isolate *isolate = info.GetIsolate();
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();    
+    Nan::HandleScope scope;
+
+    REQ_LLVM_VAL_ARG(context, 0, lhs);
+    REQ_LLVM_VAL_ARG(context, 1, rhs);
+    FALLBACK_EMPTY_UTF8_ARG(context, 2, name);
+
+    Local<v8::Value> result = Instruction::Create(static_cast<llvm::Instruction*>(IRBuilder::builder.CreateFCmpOLE(lhs, rhs, *name)));
+    info.GetReturnValue().Set(result);
+  }
+
+  NAN_METHOD(IRBuilder::CreateFCmpOGt) {
+    v8::Isolate *isolate = info.GetIsolate();
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();    
+    Nan::HandleScope scope;
+
+    REQ_LLVM_VAL_ARG(context, 0, lhs);
+    REQ_LLVM_VAL_ARG(context, 1, rhs);
+    FALLBACK_EMPTY_UTF8_ARG(context, 2, name);
+
+    Local<v8::Value> result = Instruction::Create(static_cast<llvm::Instruction*>(IRBuilder::builder.CreateFCmpOGT(lhs, rhs, *name)));
+    info.GetReturnValue().Set(result);
+  }
+
+  NAN_METHOD(IRBuilder::CreateFCmpOGe) {
+    v8::Isolate *isolate = info.GetIsolate();
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();    
+    Nan::HandleScope scope;
+
+    REQ_LLVM_VAL_ARG(context, 0, lhs);
+    REQ_LLVM_VAL_ARG(context, 1, rhs);
+    FALLBACK_EMPTY_UTF8_ARG(context, 2, name);
+
+    Local<v8::Value> result = Instruction::Create(static_cast<llvm::Instruction*>(IRBuilder::builder.CreateFCmpOGE(lhs, rhs, *name)));
+    info.GetReturnValue().Set(result);
+  }
+
+  NAN_METHOD(IRBuilder::CreateICmpULe) {
+    v8::Isolate *isolate = info.GetIsolate();
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();    
+    Nan::HandleScope scope;
+
+    REQ_LLVM_VAL_ARG(context, 0, lhs);
+    REQ_LLVM_VAL_ARG(context, 1, rhs);
+    FALLBACK_EMPTY_UTF8_ARG(context, 2, name);
+
+    Local<v8::Value> result = Instruction::Create(static_cast<llvm::Instruction*>(IRBuilder::builder.CreateICmpULE(lhs, rhs, *name)));
+    info.GetReturnValue().Set(result);
+  }
+
+  NAN_METHOD(IRBuilder::CreateXor) {
+    v8::Isolate *isolate = info.GetIsolate();
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();    
+    Nan::HandleScope scope;
+
+    REQ_LLVM_VAL_ARG(context, 0, lhs);
+    REQ_LLVM_VAL_ARG(context, 1, rhs);
+    FALLBACK_EMPTY_UTF8_ARG(context, 2, name);
+
+    Local<v8::Value> result = Instruction::Create(static_cast<llvm::Instruction*>(IRBuilder::builder.CreateXor(lhs, rhs, *name)));
+    info.GetReturnValue().Set(result);
+  }
+
+  NAN_METHOD(IRBuilder::CreateShl) {
+    v8::Isolate *isolate = info.GetIsolate();
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();    
+    Nan::HandleScope scope;
+
+    REQ_LLVM_VAL_ARG(context, 0, lhs);
+    REQ_LLVM_VAL_ARG(context, 1, rhs);
+    FALLBACK_EMPTY_UTF8_ARG(context, 2, name);
+
+    Local<v8::Value> result = Instruction::Create(static_cast<llvm::Instruction*>(IRBuilder::builder.CreateShl(lhs, rhs, *name)));
+    info.GetReturnValue().Set(result);
+  }
+
+  NAN_METHOD(IRBuilder::CreateLShr) {
+    v8::Isolate *isolate = info.GetIsolate();
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();    
+    Nan::HandleScope scope;
+
+    REQ_LLVM_VAL_ARG(context, 0, lhs);
+    REQ_LLVM_VAL_ARG(context, 1, rhs);
+    FALLBACK_EMPTY_UTF8_ARG(context, 2, name);
+
+    Local<v8::Value> result = Instruction::Create(static_cast<llvm::Instruction*>(IRBuilder::builder.CreateLShr(lhs, rhs, *name)));
+    info.GetReturnValue().Set(result);
+  }
+
+  NAN_METHOD(IRBuilder::CreateAShr) {
+    v8::Isolate *isolate = info.GetIsolate();
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();    
+    Nan::HandleScope scope;
+
+    REQ_LLVM_VAL_ARG(context, 0, lhs);
+    REQ_LLVM_VAL_ARG(context, 1, rhs);
+    FALLBACK_EMPTY_UTF8_ARG(context, 2, name);
+
+    Local<v8::Value> result = Instruction::Create(static_cast<llvm::Instruction*>(IRBuilder::builder.CreateAShr(lhs, rhs, *name)));
+    info.GetReturnValue().Set(result);
+  }
+
+  NAN_METHOD(IRBuilder::CreateSIToFP) {
+    v8::Isolate *isolate = info.GetIsolate();
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();    
+    Nan::HandleScope scope;
+
+    REQ_LLVM_VAL_ARG(context, 0, V);
+    REQ_LLVM_TYPE_ARG(context, 1, dest_ty);
+    FALLBACK_EMPTY_UTF8_ARG(context, 2, name);
+
+    Local<v8::Value> result = Instruction::Create(static_cast<llvm::Instruction*>(IRBuilder::builder.CreateSIToFP(V, dest_ty, *name)));
+    info.GetReturnValue().Set(result);
+  }
+
+  NAN_METHOD(IRBuilder::CreateUIToFP) {
+    v8::Isolate *isolate = info.GetIsolate();
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();    
+    Nan::HandleScope scope;
+
+    REQ_LLVM_VAL_ARG(context, 0, V);
+    REQ_LLVM_TYPE_ARG(context, 1, dest_ty);
+    FALLBACK_EMPTY_UTF8_ARG(context, 2, name);
+
+    Local<v8::Value> result = Instruction::Create(static_cast<llvm::Instruction*>(IRBuilder::builder.CreateUIToFP(V, dest_ty, *name)));
+    info.GetReturnValue().Set(result);
+  }
+
+  NAN_METHOD(IRBuilder::CreateFPToSI) {
+    v8::Isolate *isolate = info.GetIsolate();
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();    
+    Nan::HandleScope scope;
+
+    REQ_LLVM_VAL_ARG(context, 0, V);
+    REQ_LLVM_TYPE_ARG(context, 1, dest_ty);
+    FALLBACK_EMPTY_UTF8_ARG(context, 2, name);
+
+    Local<v8::Value> result = Instruction::Create(static_cast<llvm::Instruction*>(IRBuilder::builder.CreateFPToSI(V, dest_ty, *name)));
+    info.GetReturnValue().Set(result);
+  }
+
   NAN_METHOD(IRBuilder::CreateLandingPad) {
     v8::Isolate *isolate = info.GetIsolate();
     v8::Local<v8::Context> context = isolate->GetCurrentContext();    
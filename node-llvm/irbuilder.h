@@ -55,6 +55,24 @@ namespace jsllvm {
     static NAN_METHOD(CreateSelect);
 
     static NAN_METHOD(CreateNswSub);
+    static NAN_METHOD(CreateFSub);
+    static NAN_METHOD(CreateFMul);
+    static NAN_METHOD(CreateFDiv);
+    static NAN_METHOD(CreateFRem);
+    static NAN_METHOD(CreateFCmpOEq);
+    static NAN_METHOD(CreateFCmpUNe);
+    static NAN_METHOD(CreateFCmpOLt);
+    static NAN_METHOD(CreateFCmpOLe);
+    static NAN_METHOD(CreateFCmpOGt);
+    static NAN_METHOD(CreateFCmpOGe);
+    static NAN_METHOD(CreateICmpULe);
+    static NAN_METHOD(CreateXor);
+    static NAN_METHOD(CreateShl);
+    static NAN_METHOD(CreateLShr);
+    static NAN_METHOD(CreateAShr);
+    static NAN_METHOD(CreateSIToFP);
+    static NAN_METHOD(CreateUIToFP);
+    static NAN_METHOD(CreateFPToSI);
 
     static NAN_METHOD(CreateLandingPad);
     static NAN_METHOD(CreateResume);
@@ -63,6 +63,20 @@ _ejs_arguments_new (int numElements, ejsval* args)
     return OBJECT_TO_EJSVAL(arguments);
 }
 
+// arguments[key] for a function whose arguments object never escapes.
+// the compiler opencodes in-range integer keys, anything else comes
+// here and gets the same answer a real arguments object would give.
+ejsval
+_ejs_arguments_get (int argc, ejsval* args, ejsval key)
+{
+    if (EJSVAL_IS_NUMBER(key)) {
+        double d = EJSVAL_TO_NUMBER(key);
+        if (d >= 0 && d < argc && (double)(int)d == d)
+            return args[(int)d];
+    }
+    return _ejs_object_getprop (_ejs_arguments_new (argc, args), key);
+}
+
 void
 _ejs_arguments_init(ejsval global)
 {
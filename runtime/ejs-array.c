@@ -15,6 +15,7 @@
 #include "ejs-error.h"
 #include "ejs-symbol.h"
 #include "ejs-number.h"
+#include "ejs-typedarrays.h"
 
 // num > SPARSE_ARRAY_CUTOFF in "Array($num)" or "new Array($num)" triggers a sparse array
 #define SPARSE_ARRAY_CUTOFF 50000
@@ -23,6 +24,7 @@
 #define _EJS_ARRAY_ELEMENTS(arrobj) (((EJSArray*)arrobj)->elements)
 
 static ejsval _ejs_array_slice_dense (ejsval env, ejsval _this, uint32_t argc, ejsval* args);
+static void sparse_init (EJSArray *arr);
 
 static inline int
 max(int a, int b)
@@ -133,7 +135,7 @@ static ejsval ArraySpeciesCreate(ejsval originalArray, int64_t length) {
     }
     // 5. If C is undefined or null, return ArrayCreate(length).
     if (EJSVAL_IS_UNDEFINED(C) || EJSVAL_IS_NULL(C) || EJSVAL_EQ(C, _ejs_Array))
-        return _ejs_array_new(length, EJS_FALSE);
+        return _ejs_array_new(length, EJS_TRUE);
 
     // 6. If IsConstructor(C) is false, throw a TypeError exception.
     if (!IsConstructor(C))
@@ -144,6 +146,41 @@ static ejsval ArraySpeciesCreate(ejsval originalArray, int64_t length) {
     return Construct(C, _ejs_undefined, 1, &length_);
 }
 
+// The Array.prototype natives below have fast paths that walk dense.elements directly instead
+// of going through HasProperty/Get/Put with boxed index keys.  Skipping holes is only
+// equivalent to the spec steps when nothing on the prototype chain can supply a value for
+// them, so O has to be a plain Array (not a proxy or subclass instance) and neither
+// Array.prototype nor Object.prototype can have indexed properties.  Callbacks can change
+// any of that, so loops that call out re-check after every call and drop back to the spec
+// steps at the current index.
+static EJSBool
+dense_fast_path_ok (ejsval O)
+{
+    if (!EJSVAL_IS_DENSE_ARRAY(O))
+        return EJS_FALSE;
+
+    EJSObject* obj = EJSVAL_TO_OBJECT(O);
+    if (!EJSVAL_EQ(obj->proto, _ejs_Array_prototype))
+        return EJS_FALSE;
+
+    EJSObject* array_proto = EJSVAL_TO_OBJECT(_ejs_Array_prototype);
+    if (EJSARRAY_LEN(array_proto) != 0 || !EJSVAL_EQ(array_proto->proto, _ejs_Object_prototype))
+        return EJS_FALSE;
+
+    EJSObject* object_proto = EJSVAL_TO_OBJECT(_ejs_Object_prototype);
+    return !object_proto->map->has_index_keys && EJSVAL_IS_NULL(object_proto->proto);
+}
+
+// O[k] for the dense fast paths.  returns EJS_FALSE if the element isn't present.
+static inline EJSBool
+dense_get (ejsval O, int64_t k, ejsval* v)
+{
+    if (k >= EJS_ARRAY_LEN(O))
+        return EJS_FALSE;
+    *v = EJS_DENSE_ARRAY_ELEMENTS(O)[k];
+    return !EJSVAL_IS_ARRAY_HOLE_MAGIC(*v);
+}
+
 // ES6 Draft January 15, 2015
 // 22.1.3.24.1
 // Runtime Semantics: SortCompare( x, y )
@@ -205,15 +242,14 @@ _ejs_array_new (int64_t numElements, EJSBool fill)
 
     if (numElements > SPARSE_ARRAY_CUTOFF) {
         _ejs_init_object ((EJSObject*)rv, _ejs_Array_prototype, &_ejs_sparsearray_specops);
-
-        rv->sparse.arraylet_alloc = 5;
-        rv->sparse.arraylet_num = 0;
-        rv->sparse.arraylets = (Arraylet*)calloc(rv->sparse.arraylet_alloc, sizeof(Arraylet));
+        sparse_init (rv);
     }
     else {
         _ejs_init_object ((EJSObject*)rv, _ejs_Array_prototype, &_ejs_Array_specops);
 
         rv->dense.array_alloc = numElements + 5;
+        rv->dense.array_offset = 0;
+        rv->dense.cow = EJS_FALSE;
         rv->dense.elements = (ejsval*)malloc(rv->dense.array_alloc * sizeof (ejsval));
         if (fill) {
             for (int i = 0; i < numElements; i ++)
@@ -228,6 +264,28 @@ _ejs_array_new (int64_t numElements, EJSBool fill)
     return OBJECT_TO_EJSVAL(rv);
 }
 
+// used by the compiler for array literals made up entirely of constants.  @elements is
+// read-only data emitted alongside the literal, and the array uses it as its storage until
+// something writes to the array (see dense_unshare).
+ejsval
+_ejs_array_new_cow (int64_t numElements, ejsval* elements)
+{
+    EJSArray* rv = _ejs_gc_new (EJSArray);
+
+    _ejs_init_object ((EJSObject*)rv, _ejs_Array_prototype, &_ejs_Array_specops);
+
+    rv->dense.array_alloc = numElements;
+    rv->dense.array_offset = 0;
+    rv->dense.cow = EJS_TRUE;
+    rv->dense.elements = elements;
+
+    rv->array_length = numElements;
+    _ejs_property_desc_set_writable (&rv->array_length_desc, EJS_TRUE);
+    _ejs_property_desc_set_value (&rv->array_length_desc, NUMBER_TO_EJSVAL(numElements));
+
+    return OBJECT_TO_EJSVAL(rv);
+}
+
 ejsval
 _ejs_array_new_copy (int numElements, ejsval *elements)
 {
@@ -236,17 +294,405 @@ _ejs_array_new_copy (int numElements, ejsval *elements)
     return arr;
 }
 
+// shift doesn't move the remaining elements down, it just bumps dense.elements forward and
+// leaves the slot it vacated as slack at the front of the allocation (which unshift can then
+// reuse.)  the slack is reclaimed by moving the elements back to the start of the allocation
+// once it outgrows the elements, or when we'd otherwise have to grow the allocation.
+#define DENSE_STORAGE(arr) ((arr)->dense.elements - (arr)->dense.array_offset)
+
+// give a copy-on-write array its own copy of its elements.  everything that writes to
+// dense.elements (or moves it around within the allocation) has to call this first.
+static void
+dense_unshare (EJSArray *arr)
+{
+    if (!arr->dense.cow)
+        return;
+
+    int64_t alloc = arr->array_length + 5;
+    ejsval* elements = (ejsval*)malloc(alloc * sizeof(ejsval));
+    memmove (elements, arr->dense.elements, arr->array_length * sizeof(ejsval));
+
+    arr->dense.elements = elements;
+    arr->dense.array_alloc = alloc;
+    arr->dense.array_offset = 0;
+    arr->dense.cow = EJS_FALSE;
+}
+
+static void
+dense_compact (EJSArray *arr)
+{
+    dense_unshare (arr);
+
+    if (arr->dense.array_offset == 0)
+        return;
+
+    ejsval* storage = DENSE_STORAGE(arr);
+    memmove (storage, arr->dense.elements, arr->array_length * sizeof(ejsval));
+    arr->dense.elements = storage;
+    arr->dense.array_alloc += arr->dense.array_offset;
+    arr->dense.array_offset = 0;
+}
+
 static void
-maybe_realloc_dense (EJSArray *arr, int high_index)
+maybe_realloc_dense (EJSArray *arr, int64_t high_index)
 {
     if (high_index >= arr->dense.array_alloc) {
-        int new_alloc = high_index + 32;
+        if (!arr->dense.cow && high_index < arr->dense.array_alloc + arr->dense.array_offset) {
+            // there's enough slack at the front, use that instead
+            dense_compact (arr);
+            return;
+        }
+
+        int64_t new_alloc = high_index + 32;
         ejsval* new_elements = (ejsval*)malloc(new_alloc * sizeof(ejsval));
         memmove (new_elements, arr->dense.elements, arr->array_length * sizeof(ejsval));
-        free (arr->dense.elements);
+        if (!arr->dense.cow)
+            free (DENSE_STORAGE(arr));
         arr->dense.elements = new_elements;
         arr->dense.array_alloc = new_alloc;
+        arr->dense.array_offset = 0;
+        arr->dense.cow = EJS_FALSE;
+    }
+}
+
+// sparse arrays keep their elements in a vector of arraylets sorted by start_idx.  lookups
+// binary search the vector, stores that land within SPARSE_ARRAYLET_MERGE_GAP of an existing
+// arraylet extend it (filling the gap with holes) instead of creating a new one, and once the
+// arraylets cover SPARSE_DENSITY_THRESHOLD percent of the array's length we switch back to a
+// dense array.
+#define SPARSE_ARRAYLETS_INITIAL_ALLOC 8
+#define SPARSE_ARRAYLET_INITIAL_ALLOC 8
+#define SPARSE_ARRAYLET_MERGE_GAP 16
+#define SPARSE_DENSITY_THRESHOLD 50
+
+static void
+sparse_init (EJSArray *arr)
+{
+    arr->obj.ops = &_ejs_sparsearray_specops;
+
+    arr->sparse.arraylet_alloc = SPARSE_ARRAYLETS_INITIAL_ALLOC;
+    arr->sparse.arraylet_num = 0;
+    arr->sparse.arraylets = (Arraylet*)calloc(arr->sparse.arraylet_alloc, sizeof(Arraylet));
+    arr->sparse.element_num = 0;
+}
+
+// returns the index of the last arraylet with start_idx <= idx, or -1 if there isn't one
+static int64_t
+sparse_find_arraylet (EJSArray *arr, int64_t idx)
+{
+    int64_t low = 0;
+    int64_t high = arr->sparse.arraylet_num - 1;
+    int64_t rv = -1;
+
+    while (low <= high) {
+        int64_t mid = low + (high - low) / 2;
+        if (arr->sparse.arraylets[mid].start_idx <= idx) {
+            rv = mid;
+            low = mid + 1;
+        }
+        else {
+            high = mid - 1;
+        }
+    }
+    return rv;
+}
+
+static ejsval*
+sparse_lookup (EJSArray *arr, int64_t idx)
+{
+    int64_t i = sparse_find_arraylet (arr, idx);
+    if (i == -1)
+        return NULL;
+
+    Arraylet *al = &arr->sparse.arraylets[i];
+    if (idx >= al->start_idx + al->length)
+        return NULL;
+
+    return &al->elements[idx - al->start_idx];
+}
+
+static void
+sparse_arraylet_reserve (Arraylet *al, int64_t length)
+{
+    if (length <= al->alloc)
+        return;
+
+    int64_t new_alloc = MAX(al->alloc * 2, length);
+    al->elements = (ejsval*)realloc(al->elements, new_alloc * sizeof(ejsval));
+    al->alloc = new_alloc;
+}
+
+static Arraylet*
+sparse_insert_arraylet (EJSArray *arr, int64_t pos, int64_t start_idx)
+{
+    if (arr->sparse.arraylet_num == arr->sparse.arraylet_alloc) {
+        arr->sparse.arraylet_alloc *= 2;
+        arr->sparse.arraylets = (Arraylet*)realloc(arr->sparse.arraylets, arr->sparse.arraylet_alloc * sizeof(Arraylet));
+    }
+
+    memmove (&arr->sparse.arraylets[pos + 1], &arr->sparse.arraylets[pos], (arr->sparse.arraylet_num - pos) * sizeof(Arraylet));
+    arr->sparse.arraylet_num ++;
+
+    Arraylet *al = &arr->sparse.arraylets[pos];
+    al->start_idx = start_idx;
+    al->length = 0;
+    al->alloc = SPARSE_ARRAYLET_INITIAL_ALLOC;
+    al->elements = (ejsval*)malloc(al->alloc * sizeof(ejsval));
+    return al;
+}
+
+static void
+sparse_remove_arraylet (EJSArray *arr, int64_t pos)
+{
+    free (arr->sparse.arraylets[pos].elements);
+    memmove (&arr->sparse.arraylets[pos], &arr->sparse.arraylets[pos + 1], (arr->sparse.arraylet_num - pos - 1) * sizeof(Arraylet));
+    arr->sparse.arraylet_num --;
+}
+
+// coalesce arraylet @pos with the ones following it while they're close enough
+static void
+sparse_merge_following (EJSArray *arr, int64_t pos)
+{
+    Arraylet *al = &arr->sparse.arraylets[pos];
+
+    while (pos + 1 < arr->sparse.arraylet_num) {
+        Arraylet *next = &arr->sparse.arraylets[pos + 1];
+        int64_t end = al->start_idx + al->length;
+        int64_t gap = next->start_idx - end;
+
+        if (gap > SPARSE_ARRAYLET_MERGE_GAP)
+            break;
+
+        sparse_arraylet_reserve (al, al->length + gap + next->length);
+        for (int64_t i = 0; i < gap; i ++)
+            al->elements[al->length + i] = MAGIC_TO_EJSVAL_IMPL(EJS_ARRAY_HOLE);
+        memmove (&al->elements[al->length + gap], next->elements, next->length * sizeof(ejsval));
+        al->length += gap + next->length;
+        arr->sparse.element_num += gap;
+
+        sparse_remove_arraylet (arr, pos + 1);
+        al = &arr->sparse.arraylets[pos];
+    }
+}
+
+static void
+sparse_to_dense (EJSArray *arr)
+{
+    int64_t arraylet_num = arr->sparse.arraylet_num;
+    Arraylet *arraylets = arr->sparse.arraylets;
+
+    int64_t alloc = arr->array_length + 5;
+    ejsval* elements = (ejsval*)malloc(alloc * sizeof(ejsval));
+    for (int64_t i = 0; i < arr->array_length; i ++)
+        elements[i] = MAGIC_TO_EJSVAL_IMPL(EJS_ARRAY_HOLE);
+
+    for (int64_t i = 0; i < arraylet_num; i ++) {
+        Arraylet *al = &arraylets[i];
+        int64_t length = MIN(al->length, arr->array_length - al->start_idx);
+        if (length > 0)
+            memmove (&elements[al->start_idx], al->elements, length * sizeof(ejsval));
+        free (al->elements);
+    }
+    free (arraylets);
+
+    arr->obj.ops = &_ejs_Array_specops;
+    arr->dense.array_alloc = alloc;
+    arr->dense.array_offset = 0;
+    arr->dense.cow = EJS_FALSE;
+    arr->dense.element_descs = NULL;
+    arr->dense.elements = elements;
+}
+
+static void
+sparse_maybe_make_dense (EJSArray *arr)
+{
+    if (arr->array_length > 0 &&
+        arr->sparse.element_num * 100 >= arr->array_length * SPARSE_DENSITY_THRESHOLD)
+        sparse_to_dense (arr);
+}
+
+// used when a store to a dense array would leave more than SPARSE_ARRAY_CUTOFF holes.  the
+// existing elements are split into arraylets at runs of holes longer than
+// SPARSE_ARRAYLET_MERGE_GAP, and like everywhere else no arraylet starts or ends with a hole.
+static void
+dense_to_sparse (EJSArray *arr)
+{
+    int64_t length = arr->array_length;
+    ejsval* elements = arr->dense.elements;
+    ejsval* storage = arr->dense.cow ? NULL : DENSE_STORAGE(arr);
+
+    sparse_init (arr);
+
+    int64_t i = 0;
+    while (i < length) {
+        if (EJSVAL_IS_ARRAY_HOLE_MAGIC(elements[i])) {
+            i ++;
+            continue;
+        }
+
+        // extend the run past short gaps, stopping at the last present element
+        int64_t start = i;
+        int64_t end = i + 1;
+        for (int64_t j = end; j < length && j - end <= SPARSE_ARRAYLET_MERGE_GAP; j ++) {
+            if (!EJSVAL_IS_ARRAY_HOLE_MAGIC(elements[j]))
+                end = j + 1;
+        }
+
+        Arraylet *al = sparse_insert_arraylet (arr, arr->sparse.arraylet_num, start);
+        sparse_arraylet_reserve (al, end - start);
+        memmove (al->elements, &elements[start], (end - start) * sizeof(ejsval));
+        al->length = end - start;
+        arr->sparse.element_num += al->length;
+
+        i = end;
+    }
+
+    free (storage);
+}
+
+static void
+sparse_set (EJSArray *arr, int64_t idx, ejsval val)
+{
+    int64_t pos = sparse_find_arraylet (arr, idx);
+
+    if (pos != -1) {
+        Arraylet *al = &arr->sparse.arraylets[pos];
+        int64_t end = al->start_idx + al->length;
+
+        if (idx < end) {
+            al->elements[idx - al->start_idx] = val;
+            return;
+        }
+
+        if (idx - end <= SPARSE_ARRAYLET_MERGE_GAP) {
+            // extend this arraylet, filling in holes up to idx
+            int64_t new_length = idx - al->start_idx + 1;
+            sparse_arraylet_reserve (al, new_length);
+            for (int64_t i = al->length; i < new_length - 1; i ++)
+                al->elements[i] = MAGIC_TO_EJSVAL_IMPL(EJS_ARRAY_HOLE);
+            al->elements[new_length - 1] = val;
+            arr->sparse.element_num += new_length - al->length;
+            al->length = new_length;
+
+            sparse_merge_following (arr, pos);
+            goto done;
+        }
+    }
+
+    if (pos + 1 < arr->sparse.arraylet_num && arr->sparse.arraylets[pos + 1].start_idx - idx <= SPARSE_ARRAYLET_MERGE_GAP) {
+        // grow the following arraylet down to idx
+        Arraylet *al = &arr->sparse.arraylets[pos + 1];
+        int64_t grow = al->start_idx - idx;
+        sparse_arraylet_reserve (al, al->length + grow);
+        memmove (&al->elements[grow], al->elements, al->length * sizeof(ejsval));
+        al->elements[0] = val;
+        for (int64_t i = 1; i < grow; i ++)
+            al->elements[i] = MAGIC_TO_EJSVAL_IMPL(EJS_ARRAY_HOLE);
+        al->start_idx = idx;
+        al->length += grow;
+        arr->sparse.element_num += grow;
+    }
+    else {
+        Arraylet *al = sparse_insert_arraylet (arr, pos + 1, idx);
+        al->elements[0] = val;
+        al->length = 1;
+        arr->sparse.element_num ++;
+    }
+
+ done:
+    arr->array_length = MAX(arr->array_length, idx + 1);
+    sparse_maybe_make_dense (arr);
+}
+
+static void
+sparse_delete (EJSArray *arr, int64_t idx)
+{
+    int64_t pos = sparse_find_arraylet (arr, idx);
+    if (pos == -1)
+        return;
+
+    Arraylet *al = &arr->sparse.arraylets[pos];
+    if (idx >= al->start_idx + al->length)
+        return;
+
+    al->elements[idx - al->start_idx] = MAGIC_TO_EJSVAL_IMPL(EJS_ARRAY_HOLE);
+
+    // trim holes from either end so that arraylets only ever start and end with present elements
+    int64_t leading = 0;
+    while (leading < al->length && EJSVAL_IS_ARRAY_HOLE_MAGIC(al->elements[leading]))
+        leading ++;
+
+    if (leading == al->length) {
+        arr->sparse.element_num -= al->length;
+        sparse_remove_arraylet (arr, pos);
+        return;
     }
+
+    int64_t trailing = 0;
+    while (EJSVAL_IS_ARRAY_HOLE_MAGIC(al->elements[al->length - 1 - trailing]))
+        trailing ++;
+
+    if (leading > 0)
+        memmove (al->elements, &al->elements[leading], (al->length - leading) * sizeof(ejsval));
+    al->start_idx += leading;
+    al->length -= leading + trailing;
+    arr->sparse.element_num -= leading + trailing;
+}
+
+static void
+sparse_set_length (EJSArray *arr, int64_t newLen)
+{
+    while (arr->sparse.arraylet_num > 0) {
+        int64_t last = arr->sparse.arraylet_num - 1;
+        Arraylet *al = &arr->sparse.arraylets[last];
+
+        if (al->start_idx >= newLen) {
+            arr->sparse.element_num -= al->length;
+            sparse_remove_arraylet (arr, last);
+            continue;
+        }
+
+        if (al->start_idx + al->length > newLen) {
+            arr->sparse.element_num -= al->start_idx + al->length - newLen;
+            al->length = newLen - al->start_idx;
+        }
+        break;
+    }
+
+    arr->array_length = newLen;
+    sparse_maybe_make_dense (arr);
+}
+
+EJSBool
+_ejs_array_next_present (ejsval array, int64_t from, int64_t* idx, ejsval* value)
+{
+    EJSArray *arr = (EJSArray*)EJSVAL_TO_OBJECT(array);
+
+    if (!EJSARRAY_IS_SPARSE(arr)) {
+        for (int64_t i = MAX(from, 0); i < arr->array_length; i ++) {
+            if (!EJSVAL_IS_ARRAY_HOLE_MAGIC(arr->dense.elements[i])) {
+                *idx = i;
+                *value = arr->dense.elements[i];
+                return EJS_TRUE;
+            }
+        }
+        return EJS_FALSE;
+    }
+
+    int64_t pos = MAX(sparse_find_arraylet (arr, from), 0);
+    for (; pos < arr->sparse.arraylet_num; pos ++) {
+        Arraylet *al = &arr->sparse.arraylets[pos];
+        for (int64_t i = MAX(from - al->start_idx, 0); i < al->length; i ++) {
+            if (al->start_idx + i >= arr->array_length)
+                return EJS_FALSE;
+            if (!EJSVAL_IS_ARRAY_HOLE_MAGIC(al->elements[i])) {
+                *idx = al->start_idx + i;
+                *value = al->elements[i];
+                return EJS_TRUE;
+            }
+        }
+    }
+    return EJS_FALSE;
 }
 
 ejsval
@@ -283,6 +729,7 @@ uint32_t
 _ejs_array_push_dense(ejsval array, int argc, ejsval *args)
 {
     EJSArray *arr = (EJSArray*)EJSVAL_TO_OBJECT(array);
+    dense_unshare (arr);
     maybe_realloc_dense (arr, arr->array_length + argc);
     memmove (&EJSDENSEARRAY_ELEMENTS(arr)[EJSARRAY_LEN(arr)], args, argc * sizeof(ejsval));
     EJSARRAY_LEN(arr) += argc;
@@ -298,6 +745,32 @@ _ejs_array_pop_dense(ejsval array)
     return EJSDENSEARRAY_ELEMENTS(arr)[--EJSARRAY_LEN(arr)];
 }
 
+// generated code calls this for property loads the type profile says
+// always see a dense array, when the inline element load can't handle
+// the key.  the compiler has already checked @array's specops, so we
+// only need to handle in-bounds indices and length here.  holes go to
+// the generic path, since the prototype chain might have the element.
+ejsval
+_ejs_array_getprop_dense (ejsval array, ejsval key)
+{
+    EJSArray *arr = (EJSArray*)EJSVAL_TO_OBJECT(array);
+    if (EJSVAL_IS_NUMBER(key)) {
+        double d = EJSVAL_TO_NUMBER(key);
+        if (d >= 0 && d < EJSARRAY_LEN(arr)) {
+            int64_t idx = (int64_t)d;
+            if ((double)idx == d) {
+                ejsval rv = EJSDENSEARRAY_ELEMENTS(arr)[idx];
+                if (!EJSVAL_IS_ARRAY_HOLE_MAGIC(rv))
+                    return rv;
+            }
+        }
+    }
+    else if (EJSVAL_EQ(key, _ejs_atom_length)) {
+        return NUMBER_TO_EJSVAL(EJSARRAY_LEN(arr));
+    }
+    return _ejs_object_getprop (array, key);
+}
+
 static int32_t
 partition (ejsval array, ejsval comparefn, int32_t low, int32_t high)
 {
@@ -364,14 +837,12 @@ static EJS_NATIVE_FUNC(_ejs_Array_impl) {
         if (argc == 1 && EJSVAL_IS_NUMBER(args[0])) {
             int alloc = ToUint32(args[0]);
             if (alloc > SPARSE_ARRAY_CUTOFF) {
-                arr->obj.ops = &_ejs_sparsearray_specops;
-
-                arr->sparse.arraylet_alloc = 5;
-                arr->sparse.arraylet_num = 0;
-                arr->sparse.arraylets = (Arraylet*)calloc(arr->sparse.arraylet_alloc, sizeof(Arraylet));
+                sparse_init (arr);
             }
             else {
                 arr->dense.array_alloc = alloc;
+                arr->dense.array_offset = 0;
+                arr->dense.cow = EJS_FALSE;
                 arr->dense.elements = (ejsval*)calloc(arr->dense.array_alloc, sizeof (ejsval));
             }
             arr->array_length = alloc;
@@ -379,6 +850,8 @@ static EJS_NATIVE_FUNC(_ejs_Array_impl) {
         else {
             arr->array_length = argc;
             arr->dense.array_alloc = argc + 5;
+            arr->dense.array_offset = 0;
+            arr->dense.cow = EJS_FALSE;
             arr->dense.elements = (ejsval*)malloc(arr->dense.array_alloc * sizeof (ejsval));
 
             memmove (arr->dense.elements, args, argc * sizeof(ejsval));
@@ -622,6 +1095,18 @@ static EJS_NATIVE_FUNC(_ejs_Array_prototype_every) {
     // 7. Let k be 0.
     int64_t k = 0;
 
+    if (dense_fast_path_ok(O)) {
+        for (; k < len && dense_fast_path_ok(O); k ++) {
+            ejsval kValue;
+            if (!dense_get(O, k, &kValue))
+                continue;
+            ejsval callbackargs[3] = { kValue, NUMBER_TO_EJSVAL(k), O };
+            ejsval testResult = _ejs_invoke_closure (callbackfn, &T, 3, callbackargs, _ejs_undefined);
+            if (EJSVAL_IS_BOOLEAN(testResult) && !EJSVAL_TO_BOOLEAN(testResult))
+                return _ejs_false;
+        }
+    }
+
     // 8. Repeat, while k < len
     while (k < len) {
         // a. Let Pk be ToString(k).
@@ -743,6 +1228,20 @@ static EJS_NATIVE_FUNC(_ejs_Array_prototype_filter) {
     // 10. Let to be 0.
     int64_t to = 0;
 
+    if (dense_fast_path_ok(O) && EJSVAL_IS_DENSE_ARRAY(A)) {
+        for (; k < len && dense_fast_path_ok(O); k ++) {
+            ejsval kValue;
+            if (!dense_get(O, k, &kValue))
+                continue;
+            ejsval argumentsList[3] = { kValue, NUMBER_TO_EJSVAL(k), O };
+            ejsval selected = _ejs_invoke_closure (callbackfn, &T, 3, argumentsList, _ejs_undefined);
+            if (EJSVAL_TO_BOOLEAN(ToBoolean(selected))) {
+                _ejs_array_push_dense (A, 1, &kValue);
+                to++;
+            }
+        }
+    }
+
     // 11. Repeat, while k < len
     while (k < len) {
         // a. Let Pk be ToString(k).
@@ -926,46 +1425,57 @@ static EJS_NATIVE_FUNC(_ejs_Array_prototype_forEach) {
     // 6. If thisArg was supplied, let T be thisArg; else let T be undefined.
     ejsval T = thisArg;
 
+    // 7. Let k be 0.
+    int64_t k = 0;
+
     ejsval foreach_args[3];
-    if (EJSVAL_IS_DENSE_ARRAY(O)) {
-        int i;
+    if (dense_fast_path_ok(O)) {
         foreach_args[2] = O;
-        for (i = 0; i < EJS_ARRAY_LEN(*_this); i ++) {
-            if (EJSVAL_IS_ARRAY_HOLE_MAGIC(EJS_DENSE_ARRAY_ELEMENTS(*_this)[i]))
+        for (; k < len && dense_fast_path_ok(O); k ++) {
+            ejsval kValue;
+            if (!dense_get(O, k, &kValue))
                 continue;
-            foreach_args[0] = EJS_DENSE_ARRAY_ELEMENTS(*_this)[i];
-            foreach_args[1] = NUMBER_TO_EJSVAL(i);
+            foreach_args[0] = kValue;
+            foreach_args[1] = NUMBER_TO_EJSVAL(k);
             _ejs_invoke_closure (callbackfn, &T, 3, foreach_args, _ejs_undefined);
         }
     }
-    else {
-        // 7. Let k be 0.
-        int64_t k = 0;
+    else if (EJSVAL_IS_SPARSE_ARRAY(O)) {
+        // only visit the elements that are actually present
+        ejsval kValue;
+        foreach_args[2] = O;
+        k = -1;
+        while (_ejs_array_next_present (O, k + 1, &k, &kValue) && k < len) {
+            foreach_args[0] = kValue;
+            foreach_args[1] = NUMBER_TO_EJSVAL(k);
+            _ejs_invoke_closure (callbackfn, &T, 3, foreach_args, _ejs_undefined);
+        }
+        k = len;
+    }
 
-        // 8. Repeat, while k < len
-        while (k < len) {
-            // a. Let Pk be ToString(k).
-            ejsval Pk = ToString (NUMBER_TO_EJSVAL(k));
+    // 8. Repeat, while k < len
+    while (k < len) {
+        // a. Let Pk be ToString(k).
+        ejsval Pk = ToString (NUMBER_TO_EJSVAL(k));
 
-            // b. Let kPresent be HasProperty(O, Pk).
-            // c. ReturnIfAbrupt(kPresent).
-            EJSBool kPresent = OP(EJSVAL_TO_OBJECT(O), HasProperty)(O, Pk);
+        // b. Let kPresent be HasProperty(O, Pk).
+        // c. ReturnIfAbrupt(kPresent).
+        EJSBool kPresent = OP(EJSVAL_TO_OBJECT(O), HasProperty)(O, Pk);
 
-            // d. If kPresent is true, then
-            if (kPresent) {
-                // i. Let kValue be Get(O, Pk).
-                // ii. ReturnIfAbrupt(kValue).
-                ejsval kValue = Get(O, Pk);
-                // iii. Let funcResult be Call(callbackfn, T, «kValue, k, O»).
-                // iv. ReturnIfAbrupt(funcResult).
-                foreach_args[0] = kValue;
-                foreach_args[1] = NUMBER_TO_EJSVAL(k);
-                foreach_args[2] = O;
-                _ejs_invoke_closure (callbackfn, &T, 3, foreach_args, _ejs_undefined);
-            }
-            // e. Increase k by 1.
-            k++;
+        // d. If kPresent is true, then
+        if (kPresent) {
+            // i. Let kValue be Get(O, Pk).
+            // ii. ReturnIfAbrupt(kValue).
+            ejsval kValue = Get(O, Pk);
+            // iii. Let funcResult be Call(callbackfn, T, «kValue, k, O»).
+            // iv. ReturnIfAbrupt(funcResult).
+            foreach_args[0] = kValue;
+            foreach_args[1] = NUMBER_TO_EJSVAL(k);
+            foreach_args[2] = O;
+            _ejs_invoke_closure (callbackfn, &T, 3, foreach_args, _ejs_undefined);
         }
+        // e. Increase k by 1.
+        k++;
     }
     // 9. Return undefined.
     return _ejs_undefined;
@@ -1012,6 +1522,15 @@ static EJS_NATIVE_FUNC(_ejs_Array_prototype_indexOf) {
     // b. If k<0, let k be 0.
     if (k < 0) k = 0;
 
+    if (dense_fast_path_ok(O)) {
+        for (; k < len; k ++) {
+            ejsval elementK;
+            if (dense_get(O, k, &elementK) && EJSVAL_TO_BOOLEAN(_ejs_op_strict_eq (searchElement, elementK)))
+                return NUMBER_TO_EJSVAL(k);
+        }
+        return NUMBER_TO_EJSVAL(-1);
+    }
+
     // 11. Repeat, while k<len
     while (k < len) {
         // a. Let kPresent be HasProperty(O, ToString(k)).
@@ -1035,6 +1554,24 @@ static EJS_NATIVE_FUNC(_ejs_Array_prototype_indexOf) {
     return NUMBER_TO_EJSVAL(-1);
 }
 
+// concatenates @count copies of @str, doubling as we go
+static ejsval
+repeat_string (ejsval str, int64_t count)
+{
+    ejsval rv = _ejs_atom_empty;
+    if (EJSVAL_TO_STRLEN(str) == 0)
+        return rv;
+
+    while (count > 0) {
+        if (count & 1)
+            rv = _ejs_string_concat(rv, str);
+        count >>= 1;
+        if (count > 0)
+            str = _ejs_string_concat(str, str);
+    }
+    return rv;
+}
+
 // ES6 Draft January 15, 2015
 // 22.1.3.12
 // Array.prototype.join(separator)
@@ -1063,6 +1600,22 @@ static EJS_NATIVE_FUNC(_ejs_Array_prototype_join) {
     if (len == 0)
         return _ejs_atom_empty;
 
+    if (EJSVAL_IS_SPARSE_ARRAY(O)) {
+        // holes contribute nothing but separators, so we only need to visit the elements
+        // that are present and emit the separators between them in bulk.
+        ejsval R = _ejs_atom_empty;
+        int64_t prev = 0;
+        int64_t k = -1;
+        ejsval element;
+        while (_ejs_array_next_present (O, k + 1, &k, &element) && k < len) {
+            R = _ejs_string_concat(R, repeat_string(sep, k - prev));
+            if (!EJSVAL_IS_UNDEFINED(element) && !EJSVAL_IS_NULL(element))
+                R = _ejs_string_concat(R, ToString(element));
+            prev = k;
+        }
+        return _ejs_string_concat(R, repeat_string(sep, len - 1 - prev));
+    }
+
     // 9. Let element0 be the result of Get(O, "0").
     ejsval element0 = Get(O, _ejs_atom_0);
 
@@ -1073,6 +1626,16 @@ static EJS_NATIVE_FUNC(_ejs_Array_prototype_join) {
     // 12. Let k be 1.
     int64_t k = 1;
 
+    if (dense_fast_path_ok(O)) {
+        // ToString on an element can call out, so re-check as we go
+        for (; k < len && dense_fast_path_ok(O); k ++) {
+            ejsval element;
+            R = _ejs_string_concat(R, sep);
+            if (dense_get(O, k, &element) && !EJSVAL_IS_UNDEFINED(element) && !EJSVAL_IS_NULL(element))
+                R = _ejs_string_concat(R, ToString(element));
+        }
+    }
+
     // 13. Repeat, while k < len
     while (k < len) {
         // a. Let S be the String value produced by concatenating R and sep.
@@ -1194,9 +1757,43 @@ static EJS_NATIVE_FUNC(_ejs_Array_prototype_map) {
     // 8. ReturnIfAbrupt(A).
     ejsval A = ArraySpeciesCreate(O, len);
 
+    if (EJSVAL_IS_SPARSE_ARRAY(O)) {
+        // only visit the elements that are actually present
+        int64_t k = -1;
+        ejsval kValue;
+        while (_ejs_array_next_present (O, k + 1, &k, &kValue) && k < len) {
+            ejsval map_args[3];
+            map_args[0] = kValue;
+            map_args[1] = NUMBER_TO_EJSVAL(k);
+            map_args[2] = O;
+            ejsval mappedValue = _ejs_invoke_closure (callbackfn, &T, 2, map_args, _ejs_undefined);
+            _ejs_object_setprop(A, NUMBER_TO_EJSVAL(k), mappedValue);
+        }
+        return A;
+    }
+
     // 9. Let k be 0.
     int64_t k = 0;
 
+    if (dense_fast_path_ok(O)) {
+        ejsval map_args[3];
+        map_args[2] = O;
+        for (; k < len && dense_fast_path_ok(O); k ++) {
+            ejsval kValue;
+            if (!dense_get(O, k, &kValue))
+                continue;
+            map_args[0] = kValue;
+            map_args[1] = NUMBER_TO_EJSVAL(k);
+            ejsval mappedValue = _ejs_invoke_closure (callbackfn, &T, 2, map_args, _ejs_undefined);
+            if (EJSVAL_IS_DENSE_ARRAY(A) && k < EJS_ARRAY_LEN(A)) {
+                dense_unshare ((EJSArray*)EJSVAL_TO_OBJECT(A));
+                EJS_DENSE_ARRAY_ELEMENTS(A)[k] = mappedValue;
+            }
+            else
+                _ejs_object_setprop(A, NUMBER_TO_EJSVAL(k), mappedValue);
+        }
+    }
+
     // 10. Repeat, while k < len
     while (k < len) {
         // a. Let Pk be ToString(k).
@@ -1361,6 +1958,13 @@ static EJS_NATIVE_FUNC(_ejs_Array_prototype_reduce) {
         // a. Set accumulator to initialValue.
         accumulator = initialValue;
     }
+    else if (dense_fast_path_ok(O)) {
+        while (k < len && !dense_get(O, k, &accumulator))
+            k++;
+        if (k == len)
+            _ejs_throw_nativeerror_utf8 (EJS_TYPE_ERROR, "Reduce of empty array with no initial value");
+        k++;
+    }
     // 9. Else initialValue is not present,
     else {
         // a. Let kPresent be false.
@@ -1385,6 +1989,21 @@ static EJS_NATIVE_FUNC(_ejs_Array_prototype_reduce) {
         if (!kPresent)
             _ejs_throw_nativeerror_utf8 (EJS_TYPE_ERROR, "Reduce of empty array with no initial value");
     }
+    if (dense_fast_path_ok(O)) {
+        ejsval undef_this = _ejs_undefined;
+        ejsval reduce_args[4];
+        reduce_args[3] = O;
+        for (; k < len && dense_fast_path_ok(O); k ++) {
+            ejsval kValue;
+            if (!dense_get(O, k, &kValue))
+                continue;
+            reduce_args[0] = accumulator;
+            reduce_args[1] = kValue;
+            reduce_args[2] = NUMBER_TO_EJSVAL(k);
+            accumulator = _ejs_invoke_closure (callbackfn, &undef_this, 4, reduce_args, _ejs_undefined);
+        }
+    }
+
     // 10. Repeat, while k < len
     while (k < len) {
         // a. Let Pk be ToString(k).
@@ -1522,6 +2141,14 @@ static EJS_NATIVE_FUNC(_ejs_Array_prototype_reverse) {
     // 5. Let middle be floor(len/2).
     int64_t middle = len / 2;
 
+    if (dense_fast_path_ok(O) && len == EJS_ARRAY_LEN(O)) {
+        // holes are swapped along with everything else, which matches the delete/set steps below
+        dense_unshare ((EJSArray*)EJSVAL_TO_OBJECT(O));
+        for (int64_t lower = 0; lower < middle; lower ++)
+            swap_dense (O, lower, len - lower - 1);
+        return O;
+    }
+
     // 6. Let lower be 0.
     int64_t lower = 0;
 
@@ -1602,14 +2229,21 @@ static EJS_NATIVE_FUNC(_ejs_Array_prototype_reverse) {
 // Array.prototype.shift ()
 static EJS_NATIVE_FUNC(_ejs_Array_prototype_shift) {
     // EJS fast path for dense arrays
-    if (EJSVAL_IS_DENSE_ARRAY(*_this)) {
+    if (dense_fast_path_ok(*_this)) {
         int len = EJS_ARRAY_LEN(*_this);
         if (len == 0) {
             return _ejs_undefined;
         }
-        ejsval first = EJS_DENSE_ARRAY_ELEMENTS(*_this)[0];
-        memmove (EJS_DENSE_ARRAY_ELEMENTS(*_this), EJS_DENSE_ARRAY_ELEMENTS(*_this) + 1, sizeof(ejsval) * (len-1));
-        EJS_ARRAY_LEN(*_this) --;
+        EJSArray *arr = (EJSArray*)EJSVAL_TO_OBJECT(*_this);
+        ejsval first = arr->dense.elements[0];
+        if (EJSVAL_IS_ARRAY_HOLE_MAGIC(first))
+            first = _ejs_undefined;
+        arr->dense.elements ++;
+        arr->dense.array_offset ++;
+        arr->dense.array_alloc --;
+        arr->array_length --;
+        if (arr->dense.array_offset > arr->array_length)
+            dense_compact (arr);
         return first;
     }
 
@@ -1785,6 +2419,18 @@ static EJS_NATIVE_FUNC(_ejs_Array_prototype_some) {
     // 7. Let k be 0.
     int64_t k = 0;
 
+    if (dense_fast_path_ok(O)) {
+        for (; k < len && dense_fast_path_ok(O); k ++) {
+            ejsval kValue;
+            if (!dense_get(O, k, &kValue))
+                continue;
+            ejsval callbackargs[3] = { kValue, NUMBER_TO_EJSVAL(k), O };
+            ejsval testResult = _ejs_invoke_closure (callbackfn, &T, 3, callbackargs, _ejs_undefined);
+            if (EJSVAL_TO_BOOLEAN(ToBoolean(testResult)))
+                return _ejs_true;
+        }
+    }
+
     // 8. Repeat, while k < len
     while (k < len) {
         // a. Let Pk be ToString(k).
@@ -1884,6 +2530,25 @@ static EJS_NATIVE_FUNC(_ejs_Array_prototype_splice) {
     // 13. ReturnIfAbrupt(A).
     ejsval A = ArraySpeciesCreate(O, actualDeleteCount);
 
+    if (dense_fast_path_ok(O) && len == EJS_ARRAY_LEN(O) && EJSVAL_IS_DENSE_ARRAY(A) && EJS_ARRAY_LEN(A) == actualDeleteCount) {
+        EJSArray* arr = (EJSArray*)EJSVAL_TO_OBJECT(O);
+        int64_t itemCount = argc > 2 ? argc - 2 : 0;
+        int64_t newLen = len - actualDeleteCount + itemCount;
+
+        dense_unshare (arr);
+        dense_unshare ((EJSArray*)EJSVAL_TO_OBJECT(A));
+
+        memmove (EJS_DENSE_ARRAY_ELEMENTS(A), &EJSDENSEARRAY_ELEMENTS(arr)[actualStart], sizeof(ejsval) * actualDeleteCount);
+        maybe_realloc_dense (arr, newLen);
+        memmove (&EJSDENSEARRAY_ELEMENTS(arr)[actualStart + itemCount],
+                 &EJSDENSEARRAY_ELEMENTS(arr)[actualStart + actualDeleteCount],
+                 sizeof(ejsval) * (len - actualStart - actualDeleteCount));
+        if (itemCount > 0)
+            memmove (&EJSDENSEARRAY_ELEMENTS(arr)[actualStart], &args[2], sizeof(ejsval) * itemCount);
+        EJSARRAY_LEN(arr) = newLen;
+        return A;
+    }
+
     // 14. Let k be 0.
     int64_t k = 0;
     // 15. Repeat, while k < actualDeleteCount
@@ -2043,13 +2708,30 @@ static EJS_NATIVE_FUNC(_ejs_Array_prototype_toString) {
 // Array.prototype.unshift ( ...items )
 static EJS_NATIVE_FUNC(_ejs_Array_prototype_unshift) {
     // EJS fast path for arrays
-    if (EJSVAL_IS_DENSE_ARRAY(*_this)) {
+    if (dense_fast_path_ok(*_this)) {
         EJSArray *arr = (EJSArray*)EJSVAL_TO_OBJECT(*_this);
-        maybe_realloc_dense (arr, arr->array_length + argc);
-        int len = EJS_ARRAY_LEN(*_this);
-        memmove (EJS_DENSE_ARRAY_ELEMENTS(*_this) + argc, EJS_DENSE_ARRAY_ELEMENTS(*_this), sizeof(ejsval) * len);
-        memmove (EJS_DENSE_ARRAY_ELEMENTS(*_this), args, sizeof(ejsval) * argc);
-        EJS_ARRAY_LEN(*_this) += argc;
+        int64_t len = arr->array_length;
+        dense_unshare (arr);
+        if (arr->dense.array_offset >= argc) {
+            // reuse the slack at the front
+            arr->dense.elements -= argc;
+            arr->dense.array_offset -= argc;
+            arr->dense.array_alloc += argc;
+        }
+        else {
+            // reallocate, leaving as much slack at the front as there are elements so
+            // repeated unshifts don't each have to move everything.
+            int64_t slack = MAX(len, 16);
+            int64_t alloc = len + argc + 32;
+            ejsval* storage = (ejsval*)malloc((slack + alloc) * sizeof(ejsval));
+            memmove (storage + slack + argc, arr->dense.elements, sizeof(ejsval) * len);
+            free (DENSE_STORAGE(arr));
+            arr->dense.elements = storage + slack;
+            arr->dense.array_offset = slack;
+            arr->dense.array_alloc = alloc;
+        }
+        memmove (arr->dense.elements, args, sizeof(ejsval) * argc);
+        arr->array_length += argc;
         return NUMBER_TO_EJSVAL(len + argc);
     }
 
@@ -2481,10 +3163,36 @@ static EJS_NATIVE_FUNC(_ejs_Array_prototype_sort) {
         _ejs_throw_nativeerror_utf8 (EJS_TYPE_ERROR, "invalid comparefn argument");
 
     if (EJSVAL_IS_DENSE_ARRAY(obj)) {
+        dense_unshare ((EJSArray*)EJSVAL_TO_OBJECT(obj));
         _ejs_array_quicksort_dense (obj, comparefn, 0, len - 1);
         return obj;
     }
 
+    if (EJSVAL_IS_SPARSE_ARRAY(obj)) {
+        // gather the present elements into a scratch dense array and sort
+        // that.  SortCompare already orders undefineds last, so writing the
+        // result back from index 0 and deleting everything after it leaves
+        // the holes at the end.
+        ejsval sorted = _ejs_array_new (0, EJS_FALSE);
+        int64_t idx;
+        ejsval value;
+        for (int64_t from = 0; _ejs_array_next_present (obj, from, &idx, &value); from = idx + 1)
+            _ejs_array_push_dense (sorted, 1, &value);
+
+        int32_t num_present = EJS_ARRAY_LEN(sorted);
+        _ejs_array_quicksort_dense (sorted, comparefn, 0, num_present - 1);
+
+        for (int32_t i = 0; i < num_present; i ++)
+            Put(obj, NUMBER_TO_EJSVAL(i), EJS_DENSE_ARRAY_ELEMENTS(sorted)[i], EJS_TRUE);
+
+        // the stores above may have made @obj dense again, which
+        // _ejs_array_next_present handles fine.
+        for (int64_t from = num_present; _ejs_array_next_present (obj, from, &idx, &value); from = idx + 1)
+            DeletePropertyOrThrow(obj, NUMBER_TO_EJSVAL(idx));
+
+        return obj;
+    }
+
     /* SpiderMonkey/V8 won't sort if the object lacks the length property */
     if (!HasProperty(obj, _ejs_atom_length))
         return obj;
@@ -2529,28 +3237,22 @@ static EJS_NATIVE_FUNC(_ejs_ArrayIterator_impl) {
     return *_this;
 }
 
-static EJS_NATIVE_FUNC(_ejs_ArrayIterator_prototype_next) {
+// the body of %ArrayIteratorPrototype%.next, minus the iter result.
+// returns the EJS_NO_ITER_VALUE magic once the iterator is done.  O
+// must be an Array Iterator.
+ejsval
+_ejs_array_iterator_step (ejsval O)
+{
     ejsval result;
 
-    /* 1. Let O be the this value. */
-    /* 2. If Type(O) is not Object, throw a TypeError exception. */
-    ejsval O = *_this;
-    if (!EJSVAL_IS_OBJECT(O))
-        _ejs_throw_nativeerror_utf8(EJS_TYPE_ERROR, ".next called on non-object");
-
     EJSArrayIterator *OObj = (EJSArrayIterator*)EJSVAL_TO_OBJECT(O);
 
-    /* 3. If O does not have all of the internal slots of an Array Iterator Instance (22.1.5.3),
-     * throw a TypeError exception. */
-    if (!EJSVAL_IS_ARRAYITERATOR(O))
-        _ejs_throw_nativeerror_utf8(EJS_TYPE_ERROR, ".next called on non-ArrayIterator instance");
-
     /* 4. Let a be the value of the [[IteratedObject]] internal slot of O. */
     ejsval a = OObj->iterated;
 
     /* 5. If a is undefined, then return CreateIterResultObject(undefined, true). */
     if (EJSVAL_IS_UNDEFINED(a))
-        return _ejs_create_iter_result (_ejs_undefined, _ejs_true);
+        return MAGIC_TO_EJSVAL_IMPL(EJS_NO_ITER_VALUE);
 
     /* 6. Let index be the value of the [[ArrayIteratorNextIndex]] internal slot of O. */
     uint32_t index = OObj->next_index;
@@ -2558,11 +3260,21 @@ static EJS_NATIVE_FUNC(_ejs_ArrayIterator_prototype_next) {
     /* 7. Let itemKind be the value of the [[ArrayIterationKind]] internal slot of O. */
     EJSArrayIteratorKind itemKind = OObj->kind;
 
-    /* 8. Let lenValue be Get(a, "length"). */
-    ejsval lenValue = Get (a, _ejs_atom_length);
+    // for dense arrays and typed arrays the length is right there, and
+    // so are the elements (other than holes, which have to consult the
+    // prototype chain)
+    EJSBool dense = EJSVAL_IS_DENSE_ARRAY(a);
+    EJSBool typed = !dense && EJSVAL_IS_TYPEDARRAY(a) && EJSVAL_TO_TYPEDARRAY(a)->element_type != EJS_TYPEDARRAY_UINT8CLAMPED;
 
+    /* 8. Let lenValue be Get(a, "length"). */
     /* 9. Let len be ToLength(lenValue). */
-    int len = ToLength(lenValue);
+    int64_t len;
+    if (dense)
+        len = EJS_ARRAY_LEN(a);
+    else if (typed)
+        len = EJSVAL_TO_TYPEDARRAY(a)->length;
+    else
+        len = ToLength(Get (a, _ejs_atom_length));
 
     /* 11. If index ≥ len, then */
     if (index >= len) {
@@ -2570,7 +3282,7 @@ static EJS_NATIVE_FUNC(_ejs_ArrayIterator_prototype_next) {
         OObj->iterated = _ejs_undefined;
 
         /* b. Return CreateIterResultObject(undefined, true). */
-        return _ejs_create_iter_result (_ejs_undefined, _ejs_true);
+        return MAGIC_TO_EJSVAL_IMPL(EJS_NO_ITER_VALUE);
     }
 
     /* 12.  Set the value of the [[ArrayIteratorNextIndex]] internal slot of O to index+1. */
@@ -2583,8 +3295,13 @@ static EJS_NATIVE_FUNC(_ejs_ArrayIterator_prototype_next) {
     else {
         /* a. Let elementKey be ToString(index). */
         /* b. Let elementValue be Get(a, elementKey). */
-        ejsval elementKey = ToString(NUMBER_TO_EJSVAL((index)));
-        ejsval elementValue = Get (a, elementKey);
+        ejsval elementValue;
+        if (dense && !EJSVAL_IS_ARRAY_HOLE_MAGIC(EJS_DENSE_ARRAY_ELEMENTS(a)[index]))
+            elementValue = EJS_DENSE_ARRAY_ELEMENTS(a)[index];
+        else if (typed)
+            elementValue = _ejs_typedarray_get_at(EJSVAL_TO_OBJECT(a), index);
+        else
+            elementValue = Get (a, ToString(NUMBER_TO_EJSVAL(index)));
 
         /* 15. If itemKind is "value", then let result be elementValue. */
         if (itemKind == EJS_ARRAYITER_KIND_VALUE)
@@ -2604,6 +3321,25 @@ static EJS_NATIVE_FUNC(_ejs_ArrayIterator_prototype_next) {
         }
     }
 
+    return result;
+}
+
+EJS_NATIVE_FUNC(_ejs_ArrayIterator_prototype_next) {
+    /* 1. Let O be the this value. */
+    /* 2. If Type(O) is not Object, throw a TypeError exception. */
+    ejsval O = *_this;
+    if (!EJSVAL_IS_OBJECT(O))
+        _ejs_throw_nativeerror_utf8(EJS_TYPE_ERROR, ".next called on non-object");
+
+    /* 3. If O does not have all of the internal slots of an Array Iterator Instance (22.1.5.3),
+     * throw a TypeError exception. */
+    if (!EJSVAL_IS_ARRAYITERATOR(O))
+        _ejs_throw_nativeerror_utf8(EJS_TYPE_ERROR, ".next called on non-ArrayIterator instance");
+
+    ejsval result = _ejs_array_iterator_step(O);
+    if (EJSVAL_IS_NO_ITER_VALUE_MAGIC(result))
+        return _ejs_create_iter_result (_ejs_undefined, _ejs_true);
+
     /* 17. Return CreateIterResultObject(result, false). */
     return _ejs_create_iter_result (result, _ejs_false);
 }
@@ -2707,31 +3443,53 @@ _ejs_array_init(ejsval global)
 #undef PROTO_ITER_METHOD
 }
 
+// check if propertyName is an array index, or a string that we can convert to one
+static EJSBool
+array_index (ejsval propertyName, int64_t* idx)
+{
+    if (EJSVAL_IS_SYMBOL(propertyName))
+        return EJS_FALSE;
+
+    if (EJSVAL_IS_STRING(propertyName)) {
+        uint32_t index;
+        if (!_ejs_string_to_array_index (propertyName, &index))
+            return EJS_FALSE;
+        *idx = index;
+        return EJS_TRUE;
+    }
+
+    ejsval idx_val = ToNumber(propertyName);
+    if (!EJSVAL_IS_NUMBER(idx_val))
+        return EJS_FALSE;
+
+    double n = EJSVAL_TO_NUMBER(idx_val);
+    if (floor(n) != n || n < 0 || n >= 4294967295.0)
+        return EJS_FALSE;
+
+    *idx = (int64_t)n;
+    return EJS_TRUE;
+}
+
 static ejsval
 _ejs_array_specop_get (ejsval obj, ejsval propertyName, ejsval receiver)
 {
-    // check if propertyName is an integer, or a string that we can convert to an int
-    EJSBool is_index = EJS_FALSE;
-    ejsval idx_val;
-    int idx;
-    
-    if (!EJSVAL_IS_SYMBOL(propertyName)) {
-        idx_val = ToNumber(propertyName);
-        if (EJSVAL_IS_NUMBER(idx_val)) {
-            double n = EJSVAL_TO_NUMBER(idx_val);
-            if (floor(n) == n) {
-                idx = (int)n;
-                is_index = EJS_TRUE;
-            }
-        }
-    }
+    int64_t idx;
 
-    if (is_index) {
-        if (idx < 0 || idx >= EJS_ARRAY_LEN(obj)) {
+    if (array_index (propertyName, &idx)) {
+        if (idx >= EJS_ARRAY_LEN(obj)) {
             //printf ("getprop(%d) on an array, returning undefined\n", idx);
             return _ejs_undefined;
         }
-        ejsval rv = EJS_DENSE_ARRAY_ELEMENTS(obj)[idx];
+        ejsval rv;
+        if (EJSVAL_IS_DENSE_ARRAY(obj)) {
+            rv = EJS_DENSE_ARRAY_ELEMENTS(obj)[idx];
+        }
+        else {
+            ejsval* slot = sparse_lookup ((EJSArray*)EJSVAL_TO_OBJECT(obj), idx);
+            if (!slot)
+                return _ejs_undefined;
+            rv = *slot;
+        }
         if (EJSVAL_IS_ARRAY_HOLE_MAGIC(rv))
             return _ejs_undefined;
         return rv;
@@ -2749,29 +3507,30 @@ _ejs_array_specop_get (ejsval obj, ejsval propertyName, ejsval receiver)
 static EJSPropertyDesc*
 _ejs_array_specop_get_own_property (ejsval obj, ejsval propertyName, ejsval *exc)
 {
-    // check if propertyName is an integer, or a string that we can convert to an int
-    EJSBool is_index = EJS_FALSE;
-    ejsval idx_val;
-    int idx;
-
-    if (!EJSVAL_IS_SYMBOL(propertyName)) {
-        idx_val = ToNumber(propertyName);
-        if (EJSVAL_IS_NUMBER(idx_val)) {
-            double n = EJSVAL_TO_NUMBER(idx_val);
-            if (floor(n) == n) {
-                idx = (int)n;
-                is_index = EJS_TRUE;
+    int64_t idx;
+
+    if (array_index (propertyName, &idx)) {
+        if (idx < EJS_ARRAY_LEN(obj)) {
+            ejsval value;
+            EJSBool present = EJS_TRUE;
+
+            if (EJSVAL_IS_DENSE_ARRAY(obj)) {
+                value = EJS_DENSE_ARRAY_ELEMENTS(obj)[idx];
+            }
+            else {
+                ejsval* slot = sparse_lookup ((EJSArray*)EJSVAL_TO_OBJECT(obj), idx);
+                present = slot && !EJSVAL_IS_ARRAY_HOLE_MAGIC(*slot);
+                if (present)
+                    value = *slot;
             }
-        }
-    }
 
-    if (is_index) {
-        if (idx >= 0 && idx < EJS_ARRAY_LEN(obj)) {
-            // XXX we leak this.  need to change get_own_property to use an out param instead of a return value
-            EJSPropertyDesc* desc = (EJSPropertyDesc*)calloc(sizeof(EJSPropertyDesc), 1);
-            _ejs_property_desc_set_writable (desc, EJS_TRUE);
-            _ejs_property_desc_set_value (desc, EJS_DENSE_ARRAY_ELEMENTS(obj)[idx]);
-            return desc;
+            if (present) {
+                // XXX we leak this.  need to change get_own_property to use an out param instead of a return value
+                EJSPropertyDesc* desc = (EJSPropertyDesc*)calloc(sizeof(EJSPropertyDesc), 1);
+                _ejs_property_desc_set_writable (desc, EJS_TRUE);
+                _ejs_property_desc_set_value (desc, value);
+                return desc;
+            }
         }
     }
 
@@ -2785,73 +3544,74 @@ _ejs_array_specop_get_own_property (ejsval obj, ejsval propertyName, ejsval *exc
     return _ejs_Object_specops.GetOwnProperty (obj, propertyName, exc);
 }
 
-static EJSBool
-_ejs_array_specop_set (ejsval obj, ejsval propertyName, ejsval val, ejsval receiver)
+// store @val at @idx, switching representations if the store would leave the array mostly holes
+static void
+array_set_index (ejsval obj, int64_t idx, ejsval val)
 {
-    // check if propertyName is a uint32, or a string that we can convert to an uint32
-    EJSBool is_index = EJS_FALSE;
-    ejsval idx_val;
-    int idx;
-
-    if (!EJSVAL_IS_SYMBOL(propertyName)) {
-        idx_val = ToNumber(propertyName);
-        if (EJSVAL_IS_NUMBER(idx_val)) {
-            double n = EJSVAL_TO_NUMBER(idx_val);
-            if (floor(n) == n) {
-                idx = (int)n;
-                is_index = EJS_TRUE;
-            }
+    EJSArray* arr = (EJSArray*)EJSVAL_TO_OBJECT(obj);
+
+    if (EJSVAL_IS_DENSE_ARRAY(obj) && idx > EJSARRAY_LEN(arr) + SPARSE_ARRAY_CUTOFF)
+        dense_to_sparse (arr);
+
+    if (EJSVAL_IS_DENSE_ARRAY(obj)) {
+        dense_unshare (arr);
+
+        // we're a dense array, realloc to include up to idx+1
+        maybe_realloc_dense (arr, idx);
+
+        // if we now have a hole, fill in the range with special values to indicate this
+        for (int64_t i = idx-1; i >= EJSARRAY_LEN(arr); i --) {
+            EJSDENSEARRAY_ELEMENTS(arr)[i] = MAGIC_TO_EJSVAL_IMPL(EJS_ARRAY_HOLE);
         }
+
+        EJSDENSEARRAY_ELEMENTS(arr)[idx] = val;
+        EJSARRAY_LEN(arr) = MAX(EJSARRAY_LEN(arr), idx + 1);
     }
+    else {
+        sparse_set (arr, idx, val);
+    }
+}
 
-    if (is_index) {
-        if (EJSVAL_IS_DENSE_ARRAY(obj)) {
-            // we're a dense array, realloc to include up to idx+1
-
-            // XXX this is of course totally insane, as it causes:
-            //     a=[]; a[10000000]=1;
-            //     to allocate 10000000+1 ejsvals.
-            //     need some logic to switch to a sparse array if need be.
-            maybe_realloc_dense ((EJSArray*)EJSVAL_TO_OBJECT(obj), idx);
-
-            // if we now have a hole, fill in the range with special values to indicate this
-            if (idx > EJS_ARRAY_LEN(obj)) {
-                for (int i = idx-1; i >= EJS_ARRAY_LEN(obj); i --) {
-                    EJS_DENSE_ARRAY_ELEMENTS(obj)[i] = MAGIC_TO_EJSVAL_IMPL(EJS_ARRAY_HOLE);
-                }
-            }
+static void
+array_set_length (ejsval obj, int64_t newLen)
+{
+    EJSArray* arr = (EJSArray*)EJSVAL_TO_OBJECT(obj);
+    int64_t oldLen = EJSARRAY_LEN(arr);
 
-            EJS_DENSE_ARRAY_ELEMENTS(obj)[idx] = val;
-        }
-        else {
-            // we're already sparse, just give up as none of this is implemented yet.
-            EJS_NOT_IMPLEMENTED();
-        }
-        EJS_ARRAY_LEN(obj) = MAX(EJS_ARRAY_LEN(obj), idx + 1);
+    if (EJSVAL_IS_DENSE_ARRAY(obj) && newLen > oldLen + SPARSE_ARRAY_CUTOFF)
+        dense_to_sparse (arr);
+
+    if (EJSVAL_IS_DENSE_ARRAY(obj)) {
+        if (newLen > oldLen)
+            dense_unshare (arr);
+
+        if (newLen > EJSDENSEARRAY_ALLOC(arr))
+            maybe_realloc_dense (arr, newLen);
+
+        for (int64_t i = oldLen; i < newLen; i ++)
+            EJSDENSEARRAY_ELEMENTS(arr)[i] = MAGIC_TO_EJSVAL_IMPL(EJS_ARRAY_HOLE);
+
+        EJSARRAY_LEN(arr) = newLen;
+    }
+    else {
+        sparse_set_length (arr, newLen);
+    }
+}
+
+static EJSBool
+_ejs_array_specop_set (ejsval obj, ejsval propertyName, ejsval val, ejsval receiver)
+{
+    int64_t idx;
+
+    if (array_index (propertyName, &idx)) {
+        array_set_index (obj, idx, val);
         return EJS_TRUE;
     }
 
     if (EJSVAL_IS_STRING(propertyName)) {
         if (!ucs2_strcmp (_ejs_ucs2_length, EJSVAL_TO_FLAT_STRING(propertyName))) {
             // XXX more from 15.4.5.1 here
-            int newLen = ToLength(val);
-            int oldLen = EJS_ARRAY_LEN(obj);
-
-            if (EJSVAL_IS_DENSE_ARRAY(obj)) {
-                if (newLen > EJS_DENSE_ARRAY_ALLOC(obj))
-                    maybe_realloc_dense ((EJSArray*)EJSVAL_TO_OBJECT(obj), newLen);
-
-                if (newLen > oldLen) {
-                    for (int i = oldLen; i < newLen; i ++)
-                        EJS_DENSE_ARRAY_ELEMENTS(obj)[i] = MAGIC_TO_EJSVAL_IMPL(EJS_ARRAY_HOLE);
-                }
-            }
-            else {
-                // we're already sparse, just give up as none of this is implemented yet.
-                EJS_NOT_IMPLEMENTED();
-            }
-
-            EJS_ARRAY_LEN(obj) = newLen;
+            array_set_length (obj, ToLength(val));
             return EJS_TRUE;
         }
     }
@@ -2864,24 +3624,14 @@ _ejs_array_specop_set (ejsval obj, ejsval propertyName, ejsval val, ejsval recei
 static EJSBool
 _ejs_array_specop_has_property (ejsval obj, ejsval propertyName)
 {
-    // check if propertyName is an integer, or a string that we can convert to an int
-    ejsval idx_val;
-    int idx;
-
-    if (!EJSVAL_IS_SYMBOL(propertyName)) {
-        idx_val = ToNumber(propertyName);
-        if (EJSVAL_IS_NUMBER(idx_val)) {
-            double n = EJSVAL_TO_NUMBER(idx_val);
-            if (floor(n) == n) {
-                idx = (int)n;
-                if (idx >= 0 && idx < EJS_ARRAY_LEN(obj)) {
-                    ejsval element = EJS_DENSE_ARRAY_ELEMENTS(obj)[idx];
-                    if (EJSVAL_IS_ARRAY_HOLE_MAGIC(element))
-                        return EJS_FALSE;
-                    return EJS_TRUE;
-                }
-            }
-        }
+    int64_t idx;
+
+    if (array_index (propertyName, &idx) && idx < EJS_ARRAY_LEN(obj)) {
+        if (EJSVAL_IS_DENSE_ARRAY(obj))
+            return !EJSVAL_IS_ARRAY_HOLE_MAGIC(EJS_DENSE_ARRAY_ELEMENTS(obj)[idx]);
+
+        ejsval* slot = sparse_lookup ((EJSArray*)EJSVAL_TO_OBJECT(obj), idx);
+        return slot && !EJSVAL_IS_ARRAY_HOLE_MAGIC(*slot);
     }
 
     // if we fail there, we fall back to the object impl below
@@ -2892,101 +3642,37 @@ _ejs_array_specop_has_property (ejsval obj, ejsval propertyName)
 static EJSBool
 _ejs_array_specop_delete (ejsval obj, ejsval propertyName, EJSBool flag)
 {
-    // check if propertyName is a uint32, or a string that we can convert to an uint32
-    int idx = -1;
-    ejsval idx_val;
-
-    if (!EJSVAL_IS_SYMBOL(propertyName)) {
-        idx_val = ToNumber(propertyName);
-        if (EJSVAL_IS_NUMBER(idx_val)) {
-            double n = EJSVAL_TO_NUMBER(idx_val);
-            if (floor(n) == n) {
-                idx = (int)n;
-            }
-        }
-    }
+    int64_t idx;
 
-    if (idx < 0)
+    if (!array_index (propertyName, &idx))
         return _ejs_Object_specops.Delete (obj, propertyName, flag);
 
     // if it's outside the array bounds, do nothing
-    if (idx < EJS_ARRAY_LEN(obj))
-        EJS_DENSE_ARRAY_ELEMENTS(obj)[idx] = MAGIC_TO_EJSVAL_IMPL(EJS_ARRAY_HOLE);
+    if (idx < EJS_ARRAY_LEN(obj)) {
+        if (EJSVAL_IS_DENSE_ARRAY(obj)) {
+            dense_unshare ((EJSArray*)EJSVAL_TO_OBJECT(obj));
+            EJS_DENSE_ARRAY_ELEMENTS(obj)[idx] = MAGIC_TO_EJSVAL_IMPL(EJS_ARRAY_HOLE);
+        }
+        else
+            sparse_delete ((EJSArray*)EJSVAL_TO_OBJECT(obj), idx);
+    }
     return EJS_TRUE;
 }
 
 static EJSBool
 _ejs_array_specop_define_own_property (ejsval obj, ejsval propertyName, EJSPropertyDesc* propertyDescriptor, EJSBool flag)
 {
-    // check if propertyName is a uint32, or a string that we can convert to an uint32
-    EJSBool is_index = EJS_FALSE;
-    ejsval idx_val;
-    int idx;
-
-    if (!EJSVAL_IS_SYMBOL(propertyName)) {
-        idx_val = ToNumber(propertyName);
-        if (EJSVAL_IS_NUMBER(idx_val)) {
-            double n = EJSVAL_TO_NUMBER(idx_val);
-            if (floor(n) == n) {
-                idx = (int)n;
-                if (idx >= 0)
-                    is_index = EJS_TRUE;
-            }
-        }
-    }
-
-    if (is_index) {
-        if (EJSVAL_IS_DENSE_ARRAY(obj)) {
-            // we're a dense array, realloc to include up to idx+1
-
-            if (idx >= EJS_DENSE_ARRAY_ALLOC(obj)) {
-                // we're doing a store to an index larger than our allocated space
-                // XXX this is of course totally insane, as it causes:
-                //     a=[]; a[10000000]=1;
-                //     to allocate 10000000+1 ejsvals.
-                //     need some logic to switch to a sparse array if need be.
-                maybe_realloc_dense ((EJSArray*)EJSVAL_TO_OBJECT(obj), idx);
-
-            }
-
-            // if we now have a hole, fill in the range with special values to indicate this
-            if (idx > EJS_ARRAY_LEN(obj)) {
-                for (int i = idx; i >= EJS_ARRAY_LEN(obj); i --) {
-                    EJS_DENSE_ARRAY_ELEMENTS(obj)[i] = MAGIC_TO_EJSVAL_IMPL(EJS_ARRAY_HOLE);
-                }
-            }
+    int64_t idx;
 
-            EJS_DENSE_ARRAY_ELEMENTS(obj)[idx] = propertyDescriptor->value;
-        }
-        else {
-            // we're already sparse, just give up as none of this is implemented yet.
-            EJS_NOT_IMPLEMENTED();
-        }
-        EJS_ARRAY_LEN(obj) = MAX(EJS_ARRAY_LEN(obj), idx + 1);
+    if (array_index (propertyName, &idx)) {
+        array_set_index (obj, idx, propertyDescriptor->value);
         return EJS_TRUE;
     }
 
     if (EJSVAL_IS_STRING(propertyName)) {
         if (!ucs2_strcmp (_ejs_ucs2_length, EJSVAL_TO_FLAT_STRING(propertyName))) {
             // XXX more from 15.4.5.1 here
-            int newLen = ToUint32(_ejs_property_desc_get_value(propertyDescriptor));
-            int oldLen = EJS_ARRAY_LEN(obj);
-
-            if (EJSVAL_IS_DENSE_ARRAY(obj)) {
-                if (newLen > EJS_DENSE_ARRAY_ALLOC(obj))
-                    maybe_realloc_dense ((EJSArray*)EJSVAL_TO_OBJECT(obj), newLen);
-
-                if (newLen > oldLen) {
-                    for (int i = oldLen; i < newLen; i ++)
-                        EJS_DENSE_ARRAY_ELEMENTS(obj)[i] = MAGIC_TO_EJSVAL_IMPL(EJS_ARRAY_HOLE);
-                }
-            }
-            else {
-                // we're already sparse, just give up as none of this is implemented yet.
-                EJS_NOT_IMPLEMENTED();
-            }
-
-            EJS_ARRAY_LEN(obj) = newLen;
+            array_set_length (obj, ToUint32(_ejs_property_desc_get_value(propertyDescriptor)));
             return EJS_TRUE;
         }
     }
@@ -3012,8 +3698,8 @@ _ejs_array_specop_finalize (EJSObject* obj)
         }
         free (arr->sparse.arraylets);
     }
-    else {
-        free (EJSDENSEARRAY_ELEMENTS(obj));
+    else if (!((EJSArray*)obj)->dense.cow) {
+        free (DENSE_STORAGE((EJSArray*)obj));
     }
     _ejs_Object_specops.Finalize (obj);
 }
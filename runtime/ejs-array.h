@@ -16,16 +16,19 @@ typedef struct {
 
 typedef struct {
     /* dense array data */
-    int64_t          array_alloc;
+    int64_t          array_alloc;   /* slots available starting at elements */
+    int64_t          array_offset;  /* slots before elements left free by shift/unshift */
+    EJSBool          cow;           /* elements is constant data from an array literal, copy before writing */
     EJSPropertyDesc* element_descs;
-    ejsval*          elements;
+    ejsval*          elements;      /* always element 0; the allocation starts at elements - array_offset */
 } EJSDenseArrayData;
 
 typedef struct {
     /* sparse array data */
     int64_t   arraylet_alloc;
     int64_t   arraylet_num;
-    Arraylet *arraylets;
+    Arraylet *arraylets;     /* sorted by start_idx, never overlapping */
+    int64_t   element_num;   /* sum of the arraylets' lengths (holes included) */
 } EJSSparseArrayData;
 
 typedef struct {
@@ -77,6 +80,7 @@ extern EJSSpecOps _ejs_ArrayIterator_specops;
 
 ejsval _ejs_array_create (ejsval length, ejsval proto);
 ejsval _ejs_array_new (int64_t numElements, EJSBool fill);
+ejsval _ejs_array_new_cow (int64_t numElements, ejsval* elements);
 
 typedef enum {
     EJS_ARRAYITER_KIND_KEY,
@@ -85,6 +89,7 @@ typedef enum {
 } EJSArrayIteratorKind;
 
 ejsval _ejs_array_iterator_new(ejsval array, EJSArrayIteratorKind kind);
+ejsval _ejs_array_iterator_step(ejsval iterator);
 
 // creates a new array and populates it by pushing numElements from
 // the vector elements
@@ -92,10 +97,18 @@ ejsval _ejs_array_new_copy (int numElements, ejsval *elements);
 
 int _ejs_array_indexof (EJSArray* haystack, ejsval needle);
 
+// finds the first present (non-hole) element of @array at an index >= @from, storing it in
+// @idx/@value.  works for both dense and sparse arrays, and for sparse arrays skips holes in
+// O(log(arraylets)) time.  each call starts from scratch, so it's safe to call user code
+// (which might mutate the array) between calls.  returns EJS_FALSE when there are no more
+// elements.
+EJSBool _ejs_array_next_present (ejsval array, int64_t from, int64_t* idx, ejsval* value);
+
 void _ejs_array_init(ejsval global);
 
 uint32_t _ejs_array_push_dense (ejsval array, int argc, ejsval* args);
 ejsval   _ejs_array_pop_dense (ejsval array);
+ejsval   _ejs_array_getprop_dense (ejsval array, ejsval key);
 
 ejsval _ejs_array_join (ejsval array, ejsval sep);
 ejsval _ejs_array_from_iterables (int argc, ejsval* args);
@@ -103,6 +116,7 @@ ejsval _ejs_array_from_iterables (int argc, ejsval* args);
 EJSBool IsArray (ejsval argument);
 
 EJS_NATIVE_FUNC(_ejs_Array_prototype_values);
+EJS_NATIVE_FUNC(_ejs_ArrayIterator_prototype_next);
 
 EJS_END_DECLS
 
@@ -104,7 +104,12 @@ EJS_ATOM(exports)
 // our ejs-specific stuff
 EJS_ATOM(__ejs)
 EJS_ATOM(GC)
+EJS_ATOM(JSONParser)
+EJS_ATOM(JSONWriter)
 EJS_ATOM(unhandledException)
+EJS_ATOM(numberStringCacheStats)
+EJS_ATOM(hits)
+EJS_ATOM(misses)
 EJS_ATOM(getNextValue)
 EJS_ATOM(getRest)
 
@@ -114,6 +119,8 @@ EJS_ATOM(stdout)
 EJS_ATOM(stderr)
 EJS_ATOM(write)
 EJS_ATOM(end)
+EJS_ATOM(ondrain)
+EJS_ATOM(writableLength)
 EJS_ATOM(isTTY)
 EJS_ATOM(columns)
 
@@ -293,6 +300,7 @@ EJS_ATOM(raw)
 //EJS_ATOM(isFinite)
 EJS_ATOM(toFixed)
 EJS_ATOM(toPrecision)
+EJS_ATOM(toExponential)
 EJS_ATOM(toInteger)
 EJS_ATOM(isInteger)
 EJS_ATOM(isSafeInteger)
@@ -329,7 +337,32 @@ EJS_ATOM(input)
 //EJS_ATOM(toString)
 EJS_ATOM(getTime)
 EJS_ATOM(getTimezoneOffset)
+EJS_ATOM(setTime)
+EJS_ATOM(getDate)
+EJS_ATOM(getDay)
+EJS_ATOM(getFullYear)
+EJS_ATOM(getHours)
+EJS_ATOM(getMilliseconds)
+EJS_ATOM(getMinutes)
+EJS_ATOM(getMonth)
+EJS_ATOM(getSeconds)
+EJS_ATOM(getUTCDate)
+EJS_ATOM(getUTCDay)
+EJS_ATOM(getUTCFullYear)
+EJS_ATOM(getUTCHours)
+EJS_ATOM(getUTCMilliseconds)
+EJS_ATOM(getUTCMinutes)
+EJS_ATOM(getUTCMonth)
+EJS_ATOM(getUTCSeconds)
+EJS_ATOM(toDateString)
+EJS_ATOM(toTimeString)
+EJS_ATOM(toUTCString)
+EJS_ATOM(toISOString)
+//EJS_ATOM(toJSON)
+//EJS_ATOM(valueOf)
 EJS_ATOM(now)
+//EJS_ATOM(parse)
+EJS_ATOM(UTC)
 
 // Function functions
 //EJS_ATOM(toString)
@@ -3,8 +3,10 @@
  */
 
 #include <math.h>
+#include <stdio.h>
 #include <string.h>
 #include <sys/time.h>
+#include <unistd.h>
 
 #include "ejs-console.h"
 #include "ejs-gc.h"
@@ -18,15 +20,14 @@
 #include "ejs-typedarrays.h"
 #include "ejs-json.h"
 #include "ejs-regexp.h"
+#include "ejs-output.h"
 
 #if IOS
 #import <Foundation/Foundation.h>
 #endif
 
 #if IOS
-#define OUTPUT(format, ...) if (force_stdout) fprintf (outfile, format, __VA_ARGS__); else NSLog(@format, __VA_ARGS__)
-#else
-#define OUTPUT(format, ...) fprintf (outfile, format, __VA_ARGS__)
+#define OUTPUT(format, ...) NSLog(@format, __VA_ARGS__)
 #endif
 
 static EJSBool force_stdout;
@@ -53,11 +54,28 @@ console_toString(ejsval arg) {
             ejsval lbracket = _ejs_string_new_utf8("[ ");
             ejsval rbracket = _ejs_string_new_utf8(" ]");
              
-            ejsval content_strings = _ejs_array_new(EJS_ARRAY_LEN(arg), EJS_FALSE);
-            // XXX the loop below assumes arg is a dense array
-            EJS_ASSERT(EJSVAL_IS_DENSE_ARRAY(arg));
-            for (int i = 0; i < EJS_ARRAY_LEN(arg); i ++) {
-                EJS_DENSE_ARRAY_ELEMENTS(content_strings)[i] = console_toString(EJS_DENSE_ARRAY_ELEMENTS(arg)[i]);
+            // walk only the present elements (arg may be sparse, and
+            // console_toString may run code that changes it), and print
+            // each run of holes the way node does.
+            ejsval content_strings = _ejs_array_new(0, EJS_FALSE);
+            int64_t len = EJS_ARRAY_LEN(arg);
+            int64_t from = 0;
+            for (;;) {
+                int64_t k;
+                ejsval kValue;
+                EJSBool present = _ejs_array_next_present (arg, from, &k, &kValue) && k < len;
+                int64_t holes = (present ? k : len) - from;
+                if (holes > 0) {
+                    char buf[64];
+                    snprintf (buf, sizeof(buf), "<%lld empty item%s>", (long long)holes, holes == 1 ? "" : "s");
+                    ejsval holes_str = _ejs_string_new_utf8(buf);
+                    _ejs_array_push_dense (content_strings, 1, &holes_str);
+                }
+                if (!present)
+                    break;
+                ejsval element_str = console_toString(kValue);
+                _ejs_array_push_dense (content_strings, 1, &element_str);
+                from = k + 1;
             }
 
             ejsval contents = _ejs_array_join (content_strings, comma_space);
@@ -117,39 +135,43 @@ console_toString(ejsval arg) {
 }
 
 static ejsval
-output (FILE *outfile, uint32_t argc, ejsval *args)
+output (int fd, uint32_t argc, ejsval *args)
 {
-    for (int i = 0; i < argc; i ++) {
-        ejsval out_str = console_toString(args[i]);
-        char* strval_utf8 = ucs2_to_utf8(EJSVAL_TO_FLAT_STRING(out_str));
-        OUTPUT ("%s", strval_utf8);
-        free (strval_utf8);
 #if IOS
-        if (force_stdout)
-#endif
-            if (i < argc - 1)
-                fputc (' ', outfile);
+    if (!force_stdout) {
+        for (int i = 0; i < argc; i ++) {
+            ejsval out_str = console_toString(args[i]);
+            char* strval_utf8 = ucs2_to_utf8(EJSVAL_TO_FLAT_STRING(out_str));
+            OUTPUT ("%s", strval_utf8);
+            free (strval_utf8);
+        }
+        return _ejs_undefined;
     }
-
-#if IOS
-    if (force_stdout)
 #endif
-        fputc ('\n', outfile);
+
+    EJSOutput* out = _ejs_output_for_fd (fd);
+    for (int i = 0; i < argc; i ++) {
+        _ejs_output_write_string (out, console_toString(args[i]));
+        if (i < argc - 1)
+            _ejs_output_write_utf8 (out, " ", 1);
+    }
+    _ejs_output_write_utf8 (out, "\n", 1);
+    _ejs_output_end_write (out);
 
     return _ejs_undefined;
 }
 
 
 static EJS_NATIVE_FUNC(_ejs_console_log) {
-    return output (stdout, argc, args);
+    return output (STDOUT_FILENO, argc, args);
 }
 
 static EJS_NATIVE_FUNC(_ejs_console_warn) {
-    return output (stderr, argc, args);
+    return output (STDERR_FILENO, argc, args);
 }
 
 static EJS_NATIVE_FUNC(_ejs_console_error) {
-    return output (stderr, argc, args);
+    return output (STDERR_FILENO, argc, args);
 }
 
 // terrible, use a linked list for the timeval slots.
@@ -253,14 +275,22 @@ static EJS_NATIVE_FUNC(_ejs_console_timeEnd) {
     uint64_t usec_before = tv_before_slot->tv_sec * 1000000 + tv_before_slot->tv_usec;
     uint64_t usec_after = tvafter.tv_sec * 1000000 + tvafter.tv_usec;
 
-    FILE* outfile = stdout;
-
-    OUTPUT ("%s: %gms", str, (usec_after - usec_before) / 1000.0);
+    char buf[256];
+    int len = snprintf (buf, sizeof(buf), "%s: %gms", str, (usec_after - usec_before) / 1000.0);
+    if (len >= sizeof(buf))
+        len = sizeof(buf) - 1;
 
 #if IOS
-    if (force_stdout)
+    if (!force_stdout)
+        OUTPUT ("%s", buf);
+    else
 #endif
-        fprintf (outfile, "\n");
+    {
+        EJSOutput* out = _ejs_output_for_fd (STDOUT_FILENO);
+        _ejs_output_write_utf8 (out, buf, len);
+        _ejs_output_write_utf8 (out, "\n", 1);
+        _ejs_output_end_write (out);
+    }
 
     remove_timeval_slot(args[0]);
 
@@ -11,156 +11,938 @@
 #include "ejs-proxy.h"
 #include "ejs-symbol.h"
 
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <sys/time.h>
 
-ejsval
-_ejs_date_unix_now ()
+// Dates are a double of ms since the epoch, and every field is computed
+// from that with plain arithmetic (ES2015 20.3.1).  The only thing we need
+// libc for is the local time zone offset, and those are cached below.
+
+#define msPerSecond 1000.0
+#define msPerMinute 60000.0
+#define msPerHour   3600000.0
+#define msPerDay    86400000.0
+
+static const char* const day_names[] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+static const char* const month_names[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+
+// 20.3.1.2 Day Number and Time within Day
+static double
+Day (double t)
 {
-    EJSDate* rv = _ejs_gc_new (EJSDate);
+    return floor(t / msPerDay);
+}
 
-    _ejs_init_object ((EJSObject*)rv, _ejs_Date_prototype, &_ejs_Date_specops);
+static double
+TimeWithinDay (double t)
+{
+    double rv = fmod(t, msPerDay);
+    return rv < 0 ? rv + msPerDay : rv;
+}
 
-    gettimeofday (&rv->tv, &rv->tz);
+// the day number of @y-@m-@d (@m from 1 to 12) in the proleptic
+// Gregorian calendar, counting from 1970-01-01.  Howard Hinnant's
+// days_from_civil, which only needs integer arithmetic.
+static int64_t
+days_from_civil (int64_t y, int m, int d)
+{
+    y -= m <= 2;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    int64_t yoe = y - era * 400;
+    int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
 
-    return OBJECT_TO_EJSVAL(rv);
+// and back again
+static void
+civil_from_days (int64_t z, int64_t* y, int* m, int* d)
+{
+    z += 719468;
+    int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    int64_t doe = z - era * 146097;
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp = (5 * doy + 2) / 153;
+    *d = (int)(doy - (153 * mp + 2) / 5 + 1);
+    *m = (int)(mp < 10 ? mp + 3 : mp - 9);
+    *y = yoe + era * 400 + (*m <= 2);
 }
 
-double
-_ejs_date_get_time (EJSDate *date)
+typedef struct {
+    int64_t year;
+    int month;    // 0 - 11
+    int date;     // 1 - 31
+    int weekday;  // 0 (Sunday) - 6
+    int hours;
+    int minutes;
+    int seconds;
+    int ms;
+} DateFields;
+
+// every field of time value @t (which must be finite) at once
+static void
+date_fields (double t, DateFields* fields)
 {
-    return (double)date->tv.tv_sec * 1000 + (double)date->tv.tv_usec / 1000;
+    int64_t day = (int64_t)Day(t);
+    int64_t ms = (int64_t)TimeWithinDay(t);
+    int m;
+
+    civil_from_days (day, &fields->year, &m, &fields->date);
+    fields->month = m - 1;
+    // 20.3.1.6 Week Day: 1970-01-01 was a Thursday
+    fields->weekday = (int)(((day + 4) % 7 + 7) % 7);
+    fields->hours = (int)(ms / 3600000);
+    fields->minutes = (int)(ms / 60000 % 60);
+    fields->seconds = (int)(ms / 1000 % 60);
+    fields->ms = (int)(ms % 1000);
 }
 
-ejsval _ejs_Date EJSVAL_ALIGNMENT;
-ejsval _ejs_Date_prototype EJSVAL_ALIGNMENT;
+// 20.3.1.11 MakeTime (hour, min, sec, ms)
+static double
+MakeTime (double hour, double min, double sec, double ms)
+{
+    // 1. If hour is not finite or min is not finite or sec is not finite or ms is not finite, return NaN.
+    if (!isfinite(hour) || !isfinite(min) || !isfinite(sec) || !isfinite(ms))
+        return NAN;
+    // 2-5. Let h, m, s, milli be ToInteger of each.
+    // 6. Let t be h * msPerHour + m * msPerMinute + s * msPerSecond + milli, performing the arithmetic according to IEEE 754 rules.
+    // 7. Return t.
+    return trunc(hour) * msPerHour + trunc(min) * msPerMinute + trunc(sec) * msPerSecond + trunc(ms);
+}
 
-static EJS_NATIVE_FUNC(_ejs_Date_impl) {
-    if (!EJSVAL_IS_UNDEFINED(newTarget)) {
-        ejsval O = OrdinaryCreateFromConstructor(newTarget, _ejs_Date_prototype, &_ejs_Date_specops);
-        *_this = O;
-        EJSDate* date = (EJSDate*) EJSVAL_TO_OBJECT(O);
+// 20.3.1.12 MakeDay (year, month, date)
+static double
+MakeDay (double year, double month, double date)
+{
+    // 1. If year is not finite or month is not finite or date is not finite, return NaN.
+    if (!isfinite(year) || !isfinite(month) || !isfinite(date))
+        return NAN;
+
+    // 2-4. Let y, m, dt be ToInteger of each.
+    double y = trunc(year), m = trunc(month), dt = trunc(date);
+
+    // 5. Let ym be y + floor(m /12).
+    double ym = y + floor(m / 12);
+    // 6. Let mn be m modulo 12.
+    int mn = (int)(m - floor(m / 12) * 12);
+
+    // anything this far out is going to fail TimeClip anyway
+    if (fabs(ym) > 400000)
+        return NAN;
+
+    // 7. Find a value t such that YearFromTime(t) is ym and MonthFromTime(t) is mn and DateFromTime(t) is 1;
+    //    but if this is not possible (because some argument is out of range), return NaN.
+    // 8. Return Day(t) + dt - 1.
+    return (double)days_from_civil ((int64_t)ym, mn + 1, 1) + dt - 1;
+}
+
+// 20.3.1.13 MakeDate (day, time)
+static double
+MakeDate (double day, double time)
+{
+    // 1. If day is not finite or time is not finite, return NaN.
+    if (!isfinite(day) || !isfinite(time))
+        return NAN;
+    // 2. Return day × msPerDay + time.
+    return day * msPerDay + time;
+}
+
+// 20.3.1.14 TimeClip (time)
+static double
+TimeClip (double time)
+{
+    // 1. If time is not finite, return NaN.
+    // 2. If abs(time) > 8.64 × 10^15, return NaN.
+    if (!isfinite(time) || fabs(time) > 8.64e15)
+        return NAN;
+    // 3. Return ToInteger(time), converting -0 to +0
+    return trunc(time) + 0.0;
+}
+
+// the local time zone.  localtime_r rereads the zone's state (and takes
+// a lock, with glibc) on every call, so we remember the spans of time
+// over which we know the offset is constant, in the spirit of V8's
+// DateCache.  a span is only extended across a gap of up to
+// TZ_SPAN_PROBE seconds when the offset is the same at both ends, so we
+// assume no zone has two transitions closer together than that.
+//
+// everything is thrown away if the TZ environment variable changes.
+
+#define TZ_SPANS 8
+#define TZ_SPAN_PROBE (19 * 24 * 60 * 60)
+#define TZ_NAME_SIZE 16
+
+typedef struct {
+    int64_t start;  // seconds since the epoch, inclusive
+    int64_t end;
+    int32_t offset; // seconds east of UTC
+    char name[TZ_NAME_SIZE];
+} TZSpan;
+
+static TZSpan tz_spans[TZ_SPANS];
+static int tz_span_count;
+static int tz_next_victim;
+static char tz_env[256];
+static EJSBool tz_env_set;
+
+static void
+tz_check_env ()
+{
+    const char* tz = getenv("TZ");
+    EJSBool set = tz != NULL;
+
+    if (set == tz_env_set && (!set || !strncmp (tz, tz_env, sizeof(tz_env) - 1)))
+        return;
+
+    tz_env_set = set;
+    if (set) {
+        strncpy (tz_env, tz, sizeof(tz_env) - 1);
+        tz_env[sizeof(tz_env) - 1] = '\0';
+    }
+    tzset();
+    tz_span_count = 0;
+    tz_next_victim = 0;
+}
+
+// asks libc for the offset at @secs
+static int32_t
+tz_lookup (int64_t secs, char* name)
+{
+    time_t time_in_sec = (time_t)secs;
+    struct tm tm;
 
-        // new Date (year, month [, date [, hours [, minutes [, seconds [, ms ] ] ] ] ] )
+    if (localtime_r (&time_in_sec, &tm) == NULL) {
+        strcpy (name, "UTC");
+        return 0;
+    }
+    snprintf (name, TZ_NAME_SIZE, "%s", tm.tm_zone ? tm.tm_zone : "");
+    return (int32_t)tm.tm_gmtoff;
+}
+
+// extends @span forward by TZ_SPAN_PROBE if the offset doesn't change
+// over it, so a run of increasing times (log timestamps, say) mostly hits
+static void
+tz_probe_forward (TZSpan* span)
+{
+    char name[TZ_NAME_SIZE];
+    if (tz_lookup (span->end + TZ_SPAN_PROBE, name) == span->offset && !strcmp (name, span->name))
+        span->end += TZ_SPAN_PROBE;
+}
 
-        if (argc < 2) {
-            if (gettimeofday (&date->tv, &date->tz) < 0)
-                EJS_NOT_IMPLEMENTED();
+static TZSpan*
+tz_span_for (int64_t secs)
+{
+    tz_check_env();
+
+    for (int i = 0; i < tz_span_count; i ++) {
+        if (tz_spans[i].start <= secs && secs <= tz_spans[i].end)
+            return &tz_spans[i];
+    }
+
+    char name[TZ_NAME_SIZE];
+    int32_t offset = tz_lookup (secs, name);
+
+    for (int i = 0; i < tz_span_count; i ++) {
+        TZSpan* span = &tz_spans[i];
+        if (span->offset != offset || strcmp (span->name, name))
+            continue;
+        if (secs > span->end && secs - span->end <= TZ_SPAN_PROBE) {
+            span->end = secs;
+            tz_probe_forward (span);
+            return span;
         }
-        else {
-            struct tm tm;
-            int ms = 0;
-
-            memset (&tm, 0, sizeof(tm));
-            // there are all sorts of validation steps here that are missing from ejs
-            tm.tm_year = ToInteger(args[0]) - 1900;
-            tm.tm_mon = ToInteger(args[1]);
-            
-            tm.tm_mday = (argc > 2) ? ToInteger(args[2]) : 1;
-            tm.tm_hour = (argc > 3) ? ToInteger(args[3]) : 0;
-            tm.tm_hour = (argc > 4) ? ToInteger(args[4]) : 0;
-            tm.tm_sec  = (argc > 5) ? ToInteger(args[5]) : 0;
-   
-            if (argc > 6) {
-                ms = ToInteger(args[6]);
-                if (ms > 1000) {
-                    tm.tm_sec += ms / 1000;
-                    ms = ms % 1000;
+        if (secs < span->start && span->start - secs <= TZ_SPAN_PROBE) {
+            span->start = secs;
+            return span;
+        }
+    }
+
+    TZSpan* span;
+    if (tz_span_count < TZ_SPANS) {
+        span = &tz_spans[tz_span_count++];
+    }
+    else {
+        span = &tz_spans[tz_next_victim];
+        tz_next_victim = (tz_next_victim + 1) % TZ_SPANS;
+    }
+    span->start = span->end = secs;
+    span->offset = offset;
+    memcpy (span->name, name, TZ_NAME_SIZE);
+    tz_probe_forward (span);
+    return span;
+}
+
+// 20.3.1.7 LocalTZA + 20.3.1.8 DaylightSavingTA, for UTC time @t (finite)
+static double
+local_offset (double t)
+{
+    return tz_span_for ((int64_t)floor(t / msPerSecond))->offset * msPerSecond;
+}
+
+// 20.3.1.9 LocalTime ( t )
+static double
+LocalTime (double t)
+{
+    return t + local_offset(t);
+}
+
+// 20.3.1.10 UTC ( t )
+static double
+UTC (double t)
+{
+    if (!isfinite(t))
+        return NAN;
+    // the offset at t taken as UTC is close enough to find the offset
+    // at the UTC time we're looking for
+    return t - local_offset(t - local_offset(t));
+}
+
+// the clock for Date.now() and new Date().  the coarse clock skips a
+// syscall, but it's only precise enough if it ticks at least every ms
+#if linux && defined(CLOCK_REALTIME_COARSE)
+static clockid_t now_clock = CLOCK_REALTIME;
+#endif
+
+static double
+current_time ()
+{
+#if linux && defined(CLOCK_REALTIME_COARSE)
+    struct timespec ts;
+    clock_gettime (now_clock, &ts);
+    return floor((double)ts.tv_sec * msPerSecond + ts.tv_nsec / 1000000);
+#else
+    struct timeval tv;
+    gettimeofday (&tv, NULL);
+    return floor((double)tv.tv_sec * msPerSecond + tv.tv_usec / 1000);
+#endif
+}
+
+static ejsval
+date_to_string (double tv, EJSBool date_part, EJSBool time_part)
+{
+    if (isnan(tv))
+        return _ejs_string_new_utf8 ("Invalid Date");
+
+    TZSpan* span = tz_span_for ((int64_t)floor(tv / msPerSecond));
+    DateFields f;
+    date_fields (tv + span->offset * msPerSecond, &f);
+
+    // 'Tue Aug 28 2012 16:45:58 GMT-0700 (PDT)'
+    char date_buf[128];
+    int len = 0;
+    if (date_part)
+        len += snprintf (date_buf + len, sizeof(date_buf) - len, "%s %s %02d %s%04lld",
+                         day_names[f.weekday], month_names[f.month], f.date,
+                         f.year < 0 ? "-" : "", (long long)(f.year < 0 ? -f.year : f.year));
+    if (time_part) {
+        len += snprintf (date_buf + len, sizeof(date_buf) - len, "%s%02d:%02d:%02d GMT", date_part ? " " : "",
+                         f.hours, f.minutes, f.seconds);
+        if (span->offset != 0) {
+            int offset = span->offset / 60;
+            len += snprintf (date_buf + len, sizeof(date_buf) - len, "%c%02d%02d (%s)",
+                             offset < 0 ? '-' : '+', abs(offset) / 60, abs(offset) % 60, span->name);
+        }
+    }
+    return _ejs_string_new_utf8_len (date_buf, len);
+}
+
+// the ES2015 20.3.1.16 Date Time String Format:
+//
+//   YYYY[-MM[-DD]][THH:mm[:ss[.sss]][Z|+HH:mm|-HH:mm]]
+//
+// with ±YYYYYY for extended years.  the date-only forms are UTC, and
+// date-times without an offset are local time.  NaN if @s isn't one.
+static double
+parse_iso_date (const jschar* s, int len)
+{
+    const jschar* p = s;
+    const jschar* end = s + len;
+    int64_t year;
+    int month = 1, day = 1, hour = 0, minute = 0, second = 0, ms = 0;
+    EJSBool local = EJS_FALSE;
+    double offset = 0;
+
+#define DIGIT(c) ((c) >= '0' && (c) <= '9')
+#define DIGITS(n, out) EJS_MACRO_START                                 \
+        if (end - p < (n)) return NAN;                                  \
+        int64_t _v = 0;                                                 \
+        for (int _i = 0; _i < (n); _i ++, p++) {                        \
+            if (!DIGIT(*p)) return NAN;                                 \
+            _v = _v * 10 + (*p - '0');                                  \
+        }                                                               \
+        (out) = _v;                                                     \
+    EJS_MACRO_END
+
+    if (p < end && (*p == '+' || *p == '-')) {
+        EJSBool negative = *p == '-';
+        p++;
+        DIGITS(6, year);
+        if (negative)
+            year = -year;
+    }
+    else {
+        DIGITS(4, year);
+    }
+
+    if (p < end && *p == '-') {
+        p++;
+        DIGITS(2, month);
+        if (p < end && *p == '-') {
+            p++;
+            DIGITS(2, day);
+        }
+    }
+
+    if (p < end && *p == 'T') {
+        p++;
+        DIGITS(2, hour);
+        if (p == end || *p != ':') return NAN;
+        p++;
+        DIGITS(2, minute);
+        if (p < end && *p == ':') {
+            p++;
+            DIGITS(2, second);
+            if (p < end && *p == '.') {
+                p++;
+                if (p == end || !DIGIT(*p)) return NAN;
+                // milliseconds, ignoring any digits past them
+                int scale = 100;
+                for (; p < end && DIGIT(*p); p++) {
+                    ms += (*p - '0') * scale;
+                    scale /= 10;
                 }
             }
+        }
 
-            time_t time_in_sec = mktime(&tm);
-            date->tv.tv_sec = time_in_sec;
-            date->tv.tv_usec = ms * 1000;
-            date->valid = EJS_TRUE;
+        if (p < end && *p == 'Z') {
+            p++;
+        }
+        else if (p < end && (*p == '+' || *p == '-')) {
+            int sign = *p == '-' ? -1 : 1;
+            int offset_hours, offset_minutes;
+            p++;
+            DIGITS(2, offset_hours);
+            if (p == end || *p != ':') return NAN;
+            p++;
+            DIGITS(2, offset_minutes);
+            if (offset_hours > 23 || offset_minutes > 59) return NAN;
+            offset = sign * (offset_hours * msPerHour + offset_minutes * msPerMinute);
+        }
+        else {
+            local = EJS_TRUE;
         }
-      
-        return *_this;
     }
-    else {
-        // called as a function
-        if (argc == 0) {
-            // XXX we shouldn't be creating a date object here and immediately throwing it away.
-            // instead just refactor and create the string directly
-            return ToString(_ejs_date_unix_now());
+
+#undef DIGITS
+#undef DIGIT
+
+    if (p != end)
+        return NAN;
+
+    // 24:00 is allowed, as the end of the day
+    if (month < 1 || month > 12 || day < 1 || day > 31 || minute > 59 || second > 59 ||
+        hour > 24 || (hour == 24 && (minute || second || ms)))
+        return NAN;
+    // and days have to exist in their month
+    if (day > 28 && days_from_civil (year, month, day) >= days_from_civil (year + (month == 12), month % 12 + 1, 1))
+        return NAN;
+
+    double t = MakeDate (MakeDay (year, month - 1, day), MakeTime (hour, minute, second, ms));
+    t = local ? UTC(t) : t - offset;
+    return TimeClip(t);
+}
+
+static int
+month_from_name (const jschar* p)
+{
+    for (int m = 0; m < 12; m ++) {
+        if ((p[0] | 0x20) == (month_names[m][0] | 0x20) && (p[1] | 0x20) == month_names[m][1] && (p[2] | 0x20) == month_names[m][2])
+            return m;
+    }
+    return -1;
+}
+
+// what we can't parse as ISO, we try as the toString/toUTCString
+// formats (and the usual variations on them):
+//
+//   Tue Aug 28 2012 16:45:58 GMT-0700 (PDT)
+//   Tue, 28 Aug 2012 23:45:58 GMT
+//   Aug 28, 2012
+//
+// without a GMT/UTC/Z the time is local.
+static double
+parse_legacy_date (const jschar* s, int len)
+{
+    const jschar* p = s;
+    const jschar* end = s + len;
+    int64_t year = -1;
+    int month = -1, day = -1, hour = 0, minute = 0, second = 0;
+    EJSBool have_time = EJS_FALSE;
+    EJSBool utc = EJS_FALSE;
+    double offset = 0;
+
+    while (p < end) {
+        jschar c = *p;
+        if (c == ' ' || c == ',' || c == '\t') {
+            p++;
+        }
+        else if (c == '(') {
+            // a comment, like the zone name
+            while (p < end && *p != ')') p++;
+            if (p < end) p++;
+        }
+        else if (c >= '0' && c <= '9') {
+            int64_t v = 0;
+            const jschar* start = p;
+            while (p < end && *p >= '0' && *p <= '9' && p - start < 7)
+                v = v * 10 + (*p++ - '0');
+            if (p < end && *p == ':') {
+                if (have_time) return NAN;
+                have_time = EJS_TRUE;
+                hour = (int)v;
+                p++;
+                for (v = 0, start = p; p < end && *p >= '0' && *p <= '9' && p - start < 2; p++)
+                    v = v * 10 + (*p - '0');
+                if (p == start) return NAN;
+                minute = (int)v;
+                if (p < end && *p == ':') {
+                    p++;
+                    for (v = 0, start = p; p < end && *p >= '0' && *p <= '9' && p - start < 2; p++)
+                        v = v * 10 + (*p - '0');
+                    if (p == start) return NAN;
+                    second = (int)v;
+                }
+            }
+            else if (day == -1 && p - start <= 2) {
+                day = (int)v;
+            }
+            else if (year == -1) {
+                year = v;
+            }
+            else {
+                return NAN;
+            }
+        }
+        else if ((c == '+' || c == '-') && utc && p + 5 <= end) {
+            // the offset after GMT/UTC, as +hhmm
+            int sign = c == '-' ? -1 : 1;
+            int v = 0;
+            for (int i = 1; i <= 4; i ++) {
+                if (p[i] < '0' || p[i] > '9') return NAN;
+                v = v * 10 + (p[i] - '0');
+            }
+            offset = sign * ((v / 100) * msPerHour + (v % 100) * msPerMinute);
+            p += 5;
+        }
+        else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'z') {
+            const jschar* start = p;
+            while (p < end && (*p | 0x20) >= 'a' && (*p | 0x20) <= 'z') p++;
+            int word_len = p - start;
+            if ((word_len == 3 && ((start[0] == 'G' && start[1] == 'M' && start[2] == 'T') ||
+                                   (start[0] == 'U' && start[1] == 'T' && start[2] == 'C'))) ||
+                (word_len == 1 && start[0] == 'Z')) {
+                utc = EJS_TRUE;
+            }
+            else if (word_len >= 3 && month_from_name (start) != -1 && month == -1) {
+                month = month_from_name (start);
+            }
+            // anything else (day names, AM/PM aside) we ignore
         }
         else {
-            EJS_NOT_IMPLEMENTED();
+            return NAN;
         }
     }
+
+    if (year == -1 || month == -1 || day == -1 || day < 1 || day > 31 || hour > 24 || minute > 59 || second > 59)
+        return NAN;
+
+    double t = MakeDate (MakeDay (year, month, day), MakeTime (hour, minute, second, 0));
+    t = utc ? t - offset : UTC(t);
+    return TimeClip(t);
 }
 
-static EJS_NATIVE_FUNC(_ejs_Date_prototype_toString) {
-    if (!EJSVAL_IS_DATE(*_this))
+static double
+parse_date (ejsval string)
+{
+    EJSPrimString* flat = _ejs_string_flatten(string);
+    const jschar* s = flat->data.flat;
+    int len = flat->length;
+
+    while (len > 0 && IsWhitespace(*s)) {
+        s++;
+        len--;
+    }
+    while (len > 0 && IsWhitespace(s[len - 1]))
+        len--;
+
+    double t = parse_iso_date (s, len);
+    if (isnan(t))
+        t = parse_legacy_date (s, len);
+    return t;
+}
+
+double
+_ejs_date_get_time (EJSDate *date)
+{
+    return date->time;
+}
+
+ejsval _ejs_Date EJSVAL_ALIGNMENT;
+ejsval _ejs_Date_prototype EJSVAL_ALIGNMENT;
+
+// 20.3.4 Properties of the Date Prototype Object
+// the abstract operation thisTimeValue(value)
+static double
+thisTimeValue (ejsval value)
+{
+    if (!EJSVAL_IS_DATE(value))
         _ejs_throw_nativeerror_utf8 (EJS_TYPE_ERROR, "this is not a Date object.");
+    return ((EJSDate*)EJSVAL_TO_OBJECT(value))->time;
+}
 
-    EJSDate *date = (EJSDate*)EJSVAL_TO_OBJECT(*_this);
+// the time value for the Date(year, month[, date[, hours[, minutes[, seconds[, ms]]]]]) arguments,
+// as local time if @local.  20.3.2.1 steps 3.a-3.k, and 20.3.3.4 Date.UTC
+static double
+date_from_components (uint32_t argc, ejsval* args, EJSBool local)
+{
+    // a. Let y be ToNumber(year).
+    double y = argc > 0 ? ToDouble(args[0]) : NAN;
+    // b. Let m be ToNumber(month).
+    double m = argc > 1 ? ToDouble(args[1]) : 0;
+    // c. If date is supplied, let dt be ToNumber(date); else let dt be 1.
+    double dt = argc > 2 ? ToDouble(args[2]) : 1;
+    // d. If hours is supplied, let h be ToNumber(hours); else let h be 0.
+    double h = argc > 3 ? ToDouble(args[3]) : 0;
+    // e. If minutes is supplied, let min be ToNumber(minutes); else let min be 0.
+    double min = argc > 4 ? ToDouble(args[4]) : 0;
+    // f. If seconds is supplied, let s be ToNumber(seconds); else let s be 0.
+    double s = argc > 5 ? ToDouble(args[5]) : 0;
+    // g. If ms is supplied, let milli be ToNumber(ms); else let milli be 0.
+    double milli = argc > 6 ? ToDouble(args[6]) : 0;
+
+    // h. If y is not NaN and 0 ≤ ToInteger(y) ≤ 99, let yr be 1900+ToInteger(y); otherwise, let yr be y.
+    double yr = y;
+    if (!isnan(y) && trunc(y) >= 0 && trunc(y) <= 99)
+        yr = 1900 + trunc(y);
+
+    // i. Let finalDate be MakeDate(MakeDay(yr, m, dt), MakeTime(h, min, s, milli)).
+    double finalDate = MakeDate (MakeDay (yr, m, dt), MakeTime (h, min, s, milli));
+
+    // j. Set the [[DateValue]] internal slot of O to TimeClip(UTC(finalDate)).
+    return TimeClip (local ? UTC(finalDate) : finalDate);
+}
 
-    if (!date->valid) {
-        return _ejs_string_new_utf8 ("Invalid Date");
+// ES2015, June 2015
+// 20.3.2 The Date Constructor
+static EJS_NATIVE_FUNC(_ejs_Date_impl) {
+    // 1. If NewTarget is undefined, then
+    if (EJSVAL_IS_UNDEFINED(newTarget)) {
+        // a. Let now be the Number that is the time value (UTC) identifying the current time.
+        // b. Return ToDateString(now).
+        return date_to_string (current_time(), EJS_TRUE, EJS_TRUE);
     }
 
-    struct tm tm;
+    double tv;
+
+    // 20.3.2.3 Date ( )
+    if (argc == 0) {
+        tv = current_time();
+    }
+    // 20.3.2.2 Date ( value )
+    else if (argc == 1) {
+        ejsval value = args[0];
+        // a. If Type(value) is Object and value has a [[DateValue]] internal slot, then
+        if (EJSVAL_IS_DATE(value)) {
+            //    i. Let tv be thisTimeValue(value).
+            tv = thisTimeValue(value);
+        }
+        // b. Else,
+        else {
+            //    i. Let v be ToPrimitive(value).
+            ejsval v = ToPrimitive(value, TO_PRIM_HINT_DEFAULT);
+            //    ii. If Type(v) is String, then
+            //        1. Let tv be the result of parsing v as a date, in exactly the same manner as for the parse method (20.3.3.2).
+            if (EJSVAL_IS_STRING(v))
+                tv = parse_date (v);
+            //    iii. Else,
+            //        1. Let tv be ToNumber(v).
+            else
+                tv = ToDouble(v);
+        }
+        // c. Set the [[DateValue]] internal slot of O to TimeClip(tv).
+        tv = TimeClip(tv);
+    }
+    // 20.3.2.1 Date ( year, month [, date [ , hours [ , minutes [ , seconds [ , ms ] ] ] ] ] )
+    else {
+        tv = date_from_components (argc, args, EJS_TRUE);
+    }
+
+    // Let O be OrdinaryCreateFromConstructor(NewTarget, "%DatePrototype%", « [[DateValue]]»).
+    ejsval O = OrdinaryCreateFromConstructor(newTarget, _ejs_Date_prototype, &_ejs_Date_specops);
+    *_this = O;
+    ((EJSDate*)EJSVAL_TO_OBJECT(O))->time = tv;
+    return O;
+}
 
-    memset (&tm, 0, sizeof(tm));
+// 20.3.3.1 Date.now ( )
+static EJS_NATIVE_FUNC(_ejs_Date_now) {
+    return NUMBER_TO_EJSVAL(current_time());
+}
 
-    time_t time_in_sec = date->tv.tv_sec;
+// 20.3.3.2 Date.parse ( string )
+static EJS_NATIVE_FUNC(_ejs_Date_parse) {
+    ejsval string = _ejs_undefined;
+    if (argc > 0) string = args[0];
 
-    localtime_r (&time_in_sec, &tm);
+    return NUMBER_TO_EJSVAL(parse_date (ToString(string)));
+}
 
-    // returns strings of the format 'Tue Aug 28 2012 16:45:58 GMT-0700 (PDT)'
+// 20.3.3.4 Date.UTC ( year, month [ , date [ , hours [ , minutes [ , seconds [ , ms ] ] ] ] ] )
+static EJS_NATIVE_FUNC(_ejs_Date_UTC) {
+    return NUMBER_TO_EJSVAL(date_from_components (argc, args, EJS_FALSE));
+}
 
-    char date_buf[256];
-    if (tm.tm_gmtoff == 0)
-        strftime (date_buf, sizeof(date_buf), "%a %b %d %Y %T GMT", &tm);
-    else
-        strftime (date_buf, sizeof(date_buf), "%a %b %d %Y %T GMT%z (%Z)", &tm);
+// the getters in 20.3.4.2-20.3.4.20 are all
+//
+//   1. Let t be thisTimeValue(this value).
+//   2. ReturnIfAbrupt(t).
+//   3. If t is NaN, return NaN.
+//   4. Return Field(LocalTime(t)), or Field(t) for the UTC versions.
+#define DATE_GETTER(name, local, field)                                 \
+    static EJS_NATIVE_FUNC(_ejs_Date_prototype_##name) {                \
+        double t = thisTimeValue(*_this);                               \
+        if (isnan(t))                                                   \
+            return _ejs_nan;                                            \
+        DateFields fields;                                              \
+        date_fields ((local) ? LocalTime(t) : t, &fields);              \
+        return NUMBER_TO_EJSVAL((double)fields.field);                  \
+    }
 
-    return _ejs_string_new_utf8 (date_buf);
+DATE_GETTER(getDate,               EJS_TRUE,  date)
+DATE_GETTER(getDay,                EJS_TRUE,  weekday)
+DATE_GETTER(getFullYear,           EJS_TRUE,  year)
+DATE_GETTER(getHours,              EJS_TRUE,  hours)
+DATE_GETTER(getMilliseconds,       EJS_TRUE,  ms)
+DATE_GETTER(getMinutes,            EJS_TRUE,  minutes)
+DATE_GETTER(getMonth,              EJS_TRUE,  month)
+DATE_GETTER(getSeconds,            EJS_TRUE,  seconds)
+DATE_GETTER(getUTCDate,            EJS_FALSE, date)
+DATE_GETTER(getUTCDay,             EJS_FALSE, weekday)
+DATE_GETTER(getUTCFullYear,        EJS_FALSE, year)
+DATE_GETTER(getUTCHours,           EJS_FALSE, hours)
+DATE_GETTER(getUTCMilliseconds,    EJS_FALSE, ms)
+DATE_GETTER(getUTCMinutes,         EJS_FALSE, minutes)
+DATE_GETTER(getUTCMonth,           EJS_FALSE, month)
+DATE_GETTER(getUTCSeconds,         EJS_FALSE, seconds)
+
+#undef DATE_GETTER
+
+// 20.3.4.10 Date.prototype.getTime ( )
+static EJS_NATIVE_FUNC(_ejs_Date_prototype_getTime) {
+    // 1. Return thisTimeValue(this value).
+    return NUMBER_TO_EJSVAL(thisTimeValue(*_this));
 }
 
+// 20.3.4.44 Date.prototype.valueOf ( )
+static EJS_NATIVE_FUNC(_ejs_Date_prototype_valueOf) {
+    // 1. Return thisTimeValue(this value).
+    return NUMBER_TO_EJSVAL(thisTimeValue(*_this));
+}
+
+// 20.3.4.11 Date.prototype.getTimezoneOffset ( )
 static EJS_NATIVE_FUNC(_ejs_Date_prototype_getTimezoneOffset) {
-    EJSDate *date = (EJSDate*)EJSVAL_TO_OBJECT(*_this);
-    struct tm tm;
+    // 1. Let t be thisTimeValue(this value).
+    double t = thisTimeValue(*_this);
+    // 3. If t is NaN, return NaN.
+    if (isnan(t))
+        return _ejs_nan;
+    // 4. Return (t − LocalTime(t)) / msPerMinute.
+    return NUMBER_TO_EJSVAL((t - LocalTime(t)) / msPerMinute);
+}
 
-    time_t time_in_sec = date->tv.tv_sec;
+// 20.3.4.27 Date.prototype.setTime ( time )
+static EJS_NATIVE_FUNC(_ejs_Date_prototype_setTime) {
+    ejsval time = _ejs_undefined;
+    if (argc > 0) time = args[0];
+
+    // 1. Let t be thisTimeValue(this value).
+    thisTimeValue(*_this);
+    // 3. Let t be ToNumber(time).
+    // 5. Let v be TimeClip(t).
+    double v = TimeClip(ToDouble(time));
+    // 6. Set the [[DateValue]] internal slot of this Date object to v.
+    ((EJSDate*)EJSVAL_TO_OBJECT(*_this))->time = v;
+    // 7. Return v.
+    return NUMBER_TO_EJSVAL(v);
+}
 
-    localtime_r (&time_in_sec, &tm);
+// 20.3.4.36 Date.prototype.toISOString ( )
+static EJS_NATIVE_FUNC(_ejs_Date_prototype_toISOString) {
+    double t = thisTimeValue(*_this);
+    // If the time value of this object is not a finite Number a RangeError exception is thrown.
+    if (!isfinite(t))
+        _ejs_throw_nativeerror_utf8 (EJS_RANGE_ERROR, "Invalid time value");
+
+    DateFields f;
+    date_fields (t, &f);
+
+    // YYYY-MM-DDTHH:mm:ss.sssZ, with ±YYYYYY years outside 0-9999
+    char buf[64];
+    int len;
+    if (f.year >= 0 && f.year <= 9999)
+        len = snprintf (buf, sizeof(buf), "%04d", (int)f.year);
+    else
+        len = snprintf (buf, sizeof(buf), "%c%06lld", f.year < 0 ? '-' : '+', (long long)(f.year < 0 ? -f.year : f.year));
+    len += snprintf (buf + len, sizeof(buf) - len, "-%02d-%02dT%02d:%02d:%02d.%03dZ",
+                     f.month + 1, f.date, f.hours, f.minutes, f.seconds, f.ms);
+    return _ejs_string_new_utf8_len (buf, len);
+}
 
-    return NUMBER_TO_EJSVAL (tm.tm_gmtoff);
+// 20.3.4.37 Date.prototype.toJSON ( key )
+static EJS_NATIVE_FUNC(_ejs_Date_prototype_toJSON) {
+    // 1. Let O be ToObject(this value).
+    // 2. ReturnIfAbrupt(O).
+    ejsval O = ToObject(*_this);
+
+    // 3. Let tv be ToPrimitive(O, hint Number).
+    // 4. ReturnIfAbrupt(tv).
+    ejsval tv = ToPrimitive(O, TO_PRIM_HINT_NUMBER);
+
+    // 5. If Type(tv) is Number and tv is not finite, return null.
+    if (EJSVAL_IS_NUMBER(tv) && !isfinite(EJSVAL_TO_NUMBER(tv)))
+        return _ejs_null;
+
+    // 6. Return Invoke(O, "toISOString").
+    ejsval toISOString = Get(O, _ejs_atom_toISOString);
+    if (!IsCallable(toISOString))
+        _ejs_throw_nativeerror_utf8 (EJS_TYPE_ERROR, "toISOString is not a function");
+    return _ejs_invoke_closure (toISOString, &O, 0, NULL, _ejs_undefined);
 }
 
-static EJS_NATIVE_FUNC(_ejs_Date_prototype_getTime) {
-    return NUMBER_TO_EJSVAL(_ejs_date_get_time ((EJSDate*)EJSVAL_TO_OBJECT(*_this)));
+// 20.3.4.41 Date.prototype.toString ( )
+static EJS_NATIVE_FUNC(_ejs_Date_prototype_toString) {
+    return date_to_string (thisTimeValue(*_this), EJS_TRUE, EJS_TRUE);
 }
 
-static EJS_NATIVE_FUNC(_ejs_Date_now) {
-    struct timeval tv;
-    struct timezone tz;
-    gettimeofday (&tv, &tz);
-    return NUMBER_TO_EJSVAL(tv.tv_sec * 1000 + tv.tv_usec / 1000);
+// 20.3.4.35 Date.prototype.toDateString ( )
+static EJS_NATIVE_FUNC(_ejs_Date_prototype_toDateString) {
+    return date_to_string (thisTimeValue(*_this), EJS_TRUE, EJS_FALSE);
+}
+
+// 20.3.4.42 Date.prototype.toTimeString ( )
+static EJS_NATIVE_FUNC(_ejs_Date_prototype_toTimeString) {
+    return date_to_string (thisTimeValue(*_this), EJS_FALSE, EJS_TRUE);
+}
+
+// 20.3.4.43 Date.prototype.toUTCString ( )
+static EJS_NATIVE_FUNC(_ejs_Date_prototype_toUTCString) {
+    double t = thisTimeValue(*_this);
+    if (isnan(t))
+        return _ejs_string_new_utf8 ("Invalid Date");
+
+    DateFields f;
+    date_fields (t, &f);
+
+    // 'Tue, 28 Aug 2012 23:45:58 GMT'
+    char buf[64];
+    int len = snprintf (buf, sizeof(buf), "%s, %02d %s %s%04lld %02d:%02d:%02d GMT",
+                        day_names[f.weekday], f.date, month_names[f.month],
+                        f.year < 0 ? "-" : "", (long long)(f.year < 0 ? -f.year : f.year),
+                        f.hours, f.minutes, f.seconds);
+    return _ejs_string_new_utf8_len (buf, len);
+}
+
+// 20.3.4.45 Date.prototype [ @@toPrimitive ] ( hint )
+static EJS_NATIVE_FUNC(_ejs_Date_prototype_toPrimitive) {
+    ejsval hint = _ejs_undefined;
+    if (argc > 0) hint = args[0];
+
+    // 1. Let O be the this value.
+    ejsval O = *_this;
+    // 2. If Type(O) is not Object, throw a TypeError exception.
+    if (!EJSVAL_IS_OBJECT(O))
+        _ejs_throw_nativeerror_utf8 (EJS_TYPE_ERROR, "Date.prototype[Symbol.toPrimitive] called on non-object");
+
+    ToPrimitiveHint tryFirst;
+    const jschar* hint_chars = EJSVAL_IS_STRING(hint) ? EJSVAL_TO_FLAT_STRING(hint) : NULL;
+    // 3. If hint is the String value "string" or the String value "default", then
+    if (hint_chars && (!ucs2_strcmp (hint_chars, EJSVAL_TO_FLAT_STRING(_ejs_atom_string)) ||
+                       !ucs2_strcmp (hint_chars, EJSVAL_TO_FLAT_STRING(_ejs_atom_default))))
+        //    a. Let tryFirst be "string".
+        tryFirst = TO_PRIM_HINT_STRING;
+    // 4. Else if hint is the String value "number", then
+    else if (hint_chars && !ucs2_strcmp (hint_chars, EJSVAL_TO_FLAT_STRING(_ejs_atom_number)))
+        //    a. Let tryFirst be "number".
+        tryFirst = TO_PRIM_HINT_NUMBER;
+    // 5. Else, throw a TypeError exception.
+    else
+        _ejs_throw_nativeerror_utf8 (EJS_TYPE_ERROR, "Invalid hint");
+
+    // 6. Return OrdinaryToPrimitive(O, tryFirst).
+    return OrdinaryToPrimitive(O, tryFirst);
 }
 
 void
 _ejs_date_init(ejsval global)
 {
+#if linux && defined(CLOCK_REALTIME_COARSE)
+    struct timespec res;
+    if (clock_getres (CLOCK_REALTIME_COARSE, &res) == 0 && res.tv_sec == 0 && res.tv_nsec <= 1000000)
+        now_clock = CLOCK_REALTIME_COARSE;
+#endif
+
     _ejs_Date = _ejs_function_new_without_proto (_ejs_null, _ejs_atom_Date, _ejs_Date_impl);
     _ejs_object_setprop (global, _ejs_atom_Date, _ejs_Date);
 
     _ejs_gc_add_root (&_ejs_Date_prototype);
     _ejs_Date_prototype = _ejs_object_new(_ejs_null, &_ejs_Date_specops);
-    
+    ((EJSDate*)EJSVAL_TO_OBJECT(_ejs_Date_prototype))->time = NAN;
+
     _ejs_object_setprop (_ejs_Date,       _ejs_atom_prototype,  _ejs_Date_prototype);
 
 #define PROTO_METHOD(x) EJS_INSTALL_ATOM_FUNCTION_FLAGS (_ejs_Date_prototype, x, _ejs_Date_prototype_##x, EJS_PROP_NOT_ENUMERABLE)
 #define OBJ_METHOD(x) EJS_INSTALL_ATOM_FUNCTION_FLAGS (_ejs_Date, x, _ejs_Date_##x, EJS_PROP_NOT_ENUMERABLE)
 
     PROTO_METHOD(toString);
+    PROTO_METHOD(toDateString);
+    PROTO_METHOD(toTimeString);
+    PROTO_METHOD(toUTCString);
+    PROTO_METHOD(toISOString);
+    PROTO_METHOD(toJSON);
+    PROTO_METHOD(valueOf);
     PROTO_METHOD(getTime);
+    PROTO_METHOD(setTime);
     PROTO_METHOD(getTimezoneOffset);
+    PROTO_METHOD(getDate);
+    PROTO_METHOD(getDay);
+    PROTO_METHOD(getFullYear);
+    PROTO_METHOD(getHours);
+    PROTO_METHOD(getMilliseconds);
+    PROTO_METHOD(getMinutes);
+    PROTO_METHOD(getMonth);
+    PROTO_METHOD(getSeconds);
+    PROTO_METHOD(getUTCDate);
+    PROTO_METHOD(getUTCDay);
+    PROTO_METHOD(getUTCFullYear);
+    PROTO_METHOD(getUTCHours);
+    PROTO_METHOD(getUTCMilliseconds);
+    PROTO_METHOD(getUTCMinutes);
+    PROTO_METHOD(getUTCMonth);
+    PROTO_METHOD(getUTCSeconds);
+
+    EJS_INSTALL_SYMBOL_FUNCTION_FLAGS (_ejs_Date_prototype, toPrimitive, _ejs_Date_prototype_toPrimitive, EJS_PROP_NOT_ENUMERABLE | EJS_PROP_CONFIGURABLE);
 
     OBJ_METHOD(now);
+    OBJ_METHOD(parse);
+    OBJ_METHOD(UTC);
 
 #undef PROTO_METHOD
+#undef OBJ_METHOD
 }
 
 static EJSObject*
@@ -5,8 +5,6 @@
 #ifndef _ejs_date_h_
 #define _ejs_date_h_
 
-#include <time.h>
-#include <sys/time.h>
 #include "ejs-object.h"
 
 typedef struct {
@@ -14,9 +12,7 @@ typedef struct {
     EJSObject obj;
 
     /* date specific data */
-    EJSBool valid;
-    struct timeval tv;
-    struct timezone tz;
+    double time; // [[DateValue]], ms since the epoch in UTC.  NaN for an invalid date
 } EJSDate;
 
 
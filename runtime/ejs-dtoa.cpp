@@ -1,15 +1,170 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+ * vim: set ts=4 sw=4 et tw=99 ft=cpp:
+ */
+
+// all the number <-> string conversions in the runtime go through here,
+// so they share double-conversion's correctly rounded algorithms.
+
 #include <stdio.h>
+#include <string.h>
+#include <math.h>
 #include "double-conversion/double-conversion.h"
 
+#include "ejs-ops.h"
+
 using namespace double_conversion;
 
+static const char radix_chars[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+static int
+finish (StringBuilder* builder)
+{
+    int len = builder->position();
+    builder->Finalize();
+    return len;
+}
+
+// the part of Number.prototype.toString that isn't ToString.  this
+// generates only as many fraction digits as the double actually has
+// precision for, so 0.1.toString(3) doesn't go on forever, and rounds the
+// last one.
+static int
+dtoa_radix (double d, int radix, char* out)
+{
+    // enough for the integer digits of DBL_MAX in base 2 on one side of
+    // the middle, and the fraction digits of the smallest denormal on the
+    // other.
+    char buffer[2200];
+    int integer_cursor = sizeof(buffer) / 2;
+    int fraction_cursor = integer_cursor;
+
+    bool negative = d < 0;
+    if (negative)
+        d = -d;
+
+    double integer = floor(d);
+    double fraction = d - integer;
+    // half the distance to the next double is as far as we can tell digits apart
+    double delta = 0.5 * (nextafter(d, INFINITY) - d);
+    if (delta == 0)
+        delta = nextafter(0.0, 1.0);
+
+    if (fraction >= delta) {
+        buffer[fraction_cursor++] = '.';
+        do {
+            fraction *= radix;
+            delta *= radix;
+            int digit = (int)fraction;
+            buffer[fraction_cursor++] = radix_chars[digit];
+            fraction -= digit;
+            // round half to even if the rest doesn't fit in the precision
+            if ((fraction > 0.5 || (fraction == 0.5 && (digit & 1))) && fraction + delta > 1) {
+                // propagate the carry back through the fraction, and maybe
+                // into the integer part
+                for (;;) {
+                    fraction_cursor--;
+                    if (fraction_cursor == (int)sizeof(buffer) / 2) {
+                        integer += 1;
+                        break;
+                    }
+                    char c = buffer[fraction_cursor];
+                    int digit = c > '9' ? c - 'a' + 10 : c - '0';
+                    if (digit + 1 < radix) {
+                        buffer[fraction_cursor++] = radix_chars[digit + 1];
+                        break;
+                    }
+                }
+                break;
+            }
+        } while (fraction >= delta);
+    }
+
+    // digits below the precision of the integer part are zeros
+    while (integer / radix >= 9007199254740992.0) {
+        integer /= radix;
+        buffer[--integer_cursor] = '0';
+    }
+    do {
+        double remainder = fmod(integer, radix);
+        buffer[--integer_cursor] = radix_chars[(int)remainder];
+        integer = (integer - remainder) / radix;
+    } while (integer > 0);
+
+    if (negative)
+        buffer[--integer_cursor] = '-';
+
+    int len = fraction_cursor - integer_cursor;
+    memcpy (out, buffer + integer_cursor, len);
+    out[len] = '\0';
+    return len;
+}
+
+static const StringToDoubleConverter&
+decimal_converter ()
+{
+    static StringToDoubleConverter converter(StringToDoubleConverter::ALLOW_TRAILING_JUNK,
+                                             0.0, NAN, "Infinity", NULL);
+    return converter;
+}
+
+static const StringToDoubleConverter&
+hex_converter ()
+{
+    static StringToDoubleConverter converter(StringToDoubleConverter::ALLOW_TRAILING_JUNK | StringToDoubleConverter::ALLOW_HEX,
+                                             0.0, NAN, NULL, NULL);
+    return converter;
+}
+
 extern "C" {
 
-void
-_ejs_dtoa(double d, char* buf, size_t buf_size) {
-  StringBuilder builder(buf, buf_size);
-  DoubleToStringConverter::EcmaScriptConverter().ToShortest(d, &builder);
-  builder.Finalize();
+int
+_ejs_dtoa_shortest (double d, char* buf)
+{
+    StringBuilder builder(buf, EJS_DTOA_BUFFER_SIZE);
+    DoubleToStringConverter::EcmaScriptConverter().ToShortest(d, &builder);
+    return finish (&builder);
+}
+
+int
+_ejs_dtoa_radix (double d, int radix, char* buf)
+{
+    if (radix == 10 || !isfinite(d))
+        return _ejs_dtoa_shortest (d, buf);
+    return dtoa_radix (d, radix, buf);
+}
+
+int
+_ejs_dtoa_fixed (double d, int digits, char* buf)
+{
+    // ToFixed can't do these, and toFixed uses ToString for them anyway
+    if (!isfinite(d) || fabs(d) >= 1e21)
+        return _ejs_dtoa_shortest (d, buf);
+    StringBuilder builder(buf, EJS_DTOA_BUFFER_SIZE);
+    DoubleToStringConverter::EcmaScriptConverter().ToFixed(d, digits, &builder);
+    return finish (&builder);
+}
+
+int
+_ejs_dtoa_exponential (double d, int digits, char* buf)
+{
+    StringBuilder builder(buf, EJS_DTOA_BUFFER_SIZE);
+    DoubleToStringConverter::EcmaScriptConverter().ToExponential(d, digits, &builder);
+    return finish (&builder);
+}
+
+int
+_ejs_dtoa_precision (double d, int precision, char* buf)
+{
+    StringBuilder builder(buf, EJS_DTOA_BUFFER_SIZE);
+    DoubleToStringConverter::EcmaScriptConverter().ToPrecision(d, precision, &builder);
+    return finish (&builder);
+}
+
+double
+_ejs_strtod (const jschar* chars, int length, EJSBool hex, int* processed)
+{
+    const StringToDoubleConverter& converter = hex ? hex_converter() : decimal_converter();
+    return converter.StringToDouble(chars, length, processed);
 }
 
 };
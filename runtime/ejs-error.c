@@ -59,7 +59,7 @@ ejsval _ejs_URIError_prototype EJSVAL_ALIGNMENT;
             /* b. Let msgDesc be the PropertyDescriptor{[[Value]]: msg, [[Writable]]: true, [[Enumerable]]: false, [[Configurable]]: true}. */ \
             /* c. Let status be DefinePropertyOrThrow(O, "message", msgDesc). */ \
             /* d. Assert: status is not an abrupt completion. */        \
-            _ejs_object_setprop (*_this, _ejs_atom_message, ToString(args[0])); \
+            _ejs_object_setprop (*_this, _ejs_atom_message, msg);    \
         }                                                               \
         /* 5. Return O. */                                              \
         return O;                                                       \
@@ -15,7 +15,12 @@
 #include <execinfo.h>
 
 
-#define spew 1
+// logs every throw/catch (and dumps the thrown value) to the ejs log.
+// build with -DEJS_EXCEPTION_SPEW=1 when debugging the unwinder.
+#ifndef EJS_EXCEPTION_SPEW
+#define EJS_EXCEPTION_SPEW 0
+#endif
+#define spew EJS_EXCEPTION_SPEW
 #if spew
 #define SPEW(x) x
 #else
@@ -144,6 +149,25 @@ struct ejs_typeinfo EJS_EHTYPE_ejsvalue = {
  * Exception personality
  **********************************************************************/
 
+// The C++ personality decodes the frame's LSDA call site table every
+// time an exception passes through it, in both unwind phases.  Most
+// frames an exception passes through have no landing pad for the call
+// that threw (calls outside any try block), so we remember those call
+// sites and skip the decoding the next time.  Only _URC_CONTINUE_UNWIND
+// is cached, anything else modifies the unwind context.
+
+#define PERSONALITY_CACHE_SIZE 256
+
+typedef struct {
+    uintptr_t ip;
+    uint64_t exceptionClass;
+    _Unwind_Action actions;
+} PersonalityCacheEntry;
+
+static PersonalityCacheEntry personality_cache[PERSONALITY_CACHE_SIZE];
+
+#define PERSONALITY_CACHE_ENTRY(ip) (&personality_cache[((ip) >> 2) % PERSONALITY_CACHE_SIZE])
+
 _Unwind_Reason_Code 
 EJS_PERSONALITY(int version,
                 _Unwind_Action actions,
@@ -151,15 +175,31 @@ EJS_PERSONALITY(int version,
                 struct _Unwind_Exception *exceptionObject,
                 struct _Unwind_Context *context)
 {
+    uintptr_t ip = _Unwind_GetIP(context);
+
     //SPEW(_ejs_log ("EXCEPTIONS: %s through frame [ip=%p sp=%p] "
     SPEW(_ejs_log ("EXCEPTIONS: through frame [ip=%p sp=%p] "
                  "for exception %p\n", 
-                 (void*)(_Unwind_GetIP(context)-1),
+                 (void*)(ip-1),
                  (void*)_Unwind_GetCFA(context), exceptionObject));
 
+    // handler frames and forced unwinds always go through C++
+    EJSBool cacheable = actions == _UA_SEARCH_PHASE || actions == _UA_CLEANUP_PHASE;
+
+    PersonalityCacheEntry* entry = PERSONALITY_CACHE_ENTRY(ip);
+    if (cacheable && entry->ip == ip && entry->exceptionClass == exceptionClass && entry->actions == actions)
+        return _URC_CONTINUE_UNWIND;
+
     // Let C++ handle the unwind itself.
-    return CXX_PERSONALITY(version, actions, exceptionClass, 
-                           exceptionObject, context);
+    _Unwind_Reason_Code rv = CXX_PERSONALITY(version, actions, exceptionClass, 
+                                             exceptionObject, context);
+
+    if (cacheable && rv == _URC_CONTINUE_UNWIND) {
+        entry->ip = ip;
+        entry->exceptionClass = exceptionClass;
+        entry->actions = actions;
+    }
+    return rv;
 }
 
 
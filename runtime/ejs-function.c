@@ -444,13 +444,60 @@ _ejs_construct_closure_apply (ejsval _closure, ejsval* _this, uint32_t argc, ejs
 
     EJS_ASSERT(EJSVAL_IS_ARRAY(args_array));
 
-    *_this = Construct(_closure, newTarget, EJS_ARRAY_LEN(args_array), EJS_DENSE_ARRAY_ELEMENTS(args_array));
+    if (EJSVAL_IS_DENSE_ARRAY(args_array)) {
+        *_this = Construct(_closure, newTarget, EJS_ARRAY_LEN(args_array), EJS_DENSE_ARRAY_ELEMENTS(args_array));
+    }
+    else {
+        // a spread of a sparse array.  copy it out, holes and all
+        uint32_t n = EJS_ARRAY_LEN(args_array);
+        ejsval* argList = (ejsval*)malloc(sizeof(ejsval) * (n > 0 ? n : 1));
+        for (uint32_t i = 0; i < n; i ++)
+            argList[i] = _ejs_object_getprop (args_array, NUMBER_TO_EJSVAL(i));
+        *_this = Construct(_closure, newTarget, n, argList);
+        free (argList);
+    }
 
     EJS_ASSERT(!EJSVAL_IS_UNDEFINED(*_this));
 
     return *_this;
 }
 
+// func.apply(thisArg, [...prefix, ...rest]), for calls that forward
+// their arguments or rest parameter.  as long as apply is the builtin
+// we skip the array and call func with the arguments directly.
+ejsval
+_ejs_invoke_closure_forward (ejsval func, ejsval apply, ejsval thisArg, uint32_t nprefix, ejsval* prefix, uint32_t nrest, ejsval* rest)
+{
+    uint32_t argc = nprefix + nrest;
+    ejsval* args = rest;
+    // too many arguments to put on the stack go in a GC'ed array instead,
+    // so nothing leaks if the callee throws
+    ejsval args_array = _ejs_undefined;
+
+    if (nprefix > 0) {
+        if (argc > 64) {
+            args_array = _ejs_array_new_copy (nprefix, prefix);
+            if (nrest > 0)
+                _ejs_array_push_dense (args_array, nrest, rest);
+            args = EJS_DENSE_ARRAY_ELEMENTS(args_array);
+        }
+        else {
+            args = alloca(sizeof(ejsval) * argc);
+            memcpy (args, prefix, sizeof(ejsval) * nprefix);
+            if (nrest > 0)
+                memcpy (args + nprefix, rest, sizeof(ejsval) * nrest);
+        }
+    }
+
+    if (EJSVAL_IS_NATIVE_FUNCTION(apply, _ejs_Function_prototype_apply) && EJSVAL_IS_FUNCTION(func))
+        return OP(EJSVAL_TO_OBJECT(func), Call)(func, thisArg, argc, argc == 0 ? NULL : args);
+
+    if (EJSVAL_IS_UNDEFINED(args_array))
+        args_array = _ejs_array_new_copy (argc, args);
+    ejsval apply_args[2] = { thisArg, args_array };
+    return _ejs_invoke_closure (apply, &func, 2, apply_args, _ejs_undefined);
+}
+
 // ECMA262: 15.3.5.3
 static EJSBool
 _ejs_function_specop_has_instance (ejsval F, ejsval V)
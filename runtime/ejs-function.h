@@ -38,6 +38,7 @@ typedef struct {
 EJS_BEGIN_DECLS
 
 #define EJSVAL_IS_BOUND_FUNCTION(o) (EJSVAL_IS_FUNCTION(o) && ((EJSFunction*)EJSVAL_TO_OBJECT(o))->bound)
+#define EJSVAL_IS_NATIVE_FUNCTION(o,f) (EJSVAL_IS_FUNCTION(o) && ((EJSFunction*)EJSVAL_TO_OBJECT(o))->func == (f))
 
 #define EJS_INSTALL_ATOM_FUNCTION(o,n,f) EJS_MACRO_START                \
     ejsval tmpfunc = _ejs_function_new_native (_ejs_null, _ejs_atom_##n, f); \
@@ -112,6 +113,7 @@ EJSBool _ejs_decompose_closure (ejsval closure, EJSClosureFunc* func, ejsval* en
 
 ejsval  _ejs_construct_closure (ejsval closure, ejsval* unused_this, uint32_t argc, ejsval* args, ejsval newTarget);
 ejsval  _ejs_construct_closure_apply (ejsval closure, ejsval* unused_this, uint32_t argc, ejsval* args, ejsval newTarget);
+ejsval  _ejs_invoke_closure_forward (ejsval func, ejsval apply, ejsval thisArg, uint32_t nprefix, ejsval* prefix, uint32_t nrest, ejsval* rest);
 
 extern ejsval _ejs_function_new (ejsval env, ejsval name, EJSClosureFunc func);
 extern ejsval _ejs_function_new_native (ejsval env, ejsval name, EJSClosureFunc func);
@@ -975,20 +975,29 @@ mark_from_modules()
 #error "put code here to mark registers"
 #endif
 
+#define MAX_GENERATORS 256
+static int generator_count = 0;
+static EJSGenerator* generators[MAX_GENERATORS];
+
 static void
 mark_thread_stack()
 {
     MARK_REGISTERS;
 
     GCObjectPtr stack_top = NULL;
+    void* top = ((void*)&stack_top) + sizeof(GCObjectPtr);
+
+    // if a generator is running we're on its stack, not the thread's.
+    // the thread's stack is live from where the outermost one was resumed.
+    if (generator_count > 0) {
+        EJSGenerator* gen = generators[generator_count - 1];
+        mark_ejsvals_in_range(top, (char*)gen->stack + EJS_GENERATOR_STACK_SIZE);
+        top = EJS_UCONTEXT_SP(&generators[0]->caller_context);
+    }
 
-    mark_ejsvals_in_range(((void*)&stack_top) + sizeof(GCObjectPtr), stack_bottom);
+    mark_ejsvals_in_range(top, stack_bottom);
 }
 
-#define MAX_GENERATORS 256
-static int generator_count = 0;
-static EJSGenerator* generators[MAX_GENERATORS];
-
 void
 _ejs_gc_push_generator(EJSGenerator* gen)
 {
@@ -1001,13 +1010,18 @@ _ejs_gc_pop_generator()
     generator_count--;
 }
 
+// each running generator but the innermost (whose stack we're on, see
+// mark_thread_stack) is suspended where it resumed the next one, with
+// its registers saved in that one's caller_context.
 static void
 mark_generator_stacks()
 {
     for (int i = 0; i < generator_count; i++) {
         EJSGenerator* gen = generators[i];
-        
-        // XXX mark the actual stack
+
+        mark_ejsvals_in_range(&gen->caller_context, (char*)&gen->caller_context + sizeof(ucontext_t));
+        if (i > 0)
+            mark_ejsvals_in_range(EJS_UCONTEXT_SP(&gen->caller_context), (char*)generators[i-1]->stack + EJS_GENERATOR_STACK_SIZE);
     }
 }
 
@@ -1051,6 +1065,9 @@ _ejs_gc_collect_inner(EJSBool shutting_down)
 #endif
 
     if (!shutting_down) {
+        // the cache doesn't keep its strings alive
+        _ejs_number_string_cache_clear();
+
         mark_from_roots();
 
         total_objs = num_roots;
@@ -1303,6 +1320,23 @@ release_to_los (LargeObjectInfo *lobj)
 size_t alloc_size = 0;
 int num_allocs = 0;
 size_t alloc_size_at_last_gc = 0;
+size_t external_size = 0;
+
+void
+_ejs_gc_add_external_bytes(size_t bytes)
+{
+    // external bytes count toward the next collection the same as heap allocations, so
+    // that dropping references to large external buffers actually gets them released.
+    alloc_size += bytes;
+    external_size += bytes;
+}
+
+void
+_ejs_gc_remove_external_bytes(size_t bytes)
+{
+    EJS_ASSERT(external_size >= bytes);
+    external_size -= bytes;
+}
 
 GCObjectPtr
 _ejs_gc_alloc(size_t size, EJSScanType scan_type)
@@ -1514,6 +1548,7 @@ static EJS_NATIVE_FUNC(_ejs_GC_dumpAllocationStats) {
     _ejs_log ("  objects: %d\n", num_object_allocs);
     _ejs_log ("  closureenv: %d\n", num_closureenv_allocs);
     _ejs_log ("  primstr: %d\n", num_primstr_allocs);
+    _ejs_log ("  external: %zd bytes\n", external_size);
 
     num_object_allocs = 0;
     num_closureenv_allocs = 0;
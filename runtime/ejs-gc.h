@@ -41,6 +41,12 @@ extern GCObjectPtr _ejs_gc_alloc(size_t size, EJSScanType scan_type);
 #define _ejs_gc_new_closureenv(sz)                                             \
   (EJSClosureEnv *)_ejs_gc_alloc(sz, EJS_SCAN_TYPE_CLOSUREENV)
 
+// memory owned by GC objects but allocated outside the GC heap (e.g. external ArrayBuffer
+// storage).  adding external bytes counts toward the allocation threshold that triggers a
+// collection.
+extern void _ejs_gc_add_external_bytes(size_t bytes);
+extern void _ejs_gc_remove_external_bytes(size_t bytes);
+
 extern void _ejs_gc_add_root(ejsval *val);
 extern void _ejs_gc_remove_root(ejsval *root);
 
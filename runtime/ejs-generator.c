@@ -114,8 +114,6 @@ _ejs_iterator_wrapper_new (ejsval iterator)
     return OBJECT_TO_EJSVAL(rv);
 }
 
-#define GENERATOR_STACK_SIZE 64 * 1024
-
 static void
 _ejs_generator_start(EJSGenerator* gen)
 {
@@ -135,13 +133,17 @@ _ejs_generator_new (ejsval generator_body)
 
     rv->body = generator_body;
     rv->started = EJS_FALSE;
+    rv->state_machine = EJS_FALSE;
+    rv->running = EJS_FALSE;
+    rv->done = EJS_FALSE;
+    rv->throwing = EJS_FALSE;
     rv->yielded_value = _ejs_undefined;
     rv->sent_value = _ejs_undefined;
 
-    rv->stack = malloc(GENERATOR_STACK_SIZE);
+    rv->stack = malloc(EJS_GENERATOR_STACK_SIZE);
     getcontext(&rv->generator_context);
     rv->generator_context.uc_stack.ss_sp = rv->stack;
-    rv->generator_context.uc_stack.ss_size = GENERATOR_STACK_SIZE;
+    rv->generator_context.uc_stack.ss_size = EJS_GENERATOR_STACK_SIZE;
     rv->generator_context.uc_link = &rv->caller_context;
     makecontext(&rv->generator_context, (void(*)(void))_ejs_generator_start, 1, rv);
     memset(&rv->caller_context, 0, sizeof(rv->caller_context));
@@ -149,6 +151,70 @@ _ejs_generator_new (ejsval generator_body)
     return OBJECT_TO_EJSVAL(rv);
 }
 
+ejsval
+_ejs_generator_new_state_machine (ejsval step)
+{
+    EJSGenerator* rv = _ejs_gc_new(EJSGenerator);
+    _ejs_init_object ((EJSObject*)rv, _ejs_Generator_prototype, &_ejs_Generator_specops);
+
+    rv->body = step;
+    rv->started = EJS_FALSE;
+    rv->state_machine = EJS_TRUE;
+    rv->running = EJS_FALSE;
+    rv->done = EJS_FALSE;
+    rv->throwing = EJS_FALSE;
+    rv->yielded_value = _ejs_undefined;
+    rv->sent_value = _ejs_undefined;
+    rv->stack = NULL;
+
+    return OBJECT_TO_EJSVAL(rv);
+}
+
+// the step function returns the value of this when the generator body
+// completes, instead of the value it yields
+ejsval
+_ejs_generator_complete (ejsval generator, ejsval value)
+{
+    EJSGenerator* gen = (EJSGenerator*)EJSVAL_TO_OBJECT(generator);
+    gen->done = EJS_TRUE;
+    return value;
+}
+
+static ejsval
+_ejs_generator_resume_state_machine (ejsval generator, ejsval arg, EJSBool throwing)
+{
+    EJSGenerator* gen = (EJSGenerator*)EJSVAL_TO_OBJECT(generator);
+
+    if (gen->running)
+        _ejs_throw_nativeerror_utf8(EJS_TYPE_ERROR, "generator is already running");
+
+    // throwing into a generator that hasn't started completes it without running any of it
+    if (throwing && !gen->started)
+        gen->done = EJS_TRUE;
+
+    if (gen->done) {
+        if (throwing)
+            _ejs_throw(arg);
+        return _ejs_create_iter_result(_ejs_undefined, _ejs_true);
+    }
+
+    gen->started = EJS_TRUE;
+    gen->running = EJS_TRUE;
+
+    ejsval step_args[2] = { arg, throwing ? _ejs_true : _ejs_false };
+    ejsval undef_this = _ejs_undefined;
+    ejsval rv;
+    EJSBool success = _ejs_invoke_closure_catch (&rv, gen->body, &undef_this, 2, step_args, _ejs_undefined);
+
+    gen->running = EJS_FALSE;
+    if (!success) {
+        gen->done = EJS_TRUE;
+        _ejs_throw(rv);
+    }
+
+    return _ejs_create_iter_result(rv, gen->done ? _ejs_true : _ejs_false);
+}
+
 ejsval
 _ejs_generator_yield (ejsval generator, ejsval arg) {
     EJSGenerator* gen = (EJSGenerator*)EJSVAL_TO_OBJECT(generator);
@@ -170,6 +236,9 @@ _ejs_generator_yield (ejsval generator, ejsval arg) {
 static ejsval
 _ejs_generator_send (ejsval generator, ejsval arg) {
     EJSGenerator* gen = (EJSGenerator*)EJSVAL_TO_OBJECT(generator);
+    if (gen->state_machine)
+        return _ejs_generator_resume_state_machine(generator, arg, EJS_FALSE);
+
     gen->yielded_value = _ejs_undefined;
     gen->sent_value = arg;
     swapcontext(&gen->caller_context, &gen->generator_context);
@@ -179,6 +248,9 @@ _ejs_generator_send (ejsval generator, ejsval arg) {
 static ejsval
 _ejs_generator_throw (ejsval generator, ejsval arg) {
     EJSGenerator* gen = (EJSGenerator*)EJSVAL_TO_OBJECT(generator);
+    if (gen->state_machine)
+        return _ejs_generator_resume_state_machine(generator, arg, EJS_TRUE);
+
     gen->yielded_value = _ejs_undefined;
     gen->sent_value = arg;
     gen->throwing = EJS_TRUE;
@@ -198,8 +270,28 @@ static EJS_NATIVE_FUNC(_ejs_Generator_prototype_throw) {
 }
 
 static EJS_NATIVE_FUNC(_ejs_Generator_prototype_return) {
-    printf ("generator .return not implemented\n");
-    abort();
+    ejsval O = *_this;
+    if (!EJSVAL_IS_OBJECT(O))
+        _ejs_throw_nativeerror_utf8(EJS_TYPE_ERROR, ".return called on non-object");
+
+    if (!EJSVAL_IS_GENERATOR(O))
+        _ejs_throw_nativeerror_utf8(EJS_TYPE_ERROR, ".return called on non-generator");
+
+    EJSGenerator* gen = (EJSGenerator*)EJSVAL_TO_OBJECT(O);
+
+    // we can't unwind a generator running on its own stack
+    if (!gen->state_machine) {
+        printf ("generator .return not implemented\n");
+        abort();
+    }
+
+    if (gen->running)
+        _ejs_throw_nativeerror_utf8(EJS_TYPE_ERROR, "generator is already running");
+
+    // state machines never contain a try statement, so there are no
+    // finally blocks to run, and the generator simply completes.
+    gen->done = EJS_TRUE;
+    return _ejs_create_iter_result(argc > 0 ? args[0] : _ejs_undefined, _ejs_true);
 }
 
 static EJS_NATIVE_FUNC(_ejs_Generator_prototype_next) {
@@ -270,30 +362,12 @@ _ejs_generator_specop_scan (EJSObject* obj, EJSValueFunc scan_func)
     _ejs_gc_mark_conservative_range(&gen->generator_context, (char*)&gen->generator_context + sizeof(ucontext_t));
     _ejs_gc_mark_conservative_range(&gen->caller_context, (char*)&gen->caller_context + sizeof(ucontext_t));
 
+    // the live part of a suspended generator's stack is above the
+    // saved sp.  running generators are marked by the collector itself,
+    // see mark_generator_stacks.
     if (gen->stack) {
-        _ejs_gc_mark_conservative_range(gen->stack,
-#if __APPLE__
-#if TARGET_CPU_AMD64
-                                        (void*)gen->generator_context.__mcontext_data.__ss.__rsp
-#elif TARGET_CPU_X86
-                                        (void*)gen->generator_context.__mcontext_data.__ss.__esp
-#elif TARGET_CPU_ARM
-                                        (void*)gen->generator_context.__mcontext_data.__ss.__sp
-#elif TARGET_CPU_AARCH64
-                                        (void*)gen->generator_context.__mcontext_data.__ss.__sp
-#else
-#error "unimplemented darwin cpu arch"
-#endif
-#elif linux
-#if TARGET_CPU_AMD64
-                                        (void*)gen->generator_context.uc_mcontext.gregs[REG_RSP]
-#else
-#error "unimplemented linux cpu arch"
-#endif
-#else
-#error "unimplemented platform"
-#endif
-                                    );
+        _ejs_gc_mark_conservative_range(EJS_UCONTEXT_SP(&gen->generator_context),
+                                        (char*)gen->stack + EJS_GENERATOR_STACK_SIZE);
     }
 
     _ejs_Object_specops.Scan (obj, scan_func);
@@ -13,12 +13,45 @@ EJS_BEGIN_DECLS
 
 #define EJSVAL_IS_GENERATOR(v)  (EJSVAL_IS_OBJECT(v) && (EJSVAL_TO_OBJECT(v)->ops == &_ejs_Generator_specops))
 
+#define EJS_GENERATOR_STACK_SIZE (64 * 1024)
+
+// the stack pointer saved in a ucontext_t*
+#if __APPLE__
+#if TARGET_CPU_AMD64
+#define EJS_UCONTEXT_SP(ctx) ((void*)(ctx)->__mcontext_data.__ss.__rsp)
+#elif TARGET_CPU_X86
+#define EJS_UCONTEXT_SP(ctx) ((void*)(ctx)->__mcontext_data.__ss.__esp)
+#elif TARGET_CPU_ARM
+#define EJS_UCONTEXT_SP(ctx) ((void*)(ctx)->__mcontext_data.__ss.__sp)
+#elif TARGET_CPU_AARCH64
+#define EJS_UCONTEXT_SP(ctx) ((void*)(ctx)->__mcontext_data.__ss.__sp)
+#else
+#error "unimplemented darwin cpu arch"
+#endif
+#elif linux
+#if TARGET_CPU_AMD64
+#define EJS_UCONTEXT_SP(ctx) ((void*)(ctx)->uc_mcontext.gregs[REG_RSP])
+#else
+#error "unimplemented linux cpu arch"
+#endif
+#else
+#error "unimplemented platform"
+#endif
+
 typedef struct {
     /* object header */
     EJSObject obj;
 
     EJSBool started;
 
+    // for generators the compiler turned into state machines, body is
+    // the step function, called with (sent_value, throwing) to run up
+    // to the next yield.  the generator's locals live in its closure
+    // env, and there's no stack.
+    EJSBool state_machine;
+    EJSBool running;
+    EJSBool done;
+
     ejsval body;
 
     ejsval yielded_value;
@@ -42,6 +75,8 @@ extern ejsval _ejs_Generator_prototype;
 extern EJSSpecOps _ejs_Generator_specops;
 
 extern ejsval _ejs_generator_new (ejsval generator_body);
+extern ejsval _ejs_generator_new_state_machine (ejsval step);
+extern ejsval _ejs_generator_complete (ejsval generator, ejsval value);
 
 extern void _ejs_generator_init (ejsval global);
 
@@ -26,6 +26,7 @@
 #include "ejs-regexp.h"
 #include "ejs-require.h"
 #include "ejs-stream.h"
+#include "ejs-output.h"
 #include "ejs-string.h"
 #include "ejs-symbol.h"
 #include "ejs-timers.h"
@@ -95,6 +96,8 @@ _ejs_init_classes()
     _ejs_Class_initialize (&_ejs_Date_specops, &_ejs_Object_specops);
     _ejs_Class_initialize (&_ejs_Error_specops, &_ejs_Object_specops);
     _ejs_Class_initialize (&_ejs_Function_specops, &_ejs_Object_specops);
+    _ejs_Class_initialize (&_ejs_JSONParser_specops, &_ejs_Object_specops);
+    _ejs_Class_initialize (&_ejs_JSONWriter_specops, &_ejs_Object_specops);
     _ejs_Class_initialize (&_ejs_Map_specops, &_ejs_Object_specops);
     _ejs_Class_initialize (&_ejs_MapIterator_specops, &_ejs_Object_specops);
     _ejs_Class_initialize (&_ejs_WeakMap_specops, &_ejs_Object_specops);
@@ -228,6 +231,7 @@ _ejs_init(int argc, char** argv)
     // the node-like api we support in order for our driver to
     // function.  this should really be a separate opt-in .a/.so.
     _ejs_require_init(_ejs_global);
+    _ejs_output_init();
     _ejs_console_init(_ejs_global);
     _ejs_stream_init(_ejs_global);
     _ejs_process_init(_ejs_global, argc, argv);
@@ -244,7 +248,9 @@ _ejs_init(int argc, char** argv)
     _ejs_object_setprop (_ejs_global, _ejs_atom___ejs, _ejs__ejs);
 
     _ejs_GC_init(_ejs__ejs);
+    _ejs_json_stream_init(_ejs__ejs);
     _ejs_gc_allocate_oom_exceptions();
 
     EJS_INSTALL_ATOM_FUNCTION_FLAGS(_ejs__ejs, unhandledException, _ejs_unhandledException, 0);
+    EJS_INSTALL_ATOM_FUNCTION_FLAGS(_ejs__ejs, numberStringCacheStats, _ejs_numberStringCacheStats, 0);
 }
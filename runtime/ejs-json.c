@@ -2,6 +2,8 @@
  * vim: set ts=4 sw=4 et tw=99 ft=cpp:
  */
 
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <math.h>
 
@@ -15,122 +17,515 @@
 #include "ejs-string.h"
 #include "ejs-boolean.h"
 #include "ejs-symbol.h"
-#include "../parson/parson.h"
+#include "ejs-error.h"
+#include "ejs-typedarrays.h"
 
 ejsval _ejs_JSON EJSVAL_ALIGNMENT;
 
-static EJSBool
-json_value_to_ejsval(JSON_Value *v, ejsval *rv)
+#define JSON_MAX_NESTING 2048
+#define JSON_KEY_CACHE_SIZE 256 // must be a power of 2
+#define JSON_KEY_CACHE_MAX_LENGTH 32
+
+// a recursive descent parser that works directly on the flattened
+// ucs2 text and creates the final objects/arrays as it goes.
+typedef struct {
+    const jschar* text;
+    const jschar* p;
+    const jschar* end;
+    int depth;
+
+    // where text starts in the whole input, for error messages.  only
+    // non-zero for the streaming parser.
+    int64_t base;
+
+    // the contents of strings containing escapes are decoded here
+    jschar* buf;
+    int buf_len;
+    int buf_alloc;
+
+    // property names we've created.  JSON documents tend to have lots
+    // of objects with the same keys, and sharing the strings saves
+    // both the allocation and (since the string caches its hash) the
+    // hashing when we insert them.  this lives on the C stack, so the
+    // conservative scan keeps the strings alive.
+    ejsval keys[JSON_KEY_CACHE_SIZE];
+} JSONParser;
+
+static ejsval json_parse_value (JSONParser* parser);
+
+static void json_throw (JSONParser* parser, EJSNativeErrorType error_type, const char* msg) __attribute__ ((noreturn));
+static void json_syntax_error (JSONParser* parser) __attribute__ ((noreturn));
+
+// every error thrown while parsing goes through here, since nothing
+// above us gets a chance to free the string buffer once we've thrown.
+static void
+json_throw (JSONParser* parser, EJSNativeErrorType error_type, const char* msg)
 {
-    switch (json_value_get_type (v)) {
-    case JSONNull:
-        *rv = _ejs_null;
-        return EJS_TRUE;
+    free (parser->buf);
+    parser->buf = NULL;
+    parser->buf_len = parser->buf_alloc = 0;
+    _ejs_throw_nativeerror_utf8 (error_type, msg);
+}
 
-    case JSONString:
-        *rv = _ejs_string_new_utf8 (json_value_get_string(v));
-        return EJS_TRUE;
+static void
+json_syntax_error (JSONParser* parser)
+{
+    char msg[128];
 
-    case JSONNumber:
-        *rv = NUMBER_TO_EJSVAL(json_value_get_number(v));
-        return EJS_TRUE;
+    if (parser->p >= parser->end) {
+        snprintf (msg, sizeof(msg), "Unexpected end of JSON input");
+    }
+    else {
+        jschar c = *parser->p;
+        long long position = parser->base + (parser->p - parser->text);
+        if (c >= 0x20 && c < 0x7f)
+            snprintf (msg, sizeof(msg), "Unexpected token %c in JSON at position %lld", (char)c, position);
+        else
+            snprintf (msg, sizeof(msg), "Unexpected token U+%04X in JSON at position %lld", c, position);
+    }
+    json_throw (parser, EJS_SYNTAX_ERROR, msg);
+}
 
-    case JSONObject: {
-        JSON_Object *obj = json_value_get_object (v);
-        *rv = _ejs_object_new(_ejs_null, &_ejs_Object_specops);
+static void
+json_skip_whitespace (JSONParser* parser)
+{
+    const jschar* p = parser->p;
+    while (p < parser->end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
+        p++;
+    parser->p = p;
+}
 
-        int count = json_object_get_count (obj);
-        for (int i = 0; i < count; i ++) {
-            const char *propkey = json_object_get_name (obj, i);
-            ejsval propval;
-            if (!json_value_to_ejsval (json_object_get_value (obj, propkey), &propval))
-                return EJS_FALSE;
-            _ejs_object_setprop_utf8 (*rv, propkey, propval);
-        }
+// skips whitespace and then @c, throwing if it isn't there
+static void
+json_expect (JSONParser* parser, jschar c)
+{
+    json_skip_whitespace (parser);
+    if (parser->p >= parser->end || *parser->p != c)
+        json_syntax_error (parser);
+    parser->p++;
+}
 
-        return EJS_TRUE;
+static void
+json_expect_literal (JSONParser* parser, const char* literal)
+{
+    for (const char* l = literal; *l; l++) {
+        if (parser->p >= parser->end || *parser->p != *l)
+            json_syntax_error (parser);
+        parser->p++;
+    }
+}
+
+static void
+json_buf_append (JSONParser* parser, const jschar* chars, int len)
+{
+    if (parser->buf_len + len > parser->buf_alloc) {
+        parser->buf_alloc = MAX(parser->buf_alloc * 2, parser->buf_len + len + 32);
+        parser->buf = (jschar*)realloc (parser->buf, parser->buf_alloc * sizeof(jschar));
     }
-        
-    case JSONArray: {
-        JSON_Array *arr = json_value_get_array (v);
-        int count = json_array_get_count (arr);
+    memcpy (parser->buf + parser->buf_len, chars, len * sizeof(jschar));
+    parser->buf_len += len;
+}
+
+static int
+json_hex_value (jschar c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
 
-        *rv = _ejs_array_new (count, EJS_FALSE);
+// scans the string starting at the opening quote.  *chars points into
+// the text if there weren't any escapes, or into parser->buf (until
+// the next string is scanned) if there were.
+static void
+json_scan_string (JSONParser* parser, const jschar** chars, int* len)
+{
+    const jschar* start = ++parser->p;
+    const jschar* end = parser->end;
+    const jschar* p = start;
+
+    while (p < end && *p != '"' && *p != '\\' && *p >= 0x20)
+        p++;
+
+    if (p < end && *p == '"') {
+        *chars = start;
+        *len = (int)(p - start);
+        parser->p = p + 1;
+        return;
+    }
 
-        for (int i = 0; i < count; i ++) {
-            ejsval propkey = _ejs_number_new (i);
-            ejsval propval;
-            if (!json_value_to_ejsval (json_array_get_value (arr, i), &propval))
-                return EJS_FALSE;
-            _ejs_object_setprop (*rv, propkey, propval);
+    parser->buf_len = 0;
+    json_buf_append (parser, start, (int)(p - start));
+
+    for (;;) {
+        parser->p = p;
+        if (p >= end || *p < 0x20)
+            json_syntax_error (parser);
+
+        jschar c = *p;
+        if (c == '"')
+            break;
+
+        if (c == '\\') {
+            p++;
+            parser->p = p;
+            if (p >= end)
+                json_syntax_error (parser);
+            switch (*p) {
+            case '"':  c = '"'; break;
+            case '\\': c = '\\'; break;
+            case '/':  c = '/'; break;
+            case 'b':  c = '\b'; break;
+            case 'f':  c = '\f'; break;
+            case 'n':  c = '\n'; break;
+            case 'r':  c = '\r'; break;
+            case 't':  c = '\t'; break;
+            case 'u':
+                c = 0;
+                for (int i = 0; i < 4; i ++) {
+                    p++;
+                    parser->p = p;
+                    int digit = p < end ? json_hex_value (*p) : -1;
+                    if (digit < 0)
+                        json_syntax_error (parser);
+                    c = (c << 4) | digit;
+                }
+                break;
+            default:
+                json_syntax_error (parser);
+            }
         }
 
-        return EJS_TRUE;
+        json_buf_append (parser, &c, 1);
+        p++;
     }
-    case JSONBoolean:
-        *rv = BOOLEAN_TO_EJSVAL(json_value_get_boolean(v));
-        return EJS_TRUE;
 
+    *chars = parser->buf;
+    *len = parser->buf_len;
+    parser->p = p + 1;
+}
 
-    case JSONError:
-        EJS_NOT_IMPLEMENTED();
-        return EJS_FALSE;
+static ejsval
+json_parse_string (JSONParser* parser)
+{
+    const jschar* chars;
+    int len;
+    json_scan_string (parser, &chars, &len);
+    if (len == 0)
+        return _ejs_atom_empty;
+    return _ejs_string_new_ucs2_len (chars, len);
+}
+
+static ejsval
+json_parse_key (JSONParser* parser)
+{
+    const jschar* chars;
+    int len;
+    json_scan_string (parser, &chars, &len);
+
+    if (len == 0)
+        return _ejs_atom_empty;
+    if (len > JSON_KEY_CACHE_MAX_LENGTH)
+        return _ejs_string_new_ucs2_len (chars, len);
+
+    uint32_t hash = len;
+    for (int i = 0; i < len; i ++)
+        hash = hash * 31 + chars[i];
+
+    ejsval* entry = &parser->keys[hash & (JSON_KEY_CACHE_SIZE - 1)];
+    if (EJSVAL_IS_STRING(*entry) && EJSVAL_TO_STRLEN(*entry) == len &&
+        !memcmp (EJSVAL_TO_FLAT_STRING(*entry), chars, len * sizeof(jschar)))
+        return *entry;
+
+    *entry = _ejs_string_new_ucs2_len (chars, len);
+    return *entry;
+}
+
+#define JSON_IS_DIGIT(c) ((c) >= '0' && (c) <= '9')
+
+static ejsval
+json_parse_number (JSONParser* parser)
+{
+    const jschar* start = parser->p;
+    const jschar* end = parser->end;
+    const jschar* p = start;
+    EJSBool negative = EJS_FALSE;
+    EJSBool integral = EJS_TRUE;
+
+    if (*p == '-') {
+        negative = EJS_TRUE;
+        p++;
+    }
+
+    const jschar* digits = p;
+    parser->p = p;
+    if (p >= end || !JSON_IS_DIGIT(*p))
+        json_syntax_error (parser);
+    if (*p == '0')
+        p++;
+    else
+        while (p < end && JSON_IS_DIGIT(*p)) p++;
+    int ndigits = (int)(p - digits);
+
+    if (p < end && *p == '.') {
+        integral = EJS_FALSE;
+        p++;
+        parser->p = p;
+        if (p >= end || !JSON_IS_DIGIT(*p))
+            json_syntax_error (parser);
+        while (p < end && JSON_IS_DIGIT(*p)) p++;
+    }
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        integral = EJS_FALSE;
+        p++;
+        if (p < end && (*p == '+' || *p == '-'))
+            p++;
+        parser->p = p;
+        if (p >= end || !JSON_IS_DIGIT(*p))
+            json_syntax_error (parser);
+        while (p < end && JSON_IS_DIGIT(*p)) p++;
+    }
+
+    parser->p = p;
+
+    // integers of up to 15 digits are exact as doubles
+    if (integral && ndigits <= 15) {
+        int64_t v = 0;
+        for (const jschar* d = digits; d < p; d++)
+            v = v * 10 + (*d - '0');
+        double d = (double)v;
+        return NUMBER_TO_EJSVAL(negative ? -d : d);
     }
+
+    // the grammar above is a subset of StrDecimalLiteral
+    int processed;
+    return NUMBER_TO_EJSVAL(_ejs_strtod (start, (int)(p - start), EJS_FALSE, &processed));
 }
 
-/* 15.12.2 */
-static EJS_NATIVE_FUNC(_ejs_JSON_parse) {
-    ejsval text = _ejs_undefined;
-    ejsval reviver = _ejs_undefined;
+static void
+json_enter (JSONParser* parser)
+{
+    if (++parser->depth > JSON_MAX_NESTING)
+        json_throw (parser, EJS_RANGE_ERROR, "JSON nested too deeply");
+    parser->p++;
+}
 
-    if (argc > 0) text = args[0];
-    if (argc > 1) reviver = args[1];
+static ejsval
+json_parse_object (JSONParser* parser)
+{
+    ejsval obj = _ejs_object_new (_ejs_Object_prototype, &_ejs_Object_specops);
+    EJSPropertyMap* map = EJSVAL_TO_OBJECT(obj)->map;
+
+    json_enter (parser);
+    json_skip_whitespace (parser);
+    if (parser->p < parser->end && *parser->p == '}') {
+        parser->p++;
+        parser->depth--;
+        return obj;
+    }
 
+    for (;;) {
+        json_skip_whitespace (parser);
+        if (parser->p >= parser->end || *parser->p != '"')
+            json_syntax_error (parser);
+
+        ejsval key = json_parse_key (parser);
+        json_expect (parser, ':');
+        ejsval value = json_parse_value (parser);
+
+        // the object is brand new, so this is the same as CreateDataProperty
+        // (including replacing the value for duplicate keys)
+        EJSPropertyDesc* desc = _ejs_propertydesc_new ();
+        desc->flags = EJS_PROP_ENUMERABLE | EJS_PROP_CONFIGURABLE | EJS_PROP_WRITABLE | EJS_PROP_FLAGS_VALUE_SET;
+        desc->value = value;
+        _ejs_propertymap_insert (map, key, desc);
+
+        json_skip_whitespace (parser);
+        if (parser->p < parser->end && *parser->p == ',') {
+            parser->p++;
+            continue;
+        }
+        json_expect (parser, '}');
+        break;
+    }
+
+    parser->depth--;
+    return obj;
+}
 
-    /* 1. Let JText be ToString(text). */
-    ejsval jtext = ToString(text);
+static ejsval
+json_parse_array (JSONParser* parser)
+{
+    ejsval arr = _ejs_array_new (0, EJS_FALSE);
+
+    json_enter (parser);
+    json_skip_whitespace (parser);
+    if (parser->p < parser->end && *parser->p == ']') {
+        parser->p++;
+        parser->depth--;
+        return arr;
+    }
 
-    /* 2. Parse JText using the grammars in 15.12.1. Throw a SyntaxError exception if JText did not conform to the 
-       JSON grammar for the goal symbol JSONText.  */
-    char *flattened_jtext =  ucs2_to_utf8(EJSVAL_TO_FLAT_STRING(jtext));
+    for (;;) {
+        ejsval value = json_parse_value (parser);
+        _ejs_array_push_dense (arr, 1, &value);
 
-    /* 3. Let unfiltered be the result of parsing and evaluating JText as if it was the source text of an ECMAScript 
-       Program but using JSONString in place of StringLiteral. Note that since JText conforms to the JSON 
-       grammar this result will be either a primitive value or an object that is defined by either an ArrayLiteral or 
-       an ObjectLiteral. */
-    JSON_Value* root_val = json_parse_string(flattened_jtext);
+        json_skip_whitespace (parser);
+        if (parser->p < parser->end && *parser->p == ',') {
+            parser->p++;
+            continue;
+        }
+        json_expect (parser, ']');
+        break;
+    }
 
-    free(flattened_jtext);
+    parser->depth--;
+    return arr;
+}
 
-    if (root_val == NULL) {
-        printf ("SyntaxError\n");
-        EJS_NOT_IMPLEMENTED();
+static ejsval
+json_parse_value (JSONParser* parser)
+{
+    json_skip_whitespace (parser);
+    if (parser->p >= parser->end)
+        json_syntax_error (parser);
+
+    switch (*parser->p) {
+    case '{': return json_parse_object (parser);
+    case '[': return json_parse_array (parser);
+    case '"': return json_parse_string (parser);
+    case 't': json_expect_literal (parser, "true"); return _ejs_true;
+    case 'f': json_expect_literal (parser, "false"); return _ejs_false;
+    case 'n': json_expect_literal (parser, "null"); return _ejs_null;
+    case '-':
+    case '0': case '1': case '2': case '3': case '4':
+    case '5': case '6': case '7': case '8': case '9':
+        return json_parse_number (parser);
+    default:
+        json_syntax_error (parser);
     }
+}
 
-    ejsval unfiltered;
-    if (!json_value_to_ejsval(root_val, &unfiltered)) {
-        json_value_free (root_val);
-        /* unfiltered here is an exception */
-        EJS_NOT_IMPLEMENTED();
+// ECMA262: 24.3.1.1 Runtime Semantics: InternalizeJSONProperty( holder, name)
+static ejsval
+InternalizeJSONProperty (ejsval reviver, ejsval holder, ejsval name)
+{
+    // 1. Let val be Get(holder, name).
+    // 2. ReturnIfAbrupt(val).
+    ejsval val = Get(holder, name);
+
+    // 3. If Type(val) is Object, then
+    if (EJSVAL_IS_OBJECT(val)) {
+        //    a. Let isArray be IsArray(val).
+        //    b. ReturnIfAbrupt(isArray).
+        //    c. If isArray is true, then
+        if (EJSVAL_IS_ARRAY(val)) {
+            //   i. Set I to 0.
+            //   ii. Let len be ToLength(Get(val, "length")).
+            //   iii. ReturnIfAbrupt(len).
+            int64_t len = ToLength(Get(val, _ejs_atom_length));
+
+            //   iv. Repeat while I < len,
+            for (int64_t I = 0; I < len; I ++) {
+                ejsval prop = ToString(NUMBER_TO_EJSVAL(I));
+                // 1. Let newElement be InternalizeJSONProperty(val, ToString(I)).
+                // 2. ReturnIfAbrupt(newElement).
+                ejsval newElement = InternalizeJSONProperty(reviver, val, prop);
+                // 3. If newElement is undefined, then
+                if (EJSVAL_IS_UNDEFINED(newElement)) {
+                    // a. Let status be val.[[Delete]](ToString(I)).
+                    OP(EJSVAL_TO_OBJECT(val),Delete)(val, prop, EJS_FALSE);
+                }
+                // 4. Else,
+                else {
+                    // a. Let status be CreateDataProperty(val, ToString(I), newElement).
+                    _ejs_object_define_value_property (val, prop, newElement, EJS_PROP_ENUMERABLE | EJS_PROP_CONFIGURABLE | EJS_PROP_WRITABLE);
+                }
+                // 6. Add 1 to I.
+            }
+        }
+        //    d. Else
+        else {
+            //   i. Let keys be EnumerableOwnNames(val).
+            //   ii. ReturnIfAbrupt(keys).
+            ejsval keys = EnumerableOwnNames(val);
+
+            //   iii. For each String P in keys do,
+            for (uint32_t i = 0; i < EJS_ARRAY_LEN(keys); i ++) {
+                ejsval P = EJS_DENSE_ARRAY_ELEMENTS(keys)[i];
+                // 1. Let newElement be InternalizeJSONProperty(val, P).
+                // 2. ReturnIfAbrupt(newElement).
+                ejsval newElement = InternalizeJSONProperty(reviver, val, P);
+                // 3. If newElement is undefined, then
+                if (EJSVAL_IS_UNDEFINED(newElement)) {
+                    // a. Let status be val.[[Delete]](P).
+                    OP(EJSVAL_TO_OBJECT(val),Delete)(val, P, EJS_FALSE);
+                }
+                // 4. Else,
+                else {
+                    // a. Let status be CreateDataProperty(val, P, newElement).
+                    _ejs_object_define_value_property (val, P, newElement, EJS_PROP_ENUMERABLE | EJS_PROP_CONFIGURABLE | EJS_PROP_WRITABLE);
+                }
+            }
+        }
     }
 
-    json_value_free (root_val);
+    // 4. Return Call(reviver, holder, «name, val»).
+    ejsval call_args[2] = { name, val };
+    return _ejs_invoke_closure (reviver, &holder, 2, call_args, _ejs_undefined);
+}
+
+// ECMA262: 24.3.1 JSON.parse ( text [ , reviver ] )
+static EJS_NATIVE_FUNC(_ejs_JSON_parse) {
+    ejsval text = _ejs_undefined;
+    ejsval reviver = _ejs_undefined;
+
+    if (argc > 0) text = args[0];
+    if (argc > 1) reviver = args[1];
 
-    /* 4. If IsCallable(reviver) is true, then */
+    // 1. Let JText be ToString(text).
+    // 2. ReturnIfAbrupt(JText).
+    ejsval JText = ToString(text);
+
+    // 3. Parse JText interpreted as UTF-16 encoded Unicode points (6.1.4) as a JSON text as specified in
+    //    ECMA-404. Throw a SyntaxError exception if JText is not a valid JSON text as defined in that specification.
+    // 4. Let scriptText be the concatenation of "(", JText, and ");".
+    // 5. Let completion be the result of parsing and evaluating scriptText as if it was the source text of an
+    //    ECMAScript Script.
+    // 6. Let unfiltered be completion.[[value]].
+    JSONParser parser;
+    parser.text = EJSVAL_TO_FLAT_STRING(JText);
+    parser.p = parser.text;
+    parser.end = parser.text + EJSVAL_TO_STRLEN(JText);
+    parser.depth = 0;
+    parser.base = 0;
+    parser.buf = NULL;
+    parser.buf_len = parser.buf_alloc = 0;
+    for (int i = 0; i < JSON_KEY_CACHE_SIZE; i ++)
+        parser.keys[i] = _ejs_undefined;
+
+    ejsval unfiltered = json_parse_value (&parser);
+    json_skip_whitespace (&parser);
+    if (parser.p < parser.end)
+        json_syntax_error (&parser);
+
+    free (parser.buf);
+
+    // 8. If IsCallable(reviver) is true, then
     if (IsCallable(reviver)) {
-        printf ("no reviver support in JSON.parse yet\n");
-        EJS_NOT_IMPLEMENTED();
-        /*    a. Let root be a new object created as if by the expression new Object(), where Object is the
-              standard built-in constructor with that name. */
-        /*    b. Call the [[DefineOwnProperty]] internal method of root with the empty String, the 
-              PropertyDescriptor {[[Value]]: unfiltered, [[Writable]]: true, [[Enumerable]]: true, 
-              [[Configurable]]: true}, and false as arguments. */
-        /*    c. Return the result of calling the abstract operation Walk, passing root and the empty String. The 
-              abstract operation Walk is described below. */
-    }
-    /* 5. Else */
+        //    a. Let root be ObjectCreate(%ObjectPrototype%).
+        ejsval root = _ejs_object_new (_ejs_Object_prototype, &_ejs_Object_specops);
+        //    b. Let rootName be the empty String.
+        //    c. Let status be CreateDataProperty(root, rootName, unfiltered).
+        _ejs_object_define_value_property (root, _ejs_atom_empty, unfiltered, EJS_PROP_ENUMERABLE | EJS_PROP_CONFIGURABLE | EJS_PROP_WRITABLE);
+        //    e. Return InternalizeJSONProperty(root, rootName).
+        return InternalizeJSONProperty(reviver, root, _ejs_atom_empty);
+    }
+    // 9. Else
     else {
-        /*    a. Return unfiltered. */
+        //    a. Return unfiltered.
         return unfiltered;
     }
 }
@@ -150,91 +545,168 @@ static ejsval SerializeJSONObject (StringifyState* state, ejsval value);
 static ejsval SerializeJSONProperty (StringifyState* state, ejsval key, ejsval holder);
 static ejsval QuoteJSONString (StringifyState* state, ejsval value);
 
+// a growable buffer of ucs2 code units that JSON.stringify writes its output to.
+typedef struct {
+    jschar* chars;
+    int len;
+    int alloc;
+} JSONBuffer;
+
+static void
+json_buffer_reserve (JSONBuffer* b, int n)
+{
+    if (b->len + n > b->alloc) {
+        b->alloc = MAX(b->alloc * 2, b->len + n + 64);
+        b->chars = (jschar*)realloc (b->chars, b->alloc * sizeof(jschar));
+    }
+}
+
+static void
+json_buffer_append (JSONBuffer* b, const jschar* chars, int len)
+{
+    json_buffer_reserve (b, len);
+    memcpy (b->chars + b->len, chars, len * sizeof(jschar));
+    b->len += len;
+}
+
+static void
+json_buffer_append_ascii (JSONBuffer* b, const char* chars, int len)
+{
+    json_buffer_reserve (b, len);
+    for (int i = 0; i < len; i ++)
+        b->chars[b->len++] = chars[i];
+}
+
+#define JSON_NEEDS_ESCAPE(c) ((c) < 0x0020 || (c) == '"' || (c) == '\\')
+
+// @c in each of the four 16 bit lanes of a word
+#define JSON_LANES(c) (0x0001000100010001ULL * (uint64_t)(c))
+
+// true if any of the four code units packed in @word needs escaping.  the usual
+// "has a lane less than n" trick: a lane can only be flagged if it, or a lane below it,
+// is really less than n, so there are no false negatives.
+static EJS_ALWAYS_INLINE EJSBool
+json_word_needs_escape (uint64_t word)
+{
+    uint64_t quote = word ^ JSON_LANES('"');
+    uint64_t backslash = word ^ JSON_LANES('\\');
+
+    uint64_t control = (word - JSON_LANES(0x0020)) & ~word;
+    uint64_t is_quote = (quote - JSON_LANES(1)) & ~quote;
+    uint64_t is_backslash = (backslash - JSON_LANES(1)) & ~backslash;
+
+    return ((control | is_quote | is_backslash) & JSON_LANES(0x8000)) != 0;
+}
+
 // ES2015, June 2015
 // 24.3.2.2 abstract operation QuoteJSONString ( value )
-static ejsval
-QuoteJSONString(StringifyState* state, ejsval value) {
-    int len = EJSVAL_TO_STRLEN(value);
-    jschar *product = malloc((len * 4 + 2) * sizeof(jschar));
-    EJSPrimString* prim_value = _ejs_primstring_flatten(EJSVAL_TO_STRING(value)); // this is pretty terrible.. we need a way to simply iterate over characters in a string
+//
+// appends the quoted form of the @len code units at @chars to @b.  most strings have
+// nothing to escape, so we look at them four code units at a time and copy whole runs
+// that fall under step 2.d.
+static void
+json_quote (JSONBuffer* b, const jschar* chars, int len)
+{
+    static const char hexdigits[] = "0123456789abcdef";
 
+    // at worst every code unit turns into \u00XX
+    json_buffer_reserve (b, len * 6 + 2);
+    jschar* product = b->chars + b->len;
     int pi = 0;
-    
+
     // 1. Let product be code unit 0x0022 (QUOTATION MARK).
     product[pi++] = '"';
 
     // 2. For each code unit C in value
-    for (int vi = 0; vi < len; vi++) {
-        jschar C = prim_value->data.flat[vi];
+    int vi = 0;
+    while (vi < len) {
+        int run = vi;
+        while (run + 4 <= len) {
+            uint64_t word;
+            memcpy (&word, chars + run, sizeof(word));
+            if (json_word_needs_escape (word))
+                break;
+            run += 4;
+        }
+        while (run < len && !JSON_NEEDS_ESCAPE(chars[run]))
+            run ++;
+
+        // d. Else,
+        //    i. Let product be the concatenation of product and C.
+        memcpy (product + pi, chars + vi, (run - vi) * sizeof(jschar));
+        pi += run - vi;
+        vi = run;
+        if (vi == len)
+            break;
+
+        jschar C = chars[vi++];
+
+        // a-c all start with
+        // i. Let product be the concatenation of product and code unit 0x005C (REVERSE SOLIDUS).
+        product[pi++] = '\\';
+
         // a. If C is 0x0022 (QUOTATION MARK) or 0x005C (REVERSE SOLIDUS), then
-        if (C == '\"' || C == '\\') {
-            // i. Let product be the concatenation of product and code unit 0x005C (REVERSE SOLIDUS).
-            product[pi++] = '\\';
+        if (C == '"' || C == '\\') {
             // ii. Let product be the concatenation of product and C.
             product[pi++] = C;
         }
         // b. Else if C is 0x0008 (BACKSPACE), 0x000C (FORM FEED), 0x000A (LINE FEED), 0x000D(CARRIAGE RETURN), or 0x000B (LINE TABULATION), then
-        else if (C == '\b' ||
-                 C == '\f' ||
-                 C == '\n' ||
-                 C == '\r' ||
-                 C == '\t') {
-            // i. Let product be the concatenation of product and code unit 0x005C (REVERSE SOLIDUS).
-            product[pi++] = '\\';
-
+        else if (C == '\b' || C == '\f' || C == '\n' || C == '\r' || C == '\t') {
             // ii. Let abbrev be the String value corresponding to the value of C as follows:
-            jschar abbrev;
-            // BACKSPACE "b"
-            if (C == '\b') abbrev = 'b';
-            // FORM FEED (FF) "f"
-            if (C == '\f') abbrev = 'f';
-            // LINE FEED (LF) "n"
-            if (C == '\n') abbrev = 'n';
-            // CARRIAGE RETURN (CR) "r"
-            if (C == '\r') abbrev = 'r';
-            // LINE TABULATION "t"
-            if (C == '\t') abbrev = 't';
             // iii. Let product be the concatenation of product and abbrev.
-            product[pi++] = abbrev;
+            switch (C) {
+            case '\b': product[pi++] = 'b'; break;
+            case '\f': product[pi++] = 'f'; break;
+            case '\n': product[pi++] = 'n'; break;
+            case '\r': product[pi++] = 'r'; break;
+            case '\t': product[pi++] = 't'; break;
+            }
         }
         // c. Else if C has a code unit value less than 0x0020 (SPACE), then
-        else if (C < ' ') {
-            // i. Let product be the concatenation of product and code unit 0x005C (REVERSE SOLIDUS).
-            product[pi++] = '\\';
-
+        else {
             // ii. Let product be the concatenation of product and "u".
             product[pi++] = 'u';
 
             // iii. Let hex be the string result of converting the numeric code unit value of C to a String of four hexadecimal digits. Alphabetic hexadecimal digits are presented as lowercase Latin letters.
-            static char* hexdigits = "012356789abcdef";
-
             // iv. Let product be the concatenation of product and hex.
             product[pi++] = '0';
             product[pi++] = '0';
             product[pi++] = hexdigits[(C & 0xf0) >> 4];
             product[pi++] = hexdigits[C & 0xf];
         }
-        // d. Else,
-        else {
-            // i. Let product be the concatenation of product and C.
-            product[pi++] = C;
-        }
     }
     // 3. Let product be the concatenation of product and code unit 0x0022 (QUOTATION MARK).
-    product[pi++] = '\"';
+    product[pi++] = '"';
+
+    b->len += pi;
+}
+
+static ejsval
+QuoteJSONString(StringifyState* state, ejsval value) {
+    JSONBuffer product = { NULL, 0, 0 };
+    json_quote (&product, EJSVAL_TO_FLAT_STRING(value), EJSVAL_TO_STRLEN(value));
+
     /* 4. Return product. */
-    ejsval rv = _ejs_string_new_ucs2_len(product, pi);
-    free (product);
+    ejsval rv = _ejs_string_new_ucs2_len(product.chars, product.len);
+    free (product.chars);
     return rv;
 }
 
+static void
+CheckJSONCycle (StringifyState* state, ejsval value)
+{
+    for (int i = 0; i < EJS_ARRAY_LEN(state->stack); i ++) {
+        if (EJSVAL_EQ(EJS_DENSE_ARRAY_ELEMENTS(state->stack)[i], value))
+            _ejs_throw_nativeerror_utf8 (EJS_TYPE_ERROR, "Converting circular structure to JSON");
+    }
+}
+
 // ES2015, June 2015
 // 24.3.2.3 abstract operation SerializeJSONObject ( value )
 static ejsval
 SerializeJSONObject (StringifyState* state, ejsval value) {
     // 1. If stack contains value, throw a TypeError exception because the structure is cyclical.
-
-    // XXX
+    CheckJSONCycle (state, value);
 
     // 2. Append value to stack.
     _ejs_array_push_dense (state->stack, 1, &value);
@@ -356,7 +828,7 @@ SerializeJSONObject (StringifyState* state, ejsval value) {
 static ejsval
 SerializeJSONArray(StringifyState* state, ejsval value) {
     // 1. If stack contains value, throw a TypeError exception because the structure is cyclical.
-    // XXX
+    CheckJSONCycle (state, value);
 
     // 2. Append value to stack.
     _ejs_array_push_dense(state->stack, 1, &value);
@@ -541,6 +1013,322 @@ SerializeJSONProperty(StringifyState* state, ejsval key, ejsval holder) {
     return _ejs_undefined;
 }
 
+// JSON.stringify fast path.
+//
+// Most calls are for trees of plain objects, arrays and primitives, with no replacer and
+// no toJSON anywhere.  No user code can run while serializing those, so we read the
+// property maps and dense array elements directly and write everything into one buffer,
+// instead of a Get per property, a ToString per number and a string concatenation for
+// every piece of the result.
+//
+// As soon as we see anything else (proxies, accessors, toJSON, boxed primitives, integer
+// keys, sparse arrays, cycles, deep nesting) we give up.  Nothing observable has happened
+// at that point, so the caller throws the partial output away and runs the spec steps.
+
+#define JSON_FAST_MAX_DEPTH 256
+#define JSON_QUOTED_KEY_CACHE_SIZE 256 // must be a power of 2
+#define JSON_PROTO_CACHE_SIZE 4
+
+typedef enum {
+    JSON_FAST_OK,
+    JSON_FAST_UNDEFINED, // the value serializes to undefined, nothing was written
+    JSON_FAST_BAIL
+} JSONFastResult;
+
+typedef struct {
+    JSONBuffer out;
+
+    const jschar* gap;
+    int gap_len;
+
+    // the objects we're in the middle of serializing
+    EJSObject* stack[JSON_FAST_MAX_DEPTH];
+    int depth;
+
+    // property names we've already written.  objects in the same document tend to share
+    // their keys, and nearly all of them quote to themselves between quotation marks, so
+    // remembering that saves scanning them for characters to escape again.
+    struct {
+        ejsval key;
+        EJSBool verbatim;
+    } keys[JSON_QUOTED_KEY_CACHE_SIZE];
+
+    // prototypes known to have no toJSON anywhere up their chain
+    EJSObject* protos[JSON_PROTO_CACHE_SIZE];
+    int next_proto;
+} JSONWriter;
+
+static JSONFastResult json_fast_value (JSONWriter* w, ejsval value);
+
+static EJSBool
+json_fast_ordinary (EJSObject* obj)
+{
+    return (obj->ops == &_ejs_Object_specops ||
+            obj->ops == &_ejs_Array_specops ||
+            obj->ops == &_ejs_Function_specops);
+}
+
+// true if Get(obj, "toJSON") is guaranteed to be undefined without running any code
+static EJSBool
+json_fast_no_toJSON (JSONWriter* w, EJSObject* obj)
+{
+    if (!json_fast_ordinary (obj) || _ejs_propertymap_lookup (obj->map, _ejs_atom_toJSON))
+        return EJS_FALSE;
+
+    if (EJSVAL_IS_NULL(obj->proto))
+        return EJS_TRUE;
+
+    EJSObject* proto = EJSVAL_TO_OBJECT(obj->proto);
+    for (int i = 0; i < JSON_PROTO_CACHE_SIZE; i ++) {
+        if (w->protos[i] == proto)
+            return EJS_TRUE;
+    }
+
+    for (EJSObject* p = proto; p; p = EJSVAL_IS_NULL(p->proto) ? NULL : EJSVAL_TO_OBJECT(p->proto)) {
+        if (!json_fast_ordinary (p) || _ejs_propertymap_lookup (p->map, _ejs_atom_toJSON))
+            return EJS_FALSE;
+    }
+
+    w->protos[w->next_proto] = proto;
+    w->next_proto = (w->next_proto + 1) % JSON_PROTO_CACHE_SIZE;
+    return EJS_TRUE;
+}
+
+// true if reading a hole in @arr gives undefined, i.e. nothing on its prototype chain has
+// indexed properties.
+static EJSBool
+json_fast_hole_is_undefined (EJSObject* arr)
+{
+    if (!EJSVAL_EQ(arr->proto, _ejs_Array_prototype))
+        return EJS_FALSE;
+
+    EJSObject* array_proto = EJSVAL_TO_OBJECT(_ejs_Array_prototype);
+    if (EJSARRAY_LEN(array_proto) != 0 || !EJSVAL_EQ(array_proto->proto, _ejs_Object_prototype))
+        return EJS_FALSE;
+
+    EJSObject* object_proto = EJSVAL_TO_OBJECT(_ejs_Object_prototype);
+    return !object_proto->map->has_index_keys && EJSVAL_IS_NULL(object_proto->proto);
+}
+
+static void
+json_fast_newline (JSONWriter* w)
+{
+    json_buffer_reserve (&w->out, 1 + w->gap_len * w->depth);
+    w->out.chars[w->out.len++] = '\n';
+    for (int i = 0; i < w->depth; i ++) {
+        memcpy (w->out.chars + w->out.len, w->gap, w->gap_len * sizeof(jschar));
+        w->out.len += w->gap_len;
+    }
+}
+
+static void
+json_fast_key (JSONWriter* w, ejsval name)
+{
+    EJSPrimString* key = _ejs_string_flatten (name);
+    int slot = ((uintptr_t)key >> 4) & (JSON_QUOTED_KEY_CACHE_SIZE - 1);
+
+    if (EJSVAL_EQ(w->keys[slot].key, name) && w->keys[slot].verbatim) {
+        json_buffer_reserve (&w->out, key->length + 2);
+        w->out.chars[w->out.len++] = '"';
+        memcpy (w->out.chars + w->out.len, key->data.flat, key->length * sizeof(jschar));
+        w->out.len += key->length;
+        w->out.chars[w->out.len++] = '"';
+        return;
+    }
+
+    int start = w->out.len;
+    json_quote (&w->out, key->data.flat, key->length);
+    w->keys[slot].key = name;
+    w->keys[slot].verbatim = (w->out.len - start == key->length + 2);
+}
+
+static void
+json_fast_number (JSONWriter* w, double d)
+{
+    char num_buf[EJS_DTOA_BUFFER_SIZE];
+    int32_t i;
+
+    if (EJSDOUBLE_IS_INT32(d, &i)) {
+        // write the digits backwards from the end of num_buf
+        uint32_t u = i < 0 ? -(uint32_t)i : (uint32_t)i;
+        char* p = num_buf + sizeof(num_buf);
+        do {
+            *--p = '0' + u % 10;
+            u /= 10;
+        } while (u);
+        if (i < 0)
+            *--p = '-';
+        json_buffer_append_ascii (&w->out, p, num_buf + sizeof(num_buf) - p);
+        return;
+    }
+
+    if (!isfinite (d)) {
+        json_buffer_append_ascii (&w->out, "null", 4);
+        return;
+    }
+
+    json_buffer_append_ascii (&w->out, num_buf, _ejs_dtoa_shortest (d, num_buf));
+}
+
+static JSONFastResult
+json_fast_enter (JSONWriter* w, EJSObject* obj)
+{
+    if (w->depth == JSON_FAST_MAX_DEPTH)
+        return JSON_FAST_BAIL;
+    // a cycle, let the spec steps throw the TypeError
+    for (int i = 0; i < w->depth; i ++) {
+        if (w->stack[i] == obj)
+            return JSON_FAST_BAIL;
+    }
+    w->stack[w->depth++] = obj;
+    return JSON_FAST_OK;
+}
+
+static JSONFastResult
+json_fast_object (JSONWriter* w, EJSObject* obj)
+{
+    // integer keys come first in EnumerableOwnNames, not in insertion order
+    if (obj->map->has_index_keys)
+        return JSON_FAST_BAIL;
+
+    if (json_fast_enter (w, obj) == JSON_FAST_BAIL)
+        return JSON_FAST_BAIL;
+
+    json_buffer_append_ascii (&w->out, "{", 1);
+
+    EJSBool empty = EJS_TRUE;
+    for (_EJSPropertyMapEntry *s = obj->map->head_insert; s; s = s->next_insert) {
+        EJSPropertyDesc* desc = s->desc;
+        if (!EJSVAL_IS_STRING(s->name) || !_ejs_property_desc_is_enumerable(desc))
+            continue;
+        if (_ejs_property_desc_has_getter(desc) || _ejs_property_desc_has_setter(desc))
+            return JSON_FAST_BAIL;
+
+        // if the value turns out to be undefined we back up to here
+        int mark = w->out.len;
+
+        if (!empty)
+            json_buffer_append_ascii (&w->out, ",", 1);
+        if (w->gap_len > 0)
+            json_fast_newline (w);
+        json_fast_key (w, s->name);
+        if (w->gap_len > 0)
+            json_buffer_append_ascii (&w->out, ": ", 2);
+        else
+            json_buffer_append_ascii (&w->out, ":", 1);
+
+        JSONFastResult r = json_fast_value (w, _ejs_property_desc_get_value(desc));
+        if (r == JSON_FAST_BAIL)
+            return JSON_FAST_BAIL;
+        if (r == JSON_FAST_UNDEFINED)
+            w->out.len = mark;
+        else
+            empty = EJS_FALSE;
+    }
+
+    w->depth--;
+    if (!empty && w->gap_len > 0)
+        json_fast_newline (w);
+    json_buffer_append_ascii (&w->out, "}", 1);
+    return JSON_FAST_OK;
+}
+
+static JSONFastResult
+json_fast_array (JSONWriter* w, EJSObject* arr)
+{
+    if (json_fast_enter (w, arr) == JSON_FAST_BAIL)
+        return JSON_FAST_BAIL;
+
+    json_buffer_append_ascii (&w->out, "[", 1);
+
+    ejsval* elements = EJSDENSEARRAY_ELEMENTS(arr);
+    int len = EJSARRAY_LEN(arr);
+    for (int i = 0; i < len; i ++) {
+        if (i > 0)
+            json_buffer_append_ascii (&w->out, ",", 1);
+        if (w->gap_len > 0)
+            json_fast_newline (w);
+
+        ejsval el = elements[i];
+        if (EJSVAL_IS_ARRAY_HOLE_MAGIC(el)) {
+            if (!json_fast_hole_is_undefined (arr))
+                return JSON_FAST_BAIL;
+            el = _ejs_undefined;
+        }
+
+        JSONFastResult r = json_fast_value (w, el);
+        if (r == JSON_FAST_BAIL)
+            return JSON_FAST_BAIL;
+        if (r == JSON_FAST_UNDEFINED)
+            json_buffer_append_ascii (&w->out, "null", 4);
+    }
+
+    w->depth--;
+    if (len > 0 && w->gap_len > 0)
+        json_fast_newline (w);
+    json_buffer_append_ascii (&w->out, "]", 1);
+    return JSON_FAST_OK;
+}
+
+// SerializeJSONProperty for a value we've already read out of its holder
+static JSONFastResult
+json_fast_value (JSONWriter* w, ejsval value)
+{
+    if (EJSVAL_IS_NUMBER(value)) {
+        json_fast_number (w, EJSVAL_TO_NUMBER(value));
+        return JSON_FAST_OK;
+    }
+    if (EJSVAL_IS_STRING(value)) {
+        json_quote (&w->out, EJSVAL_TO_FLAT_STRING(value), EJSVAL_TO_STRLEN(value));
+        return JSON_FAST_OK;
+    }
+    if (EJSVAL_IS_NULL(value)) {
+        json_buffer_append_ascii (&w->out, "null", 4);
+        return JSON_FAST_OK;
+    }
+    if (EJSVAL_IS_BOOLEAN(value)) {
+        if (EJSVAL_TO_BOOLEAN(value))
+            json_buffer_append_ascii (&w->out, "true", 4);
+        else
+            json_buffer_append_ascii (&w->out, "false", 5);
+        return JSON_FAST_OK;
+    }
+    if (!EJSVAL_IS_OBJECT(value))
+        return JSON_FAST_UNDEFINED; // undefined and symbols
+
+    EJSObject* obj = EJSVAL_TO_OBJECT(value);
+    if (!json_fast_no_toJSON (w, obj))
+        return JSON_FAST_BAIL;
+
+    if (obj->ops == &_ejs_Object_specops)
+        return json_fast_object (w, obj);
+    if (obj->ops == &_ejs_Array_specops)
+        return json_fast_array (w, obj);
+
+    // functions
+    return JSON_FAST_UNDEFINED;
+}
+
+// the result of JSON.stringify(value, undefined, gap) in @result, or EJS_FALSE if @value
+// needs the spec steps.
+static EJSBool
+json_fast_stringify (ejsval value, ejsval gap, ejsval* result)
+{
+    JSONWriter* w = (JSONWriter*)calloc (1, sizeof(JSONWriter));
+    w->gap = EJSVAL_TO_FLAT_STRING(gap);
+    w->gap_len = EJSVAL_TO_STRLEN(gap);
+
+    JSONFastResult r = json_fast_value (w, value);
+    if (r == JSON_FAST_OK)
+        *result = _ejs_string_new_ucs2_len (w->out.chars, w->out.len);
+    else if (r == JSON_FAST_UNDEFINED)
+        *result = _ejs_undefined;
+
+    free (w->out.chars);
+    free (w);
+    return r != JSON_FAST_BAIL;
+}
+
 // ES2015, June 2015
 // 24.3.2 JSON.stringify ( value [ , replacer [ , space ] ] )
 static EJS_NATIVE_FUNC(_ejs_JSON_stringify) {
@@ -662,6 +1450,12 @@ static EJS_NATIVE_FUNC(_ejs_JSON_stringify) {
         // a. Set gap to the empty String.
         state.gap = _ejs_atom_empty;
     }
+    if (EJSVAL_IS_UNDEFINED(state.ReplacerFunction) && EJSVAL_IS_UNDEFINED(state.PropertyList)) {
+        ejsval result;
+        if (json_fast_stringify (value, state.gap, &result))
+            return result;
+    }
+
     // 9. Let wrapper be ObjectCreate(%ObjectPrototype%).
     ejsval wrapper = _ejs_object_new(_ejs_Object_prototype, &_ejs_Object_specops);
 
@@ -679,6 +1473,561 @@ _ejs_json_stringify (ejsval arg)
     return _ejs_JSON_stringify(_ejs_undefined, &undef_this, 1, &arg, _ejs_undefined);
 }
 
+// Streaming JSON, for documents too large to hold as one string (multi-GB
+// newline delimited logs and exports.)  Both live on __ejs:
+//
+//   var parser = new __ejs.JSONParser();
+//   parser.write(chunk)    -> an array of the top level values completed by chunk
+//   parser.end()           -> the values left once the input is done
+//
+// chunks are strings, or ArrayBuffers/typed arrays/DataViews holding utf8 (say,
+// windows from fs.mmapSync.)  Any sequence of top level values separated by
+// whitespace is accepted, so newline delimited JSON works as is.  We only hold
+// on to the text of the value in progress, so memory is bounded by the largest
+// single value, not the size of the input.  A value with a syntax error throws
+// from the write/end that completes it, and parsing carries on after it.
+//
+//   var writer = new __ejs.JSONWriter(stream);
+//   writer.write(value)    -> appends JSON.stringify(value) and a newline
+//   writer.end()           -> writes out whatever is buffered
+//
+// the output collects in a buffer that's handed to stream.write() (a stream from
+// fs.createWriteStream, process.stdout, or anything else with a write method)
+// whenever it fills up.  Closing the stream is left to the caller.
+
+#define JSON_WRITER_FLUSH_SIZE (64 * 1024)
+
+static ejsval _ejs_JSONParser EJSVAL_ALIGNMENT;
+static ejsval _ejs_JSONParser_prototype EJSVAL_ALIGNMENT;
+static ejsval _ejs_JSONWriter EJSVAL_ALIGNMENT;
+static ejsval _ejs_JSONWriter_prototype EJSVAL_ALIGNMENT;
+
+typedef struct {
+    /* object header */
+    EJSObject obj;
+
+    // text we've decoded but haven't finished with.  everything before
+    // consumed has been parsed, and we've looked for the end of the
+    // value in progress up to scan.
+    JSONBuffer pending;
+    int consumed;
+    int scan;
+
+    // where the value in progress starts in pending (-1 between values),
+    // and where we are in it
+    int value_start;
+    int depth;
+    EJSBool in_string;
+    EJSBool escaped;
+
+    // the position of pending.chars[0] in the whole input
+    int64_t position;
+
+    // the start of a utf8 sequence split across chunks
+    unsigned char partial[4];
+    int partial_len;
+
+    // values that have been parsed but not returned from write/end
+    ejsval ready;
+} EJSJSONParser;
+
+typedef struct {
+    /* object header */
+    EJSObject obj;
+
+    ejsval stream;
+    JSONWriter* writer;
+} EJSJSONWriter;
+
+#define EJSVAL_IS_JSONPARSER(v) (EJSVAL_IS_OBJECT(v) && (EJSVAL_TO_OBJECT(v)->ops == &_ejs_JSONParser_specops))
+#define EJSVAL_IS_JSONWRITER(v) (EJSVAL_IS_OBJECT(v) && (EJSVAL_TO_OBJECT(v)->ops == &_ejs_JSONWriter_specops))
+
+static void
+json_parser_reset (EJSJSONParser* parser)
+{
+    parser->pending.len = 0;
+    parser->consumed = 0;
+    parser->scan = 0;
+    parser->value_start = -1;
+    parser->depth = 0;
+    parser->in_string = EJS_FALSE;
+    parser->escaped = EJS_FALSE;
+    parser->position = 0;
+    parser->partial_len = 0;
+}
+
+// drops the text we're done with from the front of pending
+static void
+json_parser_compact (EJSJSONParser* parser)
+{
+    int consumed = parser->consumed;
+    if (consumed == 0)
+        return;
+
+    memmove (parser->pending.chars, parser->pending.chars + consumed, (parser->pending.len - consumed) * sizeof(jschar));
+    parser->pending.len -= consumed;
+    parser->scan -= consumed;
+    if (parser->value_start != -1)
+        parser->value_start -= consumed;
+    parser->position += consumed;
+    parser->consumed = 0;
+}
+
+static void
+json_parser_append_char (EJSJSONParser* parser, uint32_t c)
+{
+    JSONBuffer* b = &parser->pending;
+    json_buffer_reserve (b, 2);
+    if (c > 0xffff) {
+        c -= 0x10000;
+        b->chars[b->len++] = 0xd800 + (c >> 10);
+        b->chars[b->len++] = 0xdc00 + (c & 0x3ff);
+    }
+    else {
+        b->chars[b->len++] = c;
+    }
+}
+
+// decodes the utf8 sequence at @s (with @len bytes available) into @c, returning
+// the number of bytes it takes up.  returns 0 if the sequence is cut off.  invalid
+// sequences decode as U+FFFD, one for each maximal prefix of a valid sequence, like
+// the WHATWG decoder.
+static int
+json_decode_utf8 (const unsigned char* s, int len, uint32_t* c)
+{
+    int n;
+    uint32_t min;
+
+    if (s[0] < 0x80) { *c = s[0]; return 1; }
+    else if (s[0] >= 0xc2 && s[0] <= 0xdf) { n = 2; min = 0x80; *c = s[0] & 0x1f; }
+    else if (s[0] >= 0xe0 && s[0] <= 0xef) { n = 3; min = 0x800; *c = s[0] & 0x0f; }
+    else if (s[0] >= 0xf0 && s[0] <= 0xf4) { n = 4; min = 0x10000; *c = s[0] & 0x07; }
+    else { *c = 0xfffd; return 1; }
+
+    for (int i = 1; i < n; i ++) {
+        if (i == len)
+            return 0;
+        // the bytes so far are replaced by one U+FFFD
+        if ((s[i] & 0xc0) != 0x80) {
+            *c = 0xfffd;
+            return i;
+        }
+        *c = (*c << 6) | (s[i] & 0x3f);
+    }
+
+    // overlong forms, surrogates and anything past U+10FFFF
+    if (*c < min || (*c >= 0xd800 && *c <= 0xdfff) || *c > 0x10ffff) {
+        *c = 0xfffd;
+        return 1;
+    }
+    return n;
+}
+
+// decodes @bytes onto the end of pending.  a sequence cut off at the end is held
+// back for the next chunk.
+static void
+json_parser_append_utf8 (EJSJSONParser* parser, const unsigned char* bytes, int len)
+{
+    uint32_t c;
+
+    // finish off the sequence the last chunk ended in the middle of
+    while (parser->partial_len > 0) {
+        int n = json_decode_utf8 (parser->partial, parser->partial_len, &c);
+        if (n == 0) {
+            if (len == 0)
+                return;
+            parser->partial[parser->partial_len++] = *bytes++;
+            len--;
+            continue;
+        }
+        json_parser_append_char (parser, c);
+        // an invalid sequence might not use up all of partial
+        parser->partial_len -= n;
+        memmove (parser->partial, parser->partial + n, parser->partial_len);
+    }
+
+    json_buffer_reserve (&parser->pending, len);
+    int i = 0;
+    while (i < len) {
+        if (bytes[i] < 0x80) {
+            parser->pending.chars[parser->pending.len++] = bytes[i++];
+            continue;
+        }
+
+        int n = json_decode_utf8 (bytes + i, len - i, &c);
+        if (n == 0) {
+            memcpy (parser->partial, bytes + i, len - i);
+            parser->partial_len = len - i;
+            break;
+        }
+        json_parser_append_char (parser, c);
+        i += n;
+    }
+}
+
+// parses the value in pending that ends at @end and adds it to ready
+static void
+json_parser_emit (EJSJSONParser* parser, JSONParser* text_parser, int end)
+{
+    int start = parser->value_start;
+
+    // the value is consumed even if it turns out to be malformed, so the
+    // next write picks up after it.
+    parser->consumed = parser->scan = end;
+    parser->value_start = -1;
+    parser->depth = 0;
+    parser->in_string = parser->escaped = EJS_FALSE;
+
+    text_parser->text = text_parser->p = parser->pending.chars + start;
+    text_parser->end = parser->pending.chars + end;
+    text_parser->depth = 0;
+    text_parser->base = parser->position + start;
+
+    ejsval value = json_parse_value (text_parser);
+    json_skip_whitespace (text_parser);
+    if (text_parser->p < text_parser->end)
+        json_syntax_error (text_parser);
+
+    _ejs_array_push_dense (parser->ready, 1, &value);
+}
+
+// finds the ends of the values in the text added since the last call and parses
+// them.  if @final, the value in progress has to end with the input.
+static void
+json_parser_scan (EJSJSONParser* parser, EJSBool final)
+{
+    JSONParser text_parser;
+    text_parser.buf = NULL;
+    text_parser.buf_len = text_parser.buf_alloc = 0;
+    for (int i = 0; i < JSON_KEY_CACHE_SIZE; i ++)
+        text_parser.keys[i] = _ejs_undefined;
+
+    const jschar* chars = parser->pending.chars;
+    int len = parser->pending.len;
+    int i = parser->scan;
+
+    while (i < len) {
+        jschar c = chars[i++];
+
+        if (parser->in_string) {
+            if (parser->escaped)
+                parser->escaped = EJS_FALSE;
+            else if (c == '\\')
+                parser->escaped = EJS_TRUE;
+            else if (c == '"') {
+                parser->in_string = EJS_FALSE;
+                if (parser->depth == 0)
+                    json_parser_emit (parser, &text_parser, i);
+            }
+            continue;
+        }
+
+        switch (c) {
+        case ' ': case '\t': case '\n': case '\r':
+            // the end of a number or literal
+            if (parser->value_start != -1 && parser->depth == 0)
+                json_parser_emit (parser, &text_parser, i - 1);
+            break;
+        case '"':
+            if (parser->value_start == -1)
+                parser->value_start = i - 1;
+            parser->in_string = EJS_TRUE;
+            break;
+        case '{': case '[':
+            if (parser->value_start == -1)
+                parser->value_start = i - 1;
+            parser->depth ++;
+            break;
+        case '}': case ']':
+            // an unbalanced close is emitted right away so the parser
+            // reports it
+            if (parser->value_start == -1)
+                parser->value_start = i - 1;
+            if (--parser->depth <= 0)
+                json_parser_emit (parser, &text_parser, i);
+            break;
+        default:
+            if (parser->value_start == -1)
+                parser->value_start = i - 1;
+            break;
+        }
+    }
+    parser->scan = i;
+
+    if (final && parser->value_start != -1)
+        json_parser_emit (parser, &text_parser, len);
+    else if (parser->value_start == -1)
+        parser->consumed = len;
+
+    // a syntax error in one of the values frees this in json_throw
+    free (text_parser.buf);
+}
+
+static ejsval
+json_parser_take_ready (EJSJSONParser* parser)
+{
+    ejsval ready = parser->ready;
+    parser->ready = _ejs_array_new (0, EJS_FALSE);
+    return ready;
+}
+
+static EJS_NATIVE_FUNC(_ejs_JSONParser_impl) {
+    if (EJSVAL_IS_UNDEFINED(newTarget))
+        _ejs_throw_nativeerror_utf8 (EJS_TYPE_ERROR, "JSONParser constructor must be called with new");
+
+    ejsval obj = OrdinaryCreateFromConstructor(newTarget, _ejs_JSONParser_prototype, &_ejs_JSONParser_specops);
+    *_this = obj;
+
+    EJSJSONParser* parser = (EJSJSONParser*)EJSVAL_TO_OBJECT(obj);
+    json_parser_reset (parser);
+    parser->ready = _ejs_array_new (0, EJS_FALSE);
+    return obj;
+}
+
+static EJS_NATIVE_FUNC(_ejs_JSONParser_prototype_write) {
+    if (!EJSVAL_IS_JSONPARSER(*_this))
+        _ejs_throw_nativeerror_utf8 (EJS_TYPE_ERROR, "JSONParser.prototype.write called on incompatible receiver");
+
+    EJSJSONParser* parser = (EJSJSONParser*)EJSVAL_TO_OBJECT(*_this);
+    ejsval chunk = argc > 0 ? args[0] : _ejs_undefined;
+
+    json_parser_compact (parser);
+
+    if (EJSVAL_IS_ARRAYBUFFER(chunk)) {
+        json_parser_append_utf8 (parser, _ejs_arraybuffer_get_data (EJSVAL_TO_OBJECT(chunk)), EJS_ARRAY_BUFFER_BYTE_LEN(chunk));
+    }
+    else if (EJSVAL_IS_TYPEDARRAY(chunk)) {
+        json_parser_append_utf8 (parser, _ejs_typedarray_get_data (EJSVAL_TO_OBJECT(chunk)), EJS_TYPED_ARRAY_BYTE_LEN(chunk));
+    }
+    else if (EJSVAL_IS_DATAVIEW(chunk)) {
+        json_parser_append_utf8 (parser, _ejs_dataview_get_data (EJSVAL_TO_OBJECT(chunk)), EJS_DATA_VIEW_BYTE_LEN(chunk));
+    }
+    else {
+        ejsval text = ToString(chunk);
+        json_buffer_append (&parser->pending, EJSVAL_TO_FLAT_STRING(text), EJSVAL_TO_STRLEN(text));
+    }
+
+    json_parser_scan (parser, EJS_FALSE);
+    return json_parser_take_ready (parser);
+}
+
+static EJS_NATIVE_FUNC(_ejs_JSONParser_prototype_end) {
+    if (!EJSVAL_IS_JSONPARSER(*_this))
+        _ejs_throw_nativeerror_utf8 (EJS_TYPE_ERROR, "JSONParser.prototype.end called on incompatible receiver");
+
+    EJSJSONParser* parser = (EJSJSONParser*)EJSVAL_TO_OBJECT(*_this);
+
+    json_parser_compact (parser);
+    if (parser->partial_len > 0) {
+        json_parser_append_char (parser, 0xfffd);
+        parser->partial_len = 0;
+    }
+
+    json_parser_scan (parser, EJS_TRUE);
+
+    // ready for a new input
+    json_parser_reset (parser);
+    return json_parser_take_ready (parser);
+}
+
+static EJSObject*
+_ejs_json_parser_specop_allocate ()
+{
+    return (EJSObject*)_ejs_gc_new (EJSJSONParser);
+}
+
+static void
+_ejs_json_parser_specop_finalize (EJSObject* obj)
+{
+    EJSJSONParser* parser = (EJSJSONParser*)obj;
+    free (parser->pending.chars);
+    _ejs_Object_specops.Finalize (obj);
+}
+
+static void
+_ejs_json_parser_specop_scan (EJSObject* obj, EJSValueFunc scan_func)
+{
+    EJSJSONParser* parser = (EJSJSONParser*)obj;
+    scan_func (parser->ready);
+    _ejs_Object_specops.Scan (obj, scan_func);
+}
+
+EJS_DEFINE_CLASS(JSONParser,
+                 OP_INHERIT, // [[GetPrototypeOf]]
+                 OP_INHERIT, // [[SetPrototypeOf]]
+                 OP_INHERIT, // [[IsExtensible]]
+                 OP_INHERIT, // [[PreventExtensions]]
+                 OP_INHERIT, // [[GetOwnProperty]]
+                 OP_INHERIT, // [[DefineOwnProperty]]
+                 OP_INHERIT, // [[HasProperty]]
+                 OP_INHERIT, // [[Get]]
+                 OP_INHERIT, // [[Set]]
+                 OP_INHERIT, // [[Delete]]
+                 OP_INHERIT, // [[Enumerate]]
+                 OP_INHERIT, // [[OwnPropertyKeys]]
+                 OP_INHERIT, // [[Call]]
+                 OP_INHERIT, // [[Construct]]
+                 _ejs_json_parser_specop_allocate,
+                 _ejs_json_parser_specop_finalize,
+                 _ejs_json_parser_specop_scan
+                 )
+
+// hands everything buffered to the stream
+static void
+json_writer_flush (EJSJSONWriter* writer)
+{
+    JSONBuffer* out = &writer->writer->out;
+    if (out->len == 0)
+        return;
+
+    ejsval chunk = _ejs_string_new_ucs2_len (out->chars, out->len);
+    out->len = 0;
+
+    ejsval write = Get (writer->stream, _ejs_atom_write);
+    if (!IsCallable(write))
+        _ejs_throw_nativeerror_utf8 (EJS_TYPE_ERROR, "JSONWriter stream has no write method");
+    _ejs_invoke_closure (write, &writer->stream, 1, &chunk, _ejs_undefined);
+}
+
+static EJS_NATIVE_FUNC(_ejs_JSONWriter_impl) {
+    if (EJSVAL_IS_UNDEFINED(newTarget))
+        _ejs_throw_nativeerror_utf8 (EJS_TYPE_ERROR, "JSONWriter constructor must be called with new");
+
+    ejsval stream = argc > 0 ? args[0] : _ejs_undefined;
+    if (!EJSVAL_IS_OBJECT(stream))
+        _ejs_throw_nativeerror_utf8 (EJS_TYPE_ERROR, "JSONWriter requires a stream");
+
+    ejsval obj = OrdinaryCreateFromConstructor(newTarget, _ejs_JSONWriter_prototype, &_ejs_JSONWriter_specops);
+    *_this = obj;
+
+    EJSJSONWriter* writer = (EJSJSONWriter*)EJSVAL_TO_OBJECT(obj);
+    writer->stream = stream;
+
+    // the key cache lives as long as the writer does, so the same keys in
+    // later values don't get scanned again.  the writer's scan op keeps
+    // the cached keys alive, so their addresses can't be reused.
+    writer->writer = (JSONWriter*)calloc (1, sizeof(JSONWriter));
+    for (int i = 0; i < JSON_QUOTED_KEY_CACHE_SIZE; i ++)
+        writer->writer->keys[i].key = _ejs_undefined;
+    return obj;
+}
+
+static EJS_NATIVE_FUNC(_ejs_JSONWriter_prototype_write) {
+    if (!EJSVAL_IS_JSONWRITER(*_this))
+        _ejs_throw_nativeerror_utf8 (EJS_TYPE_ERROR, "JSONWriter.prototype.write called on incompatible receiver");
+
+    EJSJSONWriter* writer = (EJSJSONWriter*)EJSVAL_TO_OBJECT(*_this);
+    JSONWriter* w = writer->writer;
+    ejsval value = argc > 0 ? args[0] : _ejs_undefined;
+
+    // code has run since the last value, so the prototypes need checking again
+    w->depth = 0;
+    memset (w->protos, 0, sizeof(w->protos));
+
+    int mark = w->out.len;
+    JSONFastResult r = json_fast_value (w, value);
+    if (r == JSON_FAST_BAIL) {
+        w->out.len = mark;
+
+        ejsval str = _ejs_json_stringify (value);
+        if (EJSVAL_IS_UNDEFINED(str))
+            return _ejs_undefined;
+        json_buffer_append (&w->out, EJSVAL_TO_FLAT_STRING(str), EJSVAL_TO_STRLEN(str));
+    }
+    else if (r == JSON_FAST_UNDEFINED) {
+        return _ejs_undefined;
+    }
+    json_buffer_append_ascii (&w->out, "\n", 1);
+
+    if (w->out.len >= JSON_WRITER_FLUSH_SIZE)
+        json_writer_flush (writer);
+    return _ejs_undefined;
+}
+
+static EJS_NATIVE_FUNC(_ejs_JSONWriter_prototype_end) {
+    if (!EJSVAL_IS_JSONWRITER(*_this))
+        _ejs_throw_nativeerror_utf8 (EJS_TYPE_ERROR, "JSONWriter.prototype.end called on incompatible receiver");
+
+    json_writer_flush ((EJSJSONWriter*)EJSVAL_TO_OBJECT(*_this));
+    return _ejs_undefined;
+}
+
+static EJSObject*
+_ejs_json_writer_specop_allocate ()
+{
+    return (EJSObject*)_ejs_gc_new (EJSJSONWriter);
+}
+
+static void
+_ejs_json_writer_specop_finalize (EJSObject* obj)
+{
+    EJSJSONWriter* writer = (EJSJSONWriter*)obj;
+    if (writer->writer) {
+        free (writer->writer->out.chars);
+        free (writer->writer);
+    }
+    _ejs_Object_specops.Finalize (obj);
+}
+
+static void
+_ejs_json_writer_specop_scan (EJSObject* obj, EJSValueFunc scan_func)
+{
+    EJSJSONWriter* writer = (EJSJSONWriter*)obj;
+    scan_func (writer->stream);
+    if (writer->writer) {
+        for (int i = 0; i < JSON_QUOTED_KEY_CACHE_SIZE; i ++)
+            scan_func (writer->writer->keys[i].key);
+    }
+    _ejs_Object_specops.Scan (obj, scan_func);
+}
+
+EJS_DEFINE_CLASS(JSONWriter,
+                 OP_INHERIT, // [[GetPrototypeOf]]
+                 OP_INHERIT, // [[SetPrototypeOf]]
+                 OP_INHERIT, // [[IsExtensible]]
+                 OP_INHERIT, // [[PreventExtensions]]
+                 OP_INHERIT, // [[GetOwnProperty]]
+                 OP_INHERIT, // [[DefineOwnProperty]]
+                 OP_INHERIT, // [[HasProperty]]
+                 OP_INHERIT, // [[Get]]
+                 OP_INHERIT, // [[Set]]
+                 OP_INHERIT, // [[Delete]]
+                 OP_INHERIT, // [[Enumerate]]
+                 OP_INHERIT, // [[OwnPropertyKeys]]
+                 OP_INHERIT, // [[Call]]
+                 OP_INHERIT, // [[Construct]]
+                 _ejs_json_writer_specop_allocate,
+                 _ejs_json_writer_specop_finalize,
+                 _ejs_json_writer_specop_scan
+                 )
+
+void
+_ejs_json_stream_init(ejsval ejs_obj)
+{
+    _ejs_JSONParser = _ejs_function_new_without_proto (_ejs_null, _ejs_atom_JSONParser, _ejs_JSONParser_impl);
+    _ejs_object_setprop (ejs_obj, _ejs_atom_JSONParser, _ejs_JSONParser);
+
+    _ejs_gc_add_root (&_ejs_JSONParser_prototype);
+    _ejs_JSONParser_prototype = _ejs_object_new (_ejs_Object_prototype, &_ejs_Object_specops);
+    _ejs_object_setprop (_ejs_JSONParser, _ejs_atom_prototype, _ejs_JSONParser_prototype);
+
+    _ejs_JSONWriter = _ejs_function_new_without_proto (_ejs_null, _ejs_atom_JSONWriter, _ejs_JSONWriter_impl);
+    _ejs_object_setprop (ejs_obj, _ejs_atom_JSONWriter, _ejs_JSONWriter);
+
+    _ejs_gc_add_root (&_ejs_JSONWriter_prototype);
+    _ejs_JSONWriter_prototype = _ejs_object_new (_ejs_Object_prototype, &_ejs_Object_specops);
+    _ejs_object_setprop (_ejs_JSONWriter, _ejs_atom_prototype, _ejs_JSONWriter_prototype);
+
+#define PROTO_METHOD(t,x) EJS_INSTALL_ATOM_FUNCTION_FLAGS(_ejs_##t##_prototype, x, _ejs_##t##_prototype_##x, EJS_PROP_NOT_ENUMERABLE | EJS_PROP_WRITABLE | EJS_PROP_CONFIGURABLE)
+
+    PROTO_METHOD(JSONParser, write);
+    PROTO_METHOD(JSONParser, end);
+    PROTO_METHOD(JSONWriter, write);
+    PROTO_METHOD(JSONWriter, end);
+
+#undef PROTO_METHOD
+}
+
 void
 _ejs_json_init(ejsval global)
 {
@@ -11,8 +11,14 @@ EJS_BEGIN_DECLS
 
 extern ejsval _ejs_JSON;
 
+extern EJSSpecOps _ejs_JSONParser_specops;
+extern EJSSpecOps _ejs_JSONWriter_specops;
+
 void _ejs_json_init(ejsval global);
 
+// installs the streaming JSONParser/JSONWriter on @ejs_obj (__ejs)
+void _ejs_json_stream_init(ejsval ejs_obj);
+
 ejsval _ejs_json_stringify(ejsval arg);
 
 EJS_END_DECLS
@@ -2,6 +2,7 @@
 #include <stdarg.h>
 
 #include "ejs.h"
+#include "ejs-output.h"
 
 static FILE*   log_file;
 static EJSBool check_log_file;
@@ -27,10 +28,13 @@ _ejs_log (const char* fmt, ...)
 
   init_log_file();
 
+  // stderr isn't buffered, but console.error output to it might be
+  if (log_file == stderr)
+    _ejs_output_flush_all();
+
   va_start(va, fmt);
 
   vfprintf (log_file, fmt, va);
-  fflush(log_file);
 
   va_end(va);
 }
@@ -40,6 +44,18 @@ _ejs_logstr (const char* str)
 {
   init_log_file();
 
+  if (log_file == stderr)
+    _ejs_output_flush_all();
+
   fprintf (log_file, "%s\n", str);
-  fflush(log_file);
+}
+
+// a log file is only written out when its buffer fills, or at exit, so
+// anything about to abort() has to call this first
+void
+_ejs_log_flush ()
+{
+  _ejs_output_flush_all();
+  if (log_file)
+    fflush(log_file);
 }
@@ -11,6 +11,7 @@ EJS_BEGIN_DECLS
 
 void _ejs_log (const char* fmt, ... );
 void _ejs_logstr (const char* str);
+void _ejs_log_flush ();
 
 EJS_END_DECLS
 
@@ -2,6 +2,7 @@
 #include <stdarg.h>
 
 #include "ejs.h"
+#include "ejs-output.h"
 
 #include <Foundation/NSObjCRuntime.h>
 #include <Foundation/NSString.h>
@@ -32,7 +33,6 @@ _ejs_log (const char* fmt, ...)
 
   if (log_file) {
     vfprintf (log_file, fmt, va);
-    fflush(log_file);
   }
   else {
     NSLogv ([NSString stringWithUTF8String:fmt], va);
@@ -48,9 +48,16 @@ _ejs_logstr (const char* str)
 
   if (log_file) {
     fprintf (log_file, "%s\n", str);
-    fflush(log_file);
   }
   else {
     NSLog (@"%s", str);
   }
 }
+
+void
+_ejs_log_flush ()
+{
+  _ejs_output_flush_all();
+  if (log_file)
+    fflush(log_file);
+}
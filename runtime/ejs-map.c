@@ -464,6 +464,7 @@ _ejs_map_iterator_new (ejsval map, EJSMapIteratorKind kind)
 
     /* 6. Set iterator’s [[MapNextIndex]] internal slot to 0. */
     iterator->next_index = 0;
+    iterator->cursor = NULL;
 
     /* 7. Set iterator’s [[MapIterationKind]] internal slot to kind. */
     iterator->kind = kind;
@@ -478,77 +479,62 @@ static EJS_NATIVE_FUNC(_ejs_MapIterator_impl) {
     return *_this;
 }
 
-static EJS_NATIVE_FUNC(_ejs_MapIterator_prototype_next) {
-    /* 1. 0 Let O be the this value. */
-    ejsval O = *_this;
-
-    /* 2. If Type(O) is not Object, throw a TypeError exception. */
-    if (!EJSVAL_IS_OBJECT(O))
-        _ejs_throw_nativeerror_utf8 (EJS_TYPE_ERROR, "XXX");
-
-    /* 3. If O does not have all of the internal slots of a Map Iterator Instance (23.1.5.3),
-     * throw a TypeError exception. */
-    if (!EJSVAL_IS_MAPITERATOR(O))
-        _ejs_throw_nativeerror_utf8 (EJS_TYPE_ERROR, "XXX");
-
+// the body of %MapIteratorPrototype%.next, minus the iter result.
+// returns the EJS_NO_ITER_VALUE magic once the iterator is done.  O
+// must be a Map Iterator.
+ejsval
+_ejs_map_iterator_step (ejsval O)
+{
     EJSMapIterator *OObj = (EJSMapIterator*)EJSVAL_TO_OBJECT(O);
 
     /* 4. Let m be the value of the [[Map]] internal slot of O. */
     ejsval m = OObj->iterated;
 
     /* 5. Let index be the value of the [[MapNextIndex]] internal slot of O. */
-    uint32_t index = OObj->next_index;
+    // we keep a pointer to the last entry we returned instead of an
+    // index, so each step doesn't have to walk the list from the start.
+    // entries are only ever marked empty while the map is alive, never
+    // unlinked, so the cursor stays valid.
 
     /* 6. Let itemKind be the value of the [[MapIterationKind]] internal slot of O. */
     EJSMapIteratorKind itemKind = OObj->kind;
 
     /* 7. If m is undefined, then return CreateIterResultObject(undefined, true) */
     if (EJSVAL_IS_UNDEFINED(m))
-        return _ejs_create_iter_result (_ejs_undefined, _ejs_true);
+        return MAGIC_TO_EJSVAL_IMPL(EJS_NO_ITER_VALUE);
 
     /* 8. Assert: m has a [[MapData]] internal slot and m has been initialized so the value of
      * [[MapData]] is not undefined. */
 
     /* 9. Let entries be the List that is the value of the [[MapData]] internal slot of m. */
-    EJSKeyValueEntry* entries = EJSVAL_TO_MAP(m)->head_insert;
+    EJSKeyValueEntry* entry = OObj->cursor ? OObj->cursor->next_insert : EJSVAL_TO_MAP(m)->head_insert;
 
     /* 10. Repeat while index is less than the total number of elements of entries. The number of elements must
      * be redetermined each time this method is evaluated. */
-    uint32_t i = 0;
-    for (EJSKeyValueEntry *entry = entries; entry; entry = entry->next_insert) {
-
-        /* Ignore if this entry is marked as empty */
-        if (EJSVAL_IS_NO_ITER_VALUE_MAGIC(entry->key))
-            continue;
-
-        /* Ignore this item if we haven't reached the initial needed point/index */
-        if (index > i++)
-            continue;
-
+    for (; entry; entry = entry->next_insert) {
         /* a. Let e be the Record {[[key]], [[value]]} that is the value of entries[index]. */
         EJSKeyValueEntry *e = entry;
 
         /* b. Set index to index+1; */
-        index = index + 1;
-
         /* c. Set the [[MapNextIndex]] internal slot of O to index. */
-        OObj->next_index = index;
+        OObj->cursor = e;
+        OObj->next_index ++;
 
         /* d. If e.[[key]] is not empty, then */
-        /* (see EJSVAL_IS_NO_ITER_VALUE_MAGIC check at the beginning of the loop) */
-        ejsval result;
+        if (EJSVAL_IS_NO_ITER_VALUE_MAGIC(e->key))
+            continue;
 
         /*  i. If itemKind is "key" then, let result be e.[[key]]. */
         if (itemKind == EJS_MAP_ITER_KIND_KEY)
-            result = e->key;
+            return e->key;
         /*  ii. Else if itemKind is "value" then, let result be e.[[value]]. */
         else if (itemKind == EJS_MAP_ITER_KIND_VALUE)
-            result = e->value;
+            return e->value;
         /*  iii. Else, */
         else {
             /* 1. Assert: itemKind is "key+value". */
             /* 2. Let result be the result of performing ArrayCreate(2). */
-            result = _ejs_array_new (2, EJS_FALSE);
+            ejsval result = _ejs_array_new (2, EJS_FALSE);
 
             /* 3. Assert: result is a new, well-formed Array object so the following operations will never fail. */
             /* 4. Call CreateDataProperty(result, "0", e.[[key]]) . */
@@ -556,17 +542,38 @@ static EJS_NATIVE_FUNC(_ejs_MapIterator_prototype_next) {
 
             /* 5. Call CreateDataProperty(result, "1", e.[[value]]). */
             _ejs_object_setprop (result, NUMBER_TO_EJSVAL(1), e->value);
-        }
 
-        /*  iv. Return CreateIterResultObject(result, false). */
-        return _ejs_create_iter_result (result, _ejs_false);
+            /*  iv. Return CreateIterResultObject(result, false). */
+            return result;
+        }
     }
 
     /* 11. Set the [[Map]] internal slot of O to undefined. */
     OObj->iterated = _ejs_undefined;
+    OObj->cursor = NULL;
 
     /* 12. Return CreateIterResultObject(undefined, true). */
-    return _ejs_create_iter_result (_ejs_undefined, _ejs_true);
+    return MAGIC_TO_EJSVAL_IMPL(EJS_NO_ITER_VALUE);
+}
+
+EJS_NATIVE_FUNC(_ejs_MapIterator_prototype_next) {
+    /* 1. 0 Let O be the this value. */
+    ejsval O = *_this;
+
+    /* 2. If Type(O) is not Object, throw a TypeError exception. */
+    if (!EJSVAL_IS_OBJECT(O))
+        _ejs_throw_nativeerror_utf8 (EJS_TYPE_ERROR, "XXX");
+
+    /* 3. If O does not have all of the internal slots of a Map Iterator Instance (23.1.5.3),
+     * throw a TypeError exception. */
+    if (!EJSVAL_IS_MAPITERATOR(O))
+        _ejs_throw_nativeerror_utf8 (EJS_TYPE_ERROR, "XXX");
+
+    ejsval result = _ejs_map_iterator_step (O);
+    if (EJSVAL_IS_NO_ITER_VALUE_MAGIC(result))
+        return _ejs_create_iter_result (_ejs_undefined, _ejs_true);
+
+    return _ejs_create_iter_result (result, _ejs_false);
 }
 
 void
@@ -59,6 +59,7 @@ typedef struct {
     ejsval iterated;
     EJSMapIteratorKind kind;
     int next_index;
+    EJSKeyValueEntry* cursor; // the last entry visited, NULL before the first
 } EJSMapIterator;
 
 extern ejsval _ejs_MapIterator;
@@ -66,6 +67,9 @@ extern ejsval _ejs_MapIterator_prototype;
 extern EJSSpecOps _ejs_MapIterator_specops;
 
 ejsval _ejs_map_iterator_new (ejsval map, EJSMapIteratorKind kind);
+ejsval _ejs_map_iterator_step (ejsval iterator);
+
+EJS_NATIVE_FUNC(_ejs_MapIterator_prototype_next);
 
 EJS_END_DECLS
 
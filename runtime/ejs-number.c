@@ -106,181 +106,99 @@ static EJS_NATIVE_FUNC(_ejs_Number_prototype_valueOf) {
     return NUMBER_TO_EJSVAL(x);
 }
 
-// ECMA262: 20.1.3.3 Number.prototype.toFixed ( fractionDigits ) 
+// ES2015, June 2015
+// 20.1.3.2 Number.prototype.toExponential ( fractionDigits )
+static EJS_NATIVE_FUNC(_ejs_Number_prototype_toExponential) {
+    ejsval fractionDigits = _ejs_undefined;
+    if (argc > 0) fractionDigits = args[0];
+
+    // 1. Let x be thisNumberValue(this value).
+    // 2. ReturnIfAbrupt(x).
+    double x = thisNumberValue(*_this);
+
+    // 3. Let f be ToInteger(fractionDigits).
+    // 4. Assert: f is 0, when fractionDigits is undefined.
+    // 5. ReturnIfAbrupt(f).
+    int64_t f = ToInteger(fractionDigits);
+
+    // 6. If x is NaN, return the String "NaN".
+    // 7-9. (the sign, and "Infinity")
+    if (!isfinite(x))
+        return NumberToString(x, 10);
+
+    // 10. If f < 0 or f > 20, throw a RangeError exception.
+    if (f < 0 || f > 20)
+        _ejs_throw_nativeerror_utf8 (EJS_RANGE_ERROR, "toExponential() argument must be between 0 and 20");
+
+    // 11-15. if fractionDigits is undefined, as many digits as it
+    //        takes to uniquely identify x, otherwise f of them, and
+    //        the exponent.
+    char num_buf[EJS_DTOA_BUFFER_SIZE];
+    int num_len = _ejs_dtoa_exponential (x, EJSVAL_IS_UNDEFINED(fractionDigits) ? -1 : (int)f, num_buf);
+    return _ejs_string_new_ascii_len (num_buf, num_len);
+}
+
+// ES2015, June 2015
+// 20.1.3.3 Number.prototype.toFixed ( fractionDigits )
 static EJS_NATIVE_FUNC(_ejs_Number_prototype_toFixed) {
-    EJS_NOT_IMPLEMENTED();
-#if notyet
     ejsval fractionDigits = _ejs_undefined;
     if (argc > 0) fractionDigits = args[0];
 
-    // 1. Let x be thisNumberValue(this value). 
-    // 2. ReturnIfAbrupt(x). 
+    // 1. Let x be thisNumberValue(this value).
+    // 2. ReturnIfAbrupt(x).
     double x = thisNumberValue(*_this);
 
-    // 3. Let f be ToInteger(fractionDigits). (If fractionDigits is undefined, this step produces the value 0). 
+    // 3. Let f be ToInteger(fractionDigits). (If fractionDigits is undefined, this step produces the value 0).
     // 4. ReturnIfAbrupt(f).
     int64_t f = ToInteger(fractionDigits);
-    
+
     // 5. If f < 0 or f > 20, throw a RangeError exception.
     if (f < 0 || f > 20)
-        _ejs_throw_nativeerror_utf8 (EJS_RANGE_ERROR, "fractionDigits must be in the range of 0 <= f < 21");
-
-    // 6. If x is NaN, return the String "NaN". 
-    if (isnan(x))
-        return _ejs_atom_NaN;
-
-    // 7. Let s be the empty String.
-    ejsval s = _ejs_atom_empty;
-
-    // 8. If x < 0, then 
-    if (x < 0) {
-        //    a. Let s be "-". 
-        s = _ejs_atom_minus;
-        //    b. Let x = –x. 
-        x -= x;
-    }
-    ejsval m;
-    // 9. If x >= 10^21, then 
-    if (x >= 1e21) {
-        //    a. Let m = ToString(x). 
-        m = ToString(x);
-    }
-    // 10. Else x < 10^21
-    else {
-        //     a. Let n be an integer for which the exact mathematical value of n / 10^f – x is as close to zero as 
-        //         possible. If there are two such n, pick the larger n. 
-
-        //     b. If n = 0, let m be the String "0". Otherwise, let m be the String consisting of the digits of the 
-        //        decimal representation of n (in order, with no leading zeroes). 
-        if (n == 0)
-            m = _ejs_atom_0;
-        else
-            EJS_NOT_IMPLEMENTED(); // XXX let m be the String consisting of the digits of the decimal representation of n (in order, with no leading zeroes). 
-        //     c. If f != 0, then 
-        if (f != 0) {
-            //        i. Let k be the number of elements in m. 
-            //        ii. If k <= f, then 
-            if (k <= f) {
-                //            1. Let z be the String consisting of f+1-k occurrences of the code unit 0x0030. 
-                ejsval z = zeros[f+1-k];
-                //            2. Let m be the concatenation of Strings z and m. 
-                m = _ejs_string_concat (z, m);
-                //            3. Let k = f + 1. 
-                k = f + 1;
-            }
-            //        iii. Let a be the first k–f elements of m, and let b be the remaining f elements of m. 
-            ejsval a = _ejs_string_new_substring(m, 0, k-f);
-            ejsval b = _ejs_string_new_substring(m, k-f, f);
-            //        iv. Let m be the concatenation of the three Strings a, ".", and b. 
-            m = _ejs_string_concatv (a, _ejs_atom_dot, b, _ejs_null);
-        }
-    }
-    // 11. Return the concatenation of the Strings s and m. 
-    return _ejs_string_concat(s, m);
-#endif
+        _ejs_throw_nativeerror_utf8 (EJS_RANGE_ERROR, "toFixed() digits argument must be between 0 and 20");
+
+    // 6. If x is NaN, return the String "NaN".
+    // 7-9. (the sign)
+    // 10. If x >= 10^21, let m = ToString(x).
+    // 11. Else, the digits of the integer n for which n / 10^f - x is as
+    //     close to zero as possible, with a "." f digits from the end.
+    // 12. Return the concatenation of the Strings s and m.
+    char num_buf[EJS_DTOA_BUFFER_SIZE];
+    int num_len = _ejs_dtoa_fixed (x, (int)f, num_buf);
+    return _ejs_string_new_ascii_len (num_buf, num_len);
 }
 
-// ECMA262: 20.1.3.5 Number.prototype.toPrecision ( precision ) 
+// ES2015, June 2015
+// 20.1.3.5 Number.prototype.toPrecision ( precision )
 static EJS_NATIVE_FUNC(_ejs_Number_prototype_toPrecision) {
-    EJS_NOT_IMPLEMENTED();
-#if notyet
     ejsval precision = _ejs_undefined;
     if (argc > 0) precision = args[0];
 
-    // 1. Let x be thisNumberValue(this value). 
-    // 2. ReturnIfAbrupt(x). 
+    // 1. Let x be thisNumberValue(this value).
+    // 2. ReturnIfAbrupt(x).
     double x = thisNumberValue(*_this);
 
-    // 3. If precision is undefined, return ToString(x). 
+    // 3. If precision is undefined, return ToString(x).
     if (EJSVAL_IS_UNDEFINED(precision))
-        return ToString(x);
-
-    // 4. Let p be ToInteger(precision). 
-    // 5. ReturnIfAbrupt(p). 
-    int64_t = ToInteger(precision);
-
-    // 6. If x is NaN, return the String "NaN". 
-    if (isnan(x))
-        return _ejs_atom_NaN;
-
-    // 7. Let s be the empty String. 
-    ejsval s = _ejs_atom_empty;
-
-    // 8. If x < 0, then 
-    if (x < 0) {
-        //    a. Let s be "-". 
-        s = _ejs_atom_minus;
-        //    b. Let x = –x. 
-        x = -x;
-    }
-    // 9. If x = +∞, then 
-    int classified = fpclassify(x);
-    if (classified == FP_INFINITE) {
-        //    a. Return the concatenation of the Strings s and "Infinity". 
-        return _ejs_string_concat (s, _ejs_atom_Infinity);
-    }
-
-    // 10. If p < 1 or p > 21, throw a RangeError exception. 
-    if (p < 1 || p > 21) {
-        _ejs_throw_nativeerror_utf8 (EJS_RANGE_ERROR, "precision must be in the range of 1 <= p <= 21");
-    }
-
-    double e;
-
-    // 11. If x = 0, then 
-    if (x == 0) {
-        //     a. Let m be the String consisting of p occurrences of the code unit 0x0030 (the Unicode character ‘0’). 
-        m = zeros[p];
-
-        //     b. Let e = 0. 
-        e = 0;
-    }
-    // 12. Else x != 0, 
-    else {
-        //     a. Let e and n be integers such that 10^(p–1) <= n < 10^p and for which the exact mathematical value of n * 10^(e–p+1) – x is as close to zero as possible.
-        //        If there are two such sets of e and n, pick the e and n for which n * 10^(e–p+1) is larger. 
-        //     b. Let m be the String consisting of the digits of the decimal representation of n (in order, with no leading zeroes). 
-        //     c. If e < –6 or e >= p, then 
-        //        i. Assert: e != 0 
-        //        ii. Let a be the first element of m, and let b be the remaining p–1 elements of m. 
-        //        iii. Let m be the concatenation of the three Strings a, ".", and b. 
-        //        iv. If e > 0, then 
-        if (e > 0)
-            //           1. Let c = "+". 
-            c = "+";
-        //        v. Else e < 0, 
-        else {
-            //           1. Let c = "-". 
-            c = "-";
-            //           2. Let e = –e. 
-            e = -e;
-        }
-        //        vi. Let d be the String consisting of the digits of the decimal representation of e (in order, with no leading zeroes). 
-        //        vii. Return the concatenation of the five Strings s, m, "e", c, and d. 
-        return _ejs_string_concatv (s, m, _ejs_string_new_utf8("e"), c, d, _ejs_null);
-    }
-    // 13. If e = p–1, then return the concatenation of the Strings s and m. 
-    if (e == p - 1)
-        return _ejs_string_concat(s, m);
-    // 14. If e >= 0, then 
-    if (e >= 0) {
-        //     a. Let m be the concatenation of the first e+1 elements of m, the code unit 0x002E (Unicode character ‘.’), and the remaining p– (e+1) elements of m. 
-    }
-    // 15. Else e < 0, 
-    else {
-        //     a. Let m be the concatenation of the String "0.", –(e+1) occurrences of code unit 0x0030 (the Unicode character ‘0’), and the String m. 
-        int z = -(e+1);
-        ejsval zstr;
-        if (z > 0 && z <= 21)
-            zstr = zeros[z];
-        else
-            EJS_NOT_IMPLEMENTED(); // create a string z 0's long
-
-        m = _ejs_string_concatv(zerodot, zstr, m, _ejs_null);
-    }
-    // 16. Return the concatenation of the Strings s and m.
-    return _ejs_string_concat(s, m);
-#endif
+        return NumberToString(x, 10);
+
+    // 4. Let p be ToInteger(precision).
+    // 5. ReturnIfAbrupt(p).
+    int64_t p = ToInteger(precision);
+
+    // 6. If x is NaN, return the String "NaN".
+    // 7-9. (the sign, and "Infinity")
+    if (!isfinite(x))
+        return NumberToString(x, 10);
+
+    // 10. If p < 1 or p > 21, throw a RangeError exception.
+    if (p < 1 || p > 21)
+        _ejs_throw_nativeerror_utf8 (EJS_RANGE_ERROR, "toPrecision() argument must be between 1 and 21");
+
+    // 11-16. the p digits of x closest to it, in exponential notation
+    //        if the exponent is < -6 or >= p, and fixed otherwise.
+    char num_buf[EJS_DTOA_BUFFER_SIZE];
+    int num_len = _ejs_dtoa_precision (x, (int)p, num_buf);
+    return _ejs_string_new_ascii_len (num_buf, num_len);
 }
 
 static EJS_NATIVE_FUNC(_ejs_Number_isFinite) {
@@ -419,6 +337,7 @@ _ejs_number_init(ejsval global)
     PROTO_METHOD(toString);
     PROTO_METHOD(toFixed);
     PROTO_METHOD(toPrecision);
+    PROTO_METHOD(toExponential);
     // ES6
     OBJ_METHOD(isFinite);
     OBJ_METHOD(isInteger);
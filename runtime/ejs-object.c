@@ -119,6 +119,9 @@ ToPropertyKey(ejsval argument)
         //    a. Return argument. 
         return argument;
     // 3. Return ToString(argument). 
+    //    (numeric keys are common enough to go straight to NumberToString and its cache)
+    if (EJSVAL_IS_NUMBER(argument))
+        return NumberToString(EJSVAL_TO_NUMBER(argument), 10);
     return ToString(argument);
 }
 
@@ -390,6 +393,13 @@ static int primes[] = {
 };
 static int nprimes = sizeof(primes) / sizeof(primes[0]);
 
+// every change to a property map gives it a new stamp from this
+// counter, so a (map, stamp) pair never refers to two different sets
+// of properties, even if the map is freed and its memory reused.
+static uint32_t propertymap_stamp;
+
+#define PROPERTYMAP_CHANGED(map) ((map)->stamp = ++propertymap_stamp)
+
 void
 _ejs_propertymap_init (EJSPropertyMap *map)
 {
@@ -398,6 +408,8 @@ _ejs_propertymap_init (EJSPropertyMap *map)
     map->buckets = NULL;
     map->nbuckets = 0;
     map->inuse = 0;
+    map->has_index_keys = EJS_FALSE;
+    PROPERTYMAP_CHANGED(map);
 }
 
 void
@@ -477,6 +489,7 @@ _ejs_propertymap_remove (EJSPropertyMap *map, ejsval name)
             free (s->desc);
             free (s);
             map->inuse --;
+            PROPERTYMAP_CHANGED(map);
             return;
         }
         prev = s;
@@ -547,6 +560,7 @@ _ejs_propertymap_insert (EJSPropertyMap* map, ejsval name, EJSPropertyDesc* desc
         if (EJSVAL_TO_BOOLEAN(_ejs_op_strict_eq(s->name, name))) {
             _ejs_propertydesc_free (s->desc);
             s->desc = desc;
+            PROPERTYMAP_CHANGED(map);
             return;
         }
     }
@@ -558,6 +572,13 @@ _ejs_propertymap_insert (EJSPropertyMap* map, ejsval name, EJSPropertyDesc* desc
     new_s->next_insert = NULL;
     map->buckets[bucket] = new_s;
     map->inuse ++;
+    PROPERTYMAP_CHANGED(map);
+
+    if (EJSVAL_IS_STRING(name) && EJSVAL_TO_STRLEN(name) > 0) {
+        jschar c = EJSVAL_TO_FLAT_STRING(name)[0];
+        if (c >= '0' && c <= '9')
+            map->has_index_keys = EJS_TRUE;
+    }
 
     if (!map->head_insert)
         map->head_insert = new_s;
@@ -576,9 +597,20 @@ struct _EJSPropertyIterator {
     EJSObject obj;
 
     ejsval forObj;
-    ejsval *keys;
+
+    // array indices are produced one at a time, so we don't create a
+    // string for every index before the loop starts.
+    int64_t num_indices; // forObj's length when we started
+    int64_t next_index;
+
+    // the rest of the enumerable keys, in a dense array that's shared
+    // with the for..in cache and other iterators.
+    ejsval keys;
     int num;
     int current;
+    uint32_t stamp;      // forObj's property map stamp when we started
+
+    ejsval current_key;
 };
 
 static EJSObject*
@@ -590,8 +622,6 @@ _ejs_property_iterator_specop_allocate ()
 static void
 _ejs_property_iterator_specop_finalize (EJSObject* obj)
 {
-    EJSPropertyIterator* iterator = (EJSPropertyIterator*)obj;
-    free (iterator->keys);
     _ejs_Object_specops.Finalize (obj);
 }
 
@@ -601,10 +631,8 @@ _ejs_property_iterator_specop_scan (EJSObject* obj, EJSValueFunc scan_func)
     EJSPropertyIterator *iter = (EJSPropertyIterator*)obj;
 
     scan_func (iter->forObj);
-
-    for (int i = 0; i < iter->num; i ++) {
-        scan_func (iter->keys[i]);
-    }
+    scan_func (iter->keys);
+    scan_func (iter->current_key);
 }
 
 static EJS_DEFINE_CLASS(_EJSPropertyIterator,
@@ -646,10 +674,13 @@ collect_keys (ejsval objval, int *num, int *alloc, ejsval **keys)
     EJS_ASSERT(obj);
 
     for (_EJSPropertyMapEntry *s = obj->map->head_insert; s; s = s->next_insert) {
+        // symbol keyed properties aren't enumerated by for..in
+        if (!EJSVAL_IS_STRING(s->name))
+            continue;
         if (_ejs_property_desc_is_enumerable (s->desc) && !name_in_keys (s->name, *keys, *num)) {
-            if (*num == *alloc-1) {
+            if (*num == *alloc) {
                 // we need to reallocate
-                (*alloc) += 10;
+                *alloc = *alloc ? *alloc * 2 : 8;
                 *keys = (ejsval*)realloc (*keys, (*alloc) * sizeof(ejsval));
             }
             (*keys)[(*num)++] = s->name;
@@ -659,6 +690,73 @@ collect_keys (ejsval objval, int *num, int *alloc, ejsval **keys)
     collect_keys (obj->proto, num, alloc, keys);
 }
 
+// the for..in cache maps an object (and its prototype chain) to the
+// array of enumerable keys we collected for it.  an entry is valid as
+// long as the stamps of every property map on the chain are unchanged,
+// so looping over the same object repeatedly, or over an object whose
+// prototype carries the keys (methods assigned to Foo.prototype, say),
+// doesn't walk and copy the property maps again.
+#define FORIN_CACHE_SIZE 64
+#define FORIN_CACHE_MAX_DEPTH 4
+
+typedef struct {
+    int        depth;
+    EJSObject* chain[FORIN_CACHE_MAX_DEPTH]; // never dereferenced, only compared
+    uint32_t   stamps[FORIN_CACHE_MAX_DEPTH];
+    ejsval     keys;
+} ForInCacheEntry;
+
+static ForInCacheEntry forin_cache[FORIN_CACHE_SIZE];
+
+static ejsval
+enumerable_keys (ejsval forObj)
+{
+    EJSObject* chain[FORIN_CACHE_MAX_DEPTH];
+    int depth = 0;
+    ForInCacheEntry* entry = NULL;
+
+    for (ejsval o = forObj; EJSVAL_IS_OBJECT(o); o = EJSVAL_TO_OBJECT(o)->proto) {
+        if (depth == FORIN_CACHE_MAX_DEPTH) {
+            depth = -1;
+            break;
+        }
+        chain[depth++] = EJSVAL_TO_OBJECT(o);
+    }
+
+    if (depth > 0) {
+        entry = &forin_cache[((uintptr_t)chain[0] >> 4) % FORIN_CACHE_SIZE];
+        if (entry->depth == depth) {
+            EJSBool hit = EJS_TRUE;
+            for (int i = 0; hit && i < depth; i ++)
+                hit = entry->chain[i] == chain[i] && entry->stamps[i] == chain[i]->map->stamp;
+            if (hit)
+                return entry->keys;
+        }
+    }
+
+    int num = 0;
+    int alloc = 0;
+    ejsval* keys = NULL;
+    collect_keys (forObj, &num, &alloc, &keys);
+
+    ejsval rv = _ejs_array_new_copy (num, keys);
+    free (keys);
+
+    if (entry) {
+        // entries start out zero filled, which isn't an object
+        if (!EJSVAL_IS_OBJECT(entry->keys))
+            _ejs_gc_add_root (&entry->keys);
+        entry->depth = depth;
+        for (int i = 0; i < depth; i ++) {
+            entry->chain[i] = chain[i];
+            entry->stamps[i] = chain[i]->map->stamp;
+        }
+        entry->keys = rv;
+    }
+
+    return rv;
+}
+
 ejsval
 _ejs_property_iterator_new (ejsval forVal)
 {
@@ -667,42 +765,26 @@ _ejs_property_iterator_new (ejsval forVal)
     ejsval iter = _ejs_object_new (_ejs_null, &_ejs__EJSPropertyIterator_specops);
     EJSPropertyIterator* iterator = (EJSPropertyIterator*)EJSVAL_TO_OBJECT(iter);
 
+    iterator->forObj = _ejs_undefined;
+    iterator->keys = _ejs_undefined;
+    iterator->current_key = _ejs_undefined;
+    iterator->num_indices = 0;
+    iterator->next_index = 0;
+    iterator->num = 0;
     iterator->current = -1;
 
-    if (EJSVAL_IS_PRIMITIVE(forVal) || EJSVAL_IS_NULL(forVal) || EJSVAL_IS_UNDEFINED(forVal)) {
-        iterator->num = 0;
-        return OBJECT_TO_EJSVAL(iterator);
-    }
+    if (EJSVAL_IS_PRIMITIVE(forVal) || EJSVAL_IS_NULL(forVal) || EJSVAL_IS_UNDEFINED(forVal))
+        return iter;
 
     if (EJSVAL_IS_OBJECT(forVal)) {
-        int num = 0;
-        int alloc = 10;
-        ejsval* keys;
-
+        // array keys first, then additional properties
         if (EJSVAL_IS_ARRAY(forVal))
-            alloc += EJS_ARRAY_LEN(forVal);
-
-        keys = (ejsval*)malloc (alloc * sizeof(ejsval));
-
-        if (EJSVAL_IS_ARRAY(forVal)) {
-            // iterate over array keys first then additional properties
-            for (int i = 0; i < EJS_ARRAY_LEN(forVal); i ++) {
-                // XXX skip holes
-                keys[num++] = ToPropertyKey(NUMBER_TO_EJSVAL(i));
-            }
-        }
-
-        collect_keys (forVal, &num, &alloc, &keys);
+            iterator->num_indices = EJS_ARRAY_LEN(forVal);
 
         iterator->forObj = forVal;
-        iterator->num = num;
-        if (num > 0) {
-            iterator->keys = keys;
-        }
-        else {
-            iterator->keys = NULL;
-            free (keys);
-        }
+        iterator->keys = enumerable_keys (forVal);
+        iterator->num = EJS_ARRAY_LEN(iterator->keys);
+        iterator->stamp = EJSVAL_TO_OBJECT(forVal)->map->stamp;
 
         return iter;
     }
@@ -711,11 +793,45 @@ _ejs_property_iterator_new (ejsval forVal)
     }
 }
 
+// moves to the next key, returning false if there isn't one.  keys
+// deleted after the loop started are skipped.
+static EJSBool
+property_iterator_advance (EJSPropertyIterator* iterator)
+{
+    if (iterator->next_index < iterator->num_indices) {
+        int64_t index;
+        ejsval value;
+        if (_ejs_array_next_present (iterator->forObj, iterator->next_index, &index, &value) &&
+            index < iterator->num_indices) {
+            iterator->next_index = index + 1;
+            iterator->current_key = ToPropertyKey(NUMBER_TO_EJSVAL(index));
+            return EJS_TRUE;
+        }
+        iterator->next_index = iterator->num_indices;
+    }
+
+    EJSObject* obj = EJSVAL_IS_OBJECT(iterator->forObj) ? EJSVAL_TO_OBJECT(iterator->forObj) : NULL;
+
+    while (++iterator->current < iterator->num) {
+        ejsval key = EJS_DENSE_ARRAY_ELEMENTS(iterator->keys)[iterator->current];
+
+        // if nothing about the object's own properties has changed, the
+        // key is still there.  otherwise check.
+        if (obj->map->stamp != iterator->stamp && !HasProperty(iterator->forObj, key))
+            continue;
+
+        iterator->current_key = key;
+        return EJS_TRUE;
+    }
+    iterator->current = iterator->num;
+    return EJS_FALSE;
+}
+
 ejsval
 _ejs_property_iterator_current (ejsval iter)
 {
     EJSPropertyIterator* iterator = (EJSPropertyIterator*)EJSVAL_TO_OBJECT(iter);
-    if (iterator->current == -1) {
+    if (iterator->current == -1 && iterator->next_index == 0) {
         printf ("_ejs_property_iterator_current called before _ejs_property_iterator_next\n");
         abort();
     }
@@ -724,15 +840,14 @@ _ejs_property_iterator_current (ejsval iter)
         // FIXME runtime error
         EJS_NOT_IMPLEMENTED();
     }
-    return iterator->keys[iterator->current];
+    return iterator->current_key;
 }
 
 EJSBool
 _ejs_property_iterator_next (ejsval iter, EJSBool free_on_end)
 {
     EJSPropertyIterator* iterator = (EJSPropertyIterator*)EJSVAL_TO_OBJECT(iter);
-    iterator->current ++;
-    if (iterator->current == iterator->num) {
+    if (!property_iterator_advance (iterator)) {
         if (free_on_end)
             _ejs_property_iterator_free (iter);
         return EJS_FALSE;
@@ -740,6 +855,17 @@ _ejs_property_iterator_next (ejsval iter, EJSBool free_on_end)
     return EJS_TRUE;
 }
 
+// _ejs_property_iterator_next and _current in one call.  returns the
+// EJS_NO_ITER_VALUE magic when there are no keys left.
+ejsval
+_ejs_property_iterator_step (ejsval iter)
+{
+    EJSPropertyIterator* iterator = (EJSPropertyIterator*)EJSVAL_TO_OBJECT(iter);
+    if (!property_iterator_advance (iterator))
+        return MAGIC_TO_EJSVAL_IMPL(EJS_NO_ITER_VALUE);
+    return iterator->current_key;
+}
+
 void
 _ejs_property_iterator_free (ejsval iter)
 {
@@ -2368,8 +2494,10 @@ _ejs_object_specop_define_own_property (ejsval O, ejsval P, EJSPropertyDesc* Des
         _ejs_property_desc_set_value (dest, _ejs_property_desc_get_value (Desc));
     if (_ejs_property_desc_has_configurable (Desc))
         _ejs_property_desc_set_configurable (dest, _ejs_property_desc_is_configurable (Desc));
-    if (_ejs_property_desc_has_enumerable (Desc))
+    if (_ejs_property_desc_has_enumerable (Desc)) {
         _ejs_property_desc_set_enumerable (dest, _ejs_property_desc_is_enumerable (Desc));
+        PROPERTYMAP_CHANGED(obj->map);
+    }
     if (_ejs_property_desc_has_writable (Desc))
         _ejs_property_desc_set_writable (dest, _ejs_property_desc_is_writable (Desc));
 
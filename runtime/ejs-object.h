@@ -131,6 +131,8 @@ struct _EJSPropertyMap {
     _EJSPropertyMapEntry** buckets;
     int nbuckets;
     int inuse;
+    EJSBool has_index_keys; // sticky, set once a key starting with a digit is inserted
+    uint32_t stamp;         // changes whenever a property is added, removed or redefined
 };
 
 typedef struct _EJSPropertyMap EJSPropertyMap;
@@ -264,6 +266,7 @@ ejsval _ejs_object_getprop_utf8 (ejsval obj, const char *key);
 ejsval  _ejs_property_iterator_new (ejsval forObj);
 ejsval  _ejs_property_iterator_current (ejsval iterator);
 EJSBool _ejs_property_iterator_next (ejsval iterator, EJSBool free_on_end);
+ejsval  _ejs_property_iterator_step (ejsval iterator);
 void    _ejs_property_iterator_free (ejsval iterator);
 
 extern ejsval _ejs_Object;
@@ -19,6 +19,8 @@
 #include "ejs-ops.h"
 #include "ejs-error.h"
 #include "ejs-array.h"
+#include "ejs-map.h"
+#include "ejs-set.h"
 #include "ejs-proxy.h"
 
 ejsval _ejs_isNaN EJSVAL_ALIGNMENT;
@@ -26,14 +28,6 @@ ejsval _ejs_isFinite EJSVAL_ALIGNMENT;
 ejsval _ejs_parseInt EJSVAL_ALIGNMENT;
 ejsval _ejs_parseFloat EJSVAL_ALIGNMENT;
 
-typedef enum {
-    TO_PRIM_HINT_DEFAULT,
-    TO_PRIM_HINT_STRING,
-    TO_PRIM_HINT_NUMBER
-} ToPrimitiveHint;
-ejsval
-ToPrimitive(ejsval inputargument, ToPrimitiveHint PreferredType);
-
 static const size_t UINT32_CHAR_BUFFER_LENGTH = sizeof("4294967295") - 1;
 
 static char *
@@ -80,11 +74,12 @@ IntToCString(char *cbuf, jsint i, jsint base)
     return cp;
 }
 
+// @cbuf needs room for UINT32_CHAR_BUFFER_LENGTH digits, a sign and a \0
 static jschar *
 IntToUCS2(jschar *cbuf, jsint i, jsint base)
 {
-    jsuint u = (i < 0) ? -i : i;
-    jschar *cp = cbuf + UINT32_CHAR_BUFFER_LENGTH;
+    jsuint u = (i < 0) ? -(jsuint)i : i;
+    jschar *cp = cbuf + UINT32_CHAR_BUFFER_LENGTH + 1;
 
     *cp = '\0';
 
@@ -146,18 +141,59 @@ static const ejsval* builtin_numbers_atoms[] = {
     &_ejs_atom_198,&_ejs_atom_199,&_ejs_atom_200
 };
 
+// a direct mapped cache of the strings NumberToString has made for
+// numbers outside the atoms above, so stringifying the same ids, indices
+// and values over and over doesn't allocate a new string every time.
+// it isn't a root: _ejs_gc_collect empties it before marking.
+#define NUMBER_STRING_CACHE_SIZE 4096 // a power of 2
+
+typedef struct {
+    double number;
+    ejsval string; // a string, or 0 (which isn't) if the entry is empty
+} NumberStringCacheEntry;
+
+static NumberStringCacheEntry number_string_cache[NUMBER_STRING_CACHE_SIZE];
+static uint64_t number_string_cache_hits;
+static uint64_t number_string_cache_misses;
+
+static NumberStringCacheEntry*
+number_string_cache_entry (double d, EJSBool is_int32, int32_t i)
+{
+    uint32_t hash;
+    if (is_int32) {
+        // consecutive integers go in consecutive slots
+        hash = (uint32_t)i;
+    }
+    else {
+        uint64_t bits;
+        memcpy (&bits, &d, sizeof(bits));
+        hash = (uint32_t)bits ^ (uint32_t)(bits >> 32);
+        hash ^= hash >> 16;
+    }
+    return &number_string_cache[hash & (NUMBER_STRING_CACHE_SIZE - 1)];
+}
+
+void
+_ejs_number_string_cache_clear ()
+{
+    memset (number_string_cache, 0, sizeof(number_string_cache));
+}
+
+EJS_NATIVE_FUNC(_ejs_numberStringCacheStats) {
+    ejsval stats = _ejs_object_new (_ejs_Object_prototype, &_ejs_Object_specops);
+    _ejs_object_setprop (stats, _ejs_atom_hits, NUMBER_TO_EJSVAL(number_string_cache_hits));
+    _ejs_object_setprop (stats, _ejs_atom_misses, NUMBER_TO_EJSVAL(number_string_cache_misses));
+    _ejs_object_setprop (stats, _ejs_atom_size, NUMBER_TO_EJSVAL(NUMBER_STRING_CACHE_SIZE));
+    return stats;
+}
+
 ejsval NumberToString(double d, int base)
 {
     int32_t i;
-    if (EJSDOUBLE_IS_INT32(d, &i)) {
-        if (i >=0 && i <= 200 && base == 10)
-            return *builtin_numbers_atoms[i];
-        jschar int_buf[UINT32_CHAR_BUFFER_LENGTH+1];
-        jschar *cp = IntToUCS2(int_buf, i, base);
-        return _ejs_string_new_ucs2 (cp);
-    }
+    EJSBool is_int32 = EJSDOUBLE_IS_INT32(d, &i);
+    if (base == 10 && is_int32 && i >=0 && i <= 200)
+        return *builtin_numbers_atoms[i];
 
-    char num_buf[256];
     int classified = fpclassify(d);
     if (classified == FP_INFINITE) {
         if (d < 0)
@@ -168,11 +204,37 @@ ejsval NumberToString(double d, int base)
     else if (classified == FP_NAN) {
         return _ejs_atom_NaN;
     }
+
+    if (base != 10) {
+        char num_buf[EJS_DTOA_BUFFER_SIZE];
+        int num_len = _ejs_dtoa_radix(d, base, num_buf);
+        return _ejs_string_new_ascii_len (num_buf, num_len);
+    }
+
+    // -0 and 0 both hash (and compare) the same, which is fine since
+    // they're both "0"
+    NumberStringCacheEntry* entry = number_string_cache_entry (d, is_int32, i);
+    if (EJSVAL_IS_STRING(entry->string) && entry->number == d) {
+        number_string_cache_hits ++;
+        return entry->string;
+    }
+    number_string_cache_misses ++;
+
+    ejsval rv;
+    if (is_int32) {
+        jschar int_buf[UINT32_CHAR_BUFFER_LENGTH+2];
+        jschar *cp = IntToUCS2(int_buf, i, base);
+        rv = _ejs_string_new_ucs2_len (cp, int_buf + UINT32_CHAR_BUFFER_LENGTH + 1 - cp);
+    }
     else {
-        // XXX we need to take @base into account
-        _ejs_dtoa(d, num_buf, sizeof(num_buf));
+        char num_buf[EJS_DTOA_BUFFER_SIZE];
+        int num_len = _ejs_dtoa_shortest(d, num_buf);
+        rv = _ejs_string_new_ascii_len (num_buf, num_len);
     }
-    return _ejs_string_new_utf8 (num_buf);
+
+    entry->number = d;
+    entry->string = rv;
+    return rv;
 }
 
 // returns an EJSPrimString*.
@@ -212,21 +274,8 @@ ejsval ToNumber(ejsval exp)
     else if (EJSVAL_IS_BOOLEAN(exp))
         return EJSVAL_TO_BOOLEAN(exp) ? _ejs_one : _ejs_zero;
     else if (EJSVAL_IS_STRING(exp)) {
-        char num_utf8_buf[128];
-        memset(num_utf8_buf, 0, sizeof(num_utf8_buf));
-        char* num_utf8 = ucs2_to_utf8_buf(EJSVAL_TO_FLAT_STRING(exp), num_utf8_buf, sizeof(num_utf8_buf));
-        if (num_utf8 == NULL) {
-            num_utf8 = ucs2_to_utf8(EJSVAL_TO_FLAT_STRING(exp));
-        }
-        char *endptr;
-        double d = strtod(num_utf8, &endptr);
-        if (*endptr != '\0') {
-            if (num_utf8 != num_utf8_buf) free (num_utf8);
-            return _ejs_nan;
-        }
-        ejsval rv = NUMBER_TO_EJSVAL(d); // XXX NaN
-        if (num_utf8 != num_utf8_buf) free (num_utf8);
-        return rv;
+        EJSPrimString* flat = _ejs_string_flatten(exp);
+        return NUMBER_TO_EJSVAL(_ejs_string_to_number(flat->data.flat, flat->length));
     }
     else if (EJSVAL_IS_SYMBOL(exp)) {
         _ejs_throw_nativeerror_utf8 (EJS_TYPE_ERROR, "1"); // XXX
@@ -260,6 +309,179 @@ ejsval ToNumber(ejsval exp)
         EJS_NOT_IMPLEMENTED();
 }
 
+// a decimal integer of at most 15 digits is exact in a double, so we
+// don't need double-conversion for it.  this is most numeric strings.
+static EJSBool
+parse_short_decimal (const jschar* chars, int length, double* result)
+{
+    const jschar* p = chars;
+    const jschar* end = chars + length;
+    EJSBool negative = EJS_FALSE;
+
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+    if (p == end || end - p > 15)
+        return EJS_FALSE;
+
+    int64_t v = 0;
+    for (; p < end; p++) {
+        if (*p < '0' || *p > '9')
+            return EJS_FALSE;
+        v = v * 10 + (*p - '0');
+    }
+    *result = negative ? -(double)v : (double)v;
+    return EJS_TRUE;
+}
+
+static int
+radix_digit (jschar c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'Z') return c - 'A' + 10;
+    return 36;
+}
+
+// the value of the radix @R digits at the start of @chars, correctly
+// rounded for radix 10 and the powers of 2.  other radixes are exact up
+// to 2^53 and approximate past it, which 18.2.5 allows.  sets *@processed
+// to the number of digits.
+static double
+parse_radix_integer (const jschar* chars, int length, int R, int* processed)
+{
+    int i = 0;
+    while (i < length && radix_digit(chars[i]) < R)
+        i++;
+    *processed = i;
+    if (i == 0)
+        return NAN;
+
+    double d;
+    if (R == 10) {
+        int n;
+        if (parse_short_decimal (chars, i, &d))
+            return d;
+        return _ejs_strtod (chars, i, EJS_FALSE, &n);
+    }
+
+    if ((R & (R - 1)) == 0) {
+        int bits_per_digit = __builtin_ctz(R);
+        uint64_t number = 0;
+        int exponent = 0;
+        for (int j = 0; j < i; j++) {
+            number = number * R + radix_digit(chars[j]);
+            int overflow = (int)(number >> 53);
+            if (overflow == 0)
+                continue;
+
+            // keep the top 53 bits, and round the ones we drop (and the
+            // rest of the digits) half to even.
+            int overflow_bits = 1;
+            while (overflow > 1) {
+                overflow_bits++;
+                overflow >>= 1;
+            }
+            int dropped_bits = (int)(number & ((1 << overflow_bits) - 1));
+            int middle = 1 << (overflow_bits - 1);
+            number >>= overflow_bits;
+            exponent = overflow_bits;
+
+            EJSBool zero_tail = EJS_TRUE;
+            for (j++; j < i; j++) {
+                if (radix_digit(chars[j]) != 0)
+                    zero_tail = EJS_FALSE;
+                exponent += bits_per_digit;
+            }
+
+            if (dropped_bits > middle || (dropped_bits == middle && ((number & 1) || !zero_tail)))
+                number++;
+            if (number & (1ULL << 53)) {
+                exponent++;
+                number >>= 1;
+            }
+            break;
+        }
+        return ldexp((double)number, exponent);
+    }
+
+    d = 0;
+    for (int j = 0; j < i; j++)
+        d = d * R + radix_digit(chars[j]);
+    return d;
+}
+
+double
+_ejs_string_to_number (const jschar* chars, int length)
+{
+    // StringNumericLiteral ::: StrWhiteSpace_opt StrNumericLiteral StrWhiteSpace_opt
+    int start = 0, end = length;
+    while (start < end && IsWhitespace(chars[start]))
+        start++;
+    while (end > start && IsWhitespace(chars[end - 1]))
+        end--;
+
+    // StrWhiteSpace_opt is 0
+    if (start == end)
+        return 0;
+
+    const jschar* s = chars + start;
+    int len = end - start;
+    double d;
+
+    if (parse_short_decimal (s, len, &d))
+        return d;
+
+    // HexIntegerLiteral, OctalIntegerLiteral and BinaryIntegerLiteral
+    // (none of which can have a sign)
+    if (len > 2 && s[0] == '0') {
+        int processed;
+        switch (s[1]) {
+        case 'x': case 'X':
+            d = _ejs_strtod (s, len, EJS_TRUE, &processed);
+            return processed == len ? d : NAN;
+        case 'o': case 'O':
+            d = parse_radix_integer (s + 2, len - 2, 8, &processed);
+            return processed == len - 2 ? d : NAN;
+        case 'b': case 'B':
+            d = parse_radix_integer (s + 2, len - 2, 2, &processed);
+            return processed == len - 2 ? d : NAN;
+        }
+    }
+
+    // StrDecimalLiteral
+    int processed;
+    d = _ejs_strtod (s, len, EJS_FALSE, &processed);
+    return processed == len ? d : NAN;
+}
+
+EJSBool
+_ejs_string_to_array_index (ejsval str, uint32_t* index)
+{
+    EJSPrimString* flat = _ejs_string_flatten(str);
+    const jschar* chars = flat->data.flat;
+    int length = flat->length;
+
+    // ToString(ToUint32(P)) == P rules out leading zeros, signs, and
+    // anything longer than "4294967295"
+    if (length == 0 || length > 10 || (chars[0] == '0' && length > 1))
+        return EJS_FALSE;
+
+    uint64_t v = 0;
+    for (int i = 0; i < length; i++) {
+        if (chars[i] < '0' || chars[i] > '9')
+            return EJS_FALSE;
+        v = v * 10 + (chars[i] - '0');
+    }
+    // and ToUint32(P) is not 2^32-1
+    if (v >= 4294967295ULL)
+        return EJS_FALSE;
+
+    *index = (uint32_t)v;
+    return EJS_TRUE;
+}
+
 double ToDouble(ejsval exp)
 {
     return EJSVAL_TO_NUMBER(ToNumber(exp));
@@ -391,7 +613,7 @@ ejsval ToBoolean(ejsval exp)
     return BOOLEAN_TO_EJSVAL(ToEJSBool(exp));
 }
 
-static ejsval
+ejsval
 OrdinaryToPrimitive(ejsval O, ToPrimitiveHint hint)
 {
     // 1. Assert: Type(O) is Object 
@@ -1235,12 +1457,17 @@ EJS_NATIVE_FUNC(_ejs_parseInt_impl) {
     /* 2. Let  S be a newly created substring of  inputString consisting of the first character that is not a  */
     /*    StrWhiteSpaceChar and all characters following that character. (In other words, remove leading white  */
     /*    space.) If inputString does not contain any such characters, let S be the empty string. */
-    jschar* S = EJSVAL_TO_FLAT_STRING(inputString);
+    EJSPrimString* flat = _ejs_string_flatten(inputString);
+    const jschar* S = flat->data.flat;
+    int Sidx = 0;
+    int Slength = flat->length;
+    while (Slength != 0 && IsWhitespace(S[Sidx])) {
+        Sidx ++;
+        Slength --;
+    }
 
     /* 3. Let sign be 1. */
     int32_t sign = 1;
-    int Sidx = 0;
-    int Slength = EJSVAL_TO_STRLEN(inputString);
 
     /* 4. If S is not empty and the first character of S is a minus sign -, let sign be -1. */
     if (Slength != 0 && S[Sidx] == '-')
@@ -1254,13 +1481,13 @@ EJS_NATIVE_FUNC(_ejs_parseInt_impl) {
     }
 
     /* 6. Let R = ToInt32(radix). */
-    int32_t R = ToInteger(radix);
+    int32_t R = ToInt32(radix);
 
     /* 7. Let stripPrefix be true. */
     EJSBool stripPrefix = EJS_TRUE;
 
     /* 8. If R != 0, then */
-    if (!EJSVAL_IS_UNDEFINED(radix) &&  R != 0) {
+    if (R != 0) {
         /* a. If R < 2 or R > 36, then return NaN. */
         if (R < 2 || R > 36) return _ejs_nan;
 
@@ -1277,95 +1504,59 @@ EJS_NATIVE_FUNC(_ejs_parseInt_impl) {
     if (stripPrefix) {
         /* a. If the length of S is at least 2 and the first two characters of S are either "0x" or "0X", then remove */
         /*    the first two characters from S and let R = 16.*/
-        if (Slength > 2 && S[Sidx] == '0' && (S[Sidx+1] == 'x' || S[Sidx+1] == 'X')) {
+        if (Slength >= 2 && S[Sidx] == '0' && (S[Sidx+1] == 'x' || S[Sidx+1] == 'X')) {
             Sidx += 2;
             Slength -= 2;
             R = 16;
         }
     }
-    static jschar radix_8_chars[] = { '0', '1', '2', '3', '4', '5', '6', '7', 0 };
-    static jschar radix_10_chars[] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 0 };
-    static jschar radix_16_chars[] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f', 0 };
-    static jschar radix_16up_chars[] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F', 0 };
-
-    jschar* radix_chars;
-    jschar* radix_chars2 = NULL;
-
-    switch (R) {
-    case 8:
-        radix_chars = radix_8_chars;
-        break;
-    case 10:
-        radix_chars = radix_10_chars;
-        break;
-    case 16:
-        radix_chars = radix_16_chars;
-        radix_chars2 = radix_16up_chars;
-        break;
-    default:
-        EJS_NOT_IMPLEMENTED();
-    }
 
     /* 11. If S contains any character that is not a radix-R digit, then let Z be the substring of S consisting of all  */
     /*     characters before the first such character; otherwise, let Z be S. */
-    int i;
-    for (i = 0; i < Slength; i ++) {
-        jschar needle[2];
-        needle[0] = S[Sidx+i];
-        needle[1] = 0;
-        if (ucs2_strstr(radix_chars, needle) == NULL) {
-            if (!radix_chars2 || ucs2_strstr(radix_chars2, needle) == NULL)
-                break;
-        }
-    }
     /* 12. If Z is empty, return NaN. */
-    if (i == 0) {
-        return _ejs_nan;
-    }
-    
     /* 13. Let mathInt be the mathematical integer value that is represented by  Z in radix-R notation, using the letters  */
     /*     A-Z and  a-z for digits with values 10 through 35. (However, if  R is 10 and  Z contains more than 20  */
     /*     significant digits, every significant digit after the 20th may be replaced by a  0  digit, at the option of the */
     /*     implementation; and if  R is not 2, 4, 8, 10, 16, or 32, then  mathInt may be an implementation-dependent */
     /*     approximation to the mathematical integer value that is represented by Z in radix-R notation.) */
-
-    int mathInt = 0;
-    int32_t Zlen = i;
-    for (i = 0; i < Zlen; i ++) {
-        jschar needle[2];
-        needle[0] = S[Sidx+i];
-        needle[1] = 0;
-
-        int digitval;
-        jschar* r;
-        if ((r = ucs2_strstr(radix_chars, needle))) {
-            digitval = r - radix_chars;
-        }
-        else {
-            r = ucs2_strstr(radix_chars2, needle);
-            digitval = r - radix_chars2;
-        }
-        mathInt = mathInt*R + digitval;
-    }
-
     /* 14. Let number be the Number value for mathInt. */
-    int32_t number = mathInt * sign;
+    int Zlen;
+    double number = parse_radix_integer (S + Sidx, Slength, R, &Zlen);
+    if (Zlen == 0)
+        return _ejs_nan;
 
     /* 15. Return sign * number */
-    return NUMBER_TO_EJSVAL(number);
+    return NUMBER_TO_EJSVAL(sign * number);
 }
 
+// ES2015 18.2.4
+// parseFloat (string)
 EJS_NATIVE_FUNC(_ejs_parseFloat_impl) {
-    if (argc == 0)
-        return _ejs_nan;
-
-    char *float_utf8 = ucs2_to_utf8(EJSVAL_TO_FLAT_STRING(ToString(args[0])));
-
-    ejsval rv = NUMBER_TO_EJSVAL (strtod (float_utf8, NULL));
-
-    free (float_utf8);
+    ejsval string = _ejs_undefined;
+    if (argc > 0) string = args[0];
 
-    return rv;
+    // 1. Let inputString be ToString(string).
+    // 2. ReturnIfAbrupt(inputString).
+    EJSPrimString* flat = _ejs_string_flatten(ToString(string));
+
+    // 3. Let trimmedString be a substring of inputString consisting of the leftmost code unit that is
+    //    not a StrWhiteSpaceChar and all code units to the right of that code unit. (In other words,
+    //    remove leading white space.) If inputString does not contain any such code units, let
+    //    trimmedString be the empty string.
+    int start = 0;
+    while (start < flat->length && IsWhitespace(flat->data.flat[start]))
+        start ++;
+
+    // 4. If neither trimmedString nor any prefix of trimmedString satisfies the syntax of a
+    //    StrDecimalLiteral (see 7.1.3.1), return NaN.
+    // 5. Let numberString be the longest prefix of trimmedString, which might be trimmedString
+    //    itself, that satisfies the syntax of a StrDecimalLiteral.
+    // 6. Return the Number value for the MV of numberString.
+    int processed;
+    double d = _ejs_strtod (flat->data.flat + start, flat->length - start, EJS_FALSE, &processed);
+    if (processed == 0)
+        return _ejs_nan;
+    return NUMBER_TO_EJSVAL(d);
 }
 
 /* 7.4.1 CheckIterable ( obj ) */
@@ -1571,6 +1762,36 @@ IteratorStep_internal(ejsval* next, ejsval iterator)
     return _ejs_invoke_func_catch(next, call_iterator_step, &iterator);
 }
 
+/* IteratorStep followed by IteratorValue, for for..of loops.  @next is
+ * the iterator's next method, looked up once when the loop starts.
+ * Returns the EJS_NO_ITER_VALUE magic when the iterator is done.
+ *
+ * if @next is one of the builtin iterators' next methods (and hasn't
+ * been replaced), we step the iterator directly and skip allocating the
+ * iter result object. */
+ejsval
+_ejs_iterator_step_value (ejsval iterator, ejsval next)
+{
+    if (EJSVAL_IS_NATIVE_FUNCTION(next, _ejs_ArrayIterator_prototype_next) && EJSVAL_IS_ARRAYITERATOR(iterator))
+        return _ejs_array_iterator_step(iterator);
+    if (EJSVAL_IS_NATIVE_FUNCTION(next, _ejs_StringIterator_prototype_next) && EJSVAL_IS_STRINGITERATOR(iterator))
+        return _ejs_string_iterator_step(iterator);
+    if (EJSVAL_IS_NATIVE_FUNCTION(next, _ejs_MapIterator_prototype_next) && EJSVAL_IS_MAPITERATOR(iterator))
+        return _ejs_map_iterator_step(iterator);
+    if (EJSVAL_IS_NATIVE_FUNCTION(next, _ejs_SetIterator_prototype_next) && EJSVAL_IS_SETITERATOR(iterator))
+        return _ejs_set_iterator_step(iterator);
+
+    ejsval result = _ejs_invoke_closure (next, &iterator, 0, NULL, _ejs_undefined);
+
+    if (!EJSVAL_IS_OBJECT(result))
+        _ejs_throw_nativeerror_utf8 (EJS_TYPE_ERROR, "result is not an object");
+
+    if (ToEJSBool(Get(result, _ejs_atom_done)))
+        return MAGIC_TO_EJSVAL_IMPL(EJS_NO_ITER_VALUE);
+
+    return Get(result, _ejs_atom_value);
+}
+
 /* 7.4.7 CreateIterResultObject (value, done) */
 ejsval
 _ejs_create_iter_result (ejsval value, ejsval done)
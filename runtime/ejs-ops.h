@@ -7,8 +7,19 @@
 
 EJS_BEGIN_DECLS
 
+typedef enum {
+    TO_PRIM_HINT_DEFAULT,
+    TO_PRIM_HINT_STRING,
+    TO_PRIM_HINT_NUMBER
+} ToPrimitiveHint;
+
+ejsval ToPrimitive(ejsval inputargument, ToPrimitiveHint PreferredType);
+ejsval OrdinaryToPrimitive(ejsval O, ToPrimitiveHint hint);
+
 /* returns an EJSPrimString* */
 ejsval NumberToString(double d, int base);
+// empties NumberToString's cache, so the strings in it can be collected
+void _ejs_number_string_cache_clear ();
 ejsval ToString(ejsval exp);
 ejsval ToNumber(ejsval exp);
 double ToDouble(ejsval exp);
@@ -90,6 +101,8 @@ extern EJS_NATIVE_FUNC(_ejs_isNaN_impl);
 extern EJS_NATIVE_FUNC(_ejs_isFinite_impl);
 extern EJS_NATIVE_FUNC(_ejs_parseInt_impl);
 extern EJS_NATIVE_FUNC(_ejs_parseFloat_impl);
+// __ejs.numberStringCacheStats() returns { hits, misses, size } for NumberToString's cache
+extern EJS_NATIVE_FUNC(_ejs_numberStringCacheStats);
 
 ejsval CheckIterableObject (ejsval obj);
 ejsval GetIterator (ejsval obj, ejsval method);
@@ -98,6 +111,7 @@ ejsval IteratorComplete (ejsval iterResult);
 ejsval IteratorValue (ejsval iterResult);
 ejsval IteratorClose (ejsval iterator, ejsval completion, EJSBool completionIsThrow);
 ejsval IteratorStep (ejsval iterator);
+ejsval _ejs_iterator_step_value (ejsval iterator, ejsval next);
 ejsval _ejs_create_iter_result (ejsval value, ejsval done);
 
 EJSBool GetIterator_internal(ejsval* iterator, ejsval iterable);
@@ -106,7 +120,27 @@ EJSBool IteratorNext_internal(ejsval* next, ejsval iterator, ejsval value);
 EJSBool IteratorValue_internal(ejsval* value, ejsval iterResult);
 EJSBool IteratorComplete_internal (ejsval iterResult);
 
-void _ejs_dtoa(double d, char* buf, size_t buf_size);
+// number <-> string conversions (ejs-dtoa.cpp, on top of double-conversion.)
+// the _ejs_dtoa functions write ascii to @buf, which must hold
+// EJS_DTOA_BUFFER_SIZE chars, and return the length.
+#define EJS_DTOA_BUFFER_SIZE 1100 // "-0." and the 1074 binary digits of the smallest denormal
+
+int _ejs_dtoa_shortest (double d, char* buf);
+int _ejs_dtoa_radix (double d, int radix, char* buf);
+int _ejs_dtoa_fixed (double d, int digits, char* buf);
+int _ejs_dtoa_exponential (double d, int digits, char* buf); // digits = -1 for as many as needed
+int _ejs_dtoa_precision (double d, int precision, char* buf);
+
+// parses the longest StrDecimalLiteral (or hex integer, if @hex) at the
+// start of @chars and sets *@processed to its length.  NaN and 0 if
+// there isn't one.
+double _ejs_strtod (const jschar* chars, int length, EJSBool hex, int* processed);
+
+// ES2015 7.1.3.1 ToNumber Applied to the String Type
+double _ejs_string_to_number (const jschar* chars, int length);
+
+// true if @str is a canonical array index ("0", "17", but not "017" or "1.0")
+EJSBool _ejs_string_to_array_index (ejsval str, uint32_t* index);
 
 EJS_END_DECLS
 
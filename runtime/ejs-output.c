@@ -0,0 +1,613 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+ * vim: set ts=4 sw=4 et tw=99 ft=cpp:
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+#include "ejs-output.h"
+#include "ejs-gc.h"
+#include "ejs-ops.h"
+#include "ejs-function.h"
+#include "ejs-string.h"
+#include "ejs-runloop.h"
+
+// output collects in a list of fixed size chunks, so appending never
+// has to copy what's already there, and a flush hands the whole list to
+// one writev.
+#define OUTPUT_CHUNK_SIZE (16 * 1024)
+// how much we let collect before writing it regardless of the timer
+#define OUTPUT_FLUSH_SIZE (64 * 1024)
+#define OUTPUT_FLUSH_DELAY_MS 1
+// chunks kept around for reuse instead of going back to malloc
+#define OUTPUT_FREE_CHUNKS 8
+#define OUTPUT_MAX_IOV 64
+// enough room in a chunk for anything one UTF-16 code unit can produce,
+// plus a replacement character for a dangling surrogate before it
+#define OUTPUT_MAX_CHAR_BYTES 8
+
+typedef struct OutputChunk {
+    struct OutputChunk* next;
+    size_t len;
+    char data[OUTPUT_CHUNK_SIZE];
+} OutputChunk;
+
+// a list of chunks being written by a background task
+typedef struct {
+    EJSOutput* out;
+    int fd;
+    OutputChunk* chunks;
+    size_t bytes;
+    EJSBool ok;
+    EJSBool finished; // set by the background thread once it's done with the chunks, under write_lock
+    EJSBool reaped;   // we've already waited for it, and the done callback should just free it
+} OutputWrite;
+
+struct _EJSOutput {
+    int fd;
+    // stdout/stderr for fds 1 and 2, so we don't get ahead of anything
+    // printed through them
+    FILE* stdio;
+    EJSBool tty;
+
+    OutputChunk* head;
+    OutputChunk* tail;
+    size_t buffered;
+
+    OutputWrite* writing;
+    EJSBool flush_scheduled;
+    void* flush_task;
+    EJSBool need_drain;
+    EJSBool failed;
+
+    ejsval stream;
+};
+
+static EJSOutput** outputs;
+static int num_outputs;
+static EJSBool output_async;
+
+// the last of stdout/stderr written to.  they're often the same file
+// (a terminal, or 2>&1), so switching between them flushes the other.
+static EJSOutput* last_std_output;
+
+static OutputChunk* free_chunks;
+static int num_free_chunks;
+
+// background writes signal write_finished when they're done, for
+// anyone waiting on one in wait_for_write
+static pthread_mutex_t write_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t write_finished = PTHREAD_COND_INITIALIZER;
+
+static OutputChunk*
+chunk_new ()
+{
+    OutputChunk* chunk = free_chunks;
+    if (chunk) {
+        free_chunks = chunk->next;
+        num_free_chunks--;
+    }
+    else {
+        chunk = (OutputChunk*)malloc (sizeof(OutputChunk));
+    }
+    chunk->next = NULL;
+    chunk->len = 0;
+    return chunk;
+}
+
+static void
+chunks_free (OutputChunk* chunk)
+{
+    while (chunk) {
+        OutputChunk* next = chunk->next;
+        if (num_free_chunks < OUTPUT_FREE_CHUNKS) {
+            chunk->next = free_chunks;
+            free_chunks = chunk;
+            num_free_chunks++;
+        }
+        else {
+            free (chunk);
+        }
+        chunk = next;
+    }
+}
+
+// writes all of @chunks to @fd, blocking until it's done.  this runs on
+// background threads, so it mustn't touch anything else.
+static EJSBool
+write_chunks (int fd, OutputChunk* chunks)
+{
+    struct iovec iov[OUTPUT_MAX_IOV];
+    OutputChunk* chunk = chunks;
+    size_t skip = 0; // the part of chunk already written
+
+    while (chunk) {
+        int n = 0;
+        for (OutputChunk* c = chunk; c && n < OUTPUT_MAX_IOV; c = c->next, n++) {
+            iov[n].iov_base = c->data + (n == 0 ? skip : 0);
+            iov[n].iov_len = c->len - (n == 0 ? skip : 0);
+        }
+
+        ssize_t written = writev (fd, iov, n);
+        if (written == -1) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // someone else made the fd non-blocking
+                struct pollfd pfd = { fd, POLLOUT, 0 };
+                poll (&pfd, 1, -1);
+                continue;
+            }
+            return EJS_FALSE;
+        }
+
+        while (chunk && (size_t)written >= chunk->len - skip) {
+            written -= chunk->len - skip;
+            chunk = chunk->next;
+            skip = 0;
+        }
+        if (chunk)
+            skip += written;
+    }
+    return EJS_TRUE;
+}
+
+static void
+write_failed (EJSOutput* out)
+{
+    if (!out->failed)
+        perror ("write");
+    // there's nowhere for the rest to go
+    out->failed = EJS_TRUE;
+}
+
+static void
+call_ondrain (EJSOutput* out)
+{
+    // ondrain may well end() the stream, which frees @out
+    ejsval stream = out->stream;
+
+    out->need_drain = EJS_FALSE;
+    if (!EJSVAL_IS_OBJECT(stream))
+        return;
+
+    ejsval ondrain = _ejs_object_getprop (stream, _ejs_atom_ondrain);
+    if (IsCallable(ondrain))
+        _ejs_invoke_closure (ondrain, &stream, 0, NULL, _ejs_undefined);
+}
+
+// ondrain for a flush that happened underneath something else (console.error
+// switching streams, _ejs_log), where we can't run JS.  we look the output
+// up again by fd in case it's been closed in the meantime.
+static void
+drain_task (void* data)
+{
+    int fd = (int)(intptr_t)data;
+    EJSOutput* out = fd < num_outputs ? outputs[fd] : NULL;
+    if (out && out->need_drain && _ejs_output_pending (out) < EJS_OUTPUT_HIGH_WATER_MARK / 2)
+        call_ondrain (out);
+}
+
+static void
+drain_task_dtor (void* data)
+{
+}
+
+static void
+reap_write (OutputWrite* w)
+{
+    EJSOutput* out = w->out;
+
+    w->reaped = EJS_TRUE;
+    out->writing = NULL;
+    chunks_free (w->chunks);
+    if (!w->ok)
+        write_failed (out);
+}
+
+static void
+wait_for_write (EJSOutput* out)
+{
+    OutputWrite* w = out->writing;
+    pthread_mutex_lock (&write_lock);
+    while (!w->finished)
+        pthread_cond_wait (&write_finished, &write_lock);
+    pthread_mutex_unlock (&write_lock);
+    reap_write (w);
+}
+
+static void
+write_in_background (void* data)
+{
+    OutputWrite* w = (OutputWrite*)data;
+    EJSBool ok = write_chunks (w->fd, w->chunks);
+    pthread_mutex_lock (&write_lock);
+    w->ok = ok;
+    w->finished = EJS_TRUE;
+    pthread_cond_broadcast (&write_finished);
+    pthread_mutex_unlock (&write_lock);
+}
+
+static void start_flush (EJSOutput* out);
+
+static void
+background_write_done (void* data)
+{
+    OutputWrite* w = (OutputWrite*)data;
+    if (w->reaped) {
+        free (w);
+        return;
+    }
+
+    EJSOutput* out = w->out;
+    reap_write (w);
+    free (w);
+
+    // anything written while that was going goes next
+    start_flush (out);
+
+    if (out->need_drain && _ejs_output_pending (out) < EJS_OUTPUT_HIGH_WATER_MARK / 2)
+        call_ondrain (out);
+}
+
+// hands everything buffered to the fd, without waiting for it to be
+// written if we're async.  if an async write is already going, what's
+// buffered waits for it to finish.
+static void
+start_flush (EJSOutput* out)
+{
+    if (out->buffered == 0 || out->writing)
+        return;
+
+    OutputChunk* chunks = out->head;
+    size_t bytes = out->buffered;
+    out->head = out->tail = NULL;
+    out->buffered = 0;
+
+    if (out->failed) {
+        chunks_free (chunks);
+        return;
+    }
+
+    if (output_async && !out->tty) {
+        OutputWrite* w = (OutputWrite*)calloc (1, sizeof(OutputWrite));
+        w->out = out;
+        w->fd = out->fd;
+        w->chunks = chunks;
+        w->bytes = bytes;
+        out->writing = w;
+        if (_ejs_runloop_add_background_task (write_in_background, background_write_done, w))
+            return;
+        // this run loop can't, so we do it ourselves
+        out->writing = NULL;
+        free (w);
+    }
+
+    if (!write_chunks (out->fd, chunks))
+        write_failed (out);
+    chunks_free (chunks);
+}
+
+void
+_ejs_output_flush (EJSOutput* out)
+{
+    if (out->writing)
+        wait_for_write (out);
+    start_flush (out);
+    if (out->writing)
+        wait_for_write (out);
+
+    // background_write_done won't see the write we just reaped
+    if (out->need_drain)
+        _ejs_runloop_add_task (drain_task, (void*)(intptr_t)out->fd, drain_task_dtor);
+}
+
+void
+_ejs_output_flush_all ()
+{
+    for (int i = 0; i < num_outputs; i ++) {
+        if (outputs[i])
+            _ejs_output_flush (outputs[i]);
+    }
+}
+
+static void
+flush_task (void* data)
+{
+    EJSOutput* out = (EJSOutput*)data;
+    // the run loop frees the task once this returns
+    out->flush_scheduled = EJS_FALSE;
+    out->flush_task = NULL;
+    start_flush (out);
+}
+
+static void
+flush_task_dtor (void* data)
+{
+}
+
+// called before anything is added to @out's buffer
+static void
+begin_write (EJSOutput* out)
+{
+    if (out->stdio) {
+        if (last_std_output != out) {
+            if (last_std_output)
+                _ejs_output_flush (last_std_output);
+            last_std_output = out;
+        }
+        if (out->buffered == 0)
+            fflush (out->stdio);
+    }
+}
+
+// the last chunk in @out's buffer, if it has room for @needed bytes, or a new one
+static OutputChunk*
+tail_with_space (EJSOutput* out, size_t needed)
+{
+    if (out->tail && OUTPUT_CHUNK_SIZE - out->tail->len >= needed)
+        return out->tail;
+
+    // don't let a single huge write pile up in memory
+    if (out->buffered >= OUTPUT_FLUSH_SIZE)
+        start_flush (out);
+
+    OutputChunk* chunk = chunk_new ();
+    if (out->tail)
+        out->tail->next = chunk;
+    else
+        out->head = chunk;
+    out->tail = chunk;
+    return chunk;
+}
+
+void
+_ejs_output_write_utf8 (EJSOutput* out, const char* buf, size_t len)
+{
+    begin_write (out);
+
+    while (len > 0) {
+        OutputChunk* chunk = tail_with_space (out, 1);
+        size_t n = OUTPUT_CHUNK_SIZE - chunk->len;
+        if (n > len)
+            n = len;
+        memcpy (chunk->data + chunk->len, buf, n);
+        chunk->len += n;
+        out->buffered += n;
+        buf += n;
+        len -= n;
+    }
+}
+
+#define PUT_REPLACEMENT_CHAR(p) EJS_MACRO_START \
+    *p++ = (char)0xEF;                          \
+    *p++ = (char)0xBF;                          \
+    *p++ = (char)0xBD;                          \
+    EJS_MACRO_END
+
+// UTF-16 to UTF-8, straight into @out's chunks.  @high_surrogate carries
+// the first half of a pair from one piece of a rope to the next.
+// unpaired surrogates come out as U+FFFD.
+static void
+encode_ucs2 (EJSOutput* out, const jschar* s, uint32_t len, jschar* high_surrogate)
+{
+    const jschar* end = s + len;
+
+    while (s < end) {
+        OutputChunk* chunk = tail_with_space (out, OUTPUT_MAX_CHAR_BYTES);
+        char* start = chunk->data + chunk->len;
+        char* p = start;
+        char* limit = chunk->data + OUTPUT_CHUNK_SIZE - OUTPUT_MAX_CHAR_BYTES;
+
+        while (s < end && p <= limit) {
+            jschar c = *s++;
+
+            if (*high_surrogate) {
+                if (c >= 0xDC00 && c <= 0xDFFF) {
+                    uint32_t cp = 0x10000 + (((uint32_t)*high_surrogate - 0xD800) << 10) + (c - 0xDC00);
+                    *p++ = (char)(0xF0 | (cp >> 18));
+                    *p++ = (char)(0x80 | ((cp >> 12) & 0x3F));
+                    *p++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+                    *p++ = (char)(0x80 | (cp & 0x3F));
+                    *high_surrogate = 0;
+                    continue;
+                }
+                PUT_REPLACEMENT_CHAR(p);
+                *high_surrogate = 0;
+            }
+
+            if (c < 0x80) {
+                *p++ = (char)c;
+            }
+            else if (c < 0x800) {
+                *p++ = (char)(0xC0 | (c >> 6));
+                *p++ = (char)(0x80 | (c & 0x3F));
+            }
+            else if (c >= 0xD800 && c <= 0xDBFF) {
+                *high_surrogate = c;
+            }
+            else if (c >= 0xDC00 && c <= 0xDFFF) {
+                PUT_REPLACEMENT_CHAR(p);
+            }
+            else {
+                *p++ = (char)(0xE0 | (c >> 12));
+                *p++ = (char)(0x80 | ((c >> 6) & 0x3F));
+                *p++ = (char)(0x80 | (c & 0x3F));
+            }
+        }
+
+        chunk->len += p - start;
+        out->buffered += p - start;
+    }
+}
+
+// ropes deeper than this get flattened instead of walked
+#define OUTPUT_ROPE_STACK 64
+
+typedef struct {
+    EJSPrimString* str;
+    uint32_t off;
+    uint32_t len;
+} StringPiece;
+
+void
+_ejs_output_write_string (EJSOutput* out, ejsval str)
+{
+    begin_write (out);
+
+    StringPiece stack[OUTPUT_ROPE_STACK];
+    int sp = 0;
+    jschar high_surrogate = 0;
+    EJSPrimString* primstr = EJSVAL_TO_STRING(str);
+
+    stack[sp].str = primstr;
+    stack[sp].off = 0;
+    stack[sp].len = primstr->length;
+    sp++;
+
+    while (sp > 0) {
+        StringPiece piece = stack[--sp];
+        if (piece.len == 0)
+            continue;
+
+        switch (EJS_PRIMSTR_GET_TYPE(piece.str)) {
+        case EJS_STRING_FLAT:
+            encode_ucs2 (out, piece.str->data.flat + piece.off, piece.len, &high_surrogate);
+            break;
+        case EJS_STRING_DEPENDENT:
+            stack[sp].str = piece.str->data.dependent.dep;
+            stack[sp].off = piece.off + piece.str->data.dependent.off;
+            stack[sp].len = piece.len;
+            sp++;
+            break;
+        case EJS_STRING_ROPE: {
+            if (sp + 2 > OUTPUT_ROPE_STACK) {
+                // flattening happens in place, so it's only paid for once
+                _ejs_primstring_flatten (piece.str);
+                stack[sp++] = piece;
+                break;
+            }
+            EJSPrimString* left = piece.str->data.rope.left;
+            uint32_t left_len = left->length;
+            // the right side goes on the stack first, so the left comes off first
+            if (piece.off + piece.len > left_len) {
+                uint32_t off = piece.off > left_len ? piece.off - left_len : 0;
+                stack[sp].str = piece.str->data.rope.right;
+                stack[sp].off = off;
+                stack[sp].len = piece.off + piece.len - left_len - off;
+                sp++;
+            }
+            if (piece.off < left_len) {
+                stack[sp].str = left;
+                stack[sp].off = piece.off;
+                stack[sp].len = left_len - piece.off < piece.len ? left_len - piece.off : piece.len;
+                sp++;
+            }
+            break;
+        }
+        default:
+            EJS_NOT_REACHED();
+        }
+    }
+
+    if (high_surrogate) {
+        OutputChunk* chunk = tail_with_space (out, 3);
+        char* p = chunk->data + chunk->len;
+        PUT_REPLACEMENT_CHAR(p);
+        chunk->len += 3;
+        out->buffered += 3;
+    }
+}
+
+EJSBool
+_ejs_output_end_write (EJSOutput* out)
+{
+    if (out->tty || out->buffered >= OUTPUT_FLUSH_SIZE) {
+        start_flush (out);
+    }
+    else if (out->buffered > 0 && !out->flush_scheduled) {
+        out->flush_scheduled = EJS_TRUE;
+        out->flush_task = _ejs_runloop_add_task_timeout (flush_task, out, flush_task_dtor, OUTPUT_FLUSH_DELAY_MS, EJS_FALSE);
+    }
+
+    if (_ejs_output_pending (out) >= EJS_OUTPUT_HIGH_WATER_MARK) {
+        out->need_drain = EJS_TRUE;
+        return EJS_FALSE;
+    }
+    return EJS_TRUE;
+}
+
+size_t
+_ejs_output_pending (EJSOutput* out)
+{
+    return out->buffered + (out->writing ? out->writing->bytes : 0);
+}
+
+void
+_ejs_output_set_stream (EJSOutput* out, ejsval stream)
+{
+    out->stream = stream;
+}
+
+EJSOutput*
+_ejs_output_for_fd (int fd)
+{
+    if (fd >= num_outputs) {
+        int new_num = num_outputs ? num_outputs * 2 : 8;
+        while (new_num <= fd)
+            new_num *= 2;
+        outputs = (EJSOutput**)realloc (outputs, new_num * sizeof(EJSOutput*));
+        memset (outputs + num_outputs, 0, (new_num - num_outputs) * sizeof(EJSOutput*));
+        num_outputs = new_num;
+    }
+
+    EJSOutput* out = outputs[fd];
+    if (!out) {
+        out = (EJSOutput*)calloc (1, sizeof(EJSOutput));
+        out->fd = fd;
+        out->tty = isatty(fd);
+        out->stdio = fd == STDOUT_FILENO ? stdout : fd == STDERR_FILENO ? stderr : NULL;
+        out->stream = _ejs_undefined;
+        _ejs_gc_add_root (&out->stream);
+        outputs[fd] = out;
+    }
+    return out;
+}
+
+void
+_ejs_output_close (int fd)
+{
+    EJSOutput* out = fd < num_outputs ? outputs[fd] : NULL;
+    if (out) {
+        // nobody's left to drain to
+        out->need_drain = EJS_FALSE;
+        _ejs_output_flush (out);
+        if (out->flush_scheduled)
+            _ejs_runloop_remove_task (out->flush_task);
+        if (last_std_output == out)
+            last_std_output = NULL;
+        _ejs_gc_remove_root (&out->stream);
+        outputs[fd] = NULL;
+        free (out);
+    }
+    close (fd);
+}
+
+static void
+flush_at_exit ()
+{
+    _ejs_output_flush_all ();
+}
+
+void
+_ejs_output_init ()
+{
+    output_async = getenv("EJS_OUTPUT_ASYNC") != NULL;
+    atexit (flush_at_exit);
+}
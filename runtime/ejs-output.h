@@ -0,0 +1,54 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+ * vim: set ts=4 sw=4 et tw=99 ft=cpp:
+ */
+
+#ifndef _ejs_output_h_
+#define _ejs_output_h_
+
+#include "ejs.h"
+#include "ejs-value.h"
+
+/* buffered output for console and streams, one buffer per fd.
+
+   writes are encoded straight from string storage into the buffer,
+   which is written out (with a single writev) when enough has
+   collected, a millisecond or so after the first write into it, before
+   anything is written to a different fd, or at exit.  output to a
+   terminal is written at the end of every console call/stream write.
+
+   with EJS_OUTPUT_ASYNC set in the environment (and the libuv run
+   loop), buffers are written from a background thread so the writer
+   never waits on the fd.  _ejs_output_end_write then returns EJS_FALSE
+   while more than EJS_OUTPUT_HIGH_WATER_MARK bytes are waiting, and the
+   stream's ondrain is called once they've gone.
+*/
+
+#define EJS_OUTPUT_HIGH_WATER_MARK (1024 * 1024)
+
+typedef struct _EJSOutput EJSOutput;
+
+EJS_BEGIN_DECLS
+
+EJSOutput* _ejs_output_for_fd (int fd);
+
+void _ejs_output_write_utf8 (EJSOutput* out, const char* buf, size_t len);
+void _ejs_output_write_string (EJSOutput* out, ejsval str);
+// call after each complete console message/stream write.  returns
+// EJS_FALSE if the caller should hold off until ondrain
+EJSBool _ejs_output_end_write (EJSOutput* out);
+
+// the number of bytes written to @out that haven't reached the fd yet
+size_t _ejs_output_pending (EJSOutput* out);
+// the object whose ondrain is called, if any
+void _ejs_output_set_stream (EJSOutput* out, ejsval stream);
+
+void _ejs_output_flush (EJSOutput* out);
+void _ejs_output_flush_all ();
+// flushes and forgets the buffer for @fd, then closes it
+void _ejs_output_close (int fd);
+
+void _ejs_output_init ();
+
+EJS_END_DECLS
+
+#endif /* _ejs_output_h_ */
@@ -2,43 +2,233 @@
  * vim: set ts=4 sw=4 et tw=99 ft=cpp:
  */
 
+/*
+ * Type recording for executables compiled with --record-types.
+ *
+ * Every recording site in generated code is identified by its module
+ * and a per-module id.  We keep a histogram of the types seen in each
+ * operand position and dump them all to a profile at exit, which the
+ * compiler reads back with --use-type-profile.  The profile is a text
+ * file, one site per line:
+ *
+ *   binop   <module> <id> <op> <left histogram> <right histogram>
+ *   assign  <module> <id> <value histogram>
+ *   getprop <module> <id> <object histogram> <key histogram>
+ *   setprop <module> <id> <object histogram> <key histogram> <value histogram>
+ *
+ * fields are tab separated, histograms look like "int32:1000,double:2"
+ * (or "-" if nothing was recorded.)
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include "ejs.h"
 #include "ejsval.h"
+#include "ejs-value.h"
+#include "ejs-array.h"
+#include "ejs-function.h"
+
+typedef enum {
+    TYPE_UNDEFINED,
+    TYPE_NULL,
+    TYPE_BOOLEAN,
+    TYPE_INT32,     /* a number with an int32 value */
+    TYPE_DOUBLE,
+    TYPE_STRING,
+    TYPE_SYMBOL,
+    TYPE_ARRAY,     /* dense arrays only, sparse arrays are objects */
+    TYPE_FUNCTION,
+    TYPE_OBJECT,
+    TYPE_COUNT
+} RecordedType;
+
+static const char* type_names[TYPE_COUNT] = {
+    "undefined", "null", "boolean", "int32", "double", "string", "symbol", "array", "function", "object"
+};
+
+typedef enum {
+    SITE_BINOP,
+    SITE_ASSIGN,
+    SITE_GETPROP,
+    SITE_SETPROP
+} SiteKind;
+
+static const char* site_kind_names[] = { "binop", "assign", "getprop", "setprop" };
+
+#define MAX_SITE_OPERANDS 3
+
+typedef struct {
+    const char* module;     /* NULL for an empty table slot */
+    int         id;
+    SiteKind    kind;
+    const char* op;
+    uint64_t    counts[MAX_SITE_OPERANDS][TYPE_COUNT];
+} RecordedSite;
 
-static const char*
-type_name(ejsval exp)
+#define SITES_INITIAL_ALLOC 256
+
+static RecordedSite* sites;
+static int sites_alloc;
+static int sites_num;
+
+static RecordedType
+recorded_type(ejsval exp)
 {
-    if (EJSVAL_IS_NULL(exp))
-        return "null";
+    if (EJSVAL_IS_NUMBER(exp)) {
+        double d = EJSVAL_TO_NUMBER(exp);
+        int32_t i = (int32_t)d;
+        // -0 isn't an int32
+        if (d >= INT32_MIN && d <= INT32_MAX && (double)i == d && (i != 0 || !signbit(d)))
+            return TYPE_INT32;
+        return TYPE_DOUBLE;
+    }
+    else if (EJSVAL_IS_NULL(exp))
+        return TYPE_NULL;
     else if (EJSVAL_IS_BOOLEAN(exp))
-        return "boolean";
+        return TYPE_BOOLEAN;
     else if (EJSVAL_IS_STRING(exp))
-        return "string";
-    else if (EJSVAL_IS_NUMBER(exp))
-        return "number";
+        return TYPE_STRING;
     else if (EJSVAL_IS_UNDEFINED(exp))
-        return "undefined";
+        return TYPE_UNDEFINED;
+    else if (EJSVAL_IS_SYMBOL(exp))
+        return TYPE_SYMBOL;
+    else if (EJSVAL_IS_DENSE_ARRAY(exp))
+        return TYPE_ARRAY;
+    else if (EJSVAL_IS_FUNCTION(exp))
+        return TYPE_FUNCTION;
     else if (EJSVAL_IS_OBJECT(exp))
-        return "object";
+        return TYPE_OBJECT;
     else
         EJS_NOT_IMPLEMENTED();
 }
 
+static uint32_t
+site_hash(const char* module, int id)
+{
+    uint32_t h = 5381;
+    for (const char* p = module; *p; p++)
+        h = h * 33 + (unsigned char)*p;
+    return h ^ (uint32_t)id * 2654435761u;
+}
+
+static void write_profile(void);
+
+static RecordedSite*
+lookup_site(const char* module, int id, SiteKind kind, const char* op)
+{
+    if (sites_num * 2 >= sites_alloc) {
+        RecordedSite* old_sites = sites;
+        int old_alloc = sites_alloc;
+
+        if (!old_sites)
+            atexit(write_profile);
+
+        sites_alloc = old_alloc ? old_alloc * 2 : SITES_INITIAL_ALLOC;
+        sites = calloc(sites_alloc, sizeof(RecordedSite));
+        for (int i = 0; i < old_alloc; i ++) {
+            if (!old_sites[i].module)
+                continue;
+            uint32_t s = site_hash(old_sites[i].module, old_sites[i].id) & (sites_alloc - 1);
+            while (sites[s].module)
+                s = (s + 1) & (sites_alloc - 1);
+            sites[s] = old_sites[i];
+        }
+        free(old_sites);
+    }
+
+    uint32_t s = site_hash(module, id) & (sites_alloc - 1);
+    while (sites[s].module) {
+        if (sites[s].id == id && !strcmp(sites[s].module, module))
+            return &sites[s];
+        s = (s + 1) & (sites_alloc - 1);
+    }
+
+    sites[s].module = module;
+    sites[s].id = id;
+    sites[s].kind = kind;
+    sites[s].op = op;
+    sites_num ++;
+    return &sites[s];
+}
+
+static void
+write_histogram(FILE* fp, uint64_t* counts)
+{
+    EJSBool first = EJS_TRUE;
+    for (int t = 0; t < TYPE_COUNT; t ++) {
+        if (!counts[t])
+            continue;
+        fprintf(fp, "%s%s:%llu", first ? "" : ",", type_names[t], (unsigned long long)counts[t]);
+        first = EJS_FALSE;
+    }
+    if (first)
+        fputc('-', fp);
+}
+
+static void
+write_profile(void)
+{
+    const char* filename = getenv("EJS_TYPE_PROFILE");
+    if (!filename)
+        filename = "ejs-types.profile";
+
+    FILE* fp = fopen(filename, "w");
+    if (!fp) {
+        perror(filename);
+        return;
+    }
+
+    for (int i = 0; i < sites_alloc; i ++) {
+        RecordedSite* site = &sites[i];
+        if (!site->module)
+            continue;
+
+        fprintf(fp, "%s\t%s\t%d", site_kind_names[site->kind], site->module, site->id);
+        if (site->kind == SITE_BINOP)
+            fprintf(fp, "\t%s", site->op);
+
+        int noperands = site->kind == SITE_ASSIGN ? 1 : site->kind == SITE_SETPROP ? 3 : 2;
+        for (int o = 0; o < noperands; o ++) {
+            fputc('\t', fp);
+            write_histogram(fp, site->counts[o]);
+        }
+        fputc('\n', fp);
+    }
+
+    fclose(fp);
+}
+
 void
-_ejs_record_binop (int id, const char *op, ejsval left, ejsval right)
+_ejs_record_binop (const char* module, int id, const char *op, ejsval left, ejsval right)
 {
-    printf ("for id %d, binary operator %s: left=%s, right=%s\n", id, op, type_name(left), type_name(right));
+    RecordedSite* site = lookup_site(module, id, SITE_BINOP, op);
+    site->counts[0][recorded_type(left)] ++;
+    site->counts[1][recorded_type(right)] ++;
 }
 
+void
+_ejs_record_assignment (const char* module, int id, ejsval val)
+{
+    RecordedSite* site = lookup_site(module, id, SITE_ASSIGN, NULL);
+    site->counts[0][recorded_type(val)] ++;
+}
 
 void
-_ejs_record_assignment (int id, ejsval val)
+_ejs_record_getprop (const char* module, int id, ejsval obj, ejsval prop)
 {
-    printf ("for id %d, assignment: val=%s\n", id, type_name(val));
+    RecordedSite* site = lookup_site(module, id, SITE_GETPROP, NULL);
+    site->counts[0][recorded_type(obj)] ++;
+    site->counts[1][recorded_type(prop)] ++;
 }
 
 void
-_ejs_record_getprop (int id, ejsval obj, ejsval prop)
+_ejs_record_setprop (const char* module, int id, ejsval obj, ejsval prop, ejsval val)
 {
-    printf ("for id %d, getprop\n", id);
+    RecordedSite* site = lookup_site(module, id, SITE_SETPROP, NULL);
+    site->counts[0][recorded_type(obj)] ++;
+    site->counts[1][recorded_type(prop)] ++;
+    site->counts[2][recorded_type(val)] ++;
 }
@@ -14,6 +14,53 @@
 
 ejsval _ejs_Reflect EJSVAL_ALIGNMENT;
 
+// ES2015, June 2015
+// 7.3.17 CreateListFromArrayLike (obj [, elementTypes] )
+//
+// dense arrays hand back their own elements; anything else gets a
+// malloc'ed list (*allocated is set) that the caller must free.
+static ejsval*
+CreateListFromArrayLike (ejsval obj, uint32_t* len, EJSBool* allocated)
+{
+    // 1. ReturnIfAbrupt(obj).
+    // 2. If elementTypes was not passed, let elementTypes be (Undefined, Null, Boolean, String, Symbol, Number, Object).
+    // 3. If Type(obj) is not Object, throw a TypeError exception.
+    if (!EJSVAL_IS_OBJECT(obj))
+        _ejs_throw_nativeerror_utf8(EJS_TYPE_ERROR, "argumentsList is not an object");
+
+    if (EJSVAL_IS_DENSE_ARRAY(obj)) {
+        *len = EJS_ARRAY_LEN(obj);
+        *allocated = EJS_FALSE;
+        return EJS_DENSE_ARRAY_ELEMENTS(obj);
+    }
+
+    // 4. Let len be ToLength(Get(obj, "length")).
+    // 5. ReturnIfAbrupt(len).
+    int64_t n = ToLength(Get(obj, _ejs_atom_length));
+    if (n > UINT32_MAX)
+        _ejs_throw_nativeerror_utf8(EJS_RANGE_ERROR, "argumentsList is too long");
+
+    // 6. Let list be an empty List.
+    ejsval* list = (ejsval*)malloc(sizeof(ejsval) * (n > 0 ? n : 1));
+
+    // 7. Let index be 0.
+    // 8. Repeat while index < len
+    for (int64_t index = 0; index < n; index ++) {
+        // a. Let indexName be ToString(index).
+        // b. Let next be Get(obj, indexName).
+        // c. ReturnIfAbrupt(next).
+        // d. If Type(next) is not an element of elementTypes, throw a TypeError exception.
+        // e. Append next as the last element of list.
+        list[index] = Get(obj, ToString(NUMBER_TO_EJSVAL(index)));
+        // f. Set index to index + 1.
+    }
+
+    // 9. Return list.
+    *len = (uint32_t)n;
+    *allocated = EJS_TRUE;
+    return list;
+}
+
 // ECMA262: 26.1.1 Reflect.apply ( target, thisArgument, argumentsList ) 
 static EJS_NATIVE_FUNC(_ejs_Reflect_apply) {
     ejsval target = _ejs_undefined;
@@ -34,18 +81,17 @@ static EJS_NATIVE_FUNC(_ejs_Reflect_apply) {
         
     // 4. Let args be CreateListFromArray (argumentsList). 
     // 5. ReturnIfAbrupt(args).
-
-    if (!EJSVAL_IS_ARRAY(argumentsList))
-        _ejs_throw_nativeerror_utf8(EJS_TYPE_ERROR, "argumentsList is not an array");
-
-    // sparse arrays kinda suck here...
-    if (!EJSVAL_IS_DENSE_ARRAY(argumentsList))
-        _ejs_throw_nativeerror_utf8(EJS_TYPE_ERROR, "argumentsList is not a dense array");
+    uint32_t argsLen;
+    EJSBool argsAllocated;
+    ejsval* argsList = CreateListFromArrayLike(argumentsList, &argsLen, &argsAllocated);
         
     // 6. Perform the PrepareForTailCall abstract operation. 
 
     // 7. Return the result of calling the [[Call]] internal method of obj with arguments thisArgument and args.
-    return _ejs_invoke_closure(obj, &thisArgument, EJS_ARRAY_LEN(argumentsList), EJS_DENSE_ARRAY_ELEMENTS(argumentsList), _ejs_undefined);
+    ejsval rv = _ejs_invoke_closure(obj, &thisArgument, argsLen, argsList, _ejs_undefined);
+    if (argsAllocated)
+        free(argsList);
+    return rv;
 }
 
 // ES2015, June 2015
@@ -72,13 +118,15 @@ static EJS_NATIVE_FUNC(_ejs_Reflect_construct) {
 
     // 4. Let args be CreateListFromArrayLike(argumentsList).
     // 5. ReturnIfAbrupt(args).
-
-    if (!EJSVAL_IS_DENSE_ARRAY(argumentsList))
-        _ejs_throw_nativeerror_utf8(EJS_TYPE_ERROR, "ejs bug - we assume argumentsList is a dense array in Reflect.construct");
-
+    uint32_t argsLen;
+    EJSBool argsAllocated;
+    ejsval* argsList = CreateListFromArrayLike(argumentsList, &argsLen, &argsAllocated);
 
     // 6. Return Construct(target, args, newTarget).
-    return Construct(target, _newTarget, EJS_ARRAY_LEN(argumentsList), EJS_DENSE_ARRAY_ELEMENTS(argumentsList));
+    ejsval rv = Construct(target, _newTarget, argsLen, argsList);
+    if (argsAllocated)
+        free(argsList);
+    return rv;
 }
 
 static EJS_NATIVE_FUNC(_ejs_Reflect_defineProperty) {
@@ -2,6 +2,8 @@
  * vim: set ts=4 sw=4 et tw=99 ft=cpp:
  */
 
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "ejs-array.h"
@@ -20,9 +22,387 @@
 ejsval _ejs_RegExp_prototype_exec_closure;
 
 static EJS_NATIVE_FUNC(_ejs_RegExp_impl);
+static ejsval RegExpAlloc(ejsval newTarget);
+static EJS_NATIVE_FUNC(_ejs_RegExp_prototype_exec);
+static EJS_NATIVE_FUNC(_ejs_RegExp_prototype_get_global);
+static EJS_NATIVE_FUNC(_ejs_RegExp_prototype_get_sticky);
+static EJS_NATIVE_FUNC(_ejs_RegExp_prototype_get_unicode);
+static EJS_NATIVE_FUNC(_ejs_RegExp_prototype_get_flags);
+static void regexp_parse_flags (EJSRegExp* re, ejsval F);
 
 static const unsigned char* pcre16_tables;
 
+// Compiling a pattern (and JIT compiling it) costs far more than most
+// of the matches run against it, so compiled patterns are shared.
+// Each regexp literal caches its matcher in a slot the compiler gives
+// it (see _ejs_regexp_new_literal), and everything else goes through
+// a small LRU cache keyed on the pattern and the flags that affect
+// compilation.  Matchers are refcounted: the cache, literal sites and
+// RegExp objects each hold a reference.
+
+// what regexp_analyze found out about a pattern, so regexp_exec can
+// avoid pcre or narrow down where it has to look
+typedef enum {
+    REGEXP_GENERAL,        // nothing, always run pcre
+    REGEXP_LITERAL,        // the pattern is a literal string
+    REGEXP_CHAR_CLASS,     // the pattern is a class of a few literal characters
+    REGEXP_LITERAL_PREFIX  // every match starts with a literal string
+} EJSRegExpKind;
+
+#define REGEXP_MAX_LITERAL 64
+#define REGEXP_MAX_CLASS 8
+
+struct _EJSRegExpMatcher {
+    pcre16* code;
+    pcre16_extra* extra; // from pcre16_study, NULL if there was nothing to add
+    int capture_count;
+    int refcount;
+
+    EJSRegExpKind kind;
+    EJSBool anchored;    // starts with ^ (without the m flag), so only matches at 0
+    jschar literal[REGEXP_MAX_LITERAL]; // the literal, prefix or class characters
+    int literal_len;
+
+    // the cache key
+    jschar* pattern;
+    int pattern_len;
+    int options;
+    uint32_t hash;
+
+    EJSRegExpMatcher* hash_next;
+    EJSRegExpMatcher* lru_prev;
+    EJSRegExpMatcher* lru_next;
+};
+
+#define REGEXP_CACHE_SIZE 64
+#define REGEXP_CACHE_BUCKETS 128
+
+static EJSRegExpMatcher* regexp_cache[REGEXP_CACHE_BUCKETS];
+static EJSRegExpMatcher* regexp_lru_head; // most recently used
+static EJSRegExpMatcher* regexp_lru_tail;
+static int regexp_cache_count;
+
+// JIT compiled code runs on its own stack.  the runtime is single
+// threaded, so every matcher shares this one.
+static pcre16_jit_stack* regexp_jit_stack;
+
+// the character an escape in a pattern stands for, or -1 if it isn't a
+// single literal character (\d, \b, backreferences...)
+static int
+regexp_escape_literal (jschar c)
+{
+    switch (c) {
+    case 'n': return '\n';
+    case 'r': return '\r';
+    case 't': return '\t';
+    case 'f': return '\f';
+    case 'v': return '\v';
+    case '\\': case '/': case '^': case '$': case '.': case '|': case '?': case '*':
+    case '+': case '(': case ')': case '[': case ']': case '{': case '}': case '-':
+        return c;
+    default:
+        return -1;
+    }
+}
+
+static EJSBool
+regexp_is_special (jschar c)
+{
+    switch (c) {
+    case '\\': case '^': case '$': case '.': case '|': case '?': case '*':
+    case '+': case '(': case ')': case '[': case ']': case '{': case '}':
+        return EJS_TRUE;
+    default:
+        return EJS_FALSE;
+    }
+}
+
+// the literal character at @pattern[*i], advancing *i past it, or -1
+static int
+regexp_literal_at (const jschar* pattern, int len, int* i)
+{
+    jschar c = pattern[*i];
+    if (c == '\\') {
+        if (*i + 1 == len)
+            return -1;
+        int lit = regexp_escape_literal (pattern[*i + 1]);
+        if (lit != -1)
+            *i += 2;
+        return lit;
+    }
+    // with the u flag half a surrogate pair doesn't match on its own
+    if (regexp_is_special (c) || (c >= 0xD800 && c <= 0xDFFF))
+        return -1;
+    *i += 1;
+    return c;
+}
+
+// looks for the common shapes of pattern: /,/, /\n/, /[;,]/, /^GET /,
+// /foo\d+/.  anything we don't understand is REGEXP_GENERAL, so this only
+// has to be right about what it does recognize.
+static void
+regexp_analyze (EJSRegExpMatcher* matcher)
+{
+    const jschar* pattern = matcher->pattern;
+    int len = matcher->pattern_len;
+    int i = 0;
+
+    matcher->kind = REGEXP_GENERAL;
+
+    // we'd have to fold case to search for the literal
+    if (matcher->options & PCRE_CASELESS)
+        return;
+
+    if (len > 0 && pattern[0] == '^') {
+        // with m, ^ also matches after every line terminator
+        if (matcher->options & PCRE_MULTILINE)
+            return;
+        matcher->anchored = EJS_TRUE;
+        i = 1;
+    }
+
+    // [abc] on its own
+    if (!matcher->anchored && len > 2 && pattern[0] == '[' && pattern[1] != '^') {
+        int n = 0;
+        i = 1;
+        while (i < len && pattern[i] != ']' && n < REGEXP_MAX_CLASS) {
+            // a - between two characters is a range
+            if (pattern[i] == '-' && i > 1 && i + 1 < len && pattern[i+1] != ']')
+                return;
+            int c = regexp_literal_at (pattern, len, &i);
+            if (c == -1) {
+                // a few more characters are literal inside a class
+                if (pattern[i] == '\\' || pattern[i] == '[' || (pattern[i] >= 0xD800 && pattern[i] <= 0xDFFF))
+                    return;
+                c = pattern[i++];
+            }
+            matcher->literal[n++] = c;
+        }
+        if (i != len - 1 || pattern[i] != ']' || n == 0)
+            return;
+        matcher->literal_len = n;
+        matcher->kind = n == 1 ? REGEXP_LITERAL : REGEXP_CHAR_CLASS;
+        return;
+    }
+
+    // the literal characters the pattern starts with
+    int n = 0;
+    while (i < len && n < REGEXP_MAX_LITERAL) {
+        int next = i;
+        int c = regexp_literal_at (pattern, len, &next);
+        if (c == -1)
+            break;
+        // a quantified character might not be there at all
+        if (next < len && (pattern[next] == '?' || pattern[next] == '*' || pattern[next] == '+' || pattern[next] == '{'))
+            break;
+        matcher->literal[n++] = c;
+        i = next;
+    }
+
+    if (n == 0)
+        return;
+    matcher->literal_len = n;
+
+    if (i == len) {
+        matcher->kind = REGEXP_LITERAL;
+        return;
+    }
+
+    // an alternative could match without the prefix.  we don't bother
+    // working out where the | is.
+    for (int j = i; j < len; j ++) {
+        if (pattern[j] == '|')
+            return;
+    }
+    matcher->kind = REGEXP_LITERAL_PREFIX;
+}
+
+static void
+regexp_matcher_release (EJSRegExpMatcher* matcher)
+{
+    if (--matcher->refcount > 0)
+        return;
+
+    if (matcher->extra)
+        pcre16_free_study (matcher->extra);
+    pcre16_free (matcher->code);
+    free (matcher->pattern);
+    free (matcher);
+}
+
+static void
+regexp_lru_unlink (EJSRegExpMatcher* matcher)
+{
+    if (matcher->lru_prev) matcher->lru_prev->lru_next = matcher->lru_next;
+    else regexp_lru_head = matcher->lru_next;
+    if (matcher->lru_next) matcher->lru_next->lru_prev = matcher->lru_prev;
+    else regexp_lru_tail = matcher->lru_prev;
+    matcher->lru_prev = matcher->lru_next = NULL;
+}
+
+static void
+regexp_lru_push (EJSRegExpMatcher* matcher)
+{
+    matcher->lru_next = regexp_lru_head;
+    if (regexp_lru_head) regexp_lru_head->lru_prev = matcher;
+    else regexp_lru_tail = matcher;
+    regexp_lru_head = matcher;
+}
+
+static void
+regexp_cache_evict ()
+{
+    EJSRegExpMatcher* victim = regexp_lru_tail;
+    regexp_lru_unlink (victim);
+
+    EJSRegExpMatcher** p = &regexp_cache[victim->hash % REGEXP_CACHE_BUCKETS];
+    while (*p != victim)
+        p = &(*p)->hash_next;
+    *p = victim->hash_next;
+
+    regexp_cache_count--;
+    regexp_matcher_release (victim);
+}
+
+static uint32_t
+regexp_hash (const jschar* chars, int len, int options)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u ^ (uint32_t)options;
+    for (int i = 0; i < len; i ++) {
+        hash ^= chars[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// returns a new reference to the matcher for @chars compiled with
+// @options, compiling it if it isn't in the cache.
+static EJSRegExpMatcher*
+regexp_matcher_get (const jschar* chars, int len, int options)
+{
+    uint32_t hash = regexp_hash (chars, len, options);
+
+    for (EJSRegExpMatcher* m = regexp_cache[hash % REGEXP_CACHE_BUCKETS]; m; m = m->hash_next) {
+        if (m->hash == hash && m->options == options && m->pattern_len == len &&
+            !memcmp (m->pattern, chars, len * sizeof(jschar))) {
+            regexp_lru_unlink (m);
+            regexp_lru_push (m);
+            m->refcount++;
+            return m;
+        }
+    }
+
+    // pcre wants the pattern nul terminated
+    jschar* pattern = (jschar*)malloc ((len + 1) * sizeof(jschar));
+    memcpy (pattern, chars, len * sizeof(jschar));
+    pattern[len] = 0;
+
+    const char *pcre_error;
+    int pcre_erroffset;
+
+    pcre16* code = pcre16_compile(pattern, options, &pcre_error, &pcre_erroffset, pcre16_tables);
+    if (!code) {
+        free (pattern);
+        char buf[256];
+        snprintf (buf, sizeof(buf), "Invalid regular expression: %s at offset %d", pcre_error, pcre_erroffset);
+        _ejs_throw_nativeerror_utf8 (EJS_SYNTAX_ERROR, buf);
+    }
+
+    EJSRegExpMatcher* matcher = (EJSRegExpMatcher*)calloc (1, sizeof(EJSRegExpMatcher));
+    matcher->code = code;
+    matcher->pattern = pattern;
+    matcher->pattern_len = len;
+    matcher->options = options;
+    matcher->hash = hash;
+    pcre16_fullinfo (code, NULL, PCRE_INFO_CAPTURECOUNT, &matcher->capture_count);
+    regexp_analyze (matcher);
+
+    // study failing only means we match without its help
+    const char *study_error;
+    matcher->extra = pcre16_study (code, PCRE_STUDY_JIT_COMPILE, &study_error);
+    if (matcher->extra && regexp_jit_stack)
+        pcre16_assign_jit_stack (matcher->extra, NULL, regexp_jit_stack);
+
+    if (regexp_cache_count == REGEXP_CACHE_SIZE)
+        regexp_cache_evict();
+
+    matcher->hash_next = regexp_cache[hash % REGEXP_CACHE_BUCKETS];
+    regexp_cache[hash % REGEXP_CACHE_BUCKETS] = matcher;
+    regexp_lru_push (matcher);
+    regexp_cache_count++;
+
+    // one reference for the cache, one for the caller
+    matcher->refcount = 2;
+    return matcher;
+}
+
+// where @matcher's literal (or one of its class characters) first
+// occurs in @subject at or after @start, or -1.  only @start is tried if
+// @anchored.
+static int
+regexp_find_literal (EJSRegExpMatcher* matcher, const jschar* subject, int length, int start, EJSBool anchored)
+{
+    const jschar* p;
+
+    if (matcher->anchored) {
+        if (start != 0)
+            return -1;
+        anchored = EJS_TRUE;
+    }
+
+    if (matcher->kind == REGEXP_CHAR_CLASS) {
+        for (int i = start; i < length; i ++) {
+            for (int j = 0; j < matcher->literal_len; j ++) {
+                if (subject[i] == matcher->literal[j])
+                    return i;
+            }
+            if (anchored)
+                break;
+        }
+        return -1;
+    }
+
+    if (anchored) {
+        if (start + matcher->literal_len > length ||
+            memcmp (subject + start, matcher->literal, matcher->literal_len * sizeof(jschar)))
+            return -1;
+        return start;
+    }
+
+    if (matcher->literal_len == 1)
+        p = ucs2_memchr (subject + start, length - start, matcher->literal[0]);
+    else
+        p = ucs2_memmem (subject + start, length - start, matcher->literal, matcher->literal_len);
+    return p ? p - subject : -1;
+}
+
+// every match of @re goes through here.  for literal patterns we find the
+// match ourselves, and for literal prefixes we start pcre where the prefix
+// is (if it's anywhere at all.)  returns what pcre16_exec would.
+static int
+regexp_exec (EJSRegExp* re, const jschar* subject, int length, int start, int options, int* ovec, int ovec_count)
+{
+    EJSRegExpMatcher* matcher = re->matcher;
+
+    if (matcher->kind != REGEXP_GENERAL && start <= length) {
+        int pos = regexp_find_literal (matcher, subject, length, start, (options & PCRE_ANCHORED) != 0);
+        if (pos == -1)
+            return PCRE_ERROR_NOMATCH;
+
+        if (matcher->kind != REGEXP_LITERAL_PREFIX) {
+            // no captures in these, so there's always room for the match
+            ovec[0] = pos;
+            ovec[1] = pos + (matcher->kind == REGEXP_LITERAL ? matcher->literal_len : 1);
+            return 1;
+        }
+        start = pos;
+    }
+
+    return pcre16_exec(matcher->code, matcher->extra, subject, length, start,
+                       PCRE_NO_UTF16_CHECK | options, ovec, ovec_count);
+}
+
 EJSBool IsRegExp(ejsval argument) {
     // 1. If Type(argument) is not Object, return false.
     if (!EJSVAL_IS_OBJECT(argument))
@@ -65,20 +445,53 @@ _ejs_regexp_new_utf8 (const char *pattern, const char *flags)
                             _ejs_string_new_utf8 (flags));
 }
 
+// what a regexp literal's site caches after its first evaluation.  every
+// evaluation still creates a new RegExp, but they all share the matcher
+// and the source and flags strings.
+typedef struct {
+    EJSRegExpMatcher* matcher;
+    ejsval source;
+    ejsval flags;
+} EJSRegExpSite;
+
 ejsval
-_ejs_regexp_replace(ejsval str, ejsval search_re, ejsval replace)
+_ejs_regexp_new_literal (const char *pattern, const char *flags, void **site)
 {
-    EJSRegExp* re = (EJSRegExp*)EJSVAL_TO_OBJECT(search_re);
-
-    pcre16_extra extra;
-    memset (&extra, 0, sizeof(extra));
+    EJSRegExpSite* cached = (EJSRegExpSite*)*site;
+
+    if (!cached) {
+        ejsval rv = _ejs_regexp_new_utf8 (pattern, flags);
+        EJSRegExp* re = (EJSRegExp*)EJSVAL_TO_OBJECT(rv);
+
+        // sites live as long as the module, so the strings stay rooted
+        cached = (EJSRegExpSite*)malloc (sizeof(EJSRegExpSite));
+        cached->matcher = re->matcher;
+        cached->matcher->refcount++;
+        cached->source = re->pattern;
+        cached->flags = re->flags;
+        _ejs_gc_add_root (&cached->source);
+        _ejs_gc_add_root (&cached->flags);
+        *site = cached;
+        return rv;
+    }
 
-    pcre16* code = (pcre16*)re->compiled_pattern;
+    ejsval rv = RegExpAlloc(_ejs_RegExp);
+    EJSRegExp* re = (EJSRegExp*)EJSVAL_TO_OBJECT(rv);
+    regexp_parse_flags (re, cached->flags);
+    re->pattern = cached->source;
+    re->flags = cached->flags;
+    re->matcher = cached->matcher;
+    re->matcher->refcount++;
+    Put(rv, _ejs_atom_lastIndex, NUMBER_TO_EJSVAL(0), EJS_TRUE);
+    return rv;
+}
 
-    int capture_count;
-    pcre16_fullinfo (code, NULL, PCRE_INFO_CAPTURECOUNT, &capture_count);
+ejsval
+_ejs_regexp_replace(ejsval str, ejsval search_re, ejsval replace)
+{
+    EJSRegExp* re = (EJSRegExp*)EJSVAL_TO_OBJECT(search_re);
 
-    int ovec_count = 3 * (1 + capture_count);
+    int ovec_count = 3 * (1 + re->matcher->capture_count);
     int* ovec = malloc(sizeof(int) * ovec_count);
     int cur_off = 0;
 
@@ -86,9 +499,7 @@ _ejs_regexp_replace(ejsval str, ejsval search_re, ejsval replace)
         EJSPrimString *flat_str = _ejs_string_flatten (str);
         jschar *chars_str = flat_str->data.flat;
 
-        int rv = pcre16_exec(code, &extra,
-                             chars_str, flat_str->length, cur_off,
-                             PCRE_NO_UTF16_CHECK, ovec, ovec_count);
+        int rv = regexp_exec(re, chars_str, flat_str->length, cur_off, 0, ovec, ovec_count);
 
         if (rv < 0)
             break;
@@ -163,6 +574,33 @@ RegExpAlloc(ejsval newTarget) {
     return obj;
 }
 
+static void
+regexp_parse_flags (EJSRegExp* re, ejsval F)
+{
+    EJSPrimString *flat_flags = _ejs_string_flatten(F);
+    jschar* chars = flat_flags->data.flat;
+
+    for (int i = 0; i < flat_flags->length; i ++) {
+        if      (chars[i] == 'g' && !re->global)     { re->global     = EJS_TRUE; continue; }
+        else if (chars[i] == 'i' && !re->ignoreCase) { re->ignoreCase = EJS_TRUE; continue; }
+        else if (chars[i] == 'm' && !re->multiline)  { re->multiline  = EJS_TRUE; continue; }
+        else if (chars[i] == 'y' && !re->sticky)     { re->sticky     = EJS_TRUE; continue; }
+        else if (chars[i] == 'u' && !re->unicode)    { re->unicode    = EJS_TRUE; continue; }
+        _ejs_throw_nativeerror_utf8 (EJS_SYNTAX_ERROR, "Invalid flag supplied to RegExp constructor");
+    }
+}
+
+// the pcre options for @re's flags.  g and y only affect where matching
+// starts, so they don't need a separate compile.
+static int
+regexp_compile_options (EJSRegExp* re)
+{
+    int options = PCRE_UTF16 | PCRE_NO_UTF16_CHECK;
+    if (re->ignoreCase) options |= PCRE_CASELESS;
+    if (re->multiline) options |= PCRE_MULTILINE;
+    return options;
+}
+
 // ES2015, June 2015
 // 21.2.3.2.2 Runtime Semantics: RegExpInitialize ( obj, pattern, flags )
 static ejsval
@@ -189,18 +627,7 @@ RegExpInitialize(ejsval obj, ejsval pattern, ejsval flags) {
 
     // 7. If F contains any code unit other than "g", "i", "m", "u", or "y" or if it contains the same code unit more than once, throw a SyntaxError exception.
     // 8. If F contains "u", let BMP be false; else let BMP be true.
-
-    EJSPrimString *flat_flags = _ejs_string_flatten(F);
-    jschar* chars = flat_flags->data.flat;
-
-    for (int i = 0; i < flat_flags->length; i ++) {
-        if      (chars[i] == 'g' && !re->global)     { re->global     = EJS_TRUE; continue; }
-        else if (chars[i] == 'i' && !re->ignoreCase) { re->ignoreCase = EJS_TRUE; continue; }
-        else if (chars[i] == 'm' && !re->multiline)  { re->multiline  = EJS_TRUE; continue; }
-        else if (chars[i] == 'y' && !re->sticky)     { re->sticky     = EJS_TRUE; continue; }
-        else if (chars[i] == 'u' && !re->unicode)    { re->unicode    = EJS_TRUE; continue; }
-        _ejs_throw_nativeerror_utf8 (EJS_SYNTAX_ERROR, "Invalid flag supplied to RegExp constructor");
-    }
+    regexp_parse_flags(re, F);
 
     // 9. If BMP is true, then
     // a. Parse P using the grammars in 21.2.1 and interpreting each
@@ -222,16 +649,10 @@ RegExpInitialize(ejsval obj, ejsval pattern, ejsval flags) {
     // 13. Set obj’s [[RegExpMatcher]] internal slot to the internal procedure that evaluates the above parse of P by applying the semantics provided in 21.2.2 using patternCharacters as the pattern’s List of SourceCharacter values and F as the flag parameters.
 
     EJSPrimString *flat_pattern = _ejs_string_flatten(P);
-    chars = flat_pattern->data.flat;
-
-    const char *pcre_error;
-    int pcre_erroffset;
-
-    re->compiled_pattern = pcre16_compile(chars,
-                                          PCRE_UTF16 | PCRE_NO_UTF16_CHECK,
-                                          &pcre_error, &pcre_erroffset,
-                                          pcre16_tables);
 
+    if (re->matcher)
+        regexp_matcher_release (re->matcher);
+    re->matcher = regexp_matcher_get(flat_pattern->data.flat, flat_pattern->length, regexp_compile_options(re));
 
     // 14. Let setStatus be Set(obj, "lastIndex", 0, true).
     // 15. ReturnIfAbrupt(setStatus).
@@ -323,6 +744,275 @@ static EJS_NATIVE_FUNC(_ejs_RegExp_impl) {
     return RegExpInitialize(O, P, F);
 }
 
+// The builtins that run a RegExp (@@match, @@replace, @@search, @@split
+// and test) are specified in terms of Gets and Puts on the RegExp, and
+// a match array from RegExpExec for every match.  When the RegExp is
+// pristine nothing can observe the difference, so they work straight
+// from pcre's capture offsets instead, and only create the strings
+// they return.
+
+// pcre wants two ints for the match and each capture, plus the same
+// again for its own workspace.
+#define REGEXP_OVEC_COUNT(re) (3 * (1 + (re)->matcher->capture_count))
+
+// true if %RegExpPrototype%'s @name is still the builtin @func (its
+// getter if @getter)
+static EJSBool
+regexp_proto_is_builtin (ejsval name, EJSClosureFunc func, EJSBool getter)
+{
+    EJSPropertyDesc* desc = _ejs_propertymap_lookup (EJSVAL_TO_OBJECT(_ejs_RegExp_prototype)->map, name);
+    if (!desc)
+        return EJS_FALSE;
+    ejsval f = getter ? _ejs_property_desc_get_getter(desc) : _ejs_property_desc_get_value(desc);
+    return EJSVAL_IS_NATIVE_FUNCTION(f, func);
+}
+
+// true if @rx is a RegExp whose only own property is lastIndex, and
+// whose exec and flag getters are the builtins on %RegExpPrototype%.
+static EJSBool
+regexp_is_pristine (ejsval rx)
+{
+    if (!EJSVAL_IS_REGEXP(rx))
+        return EJS_FALSE;
+
+    EJSObject* obj = EJSVAL_TO_OBJECT(rx);
+    if (!EJSVAL_EQ(obj->proto, _ejs_RegExp_prototype) || obj->map->inuse != 1 || !((EJSRegExp*)obj)->matcher)
+        return EJS_FALSE;
+
+    return (regexp_proto_is_builtin (_ejs_atom_exec, _ejs_RegExp_prototype_exec, EJS_FALSE) &&
+            regexp_proto_is_builtin (_ejs_atom_global, _ejs_RegExp_prototype_get_global, EJS_TRUE) &&
+            regexp_proto_is_builtin (_ejs_atom_sticky, _ejs_RegExp_prototype_get_sticky, EJS_TRUE) &&
+            regexp_proto_is_builtin (_ejs_atom_unicode, _ejs_RegExp_prototype_get_unicode, EJS_TRUE) &&
+            regexp_proto_is_builtin (_ejs_atom_flags, _ejs_RegExp_prototype_get_flags, EJS_TRUE));
+}
+
+// lastIndex is an own data property of every RegExp, so we can usually
+// read and write its descriptor directly instead of going through Get
+// and Put.
+static int64_t
+regexp_get_lastIndex (ejsval R)
+{
+    EJSPropertyDesc* desc = _ejs_propertymap_lookup (EJSVAL_TO_OBJECT(R)->map, _ejs_atom_lastIndex);
+    if (desc && _ejs_property_desc_has_value (desc))
+        return ToLength(_ejs_property_desc_get_value (desc));
+    return ToLength(Get(R, _ejs_atom_lastIndex));
+}
+
+static void
+regexp_set_lastIndex (ejsval R, int64_t lastIndex)
+{
+    EJSPropertyDesc* desc = _ejs_propertymap_lookup (EJSVAL_TO_OBJECT(R)->map, _ejs_atom_lastIndex);
+    if (desc && _ejs_property_desc_has_value (desc) && _ejs_property_desc_is_writable (desc))
+        _ejs_property_desc_set_value (desc, NUMBER_TO_EJSVAL(lastIndex));
+    else
+        Put(R, _ejs_atom_lastIndex, NUMBER_TO_EJSVAL(lastIndex), EJS_TRUE);
+}
+
+// ES2015 21.2.5.2.3 AdvanceStringIndex ( S, index, unicode )
+static int64_t
+regexp_advance (EJSPrimString* flat, int64_t index, EJSBool unicode)
+{
+    if (unicode && index + 1 < flat->length &&
+        flat->data.flat[index] >= 0xD800 && flat->data.flat[index] <= 0xDBFF &&
+        flat->data.flat[index+1] >= 0xDC00 && flat->data.flat[index+1] <= 0xDFFF)
+        return index + 2;
+    return index + 1;
+}
+
+// tries to match @re against @flat from @start (only at @start if @anchored),
+// filling in @ovec.
+static EJSBool
+regexp_match_from (EJSRegExp* re, EJSPrimString* flat, int64_t start, EJSBool anchored, int* ovec, int ovec_count)
+{
+    if (start > flat->length)
+        return EJS_FALSE;
+    // a short ovec still tells us where the match is, pcre just returns 0
+    return regexp_exec(re, flat->data.flat, flat->length, start, anchored ? PCRE_ANCHORED : 0, ovec, ovec_count) >= 0;
+}
+
+// RegExpBuiltinExec for a pristine @R, leaving the match in @ovec instead
+// of building the match array.  lastIndex is read and updated the same way.
+static EJSBool
+regexp_builtin_exec_offsets (ejsval R, EJSPrimString* flat, int* ovec, int ovec_count)
+{
+    EJSRegExp* re = (EJSRegExp*)EJSVAL_TO_OBJECT(R);
+    EJSBool global = re->global;
+    EJSBool sticky = re->sticky;
+
+    int64_t i = (global || sticky) ? regexp_get_lastIndex (R) : 0;
+    if (!regexp_match_from (re, flat, i, sticky, ovec, ovec_count)) {
+        regexp_set_lastIndex (R, 0);
+        return EJS_FALSE;
+    }
+    if (global || sticky)
+        regexp_set_lastIndex (R, ovec[1]);
+    return EJS_TRUE;
+}
+
+static ejsval
+regexp_capture (ejsval S, int* ovec, int n)
+{
+    if (ovec[2*n] < 0)
+        return _ejs_undefined;
+    return _ejs_string_new_substring (S, ovec[2*n], ovec[2*n+1] - ovec[2*n]);
+}
+
+// the output of a replace
+typedef struct {
+    jschar* chars;
+    int len;
+    int alloc;
+} RegExpBuffer;
+
+static void
+regexp_buffer_append (RegExpBuffer* buf, const jschar* chars, int len)
+{
+    if (len <= 0)
+        return;
+    if (buf->len + len > buf->alloc) {
+        buf->alloc = MAX(buf->alloc * 2, buf->len + len);
+        buf->chars = (jschar*)realloc (buf->chars, buf->alloc * sizeof(jschar));
+    }
+    memcpy (buf->chars + buf->len, chars, len * sizeof(jschar));
+    buf->len += len;
+}
+
+static ejsval
+regexp_buffer_finish (RegExpBuffer* buf)
+{
+    ejsval rv = buf->len == 0 ? _ejs_atom_empty : _ejs_string_new_ucs2_len (buf->chars, buf->len);
+    free (buf->chars);
+    return rv;
+}
+
+// GetReplaceSubstitution (21.1.3.14.1), appending to @buf, with the match
+// and its @m captures read out of @ovec
+static void
+regexp_append_substitution (RegExpBuffer* buf, EJSPrimString* flat, int* ovec, int m, EJSPrimString* replacement)
+{
+    const jschar* S = flat->data.flat;
+    const jschar* r = replacement->data.flat;
+    int len = replacement->length;
+    int position = ovec[0];
+    int tailPos = ovec[1];
+    static const jschar dollar = '$';
+
+    int i = 0;
+    while (i < len) {
+        // copy everything up to the next $ in one go
+        int start = i;
+        while (i < len && r[i] != '$')
+            i++;
+        regexp_buffer_append (buf, r + start, i - start);
+        if (i == len)
+            break;
+
+        jschar next = i + 1 < len ? r[i+1] : 0;
+        if (next == '$') {
+            regexp_buffer_append (buf, &dollar, 1);
+            i += 2;
+        }
+        else if (next == '&') {
+            regexp_buffer_append (buf, S + position, tailPos - position);
+            i += 2;
+        }
+        else if (next == '`') {
+            regexp_buffer_append (buf, S, position);
+            i += 2;
+        }
+        else if (next == '\'') {
+            regexp_buffer_append (buf, S + tailPos, flat->length - tailPos);
+            i += 2;
+        }
+        else if (next >= '0' && next <= '9') {
+            // $nn if that names a capture, otherwise $n
+            int n = next - '0';
+            int digits = 1;
+            if (i + 2 < len && r[i+2] >= '0' && r[i+2] <= '9') {
+                int nn = n * 10 + (r[i+2] - '0');
+                if (nn >= 1 && nn <= m) {
+                    n = nn;
+                    digits = 2;
+                }
+            }
+            if (n < 1 || n > m) {
+                regexp_buffer_append (buf, &dollar, 1);
+                i ++;
+                continue;
+            }
+            if (ovec[2*n] >= 0)
+                regexp_buffer_append (buf, S + ovec[2*n], ovec[2*n+1] - ovec[2*n]);
+            i += 1 + digits;
+        }
+        else {
+            regexp_buffer_append (buf, &dollar, 1);
+            i ++;
+        }
+    }
+}
+
+// @@replace for a pristine @rx.  matches are replaced as they're found,
+// which is indistinguishable from collecting them all first since a
+// replacer function can't affect a match already in progress.
+static ejsval
+regexp_replace_fast (ejsval rx, ejsval S, ejsval replaceValue, EJSBool functionalReplace)
+{
+    EJSRegExp* re = (EJSRegExp*)EJSVAL_TO_OBJECT(rx);
+    EJSPrimString* flat = _ejs_string_flatten (S);
+    EJSPrimString* replacement = functionalReplace ? NULL : _ejs_string_flatten (replaceValue);
+    int m = re->matcher->capture_count;
+    int ovec_count = REGEXP_OVEC_COUNT(re);
+    int* ovec = (int*)alloca (sizeof(int) * ovec_count);
+
+    int numReplacerArgs = m + 3;
+    ejsval* replacerArgs = functionalReplace ? (ejsval*)alloca(sizeof(ejsval) * numReplacerArgs) : NULL;
+
+    RegExpBuffer out = { NULL, 0, 0 };
+    int nextSourcePosition = 0;
+    int64_t start = 0;
+
+    // global matches are found from start rather than lastIndex.  the
+    // final, failing exec would leave lastIndex at 0, and that's what a
+    // replacer function sees (and may change.)
+    if (re->global)
+        regexp_set_lastIndex (rx, 0);
+
+    while (EJS_TRUE) {
+        EJSBool matched;
+        if (re->global)
+            matched = regexp_match_from (re, flat, start, re->sticky, ovec, ovec_count);
+        else
+            matched = regexp_builtin_exec_offsets (rx, flat, ovec, ovec_count);
+        if (!matched)
+            break;
+
+        regexp_buffer_append (&out, flat->data.flat + nextSourcePosition, ovec[0] - nextSourcePosition);
+
+        if (functionalReplace) {
+            for (int n = 0; n <= m; n ++)
+                replacerArgs[n] = regexp_capture (S, ovec, n);
+            replacerArgs[m + 1] = NUMBER_TO_EJSVAL(ovec[0]);
+            replacerArgs[m + 2] = S;
+
+            ejsval undef_this = _ejs_undefined;
+            EJSPrimString* replaced = _ejs_string_flatten (ToString(_ejs_invoke_closure(replaceValue, &undef_this, numReplacerArgs, replacerArgs, _ejs_undefined)));
+            regexp_buffer_append (&out, replaced->data.flat, replaced->length);
+        }
+        else {
+            regexp_append_substitution (&out, flat, ovec, m, replacement);
+        }
+        nextSourcePosition = ovec[1];
+
+        if (!re->global)
+            break;
+
+        start = ovec[1] == ovec[0] ? regexp_advance (flat, ovec[1], re->unicode) : ovec[1];
+    }
+
+    regexp_buffer_append (&out, flat->data.flat + nextSourcePosition, flat->length - nextSourcePosition);
+    return regexp_buffer_finish (&out);
+}
+
 // ES6 21.2.5.2.2
 // Runtime Semantics: RegExpBuiltinExec ( R, S ) Abstract Operation
 static ejsval
@@ -339,18 +1029,20 @@ RegExpBuiltinExec(ejsval R, ejsval S)
     int length = EJSVAL_TO_STRLEN(S);
 
     // 4. Let lastIndex be Get(R,"lastIndex").
-    ejsval lastIndex = Get(R, _ejs_atom_lastIndex);
     // 5. Let i be ToLength(lastIndex).
     // 6. ReturnIfAbrupt(i).
-    int64_t i = ToLength(lastIndex);
+    int64_t i = regexp_get_lastIndex(R);
+
+    // the flag getters can't have been replaced on a pristine RegExp
+    EJSBool pristine = regexp_is_pristine(R);
 
     // 7. Let global be ToBoolean(Get(R, "global")).
     // 8. ReturnIfAbrupt(global).
-    EJSBool global = ToEJSBool(Get(R, _ejs_atom_global));
+    EJSBool global = pristine ? re->global : ToEJSBool(Get(R, _ejs_atom_global));
 
     // 9. Let sticky be ToBoolean(Get(R, "sticky")).
     // 10. ReturnIfAbrupt(sticky).
-    EJSBool sticky = ToEJSBool(Get(R, _ejs_atom_sticky));
+    EJSBool sticky = pristine ? re->sticky : ToEJSBool(Get(R, _ejs_atom_sticky));
 
     // 11. If global is false and sticky is false, then let i = 0.
     if (!global && !sticky)
@@ -358,16 +1050,13 @@ RegExpBuiltinExec(ejsval R, ejsval S)
 
     ejsval subject = S;
 
-    pcre16_extra extra;
-    memset (&extra, 0, sizeof(extra));
-
     EJSPrimString *flat_subject = _ejs_string_flatten (subject);
     jschar* subject_chars = flat_subject->data.flat;
 
-    int ovec[60];
+    int ovec_count = REGEXP_OVEC_COUNT(re);
+    int* ovec = (int*)alloca(sizeof(int) * ovec_count);
 
     // 12. Let matcher be the value of R’s [[RegExpMatcher]] internal slot.
-    pcre16* matcher = (pcre16*)re->compiled_pattern;
 
     // 13. Let flags be the value of R’s [[OriginalFlags]] internal slot.
     // XXX
@@ -393,8 +1082,7 @@ RegExpBuiltinExec(ejsval R, ejsval S)
         }
 
         //  b. Let r be the result of calling matcher with arguments S and i.
-        r = pcre16_exec(matcher, &extra, subject_chars, length, i,
-                            PCRE_NO_UTF16_CHECK, ovec, 3);
+        r = regexp_exec(re, subject_chars, length, i, 0, ovec, 3);
 
         //     c. If r is failure, then
         if (r == PCRE_ERROR_NOMATCH) {
@@ -417,10 +1105,10 @@ RegExpBuiltinExec(ejsval R, ejsval S)
         }
     }
 #else
-    r = pcre16_exec(matcher, &extra, subject_chars, length, i,
-                    PCRE_NO_UTF16_CHECK, ovec, sizeof(ovec)/sizeof(ovec[0]));
-    if (r == PCRE_ERROR_NOMATCH) {
-        Put(R, _ejs_atom_lastIndex, NUMBER_TO_EJSVAL(0), EJS_TRUE);
+    // pcre does the search for us.  a sticky RegExp can only match at i.
+    r = i > length ? PCRE_ERROR_NOMATCH : regexp_exec(re, subject_chars, length, i, sticky ? PCRE_ANCHORED : 0, ovec, ovec_count);
+    if (r < 0) {
+        regexp_set_lastIndex(R, 0);
         return _ejs_null;
     }
 
@@ -442,10 +1130,10 @@ RegExpBuiltinExec(ejsval R, ejsval S)
     if (global || sticky) {
         // a. Let putStatus be the result of Put(R, "lastIndex", e, true).
         // b. ReturnIfAbrupt(putStatus).
-        Put(R, _ejs_atom_lastIndex, NUMBER_TO_EJSVAL(e), EJS_TRUE);
+        regexp_set_lastIndex(R, e);
     }
     // 20. Let n be the length of r's captures List. (This is the same value as 21.2.2.1's NcapturingParens.)
-    int n = r - 1;
+    int n = re->matcher->capture_count;
 
     // 21. Let A be the result of the abstract operation ArrayCreate(n + 1).
     ejsval A = _ejs_array_new(n+1, EJS_FALSE);
@@ -467,7 +1155,7 @@ RegExpBuiltinExec(ejsval R, ejsval S)
         ejsval capturedValue;
 
         // b. If captureI is undefined, then let capturedValue be undefined.
-        if (ovec[i*2] == ovec[i*2+1]) {
+        if (ovec[i*2] < 0) {
             capturedValue = _ejs_undefined;
         }
         else {
@@ -550,29 +1238,35 @@ static EJS_NATIVE_FUNC(_ejs_RegExp_prototype_exec) {
     return RegExpBuiltinExec(R, S);
 }
 
-// ECMA262: 15.10.6.3
+// ES2015, June 2015
+// 21.2.5.13 RegExp.prototype.test( S )
 static EJS_NATIVE_FUNC(_ejs_RegExp_prototype_test) {
-    if (!EJSVAL_IS_REGEXP(*_this))
-        EJS_NOT_IMPLEMENTED();
-
-    EJSRegExp* re = (EJSRegExp*)EJSVAL_TO_OBJECT(*_this);
+    ejsval string = _ejs_undefined;
+    if (argc > 0) string = args[0];
 
-    ejsval subject = _ejs_undefined;
-    if (argc > 0) subject = args[0];
+    // 1. Let R be the this value.
+    ejsval R = *_this;
 
-    pcre16_extra extra;
-    memset (&extra, 0, sizeof(extra));
+    // 2. If Type(R) is not Object, throw a TypeError exception.
+    if (!EJSVAL_IS_OBJECT(R))
+        _ejs_throw_nativeerror_utf8 (EJS_TYPE_ERROR, "non-object 'this' in RegExp.prototype.test");
 
-    EJSPrimString *flat_subject = _ejs_string_flatten (subject);
-    jschar* subject_chars = flat_subject->data.flat;
+    // 3. Let string be ToString(S).
+    // 4. ReturnIfAbrupt(string).
+    ejsval S = ToString(string);
 
-    int ovec[3];
+    // we only need to know whether it matched, so skip the match array
+    if (regexp_is_pristine(R)) {
+        int ovec[3];
+        return BOOLEAN_TO_EJSVAL(regexp_builtin_exec_offsets(R, _ejs_string_flatten(S), ovec, 3));
+    }
 
-    int rv = pcre16_exec((pcre16*)re->compiled_pattern, &extra,
-                         subject_chars, flat_subject->length, 0,
-                         PCRE_NO_UTF16_CHECK, ovec, 3);
+    // 5. Let match be RegExpExec(R, string).
+    // 6. ReturnIfAbrupt(match).
+    ejsval match = RegExpExec(R, S);
 
-    return rv == PCRE_ERROR_NOMATCH ? _ejs_false : _ejs_true;
+    // 7. If match is not null, return true; else return false.
+    return BOOLEAN_TO_EJSVAL(!EJSVAL_IS_NULL(match));
 }
 
 static EJS_NATIVE_FUNC(_ejs_RegExp_prototype_toString) {
@@ -676,6 +1370,31 @@ static EJS_NATIVE_FUNC(_ejs_RegExp_get_species) {
     return _ejs_RegExp;
 }
 
+// @@match of a pristine global @rx, collecting the matched strings
+// without a match array for each.
+static ejsval
+regexp_match_all_fast (ejsval rx, ejsval S)
+{
+    EJSRegExp* re = (EJSRegExp*)EJSVAL_TO_OBJECT(rx);
+    EJSPrimString* flat = _ejs_string_flatten (S);
+    int ovec[3];
+
+    ejsval A = _ejs_null;
+    int64_t start = 0;
+    while (regexp_match_from (re, flat, start, re->sticky, ovec, 3)) {
+        if (EJSVAL_IS_NULL(A))
+            A = _ejs_array_new(0, EJS_FALSE);
+        ejsval matchStr = _ejs_string_new_substring (S, ovec[0], ovec[1] - ovec[0]);
+        _ejs_array_push_dense (A, 1, &matchStr);
+
+        start = ovec[1] == ovec[0] ? regexp_advance (flat, ovec[1], re->unicode) : ovec[1];
+    }
+
+    // the exec that failed left lastIndex at 0
+    regexp_set_lastIndex (rx, 0);
+    return A;
+}
+
 // ES6 21.2.5.6
 // RegExp.prototype [ @@match ] ( string )
 static EJS_NATIVE_FUNC(_ejs_RegExp_prototype_match) {
@@ -704,6 +1423,9 @@ static EJS_NATIVE_FUNC(_ejs_RegExp_prototype_match) {
     }
     // 8. Else global is true,
     else {
+        if (regexp_is_pristine(rx))
+            return regexp_match_all_fast(rx, S);
+
         // a. Let putStatus be Put(rx, "lastIndex", 0, true).
         // b. ReturnIfAbrupt(putStatus).
         Put(rx, _ejs_atom_lastIndex, NUMBER_TO_EJSVAL(0), EJS_TRUE);
@@ -796,6 +1518,9 @@ static EJS_NATIVE_FUNC(_ejs_RegExp_prototype_replace) {
         // b. ReturnIfAbrupt(replaceValue).
         replaceValue = ToString(replaceValue);
     }
+    if (regexp_is_pristine(rx))
+        return regexp_replace_fast(rx, S, replaceValue, functionalReplace);
+
     // 8. Let global be ToBoolean(Get(rx, "global")).
     // 9. ReturnIfAbrupt(global).
     EJSBool global = ToEJSBool(Get(rx, _ejs_atom_global));
@@ -960,6 +1685,65 @@ static EJS_NATIVE_FUNC(_ejs_RegExp_prototype_replace) {
                               _ejs_string_new_substring(S, nextSourcePosition, EJSVAL_TO_STRLEN(S) - nextSourcePosition));
 }
 
+// @@split for a pristine @rx with the default species.  trying the
+// sticky splitter at q, q+1, ... until it matches finds the same match
+// as one unanchored search from q, so we do that instead.
+static ejsval
+regexp_split_fast (ejsval rx, ejsval S, int64_t lim)
+{
+    EJSRegExp* re = (EJSRegExp*)EJSVAL_TO_OBJECT(rx);
+    EJSPrimString* flat = _ejs_string_flatten (S);
+    int size = flat->length;
+    int m = re->matcher->capture_count;
+    int ovec_count = REGEXP_OVEC_COUNT(re);
+    int* ovec = (int*)alloca (sizeof(int) * ovec_count);
+
+    ejsval A = _ejs_array_new(0, EJS_FALSE);
+    int64_t lengthA = 0;
+
+    if (lim == 0)
+        return A;
+
+    if (size == 0) {
+        if (!regexp_match_from (re, flat, 0, EJS_TRUE, ovec, ovec_count))
+            _ejs_array_push_dense (A, 1, &S);
+        return A;
+    }
+
+    int p = 0;
+    int64_t q = 0;
+    while (q < size) {
+        if (!regexp_match_from (re, flat, q, EJS_FALSE, ovec, ovec_count) || ovec[0] >= size)
+            break;
+        q = ovec[0];
+        int e = MIN(ovec[1], size);
+
+        // an empty match right where the last one ended
+        if (e == p) {
+            q = regexp_advance (flat, q, re->unicode);
+            continue;
+        }
+
+        ejsval T = _ejs_string_new_substring (S, p, q - p);
+        _ejs_array_push_dense (A, 1, &T);
+        if (++lengthA == lim)
+            return A;
+
+        p = e;
+        for (int i = 1; i <= m; i ++) {
+            ejsval nextCapture = regexp_capture (S, ovec, i);
+            _ejs_array_push_dense (A, 1, &nextCapture);
+            if (++lengthA == lim)
+                return A;
+        }
+        q = p;
+    }
+
+    ejsval T = _ejs_string_new_substring (S, p, size - p);
+    _ejs_array_push_dense (A, 1, &T);
+    return A;
+}
+
 // ES2015, June 2015
 // 21.2.5.11 RegExp.prototype [ @@split ] ( string, limit )
 static EJS_NATIVE_FUNC(_ejs_RegExp_prototype_split) {
@@ -985,6 +1769,10 @@ static EJS_NATIVE_FUNC(_ejs_RegExp_prototype_split) {
     // 6. ReturnIfAbrupt(C).
     ejsval C = SpeciesConstructor(rx, _ejs_RegExp);
 
+    // the splitter would just be a sticky copy of rx
+    if (EJSVAL_EQ(C, _ejs_RegExp) && regexp_is_pristine(rx))
+        return regexp_split_fast(rx, S, EJSVAL_IS_UNDEFINED(limit) ? EJS_MAX_SAFE_INTEGER : ToLength(limit));
+
     // 7. Let flags be ToString(Get(rx, "flags"))
     // 8. ReturnIfAbrupt(flags).
     ejsval flags = ToString(Get(rx, _ejs_atom_flags));
@@ -1143,16 +1931,62 @@ static EJS_NATIVE_FUNC(_ejs_RegExp_prototype_split) {
     return A;
 }
 
-// ES6 21.2.5.9
-// RegExp.prototype [ @@search ] ( string )
+// ES2015, June 2015
+// 21.2.5.9 RegExp.prototype [ @@search ] ( string )
 static EJS_NATIVE_FUNC(_ejs_RegExp_prototype_search) {
-    EJS_NOT_IMPLEMENTED();
+    ejsval string = _ejs_undefined;
+    if (argc > 0) string = args[0];
+
+    // 1. Let rx be the this value.
+    ejsval rx = *_this;
+
+    // 2. If Type(rx) is not Object, throw a TypeError exception.
+    if (!EJSVAL_IS_OBJECT(rx))
+        _ejs_throw_nativeerror_utf8 (EJS_TYPE_ERROR, "Regexp.prototype[Symbol.search] called with non-object 'this'");
+
+    // 3. Let S be ToString(string).
+    // 4. ReturnIfAbrupt(S).
+    ejsval S = ToString(string);
+
+    // lastIndex ends up where it started, so all that's left is where the match is
+    if (regexp_is_pristine(rx)) {
+        EJSRegExp* re = (EJSRegExp*)EJSVAL_TO_OBJECT(rx);
+        int ovec[3];
+        if (!regexp_match_from (re, _ejs_string_flatten(S), 0, re->sticky, ovec, 3))
+            return NUMBER_TO_EJSVAL(-1);
+        return NUMBER_TO_EJSVAL(ovec[0]);
+    }
+
+    // 5. Let previousLastIndex be Get(rx, "lastIndex").
+    // 6. ReturnIfAbrupt(previousLastIndex).
+    ejsval previousLastIndex = Get(rx, _ejs_atom_lastIndex);
+
+    // 7. Let status be Set(rx, "lastIndex", 0, true).
+    // 8. ReturnIfAbrupt(status).
+    Put(rx, _ejs_atom_lastIndex, NUMBER_TO_EJSVAL(0), EJS_TRUE);
+
+    // 9. Let result be RegExpExec(rx, S).
+    // 10. ReturnIfAbrupt(result).
+    ejsval result = RegExpExec(rx, S);
+
+    // 11. Let status be Set(rx, "lastIndex", previousLastIndex, true).
+    // 12. ReturnIfAbrupt(status).
+    Put(rx, _ejs_atom_lastIndex, previousLastIndex, EJS_TRUE);
+
+    // 13. If result is null, return –1.
+    if (EJSVAL_IS_NULL(result))
+        return NUMBER_TO_EJSVAL(-1);
+
+    // 14. Return Get(result, "index").
+    return Get(result, _ejs_atom_index);
 }
 
 void
 _ejs_regexp_init(ejsval global)
 {
     pcre16_tables = pcre16_maketables();
+    // NULL if pcre was built without JIT support, and pcre falls back to its default stack
+    regexp_jit_stack = pcre16_jit_stack_alloc(32 * 1024, 1024 * 1024);
 
     _ejs_RegExp = _ejs_function_new_without_proto (_ejs_null, _ejs_atom_RegExp, _ejs_RegExp_impl);
     _ejs_object_setprop (global, _ejs_atom_RegExp, _ejs_RegExp);
@@ -1201,6 +2035,15 @@ _ejs_regexp_specop_allocate()
     return (EJSObject*)_ejs_gc_new(EJSRegExp);
 }
 
+static void
+_ejs_regexp_specop_finalize (EJSObject* obj)
+{
+    EJSRegExp *re = (EJSRegExp*)obj;
+    if (re->matcher)
+        regexp_matcher_release (re->matcher);
+    _ejs_Object_specops.Finalize (obj);
+}
+
 static void
 _ejs_regexp_specop_scan (EJSObject* obj, EJSValueFunc scan_func)
 {
@@ -1227,7 +2070,7 @@ EJS_DEFINE_CLASS(RegExp,
                  OP_INHERIT, // [[Call]]
                  OP_INHERIT, // [[Construct]]
                  _ejs_regexp_specop_allocate,
-                 OP_INHERIT, // [[Finalize]]
+                 _ejs_regexp_specop_finalize,
                  _ejs_regexp_specop_scan
                  )
 
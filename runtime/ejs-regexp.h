@@ -7,6 +7,10 @@
 
 #include "ejs-object.h"
 
+// a compiled pattern, shared by every RegExp created from the same
+// source and flags.  see ejs-regexp.c
+typedef struct _EJSRegExpMatcher EJSRegExpMatcher;
+
 typedef struct {
     /* object header */
     EJSObject obj;
@@ -24,7 +28,7 @@ typedef struct {
 
     int lastIndex;
 
-    void* compiled_pattern;
+    EJSRegExpMatcher* matcher;
 } EJSRegExp;
 
 EJS_BEGIN_DECLS
@@ -40,6 +44,9 @@ ejsval _ejs_regexp_new (ejsval pattern, ejsval flags);
 
 ejsval _ejs_regexp_new_utf8(const char *pattern, const char *flags);
 
+/* regexp literals.  @site is a per-literal slot (initially NULL) the compiled pattern is cached in */
+ejsval _ejs_regexp_new_literal(const char *pattern, const char *flags, void **site);
+
 ejsval _ejs_regexp_replace(ejsval str, ejsval search, ejsval replace);
 
 /* we expose this publicly because String.prototype.match needs to call it directly */
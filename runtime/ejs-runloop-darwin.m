@@ -142,6 +142,13 @@ _ejs_runloop_remove_task(void* handle)
     [taskObj stopDelayedTask:timer];
 }
 
+EJSBool
+_ejs_runloop_add_background_task(Task work, Task done, void* data)
+{
+    // XXX we could do this with dispatch queues
+    return EJS_FALSE;
+}
+
 void
 _ejs_runloop_start()
 {
@@ -9,8 +9,32 @@ typedef struct {
   void* data;
   TaskDataDtor dtor;
   EJSBool repeats;
+  EJSBool closed;
 } task_timer;
 
+static void
+free_task(uv_handle_t* handle)
+{
+  task_timer* t = (task_timer*)handle->data;
+  if (t->dtor)
+    t->dtor(t->data);
+  free(t);
+}
+
+// the loop keeps a list of its handles, so a timer has to be closed,
+// not just stopped, before it can be freed.  that (and the dtor) happens
+// in free_task, once the loop is done with it, so it's safe to remove a
+// task from inside the task itself.
+static void
+close_task(task_timer* t)
+{
+  if (t->closed)
+    return;
+  t->closed = EJS_TRUE;
+  uv_timer_stop(&t->timer);
+  uv_close((uv_handle_t*)&t->timer, free_task);
+}
+
 static void
 invoke_task(uv_timer_t* timer, int unused)
 {
@@ -18,9 +42,7 @@ invoke_task(uv_timer_t* timer, int unused)
   t->task(t->data);
   if (t->repeats)
     return;
-  t->dtor(t->data);
-  uv_timer_stop(timer);
-  free(t);
+  close_task(t);
 }
 
 void
@@ -32,6 +54,8 @@ _ejs_runloop_add_task(Task task, void* data, TaskDataDtor dtor)
   t->task = task;
   t->data = data;
   t->dtor = dtor;
+  t->repeats = EJS_FALSE;
+  t->closed = EJS_FALSE;
 
   uv_timer_start(&t->timer, invoke_task, 0, 0);
 }
@@ -46,6 +70,7 @@ _ejs_runloop_add_task_timeout(Task task, void* data, TaskDataDtor dtor, int64_t
   t->data = data;
   t->dtor = dtor;
   t->repeats = repeats;
+  t->closed = EJS_FALSE;
 
   if (timeout == 0)
     timeout = 1;
@@ -59,9 +84,46 @@ _ejs_runloop_add_task_timeout(Task task, void* data, TaskDataDtor dtor, int64_t
 void
 _ejs_runloop_remove_task(void* handle)
 {
-  task_timer* t = (task_timer*)handle;
-  uv_timer_stop(&t->timer);
-  uv_unref((uv_handle_t*)&t->timer);
+  close_task((task_timer*)handle);
+}
+
+typedef struct {
+  uv_work_t req;
+
+  Task work;
+  Task done;
+  void* data;
+} background_task;
+
+static void
+invoke_background_work(uv_work_t* req)
+{
+  background_task* t = (background_task*)req->data;
+  t->work(t->data);
+}
+
+static void
+invoke_background_done(uv_work_t* req, int status)
+{
+  background_task* t = (background_task*)req->data;
+  t->done(t->data);
+  free(t);
+}
+
+EJSBool
+_ejs_runloop_add_background_task(Task work, Task done, void* data)
+{
+  background_task* t = malloc(sizeof(background_task));
+  t->req.data = t;
+  t->work = work;
+  t->done = done;
+  t->data = data;
+
+  if (uv_queue_work(uv_default_loop(), &t->req, invoke_background_work, invoke_background_done) != 0) {
+    free(t);
+    return EJS_FALSE;
+  }
+  return EJS_TRUE;
 }
 
 void
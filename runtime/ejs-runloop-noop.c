@@ -16,6 +16,12 @@ _ejs_runloop_remove_task(void* handle)
 {
 }
 
+EJSBool
+_ejs_runloop_add_background_task(Task work, Task done, void* data)
+{
+  return EJS_FALSE;
+}
+
 void
 _ejs_runloop_start()
 {
@@ -15,6 +15,10 @@ typedef void (*TaskDataDtor)(void* data);
 void _ejs_runloop_add_task(Task task, void* data, TaskDataDtor data_dtor);
 void* _ejs_runloop_add_task_timeout(Task task, void* data, TaskDataDtor data_dtor, int64_t timeout, EJSBool repeats);
 void _ejs_runloop_remove_task(void *handle);
+// runs @work on a background thread, then @done back on the run loop.
+// returns EJS_FALSE without running anything if this run loop has no
+// background threads.
+EJSBool _ejs_runloop_add_background_task(Task work, Task done, void* data);
 void _ejs_runloop_start();
 
 
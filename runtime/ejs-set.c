@@ -411,6 +411,7 @@ _ejs_set_iterator_new (ejsval set, EJSSetIteratorKind kind)
 
     /* 6. Set iterator’s [[SetNextIndex]] internal slot to 0. */
     iter->next_index = 0;
+    iter->cursor = NULL;
 
     /* 7. Set iterator’s [[SetIterationKind]] internal slot to kind. */
     iter->kind = kind;
@@ -426,64 +427,47 @@ static EJS_NATIVE_FUNC(_ejs_SetIterator_impl) {
     return *_this;
 }
 
-static EJS_NATIVE_FUNC(_ejs_SetIterator_prototype_next) {
-    /* 1. Let O be the this value. */
-    ejsval O = *_this;
-
-    /* 2. If Type(O) is not Object, throw a TypeError exception. */
-    if (!EJSVAL_IS_OBJECT(O))
-        _ejs_throw_nativeerror_utf8 (EJS_TYPE_ERROR, ".next called on non-object");
-
-    /* 3. If O does not have all of the internal slots of a Set Iterator Instance (23.2.5.3),
-     * throw a TypeError exception. */
-    if (!EJSVAL_IS_SETITERATOR(O))
-        _ejs_throw_nativeerror_utf8 (EJS_TYPE_ERROR, ".next called on non-SetIterator instance");
-
+// the body of %SetIteratorPrototype%.next, minus the iter result.
+// returns the EJS_NO_ITER_VALUE magic once the iterator is done.  O
+// must be a Set Iterator.
+ejsval
+_ejs_set_iterator_step (ejsval O)
+{
     EJSSetIterator *OObj = (EJSSetIterator*)EJSVAL_TO_OBJECT(O);
 
     /* 4. Let s be the value of the [[IteratedSet]] internal slot of O. */
     ejsval s = OObj->iterated;
 
     /* 5. Let index be the value of the [[SetNextIndex]] internal slot of O. */
-    uint32_t index = OObj->next_index;
+    // like MapIterator, we use a cursor instead of the index.
 
     /* 6. Let itemKind be the value of the [[SetIterationKind]] internal slot of O. */
     EJSSetIteratorKind itemKind = OObj->kind;
 
     /* 7. If s is undefined, then return CreateIterResultObject(undefined, true). */
     if (EJSVAL_IS_UNDEFINED(s))
-        return _ejs_create_iter_result (_ejs_undefined, _ejs_true);
+        return MAGIC_TO_EJSVAL_IMPL(EJS_NO_ITER_VALUE);
 
     /* 8. Assert: s has a [[SetData]] internal slot and s has been initialized so the value of
      * [[SetData]] is not undefined. */
 
     /* 9. Let entries be the List that is the value of the [[SetData]] internal slot of s. */
-    EJSSetValueEntry *entries = EJSVAL_TO_SET(s)->head_insert;
+    EJSSetValueEntry *entry = OObj->cursor ? OObj->cursor->next_insert : EJSVAL_TO_SET(s)->head_insert;
 
     /* 10. Repeat while index is less than the total number of elements of entries. The number of elements must
      * be redetermined each time this method is evaluated. */
-    uint32_t i = 0;
-    for (EJSSetValueEntry *entry = entries; entry; entry = entry->next_insert) {
-
-        /* Ignore this item if is marked as empty */
-        if (EJSVAL_IS_NO_ITER_VALUE_MAGIC(entry->value))
-            continue;
-
-        /* Ignore this item if we haven't reached the initial needed point/index */
-        if (index > i++)
-            continue;
-
+    for (; entry; entry = entry->next_insert) {
         /* a. Let e be entries[index]. */
         ejsval e = entry->value;
 
         /* b. Set index to index+1; */
-        index = index + 1;
-
         /* c. Set the [[SetNextIndex]] internal slot of O to index. */
-        OObj->next_index = index;
+        OObj->cursor = entry;
+        OObj->next_index ++;
 
         /* d. If e is not empty, then */
-        /*  (see EJSVAL_IS_NO_ITER_VALUE_MAGIC check at the beginning of the loop */
+        if (EJSVAL_IS_NO_ITER_VALUE_MAGIC(e))
+            continue;
 
         /*      i. If itemKind is "key+value" then, */
         if (itemKind == EJS_SET_ITER_KIND_KEYVALUE) {
@@ -497,18 +481,39 @@ static EJS_NATIVE_FUNC(_ejs_SetIterator_prototype_next) {
             /* 4. Call CreateDataProperty(result, "1", e) . */
             _ejs_object_setprop (result, NUMBER_TO_EJSVAL(1), e);
 
-            return _ejs_create_iter_result (result, _ejs_false);
+            return result;
         }
 
         /*      ii. Return CreateIterResultObject(e, false). */
-        return _ejs_create_iter_result (e, _ejs_false);
+        return e;
     }
 
     /* 11. Set the [[IteratedSet]] internal slot of O to undefined. */
     OObj->iterated = _ejs_undefined;
+    OObj->cursor = NULL;
 
     /* 12. Return CreateIterResultObject(undefined, true). */
-    return _ejs_create_iter_result (_ejs_undefined, _ejs_true);
+    return MAGIC_TO_EJSVAL_IMPL(EJS_NO_ITER_VALUE);
+}
+
+EJS_NATIVE_FUNC(_ejs_SetIterator_prototype_next) {
+    /* 1. Let O be the this value. */
+    ejsval O = *_this;
+
+    /* 2. If Type(O) is not Object, throw a TypeError exception. */
+    if (!EJSVAL_IS_OBJECT(O))
+        _ejs_throw_nativeerror_utf8 (EJS_TYPE_ERROR, ".next called on non-object");
+
+    /* 3. If O does not have all of the internal slots of a Set Iterator Instance (23.2.5.3),
+     * throw a TypeError exception. */
+    if (!EJSVAL_IS_SETITERATOR(O))
+        _ejs_throw_nativeerror_utf8 (EJS_TYPE_ERROR, ".next called on non-SetIterator instance");
+
+    ejsval result = _ejs_set_iterator_step (O);
+    if (EJSVAL_IS_NO_ITER_VALUE_MAGIC(result))
+        return _ejs_create_iter_result (_ejs_undefined, _ejs_true);
+
+    return _ejs_create_iter_result (result, _ejs_false);
 }
 
 void
@@ -55,6 +55,7 @@ typedef struct {
     ejsval iterated;
     EJSSetIteratorKind kind;
     int next_index;
+    EJSSetValueEntry* cursor; // the last entry visited, NULL before the first
 } EJSSetIterator;
 
 extern ejsval _ejs_SetIterator;
@@ -62,6 +63,9 @@ extern ejsval _ejs_SetIterator_prototype;
 extern EJSSpecOps _ejs_SetIterator_specops;
 
 ejsval _ejs_set_iterator_new (ejsval set, EJSSetIteratorKind kind);
+ejsval _ejs_set_iterator_step (ejsval iterator);
+
+EJS_NATIVE_FUNC(_ejs_SetIterator_prototype_next);
 
 EJS_END_DECLS
 
@@ -4,7 +4,6 @@
 
 #include <unistd.h>
 #include <termios.h>
-#include <errno.h>
 #include <sys/ioctl.h>
 
 #include "ejs.h"
@@ -14,41 +13,32 @@
 #include "ejs-string.h"
 #include "ejs-symbol.h"
 #include "ejs-value.h"
+#include "ejs-output.h"
 
 static ejsval _ejs_internal_fd_sym EJSVAL_ALIGNMENT; 
 
+// returns false once enough is waiting to be written that the caller
+// should stop until the stream's ondrain is called
 static EJS_NATIVE_FUNC(_ejs_stream_write) {
     ejsval to_write = ToString(args[0]);
     ejsval internal_fd = _ejs_object_getprop (*_this, _ejs_internal_fd_sym);
-    int fd = ToInteger(internal_fd);
+    EJSOutput* out = _ejs_output_for_fd (ToInteger(internal_fd));
 
-    int remaining = EJSVAL_TO_STRLEN(to_write);
-    int offset = 0;
-    char *buf = ucs2_to_utf8(EJSVAL_TO_FLAT_STRING(to_write));
-    
-    do {
-        int num_written = write (fd, buf + offset, remaining);
-        if (num_written == -1) {
-            if (errno == EINTR)
-                continue;
-            perror ("write");
-            free (buf);
-            return _ejs_false;
-        }
-        remaining -= num_written;
-        offset += num_written;
-    } while (remaining > 0);
-
-    free (buf);
-    return _ejs_true;
+    _ejs_output_write_string (out, to_write);
+    return BOOLEAN_TO_EJSVAL(_ejs_output_end_write (out));
 }
 
 static EJS_NATIVE_FUNC(_ejs_stream_end) {
     ejsval internal_fd = _ejs_object_getprop (*_this, _ejs_internal_fd_sym);
-    close (ToInteger(internal_fd));
+    _ejs_output_close (ToInteger(internal_fd));
     return _ejs_undefined;
 }
 
+static EJS_NATIVE_FUNC(_ejs_stream_getWritableLength) {
+    ejsval internal_fd = _ejs_object_getprop (*_this, _ejs_internal_fd_sym);
+    return NUMBER_TO_EJSVAL(_ejs_output_pending (_ejs_output_for_fd (ToInteger(internal_fd))));
+}
+
 static EJS_NATIVE_FUNC(_ejs_stream_endThrow) {
     _ejs_throw_nativeerror_utf8 (EJS_ERROR, "this stream cannot be closed");
     EJS_NOT_REACHED();
@@ -67,7 +57,10 @@ _ejs_stream_wrapFd (int fd, EJSBool throwOnEnd)
         EJS_INSTALL_ATOM_FUNCTION(stream, end, _ejs_stream_end);
     }
 
+    EJS_INSTALL_ATOM_GETTER(stream, writableLength, _ejs_stream_getWritableLength);
+
     _ejs_object_setprop (stream, _ejs_internal_fd_sym, NUMBER_TO_EJSVAL(fd));
+    _ejs_output_set_stream (_ejs_output_for_fd (fd), stream);
 
     return stream;
 }
@@ -114,6 +114,42 @@ ucs2_strstr (const jschar *haystack,
     return NULL;
 }
 
+// like memchr, for @haystack_len jschars that needn't be nul terminated
+const jschar*
+ucs2_memchr (const jschar *haystack, int haystack_len, jschar c)
+{
+    const jschar* end = haystack + haystack_len;
+    for (const jschar* p = haystack; p < end; p ++) {
+        if (*p == c)
+            return p;
+    }
+    return NULL;
+}
+
+// the first occurrence of @needle in @haystack, by length so either can
+// contain nuls.  we scan for the needle's first character and only
+// compare the rest where it turns up.
+const jschar*
+ucs2_memmem (const jschar *haystack, int haystack_len, const jschar *needle, int needle_len)
+{
+    if (needle_len == 0)
+        return haystack;
+    if (needle_len > haystack_len)
+        return NULL;
+
+    const jschar* last = haystack + haystack_len - needle_len;
+    const jschar* p = haystack;
+    while (p <= last) {
+        p = ucs2_memchr (p, last - p + 1, needle[0]);
+        if (!p)
+            return NULL;
+        if (!memcmp (p + 1, needle + 1, (needle_len - 1) * sizeof(jschar)))
+            return p;
+        p ++;
+    }
+    return NULL;
+}
+
 jschar*
 ucs2_strrstr (const jschar *haystack,
               const jschar *needle)
@@ -941,7 +977,7 @@ static EJS_NATIVE_FUNC(_ejs_String_prototype_toLocaleUpperCase) {
     EJS_NOT_IMPLEMENTED();
 }
 
-static EJSBool
+EJSBool
 IsWhitespace(jschar c) {
 
     switch (c) {
@@ -1728,19 +1764,31 @@ static EJS_NATIVE_FUNC(_ejs_StringIterator_impl) {
 }
 
 /* 21.1.5.2.1 %StringIteratorPrototype%.next () */
-static EJS_NATIVE_FUNC(_ejs_StringIterator_prototype_next) {
-    /* 1. Let O be the this value. */
-    ejsval O = *_this;
+// one code unit strings for the ascii range, created as they're needed.
+// string iteration hands these out instead of allocating a new string
+// per character.
+static ejsval ascii_strings[128];
 
-    /* 2. If Type(O) is not Object, throw a TypeError exception. */
-    if (!EJSVAL_IS_OBJECT(O))
-        _ejs_throw_nativeerror_utf8(EJS_TYPE_ERROR, ".next called on non-object");
+static ejsval
+single_unit_string (jschar c)
+{
+    if (c >= 128)
+        return _ejs_string_new_ucs2_len(&c, 1);
 
-    /* 3. If O does not have all of the internal slots of an String Iterator Instance (21.1.5.3),
-     * throw a TypeError exception. */
-    if (!EJSVAL_IS_STRINGITERATOR(O))
-        _ejs_throw_nativeerror_utf8(EJS_TYPE_ERROR, ".next called on non-StringIterator instance");
+    // the array starts out zero filled, which is the number 0, not a string
+    if (!EJSVAL_IS_STRING(ascii_strings[c])) {
+        _ejs_gc_add_root (&ascii_strings[c]);
+        ascii_strings[c] = _ejs_string_new_ucs2_len(&c, 1);
+    }
+    return ascii_strings[c];
+}
 
+// the body of %StringIteratorPrototype%.next, minus the iter result.
+// returns the EJS_NO_ITER_VALUE magic once the iterator is done.  O
+// must be a String Iterator.
+ejsval
+_ejs_string_iterator_step (ejsval O)
+{
     EJSStringIterator *OObj = (EJSStringIterator*) EJSVAL_TO_OBJECT(O);
 
     /* 4. Let s be the value of the [[IteratedString]] internal slot of O. */
@@ -1748,7 +1796,7 @@ static EJS_NATIVE_FUNC(_ejs_StringIterator_prototype_next) {
 
     /* 5. If s is undefined, then return CreateIterResultObject(undefined, true). */
     if (EJSVAL_IS_UNDEFINED(s))
-        return _ejs_create_iter_result (_ejs_undefined, _ejs_true);
+        return MAGIC_TO_EJSVAL_IMPL(EJS_NO_ITER_VALUE);
 
     ejsval sPrimStr;
     if (EJSVAL_IS_STRING(s))
@@ -1770,7 +1818,7 @@ static EJS_NATIVE_FUNC(_ejs_StringIterator_prototype_next) {
         OObj->iterated = _ejs_undefined;
 
         /* b. Return CreateIterResultObject(undefined, true). */
-        return _ejs_create_iter_result (_ejs_undefined, _ejs_true);
+        return MAGIC_TO_EJSVAL_IMPL(EJS_NO_ITER_VALUE);
     }
 
     jschar chars[2];
@@ -1783,7 +1831,7 @@ static EJS_NATIVE_FUNC(_ejs_StringIterator_prototype_next) {
 
     // 10. If first < 0xD800 or first > 0xDBFF or position+1 = len then let resultString be the string consisting of the single code unit first.
     if (chars[0] < 0xD800 || chars[0] > 0xDBFF || position+1 == len)
-        resultString = _ejs_string_new_ucs2_len(chars, 1);
+        resultString = single_unit_string(chars[0]);
     // 11. Else,
     else {
         //      a. Let second be the code unit value of the element at index position+1 in the String S.
@@ -1791,7 +1839,7 @@ static EJS_NATIVE_FUNC(_ejs_StringIterator_prototype_next) {
         //      b. If second < 0xDC00 or second > 0xDFFF, then let resultString be the string consisting
         //         of the single code unit first.
         if (chars[1] < 0xDc00 || chars[1] > 0xDFFF)
-            resultString = _ejs_string_new_ucs2_len(chars, 1);
+            resultString = single_unit_string(chars[0]);
         //      c. Else, let resultString be the string consisting of the code unit first followed by
         //          the code unit second. */
         else {
@@ -1806,6 +1854,26 @@ static EJS_NATIVE_FUNC(_ejs_StringIterator_prototype_next) {
     /* 13. Set the value of the [[StringIteratorNextIndex]] internal slot of O to position+ resultSize. */
     OObj->next_index = position + resultSize;
 
+    return resultString;
+}
+
+EJS_NATIVE_FUNC(_ejs_StringIterator_prototype_next) {
+    /* 1. Let O be the this value. */
+    ejsval O = *_this;
+
+    /* 2. If Type(O) is not Object, throw a TypeError exception. */
+    if (!EJSVAL_IS_OBJECT(O))
+        _ejs_throw_nativeerror_utf8(EJS_TYPE_ERROR, ".next called on non-object");
+
+    /* 3. If O does not have all of the internal slots of an String Iterator Instance (21.1.5.3),
+     * throw a TypeError exception. */
+    if (!EJSVAL_IS_STRINGITERATOR(O))
+        _ejs_throw_nativeerror_utf8(EJS_TYPE_ERROR, ".next called on non-StringIterator instance");
+
+    ejsval resultString = _ejs_string_iterator_step(O);
+    if (EJSVAL_IS_NO_ITER_VALUE_MAGIC(resultString))
+        return _ejs_create_iter_result (_ejs_undefined, _ejs_true);
+
     /* 14. Return CreateIterResultObject(resultString, false). */
     return _ejs_create_iter_result (resultString, _ejs_false);
 }
@@ -2121,6 +2189,34 @@ _ejs_string_new_ucs2_len (const jschar* str, int len)
     return STRING_TO_EJSVAL(rv);
 }
 
+ejsval
+_ejs_string_new_ascii_len (const char* str, int len)
+{
+    size_t value_size = EJS_PRIMSTR_FLAT_ALLOC_SIZE + sizeof(jschar) * (len + 1);
+    EJSBool ool_buffer = EJS_FALSE;
+
+    if (value_size > 2048) {
+        value_size = EJS_PRIMSTR_FLAT_ALLOC_SIZE;
+        ool_buffer = EJS_TRUE;
+    }
+
+    EJSPrimString* rv = _ejs_gc_new_primstr(value_size);
+    EJS_PRIMSTR_SET_TYPE(rv, EJS_STRING_FLAT);
+    rv->length = len;
+    if (ool_buffer) {
+        EJS_PRIMSTR_SET_HAS_OOL_BUFFER(rv);
+        rv->data.flat = (jschar*)malloc(sizeof(jschar) * (len + 1));
+    }
+    else {
+        rv->data.flat = (jschar*)((char*)rv + EJS_PRIMSTR_FLAT_ALLOC_SIZE);
+    }
+    // no decoding to do, just widen each char
+    for (int i = 0; i < len; i ++)
+        rv->data.flat[i] = (unsigned char)str[i];
+    rv->data.flat[len] = 0;
+    return STRING_TO_EJSVAL(rv);
+}
+
 static void flatten_dep (jschar **p, EJSPrimString *n, int* off, int* len);
 
 ejsval
@@ -102,6 +102,7 @@ ejsval _ejs_string_new_utf8 (const char* str);
 ejsval _ejs_string_new_utf8_len (const char* str, int len);
 ejsval _ejs_string_new_ucs2 (const jschar* str);
 ejsval _ejs_string_new_ucs2_len (const jschar* str, int len);
+ejsval _ejs_string_new_ascii_len (const char* str, int len);
 ejsval _ejs_string_new_substring (ejsval str, int off, int len);
 
 ejsval _ejs_string_concat (ejsval left, ejsval right);
@@ -111,6 +112,9 @@ EJSPrimString* _ejs_primstring_flatten (EJSPrimString* primstr);
 
 jschar _ejs_string_ucs2_at (EJSPrimString* primstr, uint32_t offset);
 
+// ES2015 11.2 WhiteSpace and 11.3 LineTerminator
+EJSBool IsWhitespace (jschar c);
+
 uint32_t _ejs_string_hash (ejsval str);
 
 int ucs2_to_utf8_char (jschar ucs2, char *utf8);
@@ -135,6 +139,9 @@ extern ejsval _ejs_StringIterator_prototype;
 extern EJSSpecOps _ejs_StringIterator_specops;
 
 ejsval _ejs_string_iterator_new(ejsval array);
+ejsval _ejs_string_iterator_step(ejsval iterator);
+
+EJS_NATIVE_FUNC(_ejs_StringIterator_prototype_next);
 
 EJS_END_DECLS
 
@@ -20,7 +20,8 @@ ejsval _ejs_clearTimeout EJSVAL_ALIGNMENT;
 ejsval _ejs_clearInterval EJSVAL_ALIGNMENT;
 
 typedef struct {
-    EJSTimer *timer;
+    // rooted, so it's still around to have its handle cleared when the task goes away
+    ejsval timer;
 
     ejsval callbackfn;
     ejsval *args;
@@ -29,13 +30,15 @@ typedef struct {
 
 
 static TimerTaskArg*
-create_task_arg (ejsval callbackfn, uint32_t argc, ejsval *args)
+create_task_arg (ejsval timer, ejsval callbackfn, uint32_t argc, ejsval *args)
 {
     TimerTaskArg *rv = malloc(sizeof(TimerTaskArg));
+    rv->timer = timer;
     rv->callbackfn = callbackfn;
     rv->argc = argc;
     rv->args = args;
 
+    _ejs_gc_add_root(&rv->timer);
     _ejs_gc_add_root(&rv->callbackfn);
     for (int i = 0; i < rv->argc; i++)
         _ejs_gc_add_root(&rv->args[i]);
@@ -46,6 +49,7 @@ create_task_arg (ejsval callbackfn, uint32_t argc, ejsval *args)
 static void
 destroy_task_arg (TimerTaskArg *arg)
 {
+    _ejs_gc_remove_root(&arg->timer);
     _ejs_gc_remove_root(&arg->callbackfn);
     for (int i = 0; i < arg->argc; i++)
         _ejs_gc_remove_root(&arg->args[i]);
@@ -67,7 +71,12 @@ call_timeout_task (void* data)
 static void
 dtor_timeout_task (void *data)
 {
-    destroy_task_arg((TimerTaskArg*)data);
+    TimerTaskArg *arg = (TimerTaskArg*)data;
+
+    // the run loop is done with the task (a one-shot timer fired, or it was
+    // cleared), so the handle may be reused from here on
+    EJSVAL_TO_TIMER(arg->timer)->handle = NULL;
+    destroy_task_arg(arg);
 }
 
 static EJS_NATIVE_FUNC(_ejs_clearTimer) {
@@ -99,12 +108,12 @@ EJS_NATIVE_FUNC(_ejs_clearTimeout_impl) {
 }
 
 static ejsval
-create_timer_value(void *handle)
+create_timer_value()
 {
     EJSObject *timer = (EJSObject*)_ejs_gc_new (EJSTimer);
     _ejs_init_object (timer, _ejs_Timer_prototype, &_ejs_Timer_specops);
 
-    ((EJSTimer*)timer)->handle = handle;
+    ((EJSTimer*)timer)->handle = NULL;
 
     return OBJECT_TO_EJSVAL(timer);
 }
@@ -134,10 +143,11 @@ _ejs_setTimer(uint32_t argc, ejsval* args, EJSBool repeats) {
     for (int i = 0; i < timer_argc; i++)
         timer_args[i] = args[i + 2];
 
-    TimerTaskArg *taskArg = create_task_arg (callbackfn, timer_argc, timer_args);
-    void *handle = _ejs_runloop_add_task_timeout (call_timeout_task, taskArg, dtor_timeout_task, ToLength(interval), repeats);
+    ejsval timer = create_timer_value ();
+    TimerTaskArg *taskArg = create_task_arg (timer, callbackfn, timer_argc, timer_args);
+    EJSVAL_TO_TIMER(timer)->handle = _ejs_runloop_add_task_timeout (call_timeout_task, taskArg, dtor_timeout_task, ToLength(interval), repeats);
 
-    return create_timer_value (handle);
+    return timer;
 }
 
 static EJS_NATIVE_FUNC(_ejs_setTimeout_impl) {
@@ -14,6 +14,7 @@
 #include "ejs-error.h"
 #include "ejs-symbol.h"
 #include "ejs-proxy.h"
+#include "ejs-gc.h"
 
 static inline int
 max(int a, int b)
@@ -113,6 +114,7 @@ _ejs_arraybuffer_new (int size)
     _ejs_init_object ((EJSObject*)rv, _ejs_ArrayBuffer_prototype, &_ejs_ArrayBuffer_specops);
 
     rv->dependent = EJS_FALSE;
+    rv->external = EJS_FALSE;
     rv->size = size;
     if (size)
         rv->data.alloced_buf = calloc(1, size);
@@ -120,6 +122,25 @@ _ejs_arraybuffer_new (int size)
     return OBJECT_TO_EJSVAL(rv);
 }
 
+ejsval
+_ejs_arraybuffer_new_external (void* data, int size, EJSArrayBufferReleaseFunc release, void* release_data)
+{
+    EJSArrayBuffer *rv = _ejs_gc_new(EJSArrayBuffer);
+
+    _ejs_init_object ((EJSObject*)rv, _ejs_ArrayBuffer_prototype, &_ejs_ArrayBuffer_specops);
+
+    rv->dependent = EJS_FALSE;
+    rv->external = EJS_TRUE;
+    rv->size = size;
+    rv->data.external.buf = data;
+    rv->data.external.release = release;
+    rv->data.external.release_data = release_data;
+
+    _ejs_gc_add_external_bytes (size);
+
+    return OBJECT_TO_EJSVAL(rv);
+}
+
 ejsval
 _ejs_arraybuffer_new_slice (ejsval bufferval, int offset, int size)
 {
@@ -129,6 +150,7 @@ _ejs_arraybuffer_new_slice (ejsval bufferval, int offset, int size)
     _ejs_init_object ((EJSObject*)rv, _ejs_ArrayBuffer_prototype, &_ejs_ArrayBuffer_specops);
 
     rv->dependent = EJS_TRUE;
+    rv->external = EJS_FALSE;
     rv->data.dependent.offset = MIN(buffer->size, offset);
     rv->data.dependent.buf = bufferval;
     rv->size = size;
@@ -162,6 +184,7 @@ static EJS_NATIVE_FUNC(_ejs_ArrayBuffer_impl) {
     EJSArrayBuffer* buffer = (EJSArrayBuffer*)EJSVAL_TO_OBJECT(*_this);
 
     buffer->dependent = EJS_FALSE;
+    buffer->external = EJS_FALSE;
     buffer->size = byteLength;
     if (byteLength)
         buffer->data.alloced_buf = calloc (1, byteLength);
@@ -393,7 +416,7 @@ EJS_DATA_VIEW_METHOD_IMPL(Float64, double, 8);
                     arr->byteLength = array_len * (elementSizeInBytes); \
                     arr->buffer = _ejs_arraybuffer_new (arr->byteLength); \
                                                                         \
-                    void* buf_data = ((EJSArrayBuffer*)EJSVAL_TO_OBJECT(arr->buffer))->data.alloced_buf; \
+                    void* buf_data = _ejs_arraybuffer_get_data(EJSVAL_TO_OBJECT(arr->buffer)); \
                     if (EJSVAL_IS_DENSE_ARRAY(args[0])) {               \
                         EJSObject* arr = EJSVAL_TO_OBJECT(args[0]);     \
                         int i;                                          \
@@ -402,8 +425,12 @@ EJS_DATA_VIEW_METHOD_IMPL(Float64, double, 8);
                         }                                               \
                     }                                                   \
                     else {                                              \
-                        _ejs_log ("need to implement normal array object copying for sparse arrays.  or do we?\n"); \
-                        EJS_NOT_IMPLEMENTED();                          \
+                        /* sparse: holes read as undefined */           \
+                        uint32_t i;                                     \
+                        for (i = 0; i < array_len; i ++) {              \
+                            ejsval v = _ejs_object_getprop (args[0], NUMBER_TO_EJSVAL(i)); \
+                            ((elementtype*)buf_data)[i] = (elementtype)ToDouble(v); \
+                        }                                               \
                     }                                                   \
                 }                                                       \
                 else if (EJSVAL_IS_ARRAYBUFFER(args[0])) {              \
@@ -2201,6 +2228,9 @@ _ejs_arraybuffer_get_data (EJSObject* buf)
         return _ejs_arraybuffer_get_data (EJSVAL_TO_OBJECT(array_buffer->data.dependent.buf)) + array_buffer->data.dependent.offset;
     }
 
+    if (array_buffer->external)
+        return array_buffer->data.external.buf;
+
     return array_buffer->data.alloced_buf;
 }
 
@@ -2475,7 +2505,13 @@ static void
 _ejs_arraybuffer_specop_finalize (EJSObject* obj)
 {
     EJSArrayBuffer *arraybuf = (EJSArrayBuffer*)obj;
-    if (!arraybuf->dependent) {
+    if (arraybuf->external) {
+        if (arraybuf->data.external.release)
+            arraybuf->data.external.release (arraybuf->data.external.buf, arraybuf->size, arraybuf->data.external.release_data);
+        _ejs_gc_remove_external_bytes (arraybuf->size);
+        arraybuf->data.external.buf = NULL;
+    }
+    else if (!arraybuf->dependent) {
         free (arraybuf->data.alloced_buf);
         arraybuf->data.alloced_buf = NULL;
     }
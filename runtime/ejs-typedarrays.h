@@ -7,12 +7,17 @@
 
 #include "ejs-object.h"
 
+/* called when an external ArrayBuffer is finalized.  @data and @size are the values passed to
+   _ejs_arraybuffer_new_external. */
+typedef void (*EJSArrayBufferReleaseFunc)(void* data, int size, void* release_data);
+
 typedef struct _EJSArrayBuffer {
     /* object header */
     EJSObject obj;
 
     /* buffer data */
     EJSBool dependent;
+    EJSBool external;
     int size;
 
     union {
@@ -22,6 +27,12 @@ typedef struct _EJSArrayBuffer {
         } dependent;
 
         void *alloced_buf;
+
+        struct {
+            void* buf;
+            EJSArrayBufferReleaseFunc release;
+            void* release_data;
+        } external;
     } data;
 } EJSArrayBuffer;
 
@@ -163,6 +174,13 @@ extern EJSSpecOps _ejs_DataView_specops;
 
 void _ejs_typedarrays_init(ejsval global);
 
+ejsval _ejs_arraybuffer_new (int size);
+ejsval _ejs_arraybuffer_new_slice (ejsval bufferval, int offset, int size);
+// wraps memory owned elsewhere (a file mapping, a native library's buffer) without copying.
+// @release (if non-NULL) is called when the buffer is collected, and @size is reported to the
+// GC as external memory for the lifetime of the buffer.
+ejsval _ejs_arraybuffer_new_external (void* data, int size, EJSArrayBufferReleaseFunc release, void* release_data);
+
 void* _ejs_arraybuffer_get_data(EJSObject* arr);
 void* _ejs_typedarray_get_data(EJSObject* arr);
 void* _ejs_dataview_get_data(EJSObject* view);
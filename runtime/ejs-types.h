@@ -107,6 +107,8 @@ extern jschar* ucs2_strdup (const jschar *str);
 extern int32_t ucs2_strcmp (const jschar *s1, const jschar *s2);
 extern int32_t ucs2_strlen (const jschar *str);
 extern jschar* ucs2_strstr (const jschar *haystack, const jschar *needle);
+extern const jschar* ucs2_memchr (const jschar *haystack, int haystack_len, jschar c);
+extern const jschar* ucs2_memmem (const jschar *haystack, int haystack_len, const jschar *needle, int needle_len);
 extern char* ucs2_to_utf8 (const jschar *str);
 extern char* ucs2_to_utf8_buf (const jschar *str, char* buf, size_t buf_size);
 extern uint32_t ucs2_hash (const jschar *str, int hash, int length);
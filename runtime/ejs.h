@@ -53,11 +53,13 @@ typedef int32_t EJSBool;
 
 #define EJS_NOT_IMPLEMENTED() EJS_MACRO_START                           \
     _ejs_log ("%s:%s:%d not implemented.\n", __PRETTY_FUNCTION__, __FILE__, __LINE__); \
+    _ejs_log_flush ();                                                  \
     abort();                                                            \
     EJS_MACRO_END
 
 #define EJS_NOT_REACHED() EJS_MACRO_START                               \
     _ejs_log ("%s:%s:%d should not be reached.\n", __PRETTY_FUNCTION__, __FILE__, __LINE__); \
+    _ejs_log_flush ();                                                  \
     abort();                                                            \
     EJS_MACRO_END
 
@@ -68,6 +70,7 @@ typedef int32_t EJSBool;
 #define EJS_ASSERT_MSG(assertion,msg) EJS_MACRO_START                   \
     if (!(assertion)) {                                                 \
         _ejs_log ("%s:%s:%d assertion failed `%s'.\n", __PRETTY_FUNCTION__, __FILE__, __LINE__, (msg)); \
+        _ejs_log_flush ();                                              \
         abort();                                                        \
     }                                                                   \
     EJS_MACRO_END
@@ -0,0 +1,64 @@
+function sum() {
+    let t = 0;
+    for (let i = 0; i < arguments.length; i++) t += arguments[i];
+    return t;
+}
+
+function get(k) {
+    return arguments[k];
+}
+
+function len() {
+    return arguments["length"];
+}
+
+function forward() {
+    return sum.apply(this, arguments);
+}
+
+function forwardRest(a, b, ...rest) {
+    return sum(a, 100, ...rest);
+}
+
+function list() {
+    let s = "";
+    for (let i = 0; i < arguments.length; i++) s += "<" + arguments[i] + ">";
+    return s;
+}
+
+function forwardPrefix(...r) {
+    return list(1, 2, 3, 4, 5, ...r);
+}
+
+function escapes() {
+    return arguments;
+}
+
+let o = {
+    base: 10,
+    m(...r) {
+        return this.n(...r);
+    },
+    n(x, y) {
+        return this.base + x + y;
+    },
+};
+
+function withApply() {
+    return sum.apply(null, arguments);
+}
+let applied = { apply: function (recv, args) { return "own apply " + args.length; } };
+function customApply() {
+    return applied.apply(null, arguments);
+}
+
+console.log(sum(), sum(1), sum(1, 2, 3, 4));
+console.log(get(0, "a"), get(1, "b"), get(5), get(1.5, "x"), get(-1, "y"), get("length"));
+console.log(len(1, 2, 3), len());
+console.log(forward(1, 2, 3), forward());
+console.log(forwardRest(1, 2, 3, 4), forwardRest(1), forwardRest());
+console.log(forwardPrefix(), forwardPrefix("a", "b"));
+let e = escapes(1, 2, 3);
+console.log(e.length, e[0], e[2]);
+console.log(o.m(1, 2));
+console.log(withApply(5, 6), customApply(1, 2, 3));
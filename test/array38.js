@@ -0,0 +1,53 @@
+// sparse arrays: stores far apart stay sparse, nearby stores coalesce
+var a = new Array(100000);
+a[5] = "five";
+a[99999] = "last";
+a[6] = "six";
+a[50000] = "middle";
+console.log(a.length);
+console.log(a[5], a[6], a[7], a[50000], a[99999]);
+console.log(5 in a, 7 in a);
+a.forEach(function (v, i) { console.log(i, v); });
+console.log(a.join("").length);
+console.log(a.map(function (v) { return v.toUpperCase(); })[50000]);
+delete a[50000];
+console.log(a[50000], 50000 in a);
+a.length = 10;
+console.log(a.length, a.join("-"));
+
+// a store far past the end of a dense array switches it to sparse
+var b = [1, 2, 3];
+b[1000000] = 4;
+console.log(b.length, b[2], b[999999], b[1000000]);
+console.log(b);
+console.log([1, , 3]);
+
+// and still works everywhere a dense array did
+var c = [1];
+c[60000] = 2;
+console.log(Reflect.apply(function () { return arguments.length + " " + arguments[60000]; }, null, c));
+console.log(new Uint8Array(b)[2], new Uint8Array(b)[1000000], new Uint8Array(b)[500]);
+
+// sorting a sparse array packs the present elements at the front, undefineds last
+var d = [];
+d[60000] = 3;
+d[10] = 1;
+d[30000] = undefined;
+d[40000] = 2;
+d.sort();
+console.log(d.length, d[0], d[1], d[2], d[3], 3 in d, 4 in d, 60000 in d);
+var e = [];
+e[70000] = "b";
+e[5] = "a";
+e[6] = "c";
+e.sort(function (x, y) { return x < y ? 1 : x > y ? -1 : 0; });
+console.log(e.length, e.slice(0, 4), 70000 in e);
+
+// holes at either end of a dense array don't end up inside its arraylets
+var f = [, , 1, , 2, , , ];
+f[100000] = 3;
+delete f[4];
+delete f[2];
+f[1] = "x";
+console.log(f.length, 0 in f, 1 in f, 2 in f, f[1], f[100000]);
+f.forEach(function (v, i) { console.log(i, v); });
@@ -0,0 +1,29 @@
+// dense fast paths in the Array.prototype builtins have to notice when
+// the array or its prototype chain changes underneath them
+var a = [1, 2, 3, 4];
+a.forEach(function (v, i) {
+    console.log(i, v);
+    if (i == 1) a.length = 3;
+});
+
+var b = [1, , 3];
+console.log(b.map(function (v) { return v * 2; }).join());
+Array.prototype[1] = "proto";
+console.log(b.join("-"), b.indexOf("proto"));
+b.forEach(function (v, i) { console.log(i, v); });
+delete Array.prototype[1];
+
+var c = [1, 2, 3];
+console.log(c.filter(function (v, i) {
+    if (i == 0) Object.prototype[3] = 4;
+    return true;
+}).length);
+delete Object.prototype[3];
+
+console.log([1, 2, 3, 4].reduce(function (acc, v) { return acc + v; }));
+console.log([1, 2, 3].every(function (v) { return v > 0; }), [1, 2, 3].some(function (v) { return v > 2; }));
+console.log([1, , 3].reverse().length, [1, 2, 3, 4, 5].reverse().join());
+
+var d = [1, 2, 3, 4, 5];
+console.log(d.splice(1, 2, "a", "b", "c").join(), d.join());
+console.log(d.shift(), d.unshift(0), d.join());
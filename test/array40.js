@@ -0,0 +1,24 @@
+// arrays used as queues: shift/unshift interleaved with push/pop
+var q = [];
+for (var i = 0; i < 100; i ++)
+    q.push(i);
+
+var sum = 0;
+while (q.length > 10) {
+    sum += q.shift();
+    if (sum % 7 == 0)
+        q.push(sum);
+}
+console.log(sum, q.length, q.join());
+
+for (var i = 0; i < 40; i ++)
+    q.unshift(i * 2);
+console.log(q.length, q[0], q[39], q[40]);
+
+for (var i = 0; i < 45; i ++)
+    q.shift();
+console.log(q.length, q.join());
+
+q.unshift("a", "b");
+q.push("z");
+console.log(q.length, q.join(), q.indexOf("z"));
@@ -0,0 +1,34 @@
+// constant array literals share their storage until they're written to,
+// so writes must never leak between arrays created by the same literal
+function table() {
+    return [1, 2, 3, 4, -5, 6.5, true, null];
+}
+
+for (var i = 0; i < 3; i ++) {
+    var t = table();
+    console.log(t.join());
+    t[i] = "x";
+    t.push(i);
+    console.log(t.join());
+}
+
+var a = table();
+a.pop();
+a.push("after-pop");
+console.log(a.join(), table().join());
+
+var b = table();
+b.shift();
+b.unshift("front");
+console.log(b.join(), table().join());
+
+var c = table();
+c.length = 2;
+c.length = 4;
+console.log(c.join(), table().join());
+
+console.log(table().reverse().join(), table().sort().join(), table().join());
+var d = table();
+console.log(d.splice(1, 2).join(), d.join(), table().join());
+delete d[0];
+console.log(d.join(), table().join());
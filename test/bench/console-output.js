@@ -0,0 +1,57 @@
+// Logging throughput.
+//
+//   console-output [count [path]] > /dev/null
+//
+// Times @count (default 1e6) console.log calls, the same lines through
+// process.stdout.write, and through a stream from fs.createWriteStream
+// on @path.  Results go to stderr, so redirect stdout somewhere that
+// isn't a terminal (a terminal gets a write per line).
+//
+// With EJS_OUTPUT_ASYNC set, writes happen on a background thread, and
+// the file stream test waits for ondrain whenever write() returns false.
+
+import * as fs from "@node-compat/fs";
+
+var N = process.argv.length > 2 ? Number(process.argv[2]) : 1000000;
+var path = process.argv.length > 3 ? process.argv[3] : "/tmp/console-output-bench.log";
+
+function time(fn) {
+    var start = Date.now();
+    fn();
+    return Date.now() - start;
+}
+
+console.error("console.log\t" + time(function () {
+    for (var i = 0; i < N; i ++)
+        console.log("request", i, "handled in", i % 17, "ms");
+}));
+
+console.error("console.log (rope)\t" + time(function () {
+    for (var i = 0; i < N; i ++)
+        console.log("[" + i + "] " + "request handled in " + (i % 17) + "ms");
+}));
+
+console.error("stdout.write\t" + time(function () {
+    for (var i = 0; i < N; i ++)
+        process.stdout.write("request " + i + " handled\n");
+}));
+
+var out = fs.createWriteStream(path);
+var start = Date.now();
+var i = 0;
+var waits = 0;
+function writeSome() {
+    while (i < N) {
+        var more = out.write("request " + i + " handled\n");
+        i ++;
+        if (!more) {
+            waits ++;
+            return;
+        }
+    }
+    out.end();
+    console.error("file stream\t" + (Date.now() - start) + "\t" + waits + " waits for ondrain");
+    fs.unlinkSync(path);
+}
+out.ondrain = writeSome;
+writeSome();
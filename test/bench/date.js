@@ -0,0 +1,69 @@
+// Date construction, field access, and formatting.
+//
+//   date [count]
+//
+// Times each operation over @count (default 1e6) time values spread
+// across 1900-2100, so the local time zone lookups see both sides of
+// plenty of DST transitions.  Run it with TZ set to a zone with DST
+// (America/Los_Angeles, say) to include the cost of those lookups.
+
+var N = process.argv.length > 2 ? Number(process.argv[2]) : 1000000;
+
+function time(fn) {
+    var start = Date.now();
+    fn();
+    return Date.now() - start;
+}
+
+var seed = 12345;
+function next() {
+    seed = (seed * 1103515245 + 12345) % 2147483648;
+    return seed;
+}
+
+var START = Date.UTC(1900, 0, 1);
+var SPAN = Date.UTC(2100, 0, 1) - START;
+
+var times = [];
+for (var i = 0; i < N; i ++)
+    times.push(START + Math.floor(next() / 2147483648 * SPAN));
+// a run of increasing times, like log timestamps
+var sequential = [];
+for (var i = 0; i < N; i ++)
+    sequential.push(Date.UTC(2012, 0, 1) + i * 1000);
+
+var dates = times.map(function (t) { return new Date(t); });
+var isoStrings = dates.map(function (d) { return d.toISOString(); });
+
+var roundTrip = 0;
+for (var i = 0; i < N; i ++) {
+    if (Date.parse(isoStrings[i]) === times[i])
+        roundTrip ++;
+}
+console.log("ISO round trips\t" + roundTrip + "/" + N);
+
+var benchmarks = {
+    "Date.now":           function () { for (var i = 0; i < N; i ++) Date.now(); },
+    "new Date()":         function () { for (var i = 0; i < N; i ++) new Date(); },
+    "new Date(t)":        function () { for (var i = 0; i < N; i ++) new Date(times[i]); },
+    "new Date(y, m, d)":  function () { for (var i = 0; i < N; i ++) new Date(2000 + i % 100, i % 12, i % 28 + 1); },
+    "getUTCFullYear":     function () { for (var i = 0; i < N; i ++) dates[i].getUTCFullYear(); },
+    "getFullYear":        function () { for (var i = 0; i < N; i ++) dates[i].getFullYear(); },
+    "getHours sequential": function () { for (var i = 0; i < N; i ++) new Date(sequential[i]).getHours(); },
+    "getTimezoneOffset":  function () { for (var i = 0; i < N; i ++) dates[i].getTimezoneOffset(); },
+    "toISOString":        function () { for (var i = 0; i < N; i ++) dates[i].toISOString(); },
+    "toString":           function () { for (var i = 0; i < N; i ++) dates[i].toString(); },
+    "Date.parse(ISO)":    function () { for (var i = 0; i < N; i ++) Date.parse(isoStrings[i]); },
+    "JSON.stringify":     function () { JSON.stringify(dates); }
+};
+
+for (var name in benchmarks) {
+    var ms;
+    try {
+        ms = time(benchmarks[name]);
+    }
+    catch (e) {
+        ms = "threw " + e;
+    }
+    console.log(name + "\t" + ms);
+}
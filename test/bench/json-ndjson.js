@@ -0,0 +1,96 @@
+// Streaming JSON over a large newline delimited JSON file.
+//
+//   json-ndjson [megabytes [path]]
+//
+// Writes about @megabytes (default 1024) of records to @path with
+// __ejs.JSONWriter on top of fs.createWriteStream, then reads them back
+// with __ejs.JSONParser, feeding it fs.mmapSync windows of the file.
+// Neither side ever holds more than a window (or a flush buffer) of
+// the text, so memory stays flat however big the file is.
+//
+// For files up to 256MB the whole-document approach (readFileSync,
+// split, JSON.parse each line) is timed as well.  Past that it needs
+// more memory than is reasonable for a benchmark.
+
+import * as fs from "@node-compat/fs";
+
+var MB = 1024 * 1024;
+var WINDOW = 8 * MB;
+var WHOLE_DOCUMENT_LIMIT = 256 * MB;
+
+var megabytes = process.argv.length > 2 ? Number(process.argv[2]) : 1024;
+var path = process.argv.length > 3 ? process.argv[3] : "/tmp/json-ndjson-bench.json";
+
+function time(fn) {
+    var start = Date.now();
+    fn();
+    return Date.now() - start;
+}
+
+function makeRecord(i) {
+    return {
+        id: i,
+        name: "record" + i,
+        score: i * 0.25,
+        active: (i & 1) == 0,
+        tags: ["alpha", "beta", "gamma"],
+        nested: { x: i, y: -i, label: "café €" }
+    };
+}
+
+var written = 0;
+var bytes = 0;
+var writeMs = time(function () {
+    var record_size = JSON.stringify(makeRecord(0)).length + 1;
+    var out = fs.createWriteStream(path);
+    var writer = new __ejs.JSONWriter(out);
+    while (bytes < megabytes * MB) {
+        writer.write(makeRecord(written));
+        written ++;
+        bytes += record_size;
+    }
+    writer.end();
+    out.end();
+});
+
+var parsed = 0;
+var checksum = 0;
+var streamMs = time(function () {
+    var parser = new __ejs.JSONParser();
+    var offset = 0;
+    for (;;) {
+        var window = fs.mmapSync(path, offset, WINDOW);
+        if (window.byteLength == 0)
+            break;
+        offset += window.byteLength;
+        var values = parser.write(window);
+        for (var i = 0; i < values.length; i ++)
+            checksum += values[i].id;
+        parsed += values.length;
+    }
+    parser.end();
+});
+
+console.log("records\t" + written);
+console.log("write (ms)\t" + writeMs);
+console.log("stream parse (ms)\t" + streamMs + "\t" + (parsed == written ? "ok" : "MISMATCH " + parsed));
+
+if (megabytes * MB <= WHOLE_DOCUMENT_LIMIT) {
+    var wholeParsed = 0;
+    var wholeChecksum = 0;
+    var wholeMs = time(function () {
+        var lines = fs.readFileSync(path).split("\n");
+        for (var i = 0; i < lines.length; i ++) {
+            if (lines[i].length == 0)
+                continue;
+            wholeChecksum += JSON.parse(lines[i]).id;
+            wholeParsed ++;
+        }
+    });
+    console.log("whole document parse (ms)\t" + wholeMs + "\t" + (wholeChecksum == checksum && wholeParsed == parsed ? "ok" : "MISMATCH"));
+}
+else {
+    console.log("whole document parse (ms)\tskipped, file is over " + (WHOLE_DOCUMENT_LIMIT / MB) + "MB");
+}
+
+fs.unlinkSync(path);
@@ -0,0 +1,116 @@
+// Number <-> string conversions.
+//
+//   number-conversion [count [baseline]]
+//
+// First checks that @count (default 1e6) doubles spread over the whole
+// exponent range survive String -> Number, and that a few known tricky
+// values format the way the spec says.  Then times each conversion on
+// the same values.
+//
+// Run it against runtimes built before and after a change to the
+// conversion code to compare them.  Runtimes from before double-conversion
+// was used everywhere abort in toFixed/toPrecision and don't have
+// toExponential, so pass "baseline" to leave those out.
+
+var N = process.argv.length > 2 ? Number(process.argv[2]) : 1000000;
+var baseline = process.argv.length > 3 && process.argv[3] == "baseline";
+var FORMATTING = ["toFixed(2)", "toPrecision(6)", "toExponential()"];
+
+function time(fn) {
+    var start = Date.now();
+    fn();
+    return Date.now() - start;
+}
+
+// a deterministic spread of doubles: small integers, int32s, and
+// fractions scaled from 1e-300 to 1e300
+var seed = 12345;
+function next() {
+    seed = (seed * 1103515245 + 12345) % 2147483648;
+    return seed;
+}
+
+var ints = [];
+var doubles = [];
+for (var i = 0; i < N; i ++) {
+    ints.push(next() % 100000 - 50000);
+    var d = next() / 2147483648 + next() / 4611686018427387904;
+    doubles.push((i & 1 ? -d : d) * Math.pow(10, next() % 600 - 300));
+}
+
+var known = [
+    [function () { return String(0.1 + 0.2); }, "0.30000000000000004"],
+    [function () { return String(5e-324); }, "5e-324"],
+    [function () { return String(1.7976931348623157e308); }, "1.7976931348623157e+308"],
+    [function () { return String(123e-20); }, "1.23e-18"],
+    [function () { return (1.005).toFixed(2); }, "1.00", FORMATTING],
+    [function () { return (1e21).toFixed(2); }, "1e+21", FORMATTING],
+    [function () { return (0.000001234).toPrecision(2); }, "0.0000012", FORMATTING],
+    [function () { return (123.456).toExponential(); }, "1.23456e+2", FORMATTING],
+    [function () { return (0.1).toString(3); }, "0.0022002200220022002200220022002201"],
+    [function () { return (-255.75).toString(16); }, "-ff.c"],
+    [function () { return String(Number("9007199254740993")); }, "9007199254740992"],
+    [function () { return String(parseInt("0xFFFFFFFFFFFFFFFFF")); }, "295147905179352830000"],
+    [function () { return String(Number(" 0b1010 ")); }, "10"]
+];
+
+var failures = 0;
+var checked = 0;
+for (var i = 0; i < known.length; i ++) {
+    if (baseline && known[i][2] === FORMATTING)
+        continue;
+    checked ++;
+    var got;
+    try {
+        got = known[i][0]();
+    }
+    catch (e) {
+        got = "threw " + e;
+    }
+    if (got !== known[i][1]) {
+        console.log("wrong\t" + known[i][0] + "\t" + got + "\t(expected " + known[i][1] + ")");
+        failures ++;
+    }
+}
+
+var roundTrip = 0;
+for (var i = 0; i < N; i ++) {
+    if (Number(String(doubles[i])) === doubles[i])
+        roundTrip ++;
+}
+console.log("known values\t" + (checked - failures) + "/" + checked);
+console.log("round trips\t" + roundTrip + "/" + N);
+
+var strings = doubles.map(function (d) { return String(d); });
+var intStrings = ints.map(function (d) { return String(d); });
+
+var benchmarks = {
+    "String(int)":        function () { for (var i = 0; i < N; i ++) String(ints[i]); },
+    "String(double)":     function () { for (var i = 0; i < N; i ++) String(doubles[i]); },
+    "concat":             function () { for (var i = 0; i < N; i ++) "v=" + doubles[i]; },
+    "toFixed(2)":         function () { for (var i = 0; i < N; i ++) (ints[i] / 7).toFixed(2); },
+    "toPrecision(6)":     function () { for (var i = 0; i < N; i ++) doubles[i].toPrecision(6); },
+    "toExponential()":    function () { for (var i = 0; i < N; i ++) doubles[i].toExponential(); },
+    "toString(16)":       function () { for (var i = 0; i < N; i ++) doubles[i].toString(16); },
+    "Number(int string)": function () { for (var i = 0; i < N; i ++) Number(intStrings[i]); },
+    "Number(string)":     function () { for (var i = 0; i < N; i ++) Number(strings[i]); },
+    "parseInt":           function () { for (var i = 0; i < N; i ++) parseInt(intStrings[i]); },
+    "parseFloat":         function () { for (var i = 0; i < N; i ++) parseFloat(strings[i]); },
+    "array[string]":      function () { var a = [1, 2, 3]; for (var i = 0; i < N; i ++) a["1"]; },
+    "JSON.stringify":     function () { JSON.stringify(doubles); }
+};
+
+for (var name in benchmarks) {
+    if (baseline && FORMATTING.indexOf(name) != -1) {
+        console.log(name + "\tskipped");
+        continue;
+    }
+    var ms;
+    try {
+        ms = time(benchmarks[name]);
+    }
+    catch (e) {
+        ms = "threw " + e;
+    }
+    console.log(name + "\t" + ms);
+}
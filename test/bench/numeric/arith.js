@@ -0,0 +1,29 @@
+// Floating point arithmetic in a tight loop.  Every operator here is
+// open-coded by the compiler when both operands are numbers, so the loop
+// body makes no runtime calls.
+
+var N = 10000000;
+
+function time(name, fn) {
+    var start = Date.now();
+    var rv = fn();
+    console.log(name + ": " + (Date.now() - start) + "ms (" + rv + ")");
+}
+
+time("add/sub", function() {
+    var a = 0;
+    for (var i = 0; i < N; i++) a = a + i - 0.5;
+    return a;
+});
+
+time("mul/div", function() {
+    var a = 1;
+    for (var i = 1; i < N; i++) a = a * 1.0000001 / 1.00000005;
+    return a;
+});
+
+time("mod", function() {
+    var a = 0;
+    for (var i = 0; i < N; i++) a += i % 7;
+    return a;
+});
@@ -0,0 +1,29 @@
+// Int32 bitwise operators.  The fast path converts both operands with
+// ToInt32 inline and only calls into the runtime for non-numbers or
+// values that don't fit in an int64.
+
+var N = 10000000;
+
+function time(name, fn) {
+    var start = Date.now();
+    var rv = fn();
+    console.log(name + ": " + (Date.now() - start) + "ms (" + rv + ")");
+}
+
+time("and/or/xor", function() {
+    var h = 0;
+    for (var i = 0; i < N; i++) h = (h ^ i) & 0xffff | 1;
+    return h;
+});
+
+time("shifts", function() {
+    var h = 0;
+    for (var i = 0; i < N; i++) h = ((h << 5) - h + i) >>> 0;
+    return h;
+});
+
+time("sar", function() {
+    var s = 0;
+    for (var i = 0; i < N; i++) s += i >> 3;
+    return s;
+});
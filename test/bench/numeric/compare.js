@@ -0,0 +1,35 @@
+// Comparisons and ++/-- on numbers, the shape of nearly every counted
+// loop.  Compare against the same loops run with a string operand mixed
+// in, which forces every operation down the runtime slow path.
+
+var N = 10000000;
+
+function time(name, fn) {
+    var start = Date.now();
+    var rv = fn();
+    console.log(name + ": " + (Date.now() - start) + "ms (" + rv + ")");
+}
+
+time("count up", function() {
+    var c = 0;
+    for (var i = 0; i < N; i++) if (i <= c) c++;
+    return c;
+});
+
+time("count down", function() {
+    var c = 0;
+    for (var i = N; i > 0; i--) if (i % 2 === 0) c++; else if (i !== c) c--;
+    return c;
+});
+
+time("equality", function() {
+    var c = 0;
+    for (var i = 0; i < N; i++) if (i == (c & 0xff)) c++; else if (i != c) c += 2;
+    return c;
+});
+
+time("count up (slow path)", function() {
+    var c = 0, limit = "" + N;
+    for (var i = 0; i < limit; i++) c++;
+    return c;
+});
@@ -0,0 +1,59 @@
+// RegExp heavy text processing: replace, split and match over a log
+// sized piece of text, one line at a time.
+//
+// The literal variants compile their pattern once per literal site,
+// the constructed variants go through the runtime's pattern cache, so
+// neither should be paying for pcre16_compile (or the JIT) per line.
+
+var LINES = 200000;
+
+function makeLines() {
+    var lines = [];
+    for (var i = 0; i < LINES; i ++)
+        lines.push("2015-06-" + (10 + i % 20) + " GET /api/v1/items/" + i + "?q=Foo%20Bar HTTP/1.1 200 " + (i * 37 % 5000));
+    return lines;
+}
+
+function time(fn) {
+    var start = Date.now();
+    fn();
+    return Date.now() - start;
+}
+
+var lines = makeLines();
+
+var benchmarks = {
+    "replace literal": function () {
+        for (var i = 0; i < lines.length; i ++)
+            lines[i].replace(/%20/g, " ");
+    },
+    "replace constructed": function () {
+        for (var i = 0; i < lines.length; i ++)
+            lines[i].replace(new RegExp("%20", "g"), " ");
+    },
+    "split literal": function () {
+        for (var i = 0; i < lines.length; i ++)
+            lines[i].split(/ +/);
+    },
+    "split constructed": function () {
+        for (var i = 0; i < lines.length; i ++)
+            lines[i].split(new RegExp(" +"));
+    },
+    "match literal": function () {
+        for (var i = 0; i < lines.length; i ++)
+            lines[i].match(/items\/(\d+)/);
+    },
+    "match constructed": function () {
+        for (var i = 0; i < lines.length; i ++)
+            lines[i].match(new RegExp("items/(\\d+)"));
+    },
+    "test literal": function () {
+        var n = 0;
+        for (var i = 0; i < lines.length; i ++)
+            if (/HTTP\/1\.[01] [45]\d\d/.test(lines[i])) n++;
+    }
+};
+
+console.log("benchmark\tms");
+for (var name in benchmarks)
+    console.log(name + "\t" + time(benchmarks[name]));
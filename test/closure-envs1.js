@@ -0,0 +1,81 @@
+// environments whose closures never escape are allocated on the stack.
+// check both those and the ones that have to stay on the heap.
+
+function sum(a) {
+  let t = 0;
+  function add(x) { t += x; }
+  add(a);
+  add(2);
+  function twice() {
+    function get() { return t + a; }
+    return get() * 2;
+  }
+  return twice();
+}
+console.log(sum(1), sum(10));
+
+// keep objects alive only through a stack environment while
+// allocating enough to trigger collections.
+function churn(n) {
+  let keep = { label: "kept", values: [] };
+  function push(v) { keep.values.push({ v: v }); }
+  for (let i = 0; i < n; i++) {
+    push(i);
+    let garbage = [];
+    for (let j = 0; j < 20; j++) garbage.push({ j: j, s: "x" + j });
+  }
+  let total = 0;
+  for (let i = 0; i < keep.values.length; i++) total += keep.values[i].v;
+  return keep.label + " " + keep.values.length + " " + total;
+}
+console.log(churn(5000));
+
+console.log((function (x) { let y = x * 2; return (function () { return y + 1; })(); })(20));
+
+// these escape and stay on the heap
+function makeCounter() {
+  let n = 0;
+  function inc() { return ++n; }
+  return inc;
+}
+let c = makeCounter();
+c();
+c();
+console.log(c());
+
+function callbacks(arr) {
+  let seen = 0;
+  arr.forEach(function (v) { seen += v; });
+  return seen;
+}
+console.log(callbacks([1, 2, 3, 4]));
+
+function loops() {
+  let fs = [];
+  for (let i = 0; i < 3; i++) fs.push(() => i);
+  return fs.map((f) => f()).join(",");
+}
+console.log(loops());
+
+function recursive(n) {
+  function fact(k) { return k <= 1 ? 1 : k * fact(k - 1); }
+  return fact(n);
+}
+console.log(recursive(6));
+
+// a closure whose value is used by the assignment around it is still
+// needed, even though nothing ever calls it through its own local
+function assignedTwice() {
+  let f;
+  let g = (f = function () { return "g"; });
+  return typeof g + " " + g();
+}
+console.log(assignedTwice());
+
+// with more than one definition the call can't go straight to either
+function redefined(which) {
+  let h = function () { return "first"; };
+  if (which) h = function () { return "second"; };
+  return h();
+}
+console.log(redefined(false), redefined(true));
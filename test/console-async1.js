@@ -0,0 +1,81 @@
+// generator: none
+// env: EJS_OUTPUT_ASYNC=1
+// output written from the background thread: a file stream has to push
+// back once enough is waiting, call ondrain once it's gone, and have
+// everything on disk after end().  stdout has to stay in call order.
+
+import * as fs from "@node-compat/fs";
+
+var path = "console-async1.tmp";
+var N = 200000;
+
+var out = fs.createWriteStream(path);
+var i = 0;
+var pushedBack = false;
+var drained = false;
+var maxPending = 0;
+
+function writeSome() {
+    while (i < N) {
+        var more = out.write("line " + i + "\n");
+        i ++;
+        if (out.writableLength > maxPending)
+            maxPending = out.writableLength;
+        if (!more) {
+            pushedBack = true;
+            return;
+        }
+    }
+    out.end();
+    check();
+}
+
+function check() {
+    var lines = fs.readFileSync(path).split("\n");
+    fs.unlinkSync(path);
+
+    var inOrder = lines.length == N + 1 && lines[N] === "";
+    for (var j = 0; inOrder && j < N; j ++)
+        inOrder = lines[j] === "line " + j;
+
+    console.log("pushed back", pushedBack, "drained", drained, "pending over high water", maxPending >= 1024 * 1024);
+    console.log("file lines", lines.length - 1, "in order", inOrder);
+
+    // switching to stderr and back flushes stdout each time, so each of
+    // these lines is its own background write
+    for (var k = 0; k < 20; k ++) {
+        if (k % 5 == 0)
+            process.stdout.write("write " + k + "\n");
+        console.log("log", k);
+        console.error("error", k);
+    }
+    // and these go out when the flush timer fires
+    setTimeout(function () {
+        console.log("after timeout");
+        setTimeout(function () {
+            console.log("after another");
+            fillStderr();
+        }, 5);
+    }, 5);
+}
+
+// the same push back on stderr, except console.log flushes it right after,
+// so the write is finished by the time the background thread reports back.
+// ondrain still has to come.
+function fillStderr() {
+    var chunk = new Array(4097).join("e");
+    var more = true;
+    for (var n = 0; more && n < 10000; n ++)
+        more = process.stderr.write(chunk);
+    process.stderr.ondrain = function () {
+        process.stderr.ondrain = undefined;
+        console.log("stderr drained");
+    };
+    console.log("stderr pushed back", !more);
+}
+
+out.ondrain = function () {
+    drained = true;
+    writeSome();
+};
+writeSome();
@@ -0,0 +1,43 @@
+// generator: none
+// console.log and process.stdout.write share one buffer for stdout, so
+// they have to come out in the order they were called, however the
+// strings were built
+
+import * as fs from "@node-compat/fs";
+
+var s = "";
+for (var i = 0; i < 20; i ++)
+    s = s + i + ",";
+console.log(s);
+console.log(s.substring(3, 20), s.slice(-6));
+
+for (var i = 0; i < 10; i ++) {
+    if (i % 5 == 0) {
+        process.stdout.write("write " + i + ": ");
+        process.stdout.write(String(process.stdout.write("")) + "\n");
+    }
+    console.log("line", i, "é€😀");
+}
+
+// unpaired surrogates come out as U+FFFD
+console.log("a\uD800b", "\uDC00", "\uD83D" + "\uDE00");
+
+console.log(typeof process.stdout.writableLength);
+
+// enough lines through a file stream to cross plenty of chunk and
+// flush boundaries, checked after reading them back
+var path = "console-buffered1.tmp";
+var out = fs.createWriteStream(path);
+var N = 5000;
+for (var i = 0; i < N; i ++)
+    out.write("line " + i + " é€😀\n");
+out.end();
+
+var lines = fs.readFileSync(path, "utf8").split("\n");
+fs.unlinkSync(path);
+var matching = 0;
+for (var i = 0; i < N; i ++) {
+    if (lines[i] === "line " + i + " é€😀")
+        matching ++;
+}
+console.log("read back", lines.length - 1, "lines,", matching, "matching");
@@ -0,0 +1,55 @@
+// time values, UTC fields, and the ISO format, none of which depend on
+// the local time zone
+
+var d = new Date(Date.UTC(2012, 7, 28, 23, 45, 58, 123));
+console.log(d.getTime());
+console.log(d.toISOString());
+console.log(JSON.stringify({ when: d }));
+console.log(d.toUTCString());
+console.log(d.getUTCFullYear(), d.getUTCMonth(), d.getUTCDate(), d.getUTCDay());
+console.log(d.getUTCHours(), d.getUTCMinutes(), d.getUTCSeconds(), d.getUTCMilliseconds());
+
+// days before the epoch, leap years, and years 0-99
+console.log(Date.UTC(1969, 11, 31, 23, 59, 59, 999));
+console.log(Date.UTC(2000, 1, 29));
+console.log(Date.UTC(2100, 2, 1) - Date.UTC(2100, 1, 28));
+console.log(Date.UTC(99, 0, 1) == Date.UTC(1999, 0, 1));
+console.log(Date.UTC(2012, 13, 1) == Date.UTC(2013, 1, 1));
+console.log(new Date(-1).toISOString());
+console.log(new Date(-62198755200000).toISOString());
+console.log(new Date(8.64e15).toISOString());
+console.log(new Date(8.64e15 + 1).getTime());
+
+[
+    "2012-08-28T23:45:58.123Z",
+    "2012-08-28T23:45:58+05:30",
+    "2012-08-28T24:00Z",
+    "2000-02-29",
+    "2012-08",
+    "2012",
+    "+002012-08-28T00:00:00.000Z",
+    "-000001-01-01T00:00:00Z",
+    "Tue, 28 Aug 2012 23:45:58 GMT",
+    "Tue Aug 28 2012 16:45:58 GMT-0700 (PDT)",
+    "2012-13-01",
+    "2012-08-28T23:60Z",
+    "not a date"
+].forEach(function (s) {
+    console.log(JSON.stringify(s), Date.parse(s));
+});
+
+var copy = new Date(d);
+copy.setTime(0);
+console.log(copy.getTime(), d.getTime());
+console.log(new Date("2012-08-28T23:45:58.123Z").valueOf() == d.valueOf());
+console.log(d - new Date(Date.UTC(2012, 7, 28)));
+
+var invalid = new Date(NaN);
+console.log(invalid.getTime(), invalid.getUTCFullYear(), invalid.toUTCString());
+console.log(JSON.stringify(invalid));
+try {
+    invalid.toISOString();
+}
+catch (e) {
+    console.log(e instanceof RangeError);
+}
@@ -0,0 +1,67 @@
+// calls through bindings that always hold the same function are made
+// directly.  make sure the guarded and unguarded cases still behave.
+
+function square(x) { return x * x; }
+
+const add = (a, b) => a + b;
+
+function counter() {
+  let n = 0;
+  function bump(by) { n += by; return n; }
+  bump(1);
+  bump(2);
+  return bump(3);
+}
+
+function usesCaptured() {
+  // square is captured here, so it lives in an env slot
+  return square(4) + add(1, 1);
+}
+
+var reassigned = function () { return "first"; };
+let r1 = reassigned();
+reassigned = function () { return "second"; };
+let r2 = reassigned();
+
+let maybe = function () { return "maybe"; };
+if (r1 === "nope")
+  maybe = 5;
+
+console.log(square(3), add(2, 3), counter(), usesCaptured());
+console.log(r1, r2, maybe());
+console.log((function (a) { return a + 1; })(41));
+
+function withArgs() { return arguments.length; }
+console.log(withArgs(1, 2, 3), withArgs());
+
+class K { m() { return "m"; } }
+try {
+  K();
+} catch (e) {
+  console.log(e instanceof TypeError);
+}
+console.log(new K().m());
+
+// storing undefined (or void 0) over the closure has to make later
+// calls throw, not run the old function
+function cleared() {
+  let n = 1;
+  var f = function () { return n; };
+  f = undefined;
+  try {
+    f();
+    return "called";
+  } catch (e) {
+    return e instanceof TypeError;
+  }
+}
+function voided() {
+  var g = function () { return "called"; };
+  g = void 0;
+  try {
+    return g();
+  } catch (e) {
+    return e instanceof TypeError;
+  }
+}
+console.log(cleared(), voided());
@@ -0,0 +1,85 @@
+function parseDigit(c) {
+    try {
+        if (c < "0" || c > "9") throw "bad digit " + c;
+        return c.charCodeAt(0) - 48;
+    } catch (e) {
+        return e;
+    }
+}
+
+function nested(n) {
+    let log = "";
+    try {
+        try {
+            if (n > 0) throw n;
+            log += "no throw;";
+        } catch (e) {
+            log += "inner " + e + ";";
+            if (n > 1) throw e * 10;
+        }
+    } catch (e) {
+        log += "outer " + e + ";";
+    }
+    return log;
+}
+
+function withFinally(n) {
+    let log = "";
+    try {
+        if (n) throw new Error("oops");
+        log += "body;";
+    } catch (e) {
+        log += "caught " + e.message + ";";
+    } finally {
+        log += "finally;";
+    }
+    return log;
+}
+
+function thrower(v) {
+    throw v;
+}
+
+function mixed(n) {
+    try {
+        if (n === 0) throw "local";
+        thrower("remote");
+    } catch (e) {
+        return e;
+    }
+}
+
+function finallyOnly() {
+    let log = "";
+    try {
+        try {
+            throw "through finally";
+        } finally {
+            log += "finally;";
+        }
+    } catch (e) {
+        log += e;
+    }
+    return log;
+}
+
+function loop() {
+    let caught = 0;
+    for (let i = 0; i < 1000; i++) {
+        try {
+            if (i % 3 === 0) throw i;
+        } catch (e) {
+            caught++;
+        }
+    }
+    return caught;
+}
+
+console.log(parseDigit("7"), parseDigit("x"));
+console.log(nested(0), nested(1), nested(2));
+console.log(withFinally(false), withFinally(true));
+console.log(mixed(0), mixed(1));
+console.log(finallyOnly());
+console.log(loop());
+let err = new TypeError("message " + 42);
+console.log(err.message, err instanceof TypeError);
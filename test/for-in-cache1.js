@@ -0,0 +1,70 @@
+// for..in keys come from a per object cache that has to notice every
+// change to the object and its prototypes.
+
+function keys(o) {
+  let rv = [];
+  for (let k in o) rv.push(k);
+  return rv.join();
+}
+
+// arrays, with holes and extra properties
+let a = [1, , 3];
+a.extra = true;
+console.log(keys(a));
+a[1] = 2;
+console.log(keys(a));
+
+let big = [];
+big[100000] = 1;
+big[5] = 2;
+console.log(keys(big));
+
+// repeated enumeration sees additions, deletions and redefinitions
+let o = { x: 1, y: 2 };
+console.log(keys(o));
+console.log(keys(o));
+o.z = 3;
+console.log(keys(o));
+delete o.x;
+console.log(keys(o));
+Object.defineProperty(o, "y", { enumerable: false });
+console.log(keys(o));
+Object.defineProperty(o, "y", { enumerable: true });
+console.log(keys(o));
+
+// keys from the prototype chain, shadowing, and changes to the prototype
+function Point(x, y) { this.x = x; this.y = y; }
+Point.prototype.norm = function () { return 0; };
+let p = new Point(1, 2), q = new Point(3, 4);
+console.log(keys(p), keys(q));
+Point.prototype.scale = function () { return 0; };
+console.log(keys(p));
+p.norm = 5;
+console.log(keys(p));
+
+// symbols and non-enumerable properties are skipped
+let s = { a: 1 };
+s[Symbol("hidden")] = 2;
+Object.defineProperty(s, "b", { value: 3, enumerable: false });
+console.log(keys(s));
+
+// a key deleted before it's visited is skipped
+let d = { first: 1, second: 2, third: 3 };
+let seen = [];
+for (let k in d) {
+  if (k === "first") delete d.third;
+  seen.push(k);
+}
+console.log(seen.join());
+
+// elements removed from an array during the loop are skipped
+let arr = [1, 2, 3, 4];
+seen = [];
+for (let k in arr) {
+  if (k === "0") arr.length = 2;
+  seen.push(k);
+}
+console.log(seen.join());
+
+// primitives and null
+console.log([keys(null), keys(undefined), keys(5)].join("|"));
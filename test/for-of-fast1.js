@@ -0,0 +1,102 @@
+// for..of over the builtin iterables steps their iterators directly.
+// make sure the results still match what calling next() would give.
+
+let out = [];
+
+// arrays, including holes and elements added during iteration
+let a = [1, 2, , 4];
+for (let x of a) out.push(String(x));
+console.log(out.join());
+
+out = [];
+let grow = [1, 2, 3];
+for (let x of grow) {
+  if (x < 3) grow.push(x + 10);
+  out.push(x);
+}
+console.log(out.join());
+
+// strings, with a surrogate pair
+out = [];
+for (let c of "ab😀c") out.push(c.length);
+console.log(out.join());
+
+let s = "";
+for (let c of "hello") s = c + s;
+console.log(s);
+
+// Maps and Sets, deleting and adding during iteration
+let m = new Map([["a", 1], ["b", 2], ["c", 3]]);
+out = [];
+for (let e of m) {
+  let k = e[0], v = e[1];
+  if (k === "a") { m.delete("b"); m.set("d", 4); }
+  out.push(k + v);
+}
+console.log(out.join());
+
+out = [];
+for (let k of m.keys()) out.push(k);
+for (let v of m.values()) out.push(v);
+console.log(out.join());
+
+let set = new Set([1, 2, 3]);
+out = [];
+for (let x of set) {
+  if (x === 1) set.delete(1);
+  if (x === 2) set.add(5);
+  out.push(x);
+}
+console.log(out.join());
+
+// typed arrays
+out = [];
+for (let x of new Int16Array([3, -4, 5])) out.push(x);
+for (let x of new Float64Array([0.5, 1.5])) out.push(x);
+console.log(out.join());
+
+// assignment to an existing binding
+let last;
+for (last of [7, 8, 9]);
+console.log(last);
+
+// break and continue
+out = [];
+for (let x of [1, 2, 3, 4, 5, 6]) {
+  if (x % 2) continue;
+  if (x > 4) break;
+  out.push(x);
+}
+console.log(out.join());
+
+// a user defined iterator
+let countdown = {
+  [Symbol.iterator]() {
+    let n = 3;
+    return { next() { return n > 0 ? { value: n--, done: false } : { value: "ignored", done: true }; } };
+  },
+};
+out = [];
+for (let x of countdown) out.push(x);
+console.log(out.join());
+
+// replacing the builtin next has to be respected
+let ArrayIteratorPrototype = Object.getPrototypeOf([][Symbol.iterator]());
+let builtin_next = ArrayIteratorPrototype.next;
+ArrayIteratorPrototype.next = function () {
+  let r = builtin_next.call(this);
+  if (!r.done) r.value = r.value * 100;
+  return r;
+};
+out = [];
+for (let x of [1, 2]) out.push(x);
+ArrayIteratorPrototype.next = builtin_next;
+for (let x of [1, 2]) out.push(x);
+console.log(out.join());
+
+// a next that doesn't return an object throws
+try {
+  for (let x of { [Symbol.iterator]() { return { next() { return 5; } }; } }) console.log(x);
+} catch (e) {
+  console.log(e instanceof TypeError);
+}
@@ -0,0 +1,110 @@
+// generators the compiler turns into state machines
+
+function* range(n) {
+    for (let i = 0; i < n; i++) {
+        if (i === 2) continue;
+        if (i === 5) break;
+        yield i;
+    }
+    return "range done";
+}
+
+function collect(gen) {
+    let values = [];
+    let item;
+    while (!(item = gen.next()).done) values.push(item.value);
+    values.push("=" + item.value);
+    return values.join();
+}
+
+console.log(collect(range(4)));
+console.log(collect(range(10)));
+
+function* echo() {
+    let received = [];
+    let x = yield "first";
+    while (x !== "stop") {
+        received.push(x);
+        x = yield x * 2;
+    }
+    return received.join("-");
+}
+
+let e = echo();
+console.log(e.next("ignored").value);
+console.log(e.next(1).value);
+console.log(e.next(2).value);
+let last = e.next("stop");
+console.log(last.value, last.done);
+console.log(e.next().done);
+
+function* delegating(arr) {
+    yield "start";
+    yield* arr;
+    for (let v of arr) {
+        if (v > 1) yield v * 10;
+    }
+    do {
+        yield "once";
+    } while (false);
+}
+console.log(collect(delegating([1, 2, 3])));
+
+function* thrower() {
+    yield 1;
+    yield 2;
+}
+let t = thrower();
+t.next();
+try {
+    t.throw(new Error("boom"));
+} catch (err) {
+    console.log("caught " + err.message);
+}
+console.log(t.next().done);
+
+let r = range(10);
+r.next();
+let ret = r.return(42);
+console.log(ret.value, ret.done);
+console.log(r.next().done);
+
+function* counter() {
+    let count = 0;
+    while (true) {
+        let step = yield count;
+        count += step || 1;
+        if (count > 5) return count;
+    }
+}
+let c = counter();
+c.next();
+c.next();
+c.next(3);
+console.log(c.next(10).value);
+
+function* self() {
+    yield gen.next();
+}
+let gen = self();
+try {
+    gen.next();
+} catch (err) {
+    console.log(err instanceof TypeError);
+}
+
+function* withThis() {
+    yield this.value;
+}
+console.log(withThis.call({ value: "this works" }).next().value);
+
+// try/finally isn't turned into a state machine
+function* guarded() {
+    try {
+        yield "a";
+        yield "b";
+    } finally {
+        console.log("finally");
+    }
+}
+console.log(collect(guarded()));
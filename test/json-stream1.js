@@ -0,0 +1,92 @@
+// the streaming JSON parser and writer on __ejs
+
+function show(values) {
+    return values.map(function (v) { return JSON.stringify(v); }).join(" | ");
+}
+
+var parser = new __ejs.JSONParser();
+var values = [];
+function take(vs) {
+    for (var i = 0; i < vs.length; i++) values.push(vs[i]);
+}
+take(parser.write('{"a": 1, "b": [1, 2'));
+console.log(values.length);
+take(parser.write(']}\n{"a": "}{"}\n"str'));
+console.log(values.length);
+take(parser.write('ing \\" with a quote"\n12'));
+take(parser.write("34 true null\n-5e"));
+take(parser.write("2 []"));
+take(parser.write("{}"));
+take(parser.end());
+console.log(show(values));
+
+// utf8 chunks split at every byte, including inside multibyte sequences
+var bytes = [0x7b, 0x22, 0x6b, 0x22, 0x3a, 0x22, 0xc3, 0xa9, 0xe2, 0x82, 0xac, 0xf0, 0x9f, 0x98, 0x80, 0x22, 0x7d, 0x0a];
+var ok = 0;
+for (var split = 0; split <= bytes.length; split++) {
+    var p = new __ejs.JSONParser();
+    var vs = p.write(new Uint8Array(bytes.slice(0, split)));
+    vs = vs.concat(p.write(new Uint8Array(bytes.slice(split))), p.end());
+    if (vs.length === 1 && vs[0].k === "é€😀") ok++;
+}
+console.log(ok, bytes.length + 1);
+console.log(show(new __ejs.JSONParser().write(new Uint8Array(bytes).buffer)));
+
+// invalid and truncated utf8
+var bad = new __ejs.JSONParser();
+var badValues = bad.write(new Uint8Array([0x22, 0xff, 0x41, 0xe2, 0x82]));
+badValues = badValues.concat(bad.write(new Uint8Array([0x41, 0x22, 0x0a])), bad.end());
+console.log(badValues.length, badValues[0] === "�A�A");
+
+// a malformed value throws, and parsing carries on after it
+var p2 = new __ejs.JSONParser();
+try {
+    p2.write('{"a": 1}\n{"b" 2}\n{"c": 3}\n');
+    console.log("no error");
+} catch (e) {
+    console.log(e instanceof SyntaxError);
+}
+console.log(show(p2.write("")), show(p2.end()));
+
+var p3 = new __ejs.JSONParser();
+p3.write("[1, 2");
+try {
+    p3.end();
+    console.log("no error");
+} catch (e) {
+    console.log(e instanceof SyntaxError);
+}
+console.log(show(p3.write("[3]")), show(p3.end()));
+
+// the writer
+var stream = {
+    chunks: [],
+    write: function (s) {
+        this.chunks.push(s);
+        return true;
+    },
+};
+var writer = new __ejs.JSONWriter(stream);
+writer.write({ a: 1, s: "x\ny" });
+writer.write([1, 2, { b: null }]);
+writer.write(undefined);
+writer.write({ toJSON: function () { return "custom"; } });
+console.log(stream.chunks.length);
+writer.end();
+console.log(stream.chunks.length, JSON.stringify(stream.chunks.join("")));
+
+stream.chunks = [];
+for (var i = 0; i < 3000; i++) writer.write({ id: i, name: "record" + i, tags: ["t" + (i % 7)] });
+console.log(stream.chunks.length);
+writer.end();
+var output = stream.chunks.join("");
+console.log(stream.chunks.length, output.length);
+
+var reparsed = new __ejs.JSONParser().write(output);
+console.log(reparsed.length, reparsed[2999].name, reparsed[10].tags[0]);
+
+try {
+    new __ejs.JSONWriter();
+} catch (e) {
+    console.log(e instanceof TypeError);
+}
@@ -0,0 +1,40 @@
+var doc = JSON.parse(' { "name" : "echo", "tags": ["a", "b\\n", "\\u00e9\\"q\\""], "nested": {"x": -0.5e2, "y": [[], {}, [1, [2, [3]]]]}, "big": 12345678901234567890, "t": true, "f": false, "n": null } ');
+console.log(doc.name, doc.tags.length, doc.tags[1] === "b\n", doc.tags[2]);
+console.log(doc.nested.x, doc.nested.y[2][1][1][0], doc.big === 12345678901234567890, doc.t, doc.f, doc.n);
+console.log(Object.keys(doc).join());
+console.log(doc.hasOwnProperty("name"), Array.isArray(doc.tags), Array.isArray(doc.nested.y[0]));
+
+// objects with the same keys
+var rows = JSON.parse('[{"id": 1, "v": "a"}, {"id": 2, "v": "b"}, {"v": "c", "id": 3}]');
+console.log(rows.map(function (r) { return r.id + r.v; }).join());
+console.log(Object.keys(rows[2]).join());
+
+// the last duplicate key wins, but keeps its first position
+var dup = JSON.parse('{"a": 1, "b": 2, "a": 3}');
+console.log(Object.keys(dup).join(), dup.a);
+
+console.log(JSON.parse('"\\ud83d\\ude00"').length, JSON.parse("-0") === 0, JSON.parse("1e3"), JSON.parse("  42  "));
+
+var bad = ["", "{", "[1,]", "{\"a\" 1}", "01", "1.", "-", "tru", "\"\\x\"", "\"a\nb\"", "[1] 2", "{'a': 1}", "NaN"];
+bad.forEach(function (text) {
+    try {
+        JSON.parse(text);
+        console.log("parsed " + text);
+    } catch (e) {
+        console.log(e instanceof SyntaxError);
+    }
+});
+
+var revived = JSON.parse('{"a": 1, "b": [1, 2, 3], "c": {"d": "drop", "e": 5}}', function (key, value) {
+    if (typeof value === "number") return value * 10;
+    if (value === "drop") return undefined;
+    return value;
+});
+console.log(revived.a, revived.b.join(), "d" in revived.c, revived.c.e);
+
+var seen = [];
+JSON.parse('{"x": [1, {"y": 2}]}', function (key, value) {
+    seen.push(key === "" ? "(root)" : key);
+    return value;
+});
+console.log(seen.join());
@@ -0,0 +1,76 @@
+var doc = {
+    name: "echo",
+    count: 42,
+    neg: -7,
+    ratio: 0.1 + 0.2,
+    big: 1e21,
+    small: 5e-7,
+    inf: Infinity,
+    nan: NaN,
+    t: true,
+    f: false,
+    n: null,
+    u: undefined,
+    fn: function () {},
+    nested: { list: [1, "two", [3], {}, [], undefined, function () {}], empty: {} },
+};
+console.log(JSON.stringify(doc));
+console.log(JSON.stringify(doc, null, 2));
+console.log(JSON.stringify([1, [2, { a: [] }]], null, "--"));
+
+// escapes, in and out of the four-at-a-time scan
+var s = "plain text long enough for a few words";
+console.log(JSON.stringify(s));
+console.log(JSON.stringify('a"b\\c\nd\te\u0001f\u001fg\u0014h'));
+console.log(JSON.stringify({ 'we"ird\n': 1, "é": "ü", " ": "😀" }));
+
+// objects sharing keys
+var rows = [];
+for (var i = 0; i < 5; i++) rows.push({ id: i, label: "row" + i, "q\"": i % 2 === 0 });
+console.log(JSON.stringify(rows));
+
+// holes and integer keys
+var holey = [1, , 3];
+console.log(JSON.stringify(holey));
+console.log(JSON.stringify({ b: 1, 2: "two", a: 2, 1: "one" }));
+
+// things the spec steps handle
+console.log(JSON.stringify({ d: { toJSON: function (key) { return "toJSON:" + key; } } }));
+var proto = { toJSON: function () { return "from proto"; } };
+console.log(JSON.stringify([Object.create(proto)]));
+console.log(JSON.stringify({ get g() { return "getter"; }, n: new Number(3), s: new String("x"), b: new Boolean(false) }));
+console.log(JSON.stringify({ a: 1, b: 2, c: 3 }, ["c", "a"]));
+console.log(JSON.stringify({ a: 1, b: "x" }, function (key, value) { return typeof value === "number" ? value * 2 : value; }));
+
+console.log(JSON.stringify(undefined) === undefined, JSON.stringify(function () {}) === undefined);
+console.log(JSON.stringify("top"), JSON.stringify(3.5), JSON.stringify(null), JSON.stringify(-1 / 0));
+
+var cyclic = { name: "loop" };
+cyclic.self = { parent: cyclic };
+try {
+    JSON.stringify(cyclic);
+    console.log("no error");
+} catch (e) {
+    console.log(e instanceof TypeError);
+}
+var cyclicArray = [1];
+cyclicArray.push([cyclicArray]);
+try {
+    JSON.stringify(cyclicArray);
+    console.log("no error");
+} catch (e) {
+    console.log(e instanceof TypeError);
+}
+
+// the same object twice isn't a cycle
+var shared = { x: 1 };
+console.log(JSON.stringify({ a: shared, b: [shared, shared] }));
+
+var deep = [];
+var cur = deep;
+for (var j = 0; j < 300; j++) {
+    var next = [];
+    cur.push(next);
+    cur = next;
+}
+console.log(JSON.stringify(deep).length);
@@ -0,0 +1,33 @@
+// generator: none
+
+import * as fs from "@node-compat/fs";
+
+var whole = fs.mmapSync("mmap1.js");
+console.log(whole.byteLength == fs.readFileSync("mmap1.js").length);
+
+var window = new Uint8Array(fs.mmapSync("mmap1.js", 3, 10));
+console.log(String.fromCharCode.apply(null, window));
+
+// a bad offset or length throws before the file is opened, so none of
+// these leave an fd behind
+var badLength = { valueOf: function () { throw new Error("bad length"); } };
+var badOffset = { valueOf: function () { throw new Error("bad offset"); } };
+var errors = 0;
+for (var i = 0; i < 5000; i ++) {
+    try {
+        fs.mmapSync("mmap1.js", i & 1 ? badOffset : 0, badLength);
+    }
+    catch (e) {
+        errors ++;
+    }
+}
+console.log(errors);
+
+try {
+    fs.mmapSync("mmap1.js", Symbol("offset"));
+}
+catch (e) {
+    console.log(e instanceof TypeError);
+}
+
+console.log(fs.mmapSync("mmap1.js", 0, 2).byteLength);
@@ -0,0 +1,31 @@
+// number <-> string conversions: shortest round trip, the fixed,
+// exponential and precision formats, radixes, and string parsing
+
+console.log(String(0.1), String(1 / 3), String(-0), String(1e21), String(1e-7), String(123e-20));
+console.log(String(2147483647), String(-2147483648), String(4294967296), String(5e-324));
+console.log("x" + 0.1 + 2.5e30 + -1.5);
+
+console.log((1234.5678).toFixed(2), (0.000001).toFixed(7), (-1.005).toFixed(2), (1e21).toFixed(2), (-0).toFixed(1));
+console.log((123.456).toExponential(), (123.456).toExponential(2), (0).toExponential(), (-5e-7).toExponential(3));
+console.log((123.456).toPrecision(2), (0.00000123).toPrecision(2), (123456).toPrecision(21), (1e21).toPrecision(3));
+console.log(NaN.toFixed(2), Infinity.toExponential(), (-Infinity).toPrecision(3));
+try { (1).toFixed(21); } catch (e) { console.log(e instanceof RangeError); }
+try { (1).toPrecision(0); } catch (e) { console.log(e instanceof RangeError); }
+
+console.log((255).toString(2), (-255).toString(16), (2147483647).toString(36), (-2147483648).toString(2));
+console.log((0.5).toString(2), (0.1).toString(3), (-255.75).toString(16), (1e21).toString(36));
+
+console.log(Number(""), Number("  42  "), Number("-0") === 0 && 1 / Number("-0"), Number("1e3"), Number(".5"), Number("5."));
+console.log(Number("0x1F"), Number("0o17"), Number("0b101"), Number("-0x10"), Number("0x"), Number("1_000"));
+console.log(Number("Infinity"), Number("-Infinity"), Number("infinity"), Number("12px"), Number(" \n7\t"));
+console.log(Number("123456789012345678901234567890"), Number("0.1") === 0.1, Number("9007199254740993"));
+
+console.log(parseInt("  -42px"), parseInt("0x1f"), parseInt("1f", 16), parseInt("z", 36), parseInt("777", 8));
+console.log(parseInt("11", 2), parseInt("12", 2), parseInt(""), 1 / parseInt("-0"), parseInt("9", 37));
+console.log(parseInt("123456789012345678901234567890"), parseInt("0xFFFFFFFFFFFFFFFFF"));
+console.log(parseFloat("  3.14abc"), parseFloat("-.5e-2x"), parseFloat("Infinityx"), parseFloat("0x10"), parseFloat("e5"));
+
+var a = [10, 20, 30];
+console.log(a["1"], a["01"], a["1.0"], a[" 1"]);
+a["01"] = "named";
+console.log(a.length, a[1], a["01"]);
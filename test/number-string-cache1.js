@@ -0,0 +1,23 @@
+// NumberToString caches the strings it makes, and the cache has to
+// give back the right string for every number, before and after a GC
+
+var stats = __ejs.numberStringCacheStats();
+console.log(stats.size);
+
+var values = [1234, -7, 1234, 0.5, -0, 1e21, 2.5e-7, 4294967296, 1234 + 4096, 0.5];
+console.log(values.join(","));
+console.log(values.map(String).join(","));
+
+var obj = {};
+for (var i = 0; i < 3000; i += 1000) obj[i + 500] = i;
+console.log(Object.keys(obj).join(","), obj[1500], obj["2500"]);
+
+var before = __ejs.numberStringCacheStats();
+var s = "";
+for (var i = 0; i < 3; i ++) s += [1001, 1002, 1003].join("-") + ";";
+console.log(s);
+var after = __ejs.numberStringCacheStats();
+console.log(after.hits - before.hits >= 6, after.misses >= before.misses);
+
+__ejs.GC.collect();
+console.log(String(1001), String(0.5), String(1234 + 4096), values.join(","));
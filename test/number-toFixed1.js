@@ -1,5 +1,3 @@
-// xfail: not implemented fully yet
-
 console.log(Math.PI.toFixed(1));
 console.log(Math.PI.toFixed(2));
 console.log(Math.PI.toFixed(3));
@@ -1,3 +1 @@
-// xfail: formatting floats with different bases just doesn't work.
-
 console.log(Number(16.5).toString(16));
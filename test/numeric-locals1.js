@@ -0,0 +1,107 @@
+// locals that only ever hold numbers are kept unboxed by the compiler.
+// these exercise the loops it targets, and the cases it has to leave
+// boxed (reads before assignment, non-number assignments.)
+
+function sum(n) {
+    var s = 0;
+    for (var i = 0; i < n; i++) s += i * 2;
+    return s;
+}
+
+function halve(n) {
+    var i = 0, acc = 0.5;
+    do {
+        acc = acc / 2 + i;
+        i++;
+    } while (i < n);
+    return acc;
+}
+
+function factorialAndString(n) {
+    var p = 1, q = "s";
+    for (var i = 1; i <= n; i++) {
+        p = p * i;
+        q = q + i;
+    }
+    return p + " " + q;
+}
+
+function readBeforeAssign(n) {
+    var k;
+    var seen = [];
+    for (var i = 0; i < n; i++) {
+        seen.push(String(k));
+        k = i;
+    }
+    return seen.join(",");
+}
+
+function conditional(a) {
+    var x;
+    if (a) x = 1;
+    return x + 1;
+}
+
+function negativeZero() {
+    var z = 0;
+    z = z * -1;
+    return 1 / z;
+}
+
+function nanLoop() {
+    var x = 0 / 0, n = 0;
+    for (var i = 0; i < 3; i++) {
+        if (x !== x) n++;
+    }
+    return n;
+}
+
+function postfix() {
+    var a = 5;
+    var b = a++;
+    var c = ++a;
+    var d = a--;
+    return [a, b, c, d].join(",");
+}
+
+function escapes() {
+    var total = 0;
+    var fns = [];
+    for (var i = 0; i < 3; i++) {
+        total += i;
+        fns.push(total);
+    }
+    return fns.join(",") + " " + typeof total;
+}
+
+function mixedOps(n) {
+    var h = 7;
+    for (var i = 0; i < n; i++) h = (h * 31 + i) % 1000003;
+    var bits = h & 0xff;
+    return h + " " + bits + " " + (h > 500 ? "big" : "small");
+}
+
+// the continue reaches the update before j is ever assigned, so j
+// holds undefined there and can't be unboxed
+function continueBeforeAssign() {
+    var j;
+    var iterations = 0;
+    for (var i = 0; i < 3; i = j + 1) {
+        iterations++;
+        if (i == 0) continue;
+        j = i;
+    }
+    return iterations + " " + i;
+}
+
+console.log(sum(10));
+console.log(halve(5));
+console.log(factorialAndString(5));
+console.log(readBeforeAssign(3));
+console.log(conditional(true), conditional(false));
+console.log(negativeZero());
+console.log(nanLoop());
+console.log(postfix());
+console.log(escapes());
+console.log(mixedOps(100));
+console.log(continueBeforeAssign());
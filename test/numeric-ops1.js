@@ -0,0 +1,71 @@
+// the compiler open-codes arithmetic, comparison and bitwise operators
+// when both operands are numbers.  make sure the fast path agrees with
+// the runtime for the edge cases, and that non-numbers still work.
+
+function show(name, v) {
+    console.log(name + ": " + v);
+}
+
+var nan = NaN, inf = Infinity, big = 4294967296 + 5, neg = -7.9;
+
+show("add", 1.5 + 2.25);
+show("sub", 1 - 3);
+show("mul", 3 * -2.5);
+show("div", 1 / 4);
+show("div0", 1 / 0);
+show("mod", 7 % 3);
+show("mod neg", -7 % 3);
+show("mod frac", 5.5 % 2);
+show("mod nan", 1 % 0);
+show("nan add", nan + 1);
+
+show("lt", 1 < 2);
+show("le", 2 <= 2);
+show("gt", 1 > 2);
+show("ge", 2 >= 3);
+show("nan lt", nan < 1);
+show("nan ge", nan >= nan);
+show("eq", 1 == 1.0);
+show("seq", 0 === -0);
+show("nan eq", nan == nan);
+show("nan seq", nan === nan);
+show("ne", 1 != 2);
+show("nan sne", nan !== nan);
+
+show("and", 0xff & 0x0f);
+show("or", 0xf0 | 0x0f);
+show("xor", 0xff ^ 0x0f);
+show("and neg", neg & 0xff);
+show("or big", big | 0);
+show("or inf", inf | 0);
+show("or nan", nan | 0);
+show("or 2^63", 9223372036854775808 | 1);
+show("shl", 1 << 31);
+show("shl mask", 1 << 33);
+show("sar", -16 >> 2);
+show("shr", -16 >>> 2);
+show("shr 0", -1 >>> 0);
+show("sar frac", 17.9 >> 1.9);
+
+// slow paths
+show("str add", "a" + 1);
+show("str lt", "a" < "b");
+show("str mul", "3" * "4");
+show("obj add", { valueOf: function() { return 41; } } + 1);
+show("str eq", "1" == 1);
+show("str seq", "1" === 1);
+show("undef sub", undefined - 1);
+show("bool or", true | 2);
+
+var i = 0, s = 0;
+for (i = 0; i < 10; i++) s += i;
+show("loop", s);
+var d = 10;
+show("postdec", d--);
+show("predec", --d);
+var str = "5";
+str++;
+show("str inc", str);
+var f = 0.5;
+f++;
+show("frac inc", f);
@@ -0,0 +1,39 @@
+// regexp literals and RegExp objects with the same source share their
+// compiled pattern, but each is still its own object
+
+function make() { return /o+/g; }
+
+var a = make();
+var b = make();
+console.log(a === b);
+a.exec("foo");
+console.log(a.lastIndex, b.lastIndex);
+console.log(a.source, b.source, a.flags, b.flags);
+
+// more distinct patterns than the runtime caches
+var seen = 0;
+for (var i = 0; i < 200; i ++) {
+    var re = new RegExp("x" + (i % 100) + "y");
+    if (re.test("ax" + (i % 100) + "yb")) seen++;
+}
+console.log(seen);
+
+// same source, different flags
+var plain = new RegExp("abc");
+var caseless = new RegExp("abc", "i");
+console.log(plain.test("ABC"), caseless.test("ABC"));
+
+var multiline = new RegExp("^b", "m");
+console.log(new RegExp("^b").test("a\nb"), multiline.test("a\nb"));
+
+try {
+    new RegExp("(");
+    console.log("no exception");
+} catch (e) {
+    console.log(e instanceof SyntaxError);
+}
+
+var words = [];
+for (var j = 0; j < 3; j ++)
+    words.push("one two three".replace(/t\w+/g, "_"));
+console.log(words.join("|"));
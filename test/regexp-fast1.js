@@ -0,0 +1,60 @@
+// the builtins take a fast path for plain RegExps, and have to behave
+// exactly like the spec steps
+
+console.log("a-b-c".replace(/-/g, "+"));
+console.log("a-b-c".replace(/-/, "+"));
+console.log("john smith".replace(/(\w+)\s(\w+)/, "$2, $1"));
+console.log("abc".replace(/b/, "[$`|$&|$'|$$|$3|$0]"));
+console.log("x1y22z333".replace(/(\d)(\d)?/g, function (m, a, b, pos) {
+    return "<" + m + ":" + a + ":" + (b === undefined ? "u" : b) + "@" + pos + ">";
+}));
+console.log("aaa".replace(/a*?/g, "-"));
+console.log("".replace(/x*/g, "!"));
+
+var g = /o/g;
+g.lastIndex = 5;
+console.log("foo boo".replace(g, "0"), g.lastIndex);
+
+var m = "a1b22c333".match(/\d+/g);
+console.log(m.length, m.join(","));
+console.log("abc".match(/x/g));
+console.log("abc".match(/(?:)/g).length);
+
+console.log("a, b,c ,d".split(/\s*,\s*/).join("|"));
+console.log("a1b2c3".split(/(\d)/).join("|"));
+console.log("a1b2c3".split(/\d/, 2).join("|"));
+console.log("abc".split(/(?:)/).join("|"));
+console.log("".split(/x/).length, "".split(/(?:)/).length);
+
+console.log("hello world".search(/o/), "hello".search(/z/));
+
+var t = /a/g;
+var results = [];
+for (var i = 0; i < 4; i ++)
+    results.push(t.test("aa") + "@" + t.lastIndex);
+console.log(results.join(" "));
+
+var sticky = new RegExp("b", "y");
+console.log(sticky.test("ab"), sticky.lastIndex);
+sticky.lastIndex = 1;
+console.log(sticky.test("ab"), sticky.lastIndex);
+
+// an own exec means the builtins have to call it
+var custom = /x/g;
+var calls = 0;
+custom.exec = function (s) {
+    calls++;
+    return RegExp.prototype.exec.call(this, s);
+};
+console.log("axbx".replace(custom, "y"), calls > 0);
+
+// a global replace starts from lastIndex 0, the replacer sees 0, and
+// whatever it sets lastIndex to sticks
+var seenLastIndex = [];
+var g = /o/g;
+g.lastIndex = 5;
+console.log("foo boo".replace(g, function (m) {
+    seenLastIndex.push(g.lastIndex);
+    g.lastIndex = 42;
+    return "0";
+}), seenLastIndex.join(","), g.lastIndex);
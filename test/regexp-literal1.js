@@ -0,0 +1,41 @@
+// literal patterns, small character classes and patterns with a
+// literal prefix are searched for without pcre, and have to match
+// exactly what pcre would
+
+console.log("a,b,,c".split(/,/).join("|"));
+console.log("one\ntwo\nthree".split(/\n/).length);
+console.log("a;b,c;d".split(/[,;]/).join("|"));
+console.log("a.b.c".split(/\./).join("|"));
+console.log("a-b]c".split(/[-\]]/).join("|"));
+console.log("a+b+c".replace(/\+/g, " plus "));
+console.log("a/b/c".replace(/\//, "\\"));
+console.log("x.y$z".replace(/[.$]/g, "_"));
+
+console.log(/^GET /.test("GET /index.html"), /^GET /.test("POST /GET /"));
+console.log(/GET /.exec("POST /GET /").index);
+console.log("foofoo".replace(/^foo/g, "bar"));
+console.log(/^a/m.exec("b\na").index);
+
+console.log("id1 foo12 bar foo3 foo".match(/foo\d+/g).join(","));
+console.log("x abc abd abbd".match(/ab+d/g).join(","));
+console.log("colour color".match(/colou?r/g).join(","));
+console.log("cat dog".replace(/dog|cat/g, "pet"));
+console.log("abcABC".replace(/b/gi, "_"));
+console.log("a1a22".replace(/a(\d+)/g, "[$1]"));
+
+var sticky = new RegExp("ab", "y");
+console.log(sticky.test("xab"), sticky.lastIndex);
+sticky.lastIndex = 1;
+console.log(sticky.test("xab"), sticky.lastIndex);
+var stickyClass = new RegExp("[ab]", "y");
+stickyClass.lastIndex = 1;
+console.log(stickyClass.exec("xba")[0], stickyClass.lastIndex);
+
+var g = /o/g;
+var positions = [];
+var m;
+while ((m = g.exec("foo boo")) !== null) positions.push(m.index);
+console.log(positions.join(","), g.lastIndex);
+
+console.log("hello".search(/l/), "hello".search(/[xyz]/), "hello".search(/lo/));
+console.log("aaa".replace(/a/g, "$&$&"));
@@ -14,6 +14,8 @@ const path = require("path"),
 const skip_ifs = Object.create(null); // `// skip-if: ...` an expression, evaled.  if true, ignore the test
 const xfails = Object.create(null); // `// xfail: ...`   test is expected to fail.  ... is the reason
 const generators = Object.create(null); // `// generator: ...` ... is the executable used to generate expected output
+const test_envs = Object.create(null); // `// env: NAME=value` set NAME in the test executable's environment
+const type_profiles = Object.create(null); // `// type-profile: round-trip` compile with --record-types, run, then compile with --use-type-profile
 
 const expected_names = Object.create(null);
 const expected_stdouts = Object.create(null);
@@ -184,71 +186,114 @@ function processOneTest(gen_expected, test, cb) {
         }
         return;
     } else {
-        try {
-            const start = timerStart();
-            const platform_target = platform_to_test ? ["--target", platform_to_test] : [];
-            const ccomp = spawn(
-                compilers[stage_to_run],
-                platform_target.concat([
-                    "--srcdir",
-                    "--moduledir",
-                    "../node-compat",
-                    "--moduledir",
-                    "../ejs-llvm",
-                    test,
-                ])
-            );
-            ccomp.on("exit", function (code, errstring) {
-                if (code !== 0) {
-                    const elapsed = getElapsed(start);
-                    testFailed(test_name, `compiler failed (exit code = ${code})`, elapsed);
-                    cb();
-                    return;
-                }
-                // XXX check code to make sure we were successful?
-                let env;
-                if (platform_to_test === "sim") {
-                    process.env["EJS_FORCE_STDOUT"] = "1";
-                    process.env["DYLD_FRAMEWORK_PATH"] =
-                        "/Applications/Xcode.app/Contents/Developer/Platforms/iPhoneSimulator.platform/Developer/SDKs/iPhoneSimulator.sdk/System/Library/Frameworks:/Applications/Xcode.app/Contents/Developer/Platforms/iPhoneSimulator.platform/Developer/SDKs/iPhoneSimulator.sdk/System/Library/PrivateFrameworks";
-                    process.env["DYLD_LIBRARY_PATH"] =
-                        "/Applications/Xcode.app/Contents/Developer/Platforms/iPhoneSimulator.platform/Developer/SDKs/iPhoneSimulator.sdk/usr/lib:/Applications/Xcode.app/Contents/Developer/Platforms/iPhoneSimulator.platform/Developer/SDKs/iPhoneSimulator.sdk/usr/lib/system:/Applications/Xcode.app/Contents/Developer/Platforms/iPhoneSimulator.platform/Developer/SDKs/iPhoneSimulator.sdk/System/Library/PrivateFrameworks/FontServices.framework:/Applications/Xcode.app/Contents/Developer/Platforms/iPhoneSimulator.platform/Developer/SDKs/iPhoneSimulator.sdk/System/Library/Frameworks/Accelerate.framework/Frameworks/vecLib.framework:/Applications/Xcode.app/Contents/Developer/Platforms/iPhoneSimulator.platform/Developer/SDKs/iPhoneSimulator.sdk//System/Library/Frameworks/OpenGLES.framework";
-                }
-
-                const cexec = spawn("./" + test + ".exe");
-                let test_stdout = "";
-                let test_stderr = "";
-                cexec.on("close", function (code, errstring) {
-                    stdouts[test_name] = test_stdout;
-
-                    // XXX check code to make sure we were successful?
-
-                    var elapsed = getElapsed(start);
-                    checkStdout(test_name, elapsed, cb);
-                });
-                cexec.on("error", function (err) {
-                    var elapsed = getElapsed(start);
-                    testFailed(test_name, err.toString(), elapsed);
-                    cb();
-                });
-                cexec.stdout.on("data", function (msg) {
-                    test_stdout += msg;
-                });
-                cexec.stderr.on("data", function (msg) {
-                    test_stderr += msg;
+        const start = timerStart();
+        const test_env = Object.assign({}, process.env, test_envs[test_name]);
+
+        if (type_profiles[test_name] === "round-trip") {
+            // compile with --record-types and run to write the profile,
+            // then compile against it and run again.  both runs have to
+            // match the expected output.
+            temp.open("ejstest-profile", function (err, info) {
+                fs.closeSync(info.fd);
+                const env = Object.assign({}, test_env, { EJS_TYPE_PROFILE: info.path });
+                compileAndRun(test, ["--record-types"], env, function (err_string, recorded_stdout) {
+                    if (err_string) {
+                        testFailed(test_name, "recording run: " + err_string, getElapsed(start));
+                        cb();
+                        return;
+                    }
+                    if (fs.statSync(info.path).size === 0) {
+                        testFailed(test_name, "recording run wrote no type profile", getElapsed(start));
+                        cb();
+                        return;
+                    }
+                    if (recorded_stdout != expected_stdouts[test_name]) {
+                        stdouts[test_name] = recorded_stdout;
+                        checkStdout(test_name, getElapsed(start), cb);
+                        return;
+                    }
+                    compileAndRun(test, ["--use-type-profile", info.path], test_env, function (err_string, test_stdout) {
+                        fs.unlinkSync(info.path);
+                        if (err_string) {
+                            testFailed(test_name, err_string, getElapsed(start));
+                            cb();
+                            return;
+                        }
+                        stdouts[test_name] = test_stdout;
+                        checkStdout(test_name, getElapsed(start), cb);
+                    });
                 });
             });
-            ccomp.on("error", function (err) {
-                const elapsed = getElapsed(start);
-                testFailed(test_name, err.toString(), elapsed);
+            return;
+        }
+
+        compileAndRun(test, [], test_env, function (err_string, test_stdout) {
+            if (err_string) {
+                testFailed(test_name, err_string, getElapsed(start));
                 cb();
                 return;
+            }
+            stdouts[test_name] = test_stdout;
+            checkStdout(test_name, getElapsed(start), cb);
+        });
+    }
+}
+
+// compiles @test (passing @compiler_args along) and runs the executable
+// with @env.  calls cb(err_string, stdout).
+function compileAndRun(test, compiler_args, env, cb) {
+    try {
+        const platform_target = platform_to_test ? ["--target", platform_to_test] : [];
+        const ccomp = spawn(
+            compilers[stage_to_run],
+            platform_target.concat(compiler_args, [
+                "--srcdir",
+                "--moduledir",
+                "../node-compat",
+                "--moduledir",
+                "../ejs-llvm",
+                test,
+            ])
+        );
+        ccomp.on("exit", function (code, errstring) {
+            if (code !== 0) {
+                cb(`compiler failed (exit code = ${code})`);
+                return;
+            }
+            // XXX check code to make sure we were successful?
+            if (platform_to_test === "sim") {
+                env = Object.assign({}, env, {
+                    EJS_FORCE_STDOUT: "1",
+                    DYLD_FRAMEWORK_PATH:
+                        "/Applications/Xcode.app/Contents/Developer/Platforms/iPhoneSimulator.platform/Developer/SDKs/iPhoneSimulator.sdk/System/Library/Frameworks:/Applications/Xcode.app/Contents/Developer/Platforms/iPhoneSimulator.platform/Developer/SDKs/iPhoneSimulator.sdk/System/Library/PrivateFrameworks",
+                    DYLD_LIBRARY_PATH:
+                        "/Applications/Xcode.app/Contents/Developer/Platforms/iPhoneSimulator.platform/Developer/SDKs/iPhoneSimulator.sdk/usr/lib:/Applications/Xcode.app/Contents/Developer/Platforms/iPhoneSimulator.platform/Developer/SDKs/iPhoneSimulator.sdk/usr/lib/system:/Applications/Xcode.app/Contents/Developer/Platforms/iPhoneSimulator.platform/Developer/SDKs/iPhoneSimulator.sdk/System/Library/PrivateFrameworks/FontServices.framework:/Applications/Xcode.app/Contents/Developer/Platforms/iPhoneSimulator.platform/Developer/SDKs/iPhoneSimulator.sdk/System/Library/Frameworks/Accelerate.framework/Frameworks/vecLib.framework:/Applications/Xcode.app/Contents/Developer/Platforms/iPhoneSimulator.platform/Developer/SDKs/iPhoneSimulator.sdk//System/Library/Frameworks/OpenGLES.framework",
+                });
+            }
+
+            const cexec = spawn("./" + test + ".exe", [], { env: env });
+            let test_stdout = "";
+            let test_stderr = "";
+            cexec.on("close", function (code, errstring) {
+                // XXX check code to make sure we were successful?
+                cb(null, test_stdout);
             });
-        } catch (e) {
-            console.log(e);
-            setTimeout(cb, 0);
-            return;
-        }
+            cexec.on("error", function (err) {
+                cb(err.toString());
+            });
+            cexec.stdout.on("data", function (msg) {
+                test_stdout += msg;
+            });
+            cexec.stderr.on("data", function (msg) {
+                test_stderr += msg;
+            });
+        });
+        ccomp.on("error", function (err) {
+            cb(err.toString());
+        });
+    } catch (e) {
+        console.log(e);
+        cb(e.toString());
     }
 }
 
@@ -312,6 +357,18 @@ function readTest(test) {
                 throw new Error("test " + test + " already has a generator: directive");
             generators[test_name] = line.substr("generator:".length).trim();
         }
+
+        if (line.indexOf("env:") === 0) {
+            let [env_name, ...env_value] = line.substr("env:".length).trim().split("=");
+            if (!test_envs[test_name]) test_envs[test_name] = Object.create(null);
+            test_envs[test_name][env_name] = env_value.join("=");
+        }
+
+        if (line.indexOf("type-profile:") === 0) {
+            if (type_profiles[test_name])
+                throw new Error("test " + test + " already has a type-profile: directive");
+            type_profiles[test_name] = line.substr("type-profile:".length).trim();
+        }
     }
 }
 
@@ -25,3 +25,14 @@ var t3 = setTimeout(log, 40, "40");
 setTimeout(function () {
     clearTimeout(t3);
 });
+
+// Clearing one that already fired leaves alone whatever reused its handle
+// (here most likely console.log's flush task).
+var t4 = setTimeout(function () {
+    log("50");
+    setTimeout(function () {
+        clearTimeout(t4);
+        log("cleared a fired timer");
+        setTimeout(log, 10, "still flushing");
+    }, 10);
+}, 50);
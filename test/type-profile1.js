@@ -0,0 +1,32 @@
+// type-profile: round-trip
+// runs once built with --record-types, then again built with
+// --use-type-profile, where the loads below that only saw dense arrays
+// are inlined and the string-only + skips its numeric check.
+
+function get(a, i) {
+    return a[i];
+}
+
+var a = [];
+for (var i = 0; i < 100; i ++)
+    a.push(i * 2);
+
+var sum = 0;
+for (var i = 0; i < a.length; i ++)
+    sum += get(a, i);
+console.log(sum);
+
+// keys the inline load hands back to the runtime
+console.log(get(a, -1), get(a, 100), get(a, 1.5), get(a, "3"), get(a, "length"));
+
+var label = "";
+for (var i = 0; i < 5; i ++)
+    label = label + "x";
+console.log(label);
+
+// a hole has to look at the prototype chain
+var holes = [1, , 3];
+console.log(get(holes, 1));
+Array.prototype[1] = "from the prototype";
+console.log(get(holes, 1));
+delete Array.prototype[1];